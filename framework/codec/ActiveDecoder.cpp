@@ -5,6 +5,7 @@
 
 #include "ActiveDecoder.h"
 #include "utils/timer.h"
+#include <utils/afTrace.h>
 #include <utils/errors/framework_error.h>
 #include <utils/frame_work_log.h>
 
@@ -82,12 +83,16 @@ int ActiveDecoder::decode_func()
         af_usleep(10000);
         return 0;
     }
+    AF_TRACE_SCOPE("decoder", "decode_func");
     int needWait = 0;
     int ret;
     int64_t pts = INT64_MIN;
     while (!mInputQueue.empty() && mOutputQueue.size() < maxOutQueueSize && mRunning) {
         needWait = 0;
-        ret = extract_decoder();
+        {
+            AF_TRACE_SCOPE("decoder", "extract_decoder");
+            ret = extract_decoder();
+        }
         if (ret == 0) {
             needWait++;
         } else if (ret < 0) {
@@ -104,7 +109,10 @@ int ActiveDecoder::decode_func()
 
         pts = pPacket->getInfo().pts;
         std::unique_ptr<IAFPacket> packet = std::unique_ptr<IAFPacket>(pPacket);
-        ret = enqueue_decoder(packet);
+        {
+            AF_TRACE_SCOPE("decoder", "enqueue_decoder");
+            ret = enqueue_decoder(packet);
+        }
 
         if (ret == -EAGAIN) {
             needWait++;
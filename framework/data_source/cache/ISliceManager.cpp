@@ -62,7 +62,9 @@ namespace Cicada {
 
     slice *ISliceManager::getSlice(uint64_t capacity, uint64_t position, SliceReleaseCb &release)
     {
-        uint8_t *buffer = mBufferPool->getBuffer();
+        // reuse the least recently used one instead of allocating when the memory governor asks
+        bool overBudget = mAccount.isOverBudget();
+        uint8_t *buffer = overBudget ? mBufferPool->getIdleBuffer() : mBufferPool->getBuffer();
 
         if (buffer == nullptr) {
             //TODO: cal the slice score,release the lowest one
@@ -90,12 +92,57 @@ namespace Cicada {
             }
         }
 
-        std::unique_lock<std::mutex> lock(mSliceLock);
         memPoolSlice *slice = new memPoolSlice(capacity, position, buffer, release);
-        mSliceQueue.push_back(slice);
+        {
+            std::unique_lock<std::mutex> lock(mSliceLock);
+            mSliceQueue.push_back(slice);
+        }
+
+        if (!overBudget) {
+            updateUsage();
+        }
+
         return slice;
     }
 
+    int64_t ISliceManager::evict(int64_t bytes)
+    {
+        int64_t allocated = mBufferPool->getAllocatedSize();
+        mBufferPool->trim();
+
+        while (allocated - (int64_t) mBufferPool->getAllocatedSize() < bytes) {
+            memPoolSlice *deleteSlice = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mSliceLock);
+
+                if (mSliceQueue.empty()) {
+                    break;
+                }
+
+                deleteSlice = mSliceQueue.front();
+                mSliceQueue.pop_front();
+            }
+
+            if (!deleteSlice->tryReleaseReference()) {
+                std::unique_lock<std::mutex> lock(mSliceLock);
+                mSliceQueue.push_front(deleteSlice);
+                break;
+            }
+
+            mBufferPool->releaseBuffer(deleteSlice->getBuffer());
+            delete deleteSlice;
+            mBufferPool->trim();
+        }
+
+        updateUsage();
+        return allocated - (int64_t) mBufferPool->getAllocatedSize();
+    }
+
+    void ISliceManager::updateUsage()
+    {
+        mAccount.setUsage(memoryGovernor::COMPONENT_SLICE_CACHE, (int64_t) mBufferPool->getAllocatedSize());
+    }
+
     int ISliceManager::getSliceSize()
     {
         return mSliceSize;
@@ -8,6 +8,7 @@
 #include "memPool.h"
 #include "memPoolSlice.h"
 #include <mutex>
+#include <utils/memoryGovernor.h>
 using namespace std;
 
 namespace Cicada{
@@ -29,12 +30,18 @@ namespace Cicada{
     private:
         ISliceManager();
 
+        // release the least recently used slices and free the idle buffers, return the bytes freed
+        int64_t evict(int64_t bytes);
+
+        void updateUsage();
+
     private:
         IMemPool *mBufferPool = nullptr;
         std::deque<memPoolSlice *> mSliceQueue;
         int64_t mCapacity;
         int mSliceSize;
         mutex mSliceLock;
+        memoryGovernor::account mAccount{"sliceCache", [this](int64_t bytes) { return evict(bytes); }};
     };
 }
 
@@ -18,7 +18,7 @@ namespace Cicada {
         std::lock_guard<std::mutex> lock(mMutex);
 
         while (!mBufferQueue.empty()) {
-            delete mBufferQueue.front();
+            delete[] mBufferQueue.front();
             mBufferQueue.pop_front();
         }
     }
@@ -43,9 +43,39 @@ namespace Cicada {
         return buffer;
     }
 
+    uint8_t *fixSizePool::getIdleBuffer()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mBufferQueue.empty()) {
+            return nullptr;
+        }
+
+        uint8_t *buffer = mBufferQueue.front();
+        mBufferQueue.pop_front();
+        return buffer;
+    }
+
     void fixSizePool::releaseBuffer(uint8_t *buffer)
     {
         std::lock_guard<std::mutex> lock(mMutex);
         mBufferQueue.push_back(buffer);
     }
+
+    void fixSizePool::trim()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        while (!mBufferQueue.empty()) {
+            delete[] mBufferQueue.front();
+            mBufferQueue.pop_front();
+            mAllocedCount--;
+        }
+    }
+
+    uint64_t fixSizePool::getAllocatedSize()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mAllocedCount * mBufferSize;
+    }
 }
@@ -18,8 +18,15 @@ namespace Cicada{
 
         virtual uint8_t *getBuffer() = 0;
 
+        // a released buffer, never allocate a new one
+        virtual uint8_t *getIdleBuffer() = 0;
+
         virtual void releaseBuffer(uint8_t *buffer) = 0;
 
+        // free the released buffers
+        virtual void trim() = 0;
+
+        virtual uint64_t getAllocatedSize() = 0;
 
     };
 
@@ -31,8 +38,14 @@ namespace Cicada{
 
         uint8_t *getBuffer() override;
 
+        uint8_t *getIdleBuffer() override;
+
         void releaseBuffer(uint8_t *buffer) override;
 
+        void trim() override;
+
+        uint64_t getAllocatedSize() override;
+
     private:
         int mBufferSize;
         uint64_t mBufferNum;
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <utils/afTrace.h>
 #include <utils/errors/framework_error.h>
 #include <utils/frame_work_log.h>
 #include <utils/timer.h>
@@ -181,6 +182,7 @@ size_t Cicada::CURLConnection2::write_callback(char *buffer, size_t size, size_t
     if (!userp) {
         return CURL_WRITEFUNC_PAUSE;
     }
+    AF_TRACE_SCOPE("network", "write_callback");
     auto *pHandle = (CURLConnection2 *) userp;
     assert(!pHandle->mPaused);
     auto amount = (uint32_t) (size * nitems);
@@ -8,12 +8,20 @@
 
 #include "CURLShareInstance.h"
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <mutex>
+#ifdef USE_OPENSSL
+#include <openssl/ssl.h>
+#endif
+#include <utils/CicadaJSON.h>
 #include <utils/UrlUtils.h>
+#include <utils/property.h>
 
 using namespace Cicada;
 
+#define DEFAULT_SSL_SESSION_HOSTS 16
+
 static curl_sslbackend getCurlSslBackend()
 {
     const curl_ssl_backend **list;
@@ -33,7 +41,13 @@ CURLShareInstance::CURLShareInstance()
     mSslbackend = getCurlSslBackend();
     curl_global_init(CURL_GLOBAL_DEFAULT);
     mShareWithDNS = unique_ptr<curlShare>(new curlShare());
-    mShare = unique_ptr<curlShare>(new curlShare(CURL_LOCK_DATA_SSL_SESSION));
+    mShare = unique_ptr<curlShare>(new curlShare(curlShare::SHARED_SSL_SESSION));
+
+    int hosts = atoi(getProperty("ro.network.tls.sessionCacheHosts"));
+    if (hosts <= 0) {
+        hosts = DEFAULT_SSL_SESSION_HOSTS;
+    }
+    mSslShares.resize(hosts);
 }
 
 CURLShareInstance::~CURLShareInstance()
@@ -69,7 +83,11 @@ curl_slist *CURLShareInstance::getHosts(const string &url, CURLSH **sh)
     string hostName = urlComponents.host;
     hostName += ":" + to_string(port);
     auto resolveItem = resolve.find(hostName);
-    *sh = (CURLSH *) (*mShare);
+    if (strcmp(urlComponents.proto.c_str(), "https") == 0) {
+        *sh = (CURLSH *) (*getSslSessionShare(hostName));
+    } else {
+        *sh = (CURLSH *) (*mShare);
+    }
 
     if (resolveItem == resolve.end() || (*resolveItem).second.empty()) {
         return host;
@@ -96,4 +114,117 @@ curl_slist *CURLShareInstance::getHosts(const string &url, CURLSH **sh)
 curl_sslbackend CURLShareInstance::getSslbakcend()
 {
     return mSslbackend;
-}
\ No newline at end of file
+}
+
+curlShare *CURLShareInstance::getSslSessionShare(const string &hostName)
+{
+    std::lock_guard<std::mutex> lock(mSslSessionMutex);
+    auto item = mSslHosts.find(hostName);
+
+    if (item != mSslHosts.end()) {
+        mSslHostLru.splice(mSslHostLru.begin(), mSslHostLru, item->second.first);
+        return mSslShares[item->second.second].get();
+    }
+
+    size_t slot = mSslHosts.size();
+
+    if (slot >= mSslShares.size()) {
+        // reuse the share of the least recently used host, curl will drop its sessions by LRU
+        auto last = mSslHosts.find(mSslHostLru.back());
+        assert(last != mSslHosts.end());
+        slot = last->second.second;
+        mSslHosts.erase(last);
+        mSslHostLru.pop_back();
+    }
+
+    if (mSslShares[slot] == nullptr) {
+        mSslShares[slot] = unique_ptr<curlShare>(new curlShare(curlShare::SHARED_SSL_SESSION));
+    }
+
+    mSslHostLru.push_front(hostName);
+    mSslHosts[hostName] = std::make_pair(mSslHostLru.begin(), slot);
+    return mSslShares[slot].get();
+}
+
+void CURLShareInstance::onConnected(CURL *handle)
+{
+    long connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+
+    // reuse a alive connection, no handshake at all
+    if (connects <= 0) {
+        return;
+    }
+
+    if (!isTlsSessionStatsSupported()) {
+        return;
+    }
+
+#if defined(USE_OPENSSL) && LIBCURL_VERSION_NUM >= 0x073000
+    struct curl_tlssessioninfo *info = nullptr;
+    CURLcode ret = curl_easy_getinfo(handle, CURLINFO_TLS_SSL_PTR, &info);
+
+    if (ret != CURLE_OK || info == nullptr || info->backend != CURLSSLBACKEND_OPENSSL || info->internals == nullptr) {
+        return;
+    }
+
+    bool resumed = SSL_session_reused((SSL *) info->internals) == 1;
+    curl_off_t connectTime = 0;
+    curl_off_t appConnectTime = 0;
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connectTime);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appConnectTime);
+    uint64_t handshake = appConnectTime > connectTime ? appConnectTime - connectTime : 0;
+
+    std::lock_guard<std::mutex> lock(mSslSessionMutex);
+
+    if (resumed) {
+        mTlsStats.hits++;
+        mTlsStats.resumedHandshakeUs += handshake;
+    } else {
+        mTlsStats.misses++;
+        mTlsStats.fullHandshakeUs += handshake;
+    }
+#endif
+}
+
+CURLShareInstance::TlsSessionStats CURLShareInstance::getTlsSessionStats()
+{
+    std::lock_guard<std::mutex> lock(mSslSessionMutex);
+    return mTlsStats;
+}
+
+bool CURLShareInstance::isTlsSessionStatsSupported() const
+{
+#if defined(USE_OPENSSL) && LIBCURL_VERSION_NUM >= 0x073000
+    return mSslbackend == CURLSSLBACKEND_OPENSSL;
+#else
+    return false;
+#endif
+}
+
+std::string CURLShareInstance::getTlsSessionStatsInfo()
+{
+    CicadaJSONItem Json;
+
+    if (!isTlsSessionStatsSupported()) {
+        Json.addValue("hits", -1);
+        Json.addValue("misses", -1);
+        return Json.printJSON();
+    }
+
+    TlsSessionStats stats = getTlsSessionStats();
+    Json.addValue("hits", (long) stats.hits);
+    Json.addValue("misses", (long) stats.misses);
+
+    int64_t resumedCost = stats.hits > 0 ? stats.resumedHandshakeUs / stats.hits : 0;
+    int64_t fullCost = stats.misses > 0 ? stats.fullHandshakeUs / stats.misses : 0;
+    Json.addValue("resumedHandshakeCost", (long) resumedCost);
+    Json.addValue("fullHandshakeCost", (long) fullCost);
+
+    // estimate of the handshake time saved by the resumed sessions
+    if (stats.hits > 0 && stats.misses > 0 && fullCost > resumedCost) {
+        Json.addValue("savedTime", (long) ((fullCost - resumedCost) * stats.hits));
+    }
+
+    return Json.printJSON();
+}
@@ -9,29 +9,69 @@
 #ifndef CURLShareInstance_H
 #define CURLShareInstance_H
 
+#include <atomic>
 #include <curl/curl.h>
+#include <list>
+#include <map>
 #include <mutex>
 #include <utils/globalSettings.h>
+#include <vector>
 #include "curlShare.h"
 
 namespace Cicada{
 
     class CURLShareInstance {
+    public:
+        struct TlsSessionStats {
+            uint64_t hits{0};
+            uint64_t misses{0};
+            // accumulated TLS handshake cost (APPCONNECT - CONNECT) in us
+            uint64_t resumedHandshakeUs{0};
+            uint64_t fullHandshakeUs{0};
+        };
+
     public:
         static CURLShareInstance *Instance();
 
         curl_slist *getHosts(const string &url, CURLSH **sh);
         curl_sslbackend getSslbakcend();
 
+        /*
+         * called after a transfer is established, count the TLS session
+         * resumption of the connection which the handle created
+         */
+        void onConnected(CURL *handle);
+
+        TlsSessionStats getTlsSessionStats();
+
+        // only the OpenSSL backend tells whether a session is resumed
+        bool isTlsSessionStatsSupported() const;
+
+        // the counters are -1 if not supported
+        std::string getTlsSessionStatsInfo();
+
     private:
         CURLShareInstance();
 
         ~CURLShareInstance();
 
+        curlShare *getSslSessionShare(const string &hostName);
+
     private:
         curl_sslbackend mSslbackend;
         std::unique_ptr<curlShare> mShareWithDNS{};
         std::unique_ptr<curlShare> mShare{};
+
+        /*
+         * curl keeps a small LRU of TLS sessions in each share handle, so the
+         * sessions are bucketed per host:port into a bounded pool of shares,
+         * one edge won't evict the sessions of others.
+         */
+        std::mutex mSslSessionMutex;
+        std::vector<std::unique_ptr<curlShare>> mSslShares{};
+        std::list<std::string> mSslHostLru{};
+        std::map<std::string, std::pair<std::list<std::string>::iterator, size_t>> mSslHosts{};
+        TlsSessionStats mTlsStats{};
     };
 
 }// namespace Cicada
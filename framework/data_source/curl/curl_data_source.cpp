@@ -496,11 +496,17 @@ string CurlDataSource::GetOption(const string &key)
         return mConnectInfo;
     }
 
+    if (key == "tlsSessionInfo") {
+        return CURLShareInstance::Instance()->getTlsSessionStatsInfo();
+    }
+
     return IDataSource::GetOption(key);
 }
 
 void CurlDataSource::fillConnectInfo()
 {
+    CURLShareInstance::Instance()->onConnected(mPConnection->getCurlHandle());
+
     CicadaJSONItem Json;
     Json.addValue("time", (double) af_getsteady_ms());
     Json.addValue("url", mLocation);
@@ -544,6 +550,7 @@ void CurlDataSource::fillConnectInfo()
     printInfo infos[] {
         {"dnsCost",       CURLINFO_NAMELOOKUP_TIME, 1000, 0},
         {"connectCost",   CURLINFO_CONNECT_TIME,    1000, 0},
+        {"ttfbCost",      CURLINFO_STARTTRANSFER_TIME, 1000, 0},
         {"redirectCount", CURLINFO_REDIRECT_COUNT,  1,    0},
         {nullptr,         0,                        0,    0}
     };
@@ -507,11 +507,17 @@ string CurlDataSource2::GetOption(const string &key)
         return mConnectInfo;
     }
 
+    if (key == "tlsSessionInfo") {
+        return CURLShareInstance::Instance()->getTlsSessionStatsInfo();
+    }
+
     return IDataSource::GetOption(key);
 }
 
 void CurlDataSource2::fillConnectInfo()
 {
+    CURLShareInstance::Instance()->onConnected(mPConnection->getCurlHandle());
+
     CicadaJSONItem Json;
     Json.addValue("time", (double) af_getsteady_ms());
     Json.addValue("url", mLocation);
@@ -559,6 +565,7 @@ void CurlDataSource2::fillConnectInfo()
     } printInfo;
     printInfo infos[]{{"dnsCost", CURLINFO_NAMELOOKUP_TIME, valueTypeDouble, 1000, 0},
                       {"connectCost", CURLINFO_CONNECT_TIME, valueTypeDouble, 1000, 0},
+                      {"ttfbCost", CURLINFO_STARTTRANSFER_TIME, valueTypeDouble, 1000, 0},
                       {"redirectCount", CURLINFO_REDIRECT_COUNT, valueTypeLong, 1, 0},
                       {"pv", CURLINFO_HTTP_VERSION, valueTypeLong, 1, 0},
                       {nullptr, 0, valueTypeDouble, 0}};
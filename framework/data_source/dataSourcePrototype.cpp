@@ -10,6 +10,9 @@
 #endif
 #include "../../plugin/BiDataSource.h"
 #include "ffmpeg_data_source.h"
+#include "ioRecordDataSource.h"
+#include "ioReplayDataSource.h"
+#include "netEmulatorDataSource.h"
 
 using namespace Cicada;
 
@@ -27,6 +30,26 @@ Cicada::IDataSource *dataSourcePrototype::create(const std::string &uri, const C
     dataSourcePrototype *dataSource = nullptr;
     IDataSource *source = nullptr;
 
+    /*
+     * the replay, the record and the network emulator wrap the real source in this order, they are created here
+     * instead of self registered prototypes, nothing would refer to them in the static library and the linker
+     * would drop them
+     */
+    int sequence = ioReplayDataSource::claimCapture(uri, flags);
+
+    if (sequence >= 0) {
+        source = new ioReplayDataSource(uri, sequence);
+    } else if (ioRecordDataSource::probe(uri, flags)) {
+        source = new ioRecordDataSource(uri);
+    } else if (netEmulatorDataSource::probe(uri, flags)) {
+        source = new netEmulatorDataSource(uri);
+    }
+
+    if (source) {
+        source->setOptions(opts);
+        return source;
+    }
+
     for (int i = 0; i < _nextSlot; ++i) {
         int score = dataSourceQueue[i]->probeScore(uri, opts, flags);
 
@@ -12,6 +12,10 @@
 #include <utils/CicadaType.h>
 
 const static int DS_NEED_CACHE = 1 << 0;
+// create the real source under the network emulator, the io record and replay
+const static int DS_NO_EMULATION = 1 << 1;
+const static int DS_NO_RECORD = 1 << 2;
+const static int DS_NO_REPLAY = 1 << 3;
 
 class CICADA_CPLUS_EXTERN dataSourcePrototype {
     static dataSourcePrototype *dataSourceQueue[10];//TODO: should be replaced with a factory object.
@@ -0,0 +1,215 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "ioRecord"
+
+#include "ioRecord.h"
+#include <cerrno>
+#include <cstring>
+#include <utils/frame_work_log.h>
+
+#define RECORD_MAGIC "CIOR"
+#define RECORD_VERSION 1
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+using namespace std;
+
+namespace Cicada {
+
+    static bool readVarint(const uint8_t *&p, const uint8_t *end, int64_t &value)
+    {
+        uint64_t raw = 0;
+        int shift = 0;
+
+        while (p < end && shift < 64) {
+            uint8_t byte = *p++;
+            raw |= (uint64_t) (byte & 0x7f) << shift;
+
+            if (!(byte & 0x80)) {
+                value = (int64_t) (raw >> 1) ^ -(int64_t) (raw & 1);
+                return true;
+            }
+
+            shift += 7;
+        }
+
+        return false;
+    }
+
+    static bool readBytes(const uint8_t *&p, const uint8_t *end, string &data)
+    {
+        int64_t size;
+
+        if (!readVarint(p, end, size) || size < 0 || size > end - p) {
+            return false;
+        }
+
+        data.assign((const char *) p, (size_t) size);
+        p += size;
+        return true;
+    }
+
+    ioRecordWriter::~ioRecordWriter()
+    {
+        close();
+    }
+
+    int ioRecordWriter::open(const string &path, const string &url)
+    {
+        close();
+        mFile = fopen(path.c_str(), "wb");
+
+        if (mFile == nullptr) {
+            AF_LOGE("open record file %s error %d\n", path.c_str(), errno);
+            return -errno;
+        }
+
+        fwrite(RECORD_MAGIC, 1, 4, mFile);
+        fputc(RECORD_VERSION, mFile);
+        writeVarint((int64_t) url.size());
+        fwrite(url.data(), 1, url.size(), mFile);
+        return 0;
+    }
+
+    void ioRecordWriter::writeVarint(int64_t value)
+    {
+        auto raw = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+        uint8_t buffer[10];
+        int size = 0;
+
+        do {
+            buffer[size] = raw & 0x7f;
+            raw >>= 7;
+
+            if (raw) {
+                buffer[size] |= 0x80;
+            }
+
+            size++;
+        } while (raw);
+
+        fwrite(buffer, 1, size, mFile);
+    }
+
+    int ioRecordWriter::write(const ioRecordEntry &entry)
+    {
+        if (mFile == nullptr) {
+            return -EINVAL;
+        }
+
+        fputc(entry.type, mFile);
+        writeVarint(entry.start);
+        writeVarint(entry.cost);
+        writeVarint(entry.arg);
+        writeVarint(entry.whence);
+        writeVarint(entry.result);
+        fwrite(&entry.hash, 1, sizeof(entry.hash), mFile);
+        writeVarint((int64_t) entry.data.size());
+        fwrite(entry.data.data(), 1, entry.data.size(), mFile);
+        return ferror(mFile) ? -EIO : 0;
+    }
+
+    void ioRecordWriter::close()
+    {
+        if (mFile) {
+            fclose(mFile);
+            mFile = nullptr;
+        }
+    }
+
+    int ioRecordReader::load(const string &path, string &url, vector<ioRecordEntry> &entries)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+
+        if (file == nullptr) {
+            return -errno;
+        }
+
+        vector<uint8_t> content;
+        uint8_t buffer[64 * 1024];
+        size_t size;
+
+        while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            content.insert(content.end(), buffer, buffer + size);
+        }
+
+        fclose(file);
+        const uint8_t *p = content.data();
+        const uint8_t *end = p + content.size();
+
+        if (content.size() < 5 || memcmp(p, RECORD_MAGIC, 4) != 0 || p[4] != RECORD_VERSION) {
+            AF_LOGE("%s is not a record file\n", path.c_str());
+            return -EINVAL;
+        }
+
+        p += 5;
+
+        if (!readBytes(p, end, url)) {
+            return -EINVAL;
+        }
+
+        entries.clear();
+
+        while (p < end) {
+            ioRecordEntry entry{};
+            int64_t whence;
+            entry.type = *p++;
+
+            if (!readVarint(p, end, entry.start) || !readVarint(p, end, entry.cost) || !readVarint(p, end, entry.arg) ||
+                !readVarint(p, end, whence) || !readVarint(p, end, entry.result) || end - p < (int64_t) sizeof(entry.hash)) {
+                // a truncated tail, the capture was not closed
+                break;
+            }
+
+            entry.whence = (int32_t) whence;
+            memcpy(&entry.hash, p, sizeof(entry.hash));
+            p += sizeof(entry.hash);
+
+            if (!readBytes(p, end, entry.data)) {
+                break;
+            }
+
+            entries.push_back(move(entry));
+        }
+
+        return 0;
+    }
+
+    uint64_t ioRecord::hash(const void *data, size_t size)
+    {
+        uint64_t value = FNV_OFFSET_BASIS;
+        auto *bytes = static_cast<const uint8_t *>(data);
+
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= FNV_PRIME;
+        }
+
+        return value;
+    }
+
+    string ioRecord::getRecordPath(const string &dir, const string &url, int sequence)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "/%016llx_%d.rec", (unsigned long long) hash(url.data(), url.size()), sequence);
+        return dir + name;
+    }
+
+    void ioRecordSequence::update(const string &dir)
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        if (dir != mDir) {
+            mSequences.clear();
+            mDir = dir;
+        }
+    }
+
+    int ioRecordSequence::next(const string &dir, const string &url)
+    {
+        update(dir);
+        lock_guard<mutex> lock(mMutex);
+        return mSequences[url]++;
+    }
+}// namespace Cicada
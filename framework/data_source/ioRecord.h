@@ -0,0 +1,101 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_IORECORD_H
+#define CICADA_PLAYER_IORECORD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Cicada {
+
+    /*
+     * The calls on a data source, captured by ioRecordDataSource and replayed by ioReplayDataSource.
+     * A record file is the magic "CIOR", a version byte and the url, followed by the entries, the integers are
+     * zigzag varints, so a read without the payload costs about 20 bytes.
+     */
+    class ioRecordEntry {
+    public:
+        enum Type {
+            TYPE_OPEN = 1,
+            TYPE_OPEN_URL,
+            TYPE_READ,
+            TYPE_SEEK,
+            TYPE_CLOSE,
+        };
+
+    public:
+        uint8_t type{0};
+        // us since the source created
+        int64_t start{0};
+        // us the call blocked
+        int64_t cost{0};
+        // the flags of open, the size of read, the offset of seek
+        int64_t arg{0};
+        int32_t whence{0};
+        int64_t result{0};
+        // fnv-1a of the bytes read
+        uint64_t hash{0};
+        // the payload of read, or the url of open
+        std::string data{};
+    };
+
+    class ioRecordWriter {
+    public:
+        ioRecordWriter() = default;
+
+        ~ioRecordWriter();
+
+        int open(const std::string &path, const std::string &url);
+
+        int write(const ioRecordEntry &entry);
+
+        void close();
+
+    private:
+        void writeVarint(int64_t value);
+
+    private:
+        FILE *mFile{nullptr};
+    };
+
+    class ioRecordReader {
+    public:
+        // load all the entries, return a negative errno on failure
+        static int load(const std::string &path, std::string &url, std::vector<ioRecordEntry> &entries);
+    };
+
+    class ioRecord {
+    public:
+        static uint64_t hash(const void *data, size_t size);
+
+        // the nth source opened for the url in a session shares the same file in the record and the replay
+        static std::string getRecordPath(const std::string &dir, const std::string &url, int sequence);
+    };
+
+    /*
+     * Number the sources of a url in the order they are created in a session. A session is the configured dir,
+     * the numbers start from 0 again once the dir is changed or disabled, so set another dir or clear it
+     * before a dir is used again.
+     */
+    class ioRecordSequence {
+    public:
+        // dir is the configured one, empty if disabled
+        void update(const std::string &dir);
+
+        int next(const std::string &dir, const std::string &url);
+
+    private:
+        std::mutex mMutex{};
+        std::string mDir{};
+        std::map<std::string, int> mSequences{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_IORECORD_H
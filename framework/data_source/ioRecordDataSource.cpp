@@ -0,0 +1,199 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "ioRecordDataSource"
+
+#include "ioRecordDataSource.h"
+#include <cerrno>
+#include <utils/globalSettings.h>
+#include <utils/frame_work_log.h>
+#include <utils/timer.h>
+
+using namespace std;
+
+namespace Cicada {
+
+    static ioRecordSequence gSequence;
+
+    ioRecordDataSource::ioRecordDataSource(const string &url) : IDataSource(url)
+    {
+        mEpoch = af_gettime_relative();
+        mDir = globalSettings::getSetting().getProperty("protected.io.record");
+        mSequence = gSequence.next(mDir, url);
+    }
+
+    ioRecordDataSource::~ioRecordDataSource()
+    {
+        Close();
+        mWriter.close();
+    }
+
+    bool ioRecordDataSource::probe(const string &uri, int flags)
+    {
+        string dir = globalSettings::getSetting().getProperty("protected.io.record");
+        gSequence.update(dir);
+
+        // never capture under the network emulator, the emulated timing is captured above it
+        if (flags & (DS_NO_RECORD | DS_NO_EMULATION)) {
+            return false;
+        }
+
+        return !dir.empty();
+    }
+
+    void ioRecordDataSource::record(uint8_t type, int64_t start, int64_t arg, int32_t whence, int64_t result, const void *data)
+    {
+        ioRecordEntry entry{};
+        entry.type = type;
+        entry.start = start - mEpoch;
+        entry.cost = af_gettime_relative() - start;
+        entry.arg = arg;
+        entry.whence = whence;
+        entry.result = result;
+
+        if (type == ioRecordEntry::TYPE_READ && result > 0) {
+            entry.hash = ioRecord::hash(data, (size_t) result);
+
+            if (mRecordPayload) {
+                entry.data.assign(static_cast<const char *>(data), (size_t) result);
+            }
+        } else if (type == ioRecordEntry::TYPE_OPEN_URL) {
+            entry.data = static_cast<const char *>(data);
+        }
+
+        mWriter.write(entry);
+    }
+
+    int ioRecordDataSource::Open(int flags)
+    {
+        if (mSource == nullptr) {
+            string path = ioRecord::getRecordPath(mDir, mUri, mSequence);
+            int ret = mWriter.open(path, mUri);
+
+            if (ret < 0) {
+                return ret;
+            }
+
+            AF_LOGI("capture %s to %s\n", mUri.c_str(), path.c_str());
+            mRecordPayload = globalSettings::getSetting().getProperty("protected.io.record.payload") == "ON";
+            mSource = unique_ptr<IDataSource>(dataSourcePrototype::create(mUri, mOpts, DS_NO_RECORD));
+            mSource->Set_config(mConfig);
+            mSource->Interrupt(mInterrupt);
+
+            if (rangeStart != INT64_MIN || rangeEnd != INT64_MIN) {
+                mSource->setRange(rangeStart, rangeEnd);
+            }
+        }
+
+        int64_t start = af_gettime_relative();
+        int ret = mSource->Open(flags);
+        record(ioRecordEntry::TYPE_OPEN, start, flags, 0, ret);
+        mOpened = true;
+        return ret;
+    }
+
+    int ioRecordDataSource::Open(const string &url)
+    {
+        if (mSource == nullptr) {
+            mUri = url;
+            return Open(0);
+        }
+
+        int64_t start = af_gettime_relative();
+        int ret = mSource->Open(url);
+        record(ioRecordEntry::TYPE_OPEN_URL, start, 0, 0, ret, url.c_str());
+        mOpened = true;
+        return ret;
+    }
+
+    void ioRecordDataSource::Close()
+    {
+        if (mSource && mOpened) {
+            int64_t start = af_gettime_relative();
+            mSource->Close();
+            record(ioRecordEntry::TYPE_CLOSE, start, 0, 0, 0);
+            mOpened = false;
+        }
+    }
+
+    int64_t ioRecordDataSource::Seek(int64_t offset, int whence)
+    {
+        if (mSource == nullptr) {
+            return -EINVAL;
+        }
+
+        int64_t start = af_gettime_relative();
+        int64_t ret = mSource->Seek(offset, whence);
+        record(ioRecordEntry::TYPE_SEEK, start, offset, whence, ret);
+        return ret;
+    }
+
+    int ioRecordDataSource::Read(void *buf, size_t nbyte)
+    {
+        if (mSource == nullptr) {
+            return -EINVAL;
+        }
+
+        int64_t start = af_gettime_relative();
+        int ret = mSource->Read(buf, nbyte);
+        record(ioRecordEntry::TYPE_READ, start, (int64_t) nbyte, 0, ret, buf);
+        return ret;
+    }
+
+    void ioRecordDataSource::Interrupt(bool interrupt)
+    {
+        if (mSource) {
+            mSource->Interrupt(interrupt);
+        }
+
+        IDataSource::Interrupt(interrupt);
+    }
+
+    int ioRecordDataSource::setRange(int64_t start, int64_t end)
+    {
+        IDataSource::setRange(start, end);
+
+        if (mSource) {
+            return mSource->setRange(start, end);
+        }
+
+        return 0;
+    }
+
+    void ioRecordDataSource::Set_config(SourceConfig &config)
+    {
+        IDataSource::Set_config(config);
+
+        if (mSource) {
+            mSource->Set_config(config);
+        }
+    }
+
+    string ioRecordDataSource::Get_error_info(int error)
+    {
+        if (mSource) {
+            return mSource->Get_error_info(error);
+        }
+
+        return IDataSource::Get_error_info(error);
+    }
+
+    string ioRecordDataSource::GetOption(const string &key)
+    {
+        if (mSource) {
+            return mSource->GetOption(key);
+        }
+
+        return IDataSource::GetOption(key);
+    }
+
+    IDataSource::speedLevel ioRecordDataSource::getSpeedLevel()
+    {
+        return mSource ? mSource->getSpeedLevel() : IDataSource::getSpeedLevel();
+    }
+
+    uint64_t ioRecordDataSource::getFlags()
+    {
+        return mSource ? mSource->getFlags() : 0;
+    }
+}// namespace Cicada
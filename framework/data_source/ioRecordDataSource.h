@@ -0,0 +1,69 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_IORECORDDATASOURCE_H
+#define CICADA_PLAYER_IORECORDDATASOURCE_H
+
+#include "dataSourcePrototype.h"
+#include "ioRecord.h"
+#include <memory>
+
+namespace Cicada {
+
+    /*
+     * Capture every call on the real source with the timing and the hash of the bytes, to replay a session by
+     * ioReplayDataSource. Enabled by the property "protected.io.record", the value is the directory of the captures,
+     * the payloads are captured too if "protected.io.record.payload" is "ON", then the replay needs no origin.
+     * The captures of a url are numbered in the order the sources are created, as the replay claims them.
+     */
+    class ioRecordDataSource : public IDataSource {
+    public:
+        explicit ioRecordDataSource(const std::string &url);
+
+        ~ioRecordDataSource() override;
+
+        // enabled, flags of dataSourcePrototype::create
+        static bool probe(const std::string &uri, int flags);
+
+        int Open(int flags) override;
+
+        int Open(const std::string &url) override;
+
+        void Close() override;
+
+        int64_t Seek(int64_t offset, int whence) override;
+
+        int Read(void *buf, size_t nbyte) override;
+
+        void Interrupt(bool interrupt) override;
+
+        int setRange(int64_t start, int64_t end) override;
+
+        void Set_config(SourceConfig &config) override;
+
+        std::string Get_error_info(int error) override;
+
+        std::string GetOption(const std::string &key) override;
+
+        speedLevel getSpeedLevel() override;
+
+        uint64_t getFlags() override;
+
+    private:
+        void record(uint8_t type, int64_t start, int64_t arg, int32_t whence, int64_t result, const void *data = nullptr);
+
+    private:
+        std::unique_ptr<IDataSource> mSource{};
+        ioRecordWriter mWriter{};
+        std::string mDir{};
+        int mSequence{0};
+        int64_t mEpoch{0};
+        bool mRecordPayload{false};
+        // not to capture the close by the destructor again
+        bool mOpened{false};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_IORECORDDATASOURCE_H
@@ -0,0 +1,350 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "ioReplayDataSource"
+
+#include "ioReplayDataSource.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utils/errors/framework_error.h>
+#include <utils/file/FileUtils.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+
+#define WAIT_SLICE_US (10 * 1000)
+
+using namespace std;
+
+namespace Cicada {
+
+    static ioRecordSequence gSequence;
+
+    // the queries of size and position are not replayed as calls
+    static bool isQuery(const ioRecordEntry &entry)
+    {
+        return entry.type == ioRecordEntry::TYPE_SEEK &&
+               (entry.whence == SEEK_SIZE || (entry.whence == SEEK_CUR && entry.arg == 0));
+    }
+
+    ioReplayDataSource::ioReplayDataSource(const string &url, int sequence) : mSequence(sequence)
+    {
+        setUri(url);
+        setImpl(readCb, seekCb, openCb, nullptr, nullptr, nullptr, nullptr, this);
+    }
+
+    ioReplayDataSource::~ioReplayDataSource()
+    {
+        Close();
+    }
+
+    int ioReplayDataSource::claimCapture(const string &uri, int flags)
+    {
+        string dir = globalSettings::getSetting().getProperty("protected.io.replay");
+        gSequence.update(dir);
+
+        if ((flags & DS_NO_REPLAY) || dir.empty()) {
+            return -1;
+        }
+
+        // taken even if it doesn't exist, the recorded source may have not been opened
+        int sequence = gSequence.next(dir, uri);
+
+        if (!FileUtils::isFileExist(ioRecord::getRecordPath(dir, uri, sequence).c_str())) {
+            return -1;
+        }
+
+        return sequence;
+    }
+
+    int ioReplayDataSource::load()
+    {
+        string dir = globalSettings::getSetting().getProperty("protected.io.replay");
+        string path = ioRecord::getRecordPath(dir, mUri, mSequence);
+        string url;
+        int ret = ioRecordReader::load(path, url, mEntries);
+
+        if (ret < 0) {
+            AF_LOGW("no capture %s for %s, read from the origin\n", path.c_str(), mUri.c_str());
+            return ret;
+        }
+
+        int64_t pos = 0;
+        mEntryPos.clear();
+
+        for (auto &entry : mEntries) {
+            mEntryPos.push_back(pos);
+
+            if (entry.type == ioRecordEntry::TYPE_OPEN || entry.type == ioRecordEntry::TYPE_OPEN_URL) {
+                pos = rangeStart != INT64_MIN ? rangeStart : 0;
+            } else if (entry.type == ioRecordEntry::TYPE_SEEK && entry.whence != SEEK_SIZE && entry.result >= 0) {
+                pos = entry.result;
+            } else if (entry.type == ioRecordEntry::TYPE_READ && entry.result > 0) {
+                pos += entry.result;
+            }
+        }
+
+        AF_LOGI("replay %s from %s, %zu calls\n", mUri.c_str(), path.c_str(), mEntries.size());
+        return 0;
+    }
+
+    int ioReplayDataSource::Open(int flags)
+    {
+        if (!mLoaded) {
+            mLoaded = true;
+            load();
+        }
+
+        return replayOpen(ioRecordEntry::TYPE_OPEN);
+    }
+
+    void ioReplayDataSource::Close()
+    {
+        if (mOrigin) {
+            mOrigin->Close();
+            mOriginPos = -1;
+        }
+    }
+
+    void ioReplayDataSource::Interrupt(bool interrupt)
+    {
+        if (mOrigin) {
+            mOrigin->Interrupt(interrupt);
+        }
+
+        IDataSource::Interrupt(interrupt);
+    }
+
+    int ioReplayDataSource::readCb(void *arg, uint8_t *buffer, int size)
+    {
+        return static_cast<ioReplayDataSource *>(arg)->replayRead(buffer, size);
+    }
+
+    int64_t ioReplayDataSource::seekCb(void *arg, int64_t offset, int whence)
+    {
+        return static_cast<ioReplayDataSource *>(arg)->replaySeek(offset, whence);
+    }
+
+    int ioReplayDataSource::openCb(void *arg, const char *url, int64_t start, int64_t end)
+    {
+        auto *source = static_cast<ioReplayDataSource *>(arg);
+        source->mUri = url;
+        // the origin follows the new url
+        source->mOrigin = nullptr;
+        source->mOriginPos = -1;
+        return source->replayOpen(ioRecordEntry::TYPE_OPEN_URL);
+    }
+
+    int ioReplayDataSource::findEntry(uint8_t type) const
+    {
+        for (size_t i = mCursor; i < mEntries.size(); i++) {
+            if (mEntries[i].type == type && !isQuery(mEntries[i])) {
+                return (int) i;
+            }
+        }
+
+        return -1;
+    }
+
+    int ioReplayDataSource::waitCost(const ioRecordEntry &entry)
+    {
+        int64_t end = af_gettime_relative() + entry.cost;
+        int64_t now;
+
+        while ((now = af_gettime_relative()) < end) {
+            if (mInterrupt) {
+                return FRAMEWORK_ERR_EXIT;
+            }
+
+            af_usleep((int) std::min(end - now, (int64_t) WAIT_SLICE_US));
+        }
+
+        return mInterrupt ? FRAMEWORK_ERR_EXIT : 0;
+    }
+
+    int ioReplayDataSource::replayOpen(uint8_t type)
+    {
+        mPos = rangeStart != INT64_MIN ? rangeStart : 0;
+        mPending.clear();
+        int index = findEntry(type);
+
+        if (index < 0) {
+            // not captured, open the origin
+            mOrigin = nullptr;
+            return readOrigin(nullptr, 0);
+        }
+
+        mCursor = index + 1;
+        int ret = waitCost(mEntries[index]);
+        return ret < 0 ? ret : (int) mEntries[index].result;
+    }
+
+    int ioReplayDataSource::readOrigin(uint8_t *buffer, int size)
+    {
+        int ret;
+
+        if (mOrigin == nullptr) {
+            mOrigin = unique_ptr<IDataSource>(
+                    dataSourcePrototype::create(mUri, mOpts, DS_NO_REPLAY | DS_NO_RECORD | DS_NO_EMULATION));
+            mOrigin->Set_config(mConfig);
+            mOrigin->Interrupt(mInterrupt);
+
+            if (rangeStart != INT64_MIN || rangeEnd != INT64_MIN) {
+                mOrigin->setRange(rangeStart, rangeEnd);
+            }
+
+            mOriginPos = -1;
+        }
+
+        if (mOriginPos < 0) {
+            if ((ret = mOrigin->Open(0)) < 0) {
+                AF_LOGE("open the origin %s error %d\n", mUri.c_str(), ret);
+                return ret;
+            }
+
+            mOriginPos = rangeStart != INT64_MIN ? rangeStart : 0;
+        }
+
+        if (buffer == nullptr) {
+            return 0;
+        }
+
+        if (mOriginPos != mPos) {
+            int64_t pos = mOrigin->Seek(mPos, SEEK_SET);
+
+            if (pos < 0) {
+                return (int) pos;
+            }
+
+            mOriginPos = pos;
+        }
+
+        ret = mOrigin->Read(buffer, size);
+
+        if (ret > 0) {
+            mOriginPos += ret;
+        }
+
+        return ret;
+    }
+
+    int ioReplayDataSource::replayRead(uint8_t *buffer, int size)
+    {
+        int ret;
+
+        if (!mPending.empty()) {
+            ret = std::min(size, (int) mPending.size());
+            memcpy(buffer, mPending.data(), ret);
+            mPending.erase(0, ret);
+            mPos += ret;
+            return ret;
+        }
+
+        int index = findEntry(ioRecordEntry::TYPE_READ);
+
+        if (index < 0) {
+            ret = readOrigin(buffer, size);
+        } else {
+            const ioRecordEntry &entry = mEntries[index];
+            mCursor = index + 1;
+
+            if ((ret = waitCost(entry)) < 0) {
+                return ret;
+            }
+
+            if (entry.result <= 0) {
+                // the eos and the errors are replayed too
+                return (int) entry.result;
+            }
+
+            if (mEntryPos[index] != mPos) {
+                AF_LOGW("replay diverged at %lld, captured %lld\n", mPos, mEntryPos[index]);
+            }
+
+            if (!entry.data.empty() && mEntryPos[index] == mPos) {
+                ret = std::min(size, (int) entry.data.size());
+                memcpy(buffer, entry.data.data(), ret);
+                mPending.assign(entry.data, ret, string::npos);
+            } else {
+                ret = readOrigin(buffer, std::min(size, (int) entry.result));
+
+                if (ret == entry.result && mEntryPos[index] == mPos && ioRecord::hash(buffer, ret) != entry.hash) {
+                    AF_LOGW("the origin of %s changed at %lld\n", mUri.c_str(), mPos);
+                }
+            }
+        }
+
+        if (ret > 0) {
+            mPos += ret;
+        }
+
+        return ret;
+    }
+
+    int64_t ioReplayDataSource::replaySeek(int64_t offset, int whence)
+    {
+        if (whence == SEEK_SIZE) {
+            if (mSize < 0) {
+                for (auto &entry : mEntries) {
+                    if (entry.type == ioRecordEntry::TYPE_SEEK && entry.whence == SEEK_SIZE) {
+                        mSize = entry.result;
+                        break;
+                    }
+                }
+            }
+
+            if (mSize < 0 && readOrigin(nullptr, 0) >= 0) {
+                mSize = mOrigin->Seek(0, SEEK_SIZE);
+            }
+
+            return mSize;
+        }
+
+        if (whence == SEEK_CUR && offset == 0) {
+            return mPos;
+        }
+
+        int index = findEntry(ioRecordEntry::TYPE_SEEK);
+
+        if (index >= 0 && mEntries[index].arg == offset && mEntries[index].whence == whence) {
+            mCursor = index + 1;
+            int ret = waitCost(mEntries[index]);
+
+            if (ret < 0) {
+                return ret;
+            }
+
+            if (mEntries[index].result >= 0) {
+                mPos = mEntries[index].result;
+                mPending.clear();
+            }
+
+            return mEntries[index].result;
+        }
+
+        AF_LOGW("replay diverged, seek %lld %d not captured\n", offset, whence);
+
+        if (whence == SEEK_CUR) {
+            offset += mPos;
+        } else if (whence == SEEK_END) {
+            int64_t size = replaySeek(0, SEEK_SIZE);
+
+            if (size < 0) {
+                return FRAMEWORK_ERR(ENOSYS);
+            }
+
+            offset += size;
+        } else if (whence != SEEK_SET) {
+            return FRAMEWORK_ERR(EINVAL);
+        }
+
+        if (offset < 0) {
+            return FRAMEWORK_ERR(EINVAL);
+        }
+
+        mPos = offset;
+        mPending.clear();
+        return offset;
+    }
+}// namespace Cicada
@@ -0,0 +1,86 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_IOREPLAYDATASOURCE_H
+#define CICADA_PLAYER_IOREPLAYDATASOURCE_H
+
+#include "dataSourcePrototype.h"
+#include "ioRecord.h"
+#include "proxyDataSource.h"
+#include <memory>
+
+namespace Cicada {
+
+    /*
+     * Replay a session captured by ioRecordDataSource, each call returns the captured result after the captured
+     * cost, so the player sees the same bytes at the same pace. Enabled by the property "protected.io.replay",
+     * the value is the directory of the captures, the urls not captured are opened as usual.
+     * The bytes are taken from the capture if it has the payloads, otherwise read from the origin and checked
+     * with the hashes.
+     */
+    class ioReplayDataSource : public proxyDataSource {
+    public:
+        // sequence is the capture claimed by claimCapture
+        ioReplayDataSource(const std::string &url, int sequence);
+
+        ~ioReplayDataSource() override;
+
+        /*
+         * take the next capture of the uri, in the order the recorded sources were created,
+         * return its sequence, or -1 if the replay is off or the capture doesn't exist
+         */
+        static int claimCapture(const std::string &uri, int flags);
+
+        int Open(int flags) override;
+
+        void Close() override;
+
+        void Interrupt(bool interrupt) override;
+
+        speedLevel getSpeedLevel() override
+        {
+            return speedLevel_remote;
+        }
+
+    private:
+        static int readCb(void *arg, uint8_t *buffer, int size);
+
+        static int64_t seekCb(void *arg, int64_t offset, int whence);
+
+        static int openCb(void *arg, const char *url, int64_t start, int64_t end);
+
+        int replayRead(uint8_t *buffer, int size);
+
+        int64_t replaySeek(int64_t offset, int whence);
+
+        int replayOpen(uint8_t type);
+
+        // the index of the next entry of the type from the cursor, or -1 if the capture is run out
+        int findEntry(uint8_t type) const;
+
+        int load();
+
+        // sleep the cost of the call, return FRAMEWORK_ERR_EXIT if interrupted
+        int waitCost(const ioRecordEntry &entry);
+
+        int readOrigin(uint8_t *buffer, int size);
+
+    private:
+        int mSequence{0};
+        std::vector<ioRecordEntry> mEntries{};
+        // the position of the source before each entry in the capture
+        std::vector<int64_t> mEntryPos{};
+        size_t mCursor{0};
+        bool mLoaded{false};
+        int64_t mPos{0};
+        int64_t mSize{-1};
+        // the payload left by a read smaller than the captured one
+        std::string mPending{};
+        std::unique_ptr<IDataSource> mOrigin{};
+        int64_t mOriginPos{-1};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_IOREPLAYDATASOURCE_H
@@ -0,0 +1,409 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "netEmulatorDataSource"
+
+#include "netEmulatorDataSource.h"
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <random>
+#include <utils/CicadaJSON.h>
+#include <utils/CicadaUtils.h>
+#include <utils/errors/framework_error.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+#include <vector>
+
+// read in small pieces, so the bandwidth changes take effect in time
+#define READ_CHUNK_SIZE (16 * 1024)
+#define WAIT_SLICE_US (10 * 1000)
+
+using namespace std;
+
+namespace Cicada {
+
+    class netEmulatorLink {
+    public:
+        explicit netEmulatorLink(const string &profile)
+        {
+            CicadaJSONItem json(profile);
+            CicadaJSONArray trace = json.getArray("trace");
+
+            for (int i = 0; i < trace.getSize(); i++) {
+                CicadaJSONItem &item = trace.getItem(i);
+                int64_t duration = item.getInt64("ms", 0) * 1000;
+
+                if (duration > 0) {
+                    mTrace.push_back({duration, item.getInt64("kbps", 0)});
+                    mTraceDuration += duration;
+                }
+            }
+
+            if (mTrace.empty()) {
+                mTrace.push_back({1000000, json.getInt64("kbps", 0)});
+                mTraceDuration = 1000000;
+            }
+
+            mRtt = json.getInt64("rttMs", 0) * 1000;
+            mJitter = json.getInt64("jitterMs", 0) * 1000;
+            mStallInterval = json.getInt64("stallIntervalMs", 0) * 1000;
+            mStall = json.getInt64("stallMs", 0) * 1000;
+            mResetInterval = json.getInt64("resetIntervalMs", 0) * 1000;
+            mResetAsError = json.getBool("resetAsError", false);
+            mRandom.seed((uint32_t) json.getInt("seed", 1));
+            mEpoch = af_gettime_relative();
+            mNextFree = mEpoch;
+            AF_LOGI("network emulator %s\n", profile.c_str());
+        }
+
+        // the delay of a request, rounds of rtt with the jitter
+        int64_t getRequestDelay(int rounds)
+        {
+            lock_guard<mutex> lock(mMutex);
+            int64_t jitter = 0;
+
+            if (mJitter > 0) {
+                jitter = uniform_int_distribution<int64_t>(-mJitter, mJitter)(mRandom);
+            }
+
+            return std::max(mRtt * rounds + jitter, (int64_t) 0);
+        }
+
+        // take the bytes on the link, return the time the transfer is done
+        int64_t reserve(int64_t bytes)
+        {
+            lock_guard<mutex> lock(mMutex);
+            int64_t now = af_gettime_relative();
+            int64_t start = std::max(now, mNextFree);
+            int64_t kbps = getKbps(start);
+
+            if (kbps <= 0) {
+                return now;
+            }
+
+            mNextFree = start + bytes * 8 * 1000 / kbps;
+            return mNextFree;
+        }
+
+        // the end of the stall the time is in, or INT64_MIN
+        int64_t getStallEnd(int64_t time) const
+        {
+            if (mStallInterval <= 0 || mStall <= 0) {
+                return INT64_MIN;
+            }
+
+            int64_t offset = (time - mEpoch) % mStallInterval;
+            int64_t stallStart = mStallInterval - mStall;
+            return offset >= stallStart ? time + mStallInterval - offset : INT64_MIN;
+        }
+
+        int64_t getResetCount(int64_t time) const
+        {
+            return mResetInterval > 0 ? (time - mEpoch) / mResetInterval : 0;
+        }
+
+        bool isResetAsError() const
+        {
+            return mResetAsError;
+        }
+
+    private:
+        int64_t getKbps(int64_t time) const
+        {
+            int64_t offset = (time - mEpoch) % mTraceDuration;
+
+            for (auto &item : mTrace) {
+                if (offset < item.first) {
+                    return item.second;
+                }
+
+                offset -= item.first;
+            }
+
+            return mTrace.back().second;
+        }
+
+    private:
+        mutex mMutex{};
+        // duration in us, kbps
+        vector<pair<int64_t, int64_t>> mTrace{};
+        int64_t mTraceDuration{0};
+        int64_t mRtt{0};
+        int64_t mJitter{0};
+        int64_t mStallInterval{0};
+        int64_t mStall{0};
+        int64_t mResetInterval{0};
+        bool mResetAsError{false};
+        mt19937 mRandom{};
+        int64_t mEpoch{0};
+        int64_t mNextFree{0};
+    };
+
+    static mutex gLinkMutex;
+    static string gLinkProfile;
+    static shared_ptr<netEmulatorLink> gLink;
+
+    static shared_ptr<netEmulatorLink> getLink()
+    {
+        string profile = globalSettings::getSetting().getProperty("protected.network.emulator");
+        lock_guard<mutex> lock(gLinkMutex);
+
+        if (profile.empty()) {
+            gLink = nullptr;
+        } else if (gLink == nullptr || profile != gLinkProfile) {
+            gLink = make_shared<netEmulatorLink>(profile);
+        }
+
+        gLinkProfile = profile;
+        return gLink;
+    }
+
+    netEmulatorDataSource::netEmulatorDataSource(const string &url) : IDataSource(url)
+    {
+        mLink = getLink();
+    }
+
+    netEmulatorDataSource::~netEmulatorDataSource()
+    {
+        Close();
+    }
+
+    bool netEmulatorDataSource::probe(const string &uri, int flags)
+    {
+        if ((flags & DS_NO_EMULATION) || !CicadaUtils::startWith(uri, {"http://", "https://", "file://", "/"})) {
+            return false;
+        }
+
+        return !globalSettings::getSetting().getProperty("protected.network.emulator").empty();
+    }
+
+    int netEmulatorDataSource::waitUntil(int64_t time)
+    {
+        int64_t now;
+
+        while ((now = af_gettime_relative()) < time) {
+            if (mInterrupt) {
+                return FRAMEWORK_ERR_EXIT;
+            }
+
+            af_usleep((int) std::min(time - now, (int64_t) WAIT_SLICE_US));
+        }
+
+        return mInterrupt ? FRAMEWORK_ERR_EXIT : 0;
+    }
+
+    int netEmulatorDataSource::waitRequest(int rounds)
+    {
+        return waitUntil(af_gettime_relative() + mLink->getRequestDelay(rounds));
+    }
+
+    int netEmulatorDataSource::Open(int flags)
+    {
+        if (mLink == nullptr) {
+            return -EINVAL;
+        }
+
+        if (mSource == nullptr) {
+            mSource = unique_ptr<IDataSource>(dataSourcePrototype::create(mUri, mOpts, DS_NO_EMULATION));
+            mSource->Set_config(mConfig);
+            mSource->Interrupt(mInterrupt);
+
+            if (rangeStart != INT64_MIN || rangeEnd != INT64_MIN) {
+                mSource->setRange(rangeStart, rangeEnd);
+            }
+        }
+
+        // the handshake and the request
+        int ret = waitRequest(2);
+
+        if (ret < 0) {
+            return ret;
+        }
+
+        ret = mSource->Open(flags);
+
+        if (ret >= 0) {
+            mPos = rangeStart != INT64_MIN ? rangeStart : 0;
+            mResetCount = mLink->getResetCount(af_gettime_relative());
+            mNeedReconnect = false;
+        }
+
+        return ret;
+    }
+
+    int netEmulatorDataSource::Open(const string &url)
+    {
+        if (mSource == nullptr) {
+            mUri = url;
+            return Open(0);
+        }
+
+        // reuse the connection
+        int ret = waitRequest(1);
+
+        if (ret < 0) {
+            return ret;
+        }
+
+        mUri = url;
+        ret = mSource->Open(url);
+
+        if (ret >= 0) {
+            mPos = 0;
+            mResetCount = mLink->getResetCount(af_gettime_relative());
+            mNeedReconnect = false;
+        }
+
+        return ret;
+    }
+
+    void netEmulatorDataSource::Close()
+    {
+        if (mSource) {
+            mSource->Close();
+        }
+    }
+
+    int64_t netEmulatorDataSource::Seek(int64_t offset, int whence)
+    {
+        if (mSource == nullptr) {
+            return -EINVAL;
+        }
+
+        if (whence == SEEK_SIZE || (whence == SEEK_CUR && offset == 0)) {
+            return mSource->Seek(offset, whence);
+        }
+
+        int64_t ret = mSource->Seek(offset, whence);
+
+        if (ret >= 0 && ret != mPos) {
+            // a new range request
+            mPos = ret;
+            int waitRet = waitRequest(1);
+
+            if (waitRet < 0) {
+                return waitRet;
+            }
+        }
+
+        return ret;
+    }
+
+    int netEmulatorDataSource::Read(void *buf, size_t nbyte)
+    {
+        if (mSource == nullptr) {
+            return -EINVAL;
+        }
+
+        int ret;
+
+        if (mNeedReconnect) {
+            int64_t pos = mSource->Seek(mPos, SEEK_SET);
+
+            if (pos < 0) {
+                return (int) pos;
+            }
+
+            mNeedReconnect = false;
+            mResetCount = mLink->getResetCount(af_gettime_relative());
+
+            if ((ret = waitRequest(2)) < 0) {
+                return ret;
+            }
+        }
+
+        int64_t now = af_gettime_relative();
+        int64_t stallEnd = mLink->getStallEnd(now);
+
+        if (stallEnd != INT64_MIN) {
+            AF_LOGD("stall %lld ms\n", (stallEnd - now) / 1000);
+
+            if ((ret = waitUntil(stallEnd)) < 0) {
+                return ret;
+            }
+
+            now = af_gettime_relative();
+        }
+
+        int64_t resetCount = mLink->getResetCount(now);
+
+        if (resetCount > mResetCount) {
+            AF_LOGI("reset the connection of %s\n", mUri.c_str());
+            mResetCount = resetCount;
+            mNeedReconnect = true;
+
+            if (mLink->isResetAsError()) {
+                return gen_framework_errno(error_class_network, network_errno_general);
+            }
+
+            return Read(buf, nbyte);
+        }
+
+        ret = mSource->Read(buf, std::min(nbyte, (size_t) READ_CHUNK_SIZE));
+
+        if (ret > 0) {
+            mPos += ret;
+            int waitRet = waitUntil(mLink->reserve(ret));
+
+            if (waitRet < 0) {
+                return waitRet;
+            }
+        }
+
+        return ret;
+    }
+
+    void netEmulatorDataSource::Interrupt(bool interrupt)
+    {
+        if (mSource) {
+            mSource->Interrupt(interrupt);
+        }
+
+        IDataSource::Interrupt(interrupt);
+    }
+
+    int netEmulatorDataSource::setRange(int64_t start, int64_t end)
+    {
+        IDataSource::setRange(start, end);
+
+        if (mSource) {
+            return mSource->setRange(start, end);
+        }
+
+        return 0;
+    }
+
+    void netEmulatorDataSource::Set_config(SourceConfig &config)
+    {
+        IDataSource::Set_config(config);
+
+        if (mSource) {
+            mSource->Set_config(config);
+        }
+    }
+
+    string netEmulatorDataSource::Get_error_info(int error)
+    {
+        if (mSource) {
+            return mSource->Get_error_info(error);
+        }
+
+        return IDataSource::Get_error_info(error);
+    }
+
+    string netEmulatorDataSource::GetOption(const string &key)
+    {
+        if (mSource) {
+            return mSource->GetOption(key);
+        }
+
+        return IDataSource::GetOption(key);
+    }
+
+    uint64_t netEmulatorDataSource::getFlags()
+    {
+        return mSource ? mSource->getFlags() : 0;
+    }
+}// namespace Cicada
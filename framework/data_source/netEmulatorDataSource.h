@@ -0,0 +1,81 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_NETEMULATORDATASOURCE_H
+#define CICADA_PLAYER_NETEMULATORDATASOURCE_H
+
+#include "dataSourcePrototype.h"
+#include <memory>
+
+namespace Cicada {
+    class netEmulatorLink;
+
+    /*
+     * Wrap the file and http sources with an emulated network, for the reproducible performance tests offline.
+     * Enabled by the property "protected.network.emulator", the value is the profile in json:
+     *
+     *   {"trace":[{"ms":5000,"kbps":4000},{"ms":5000,"kbps":800}],  the bandwidth trace looped, 0 kbps is unlimited
+     *    "kbps":2000,                       a constant bandwidth if no trace
+     *    "rttMs":80, "jitterMs":20,         the delay of each request, the first connect costs two rtt
+     *    "stallIntervalMs":20000, "stallMs":3000,  no data for stallMs in every stallIntervalMs
+     *    "resetIntervalMs":30000,           the connections opened are reset in every resetIntervalMs
+     *    "resetAsError":false,              return the reset as a network error, or reconnect in place as curl does
+     *    "seed":1}
+     *
+     * All the sources share one link, so the concurrent audio/video connections share the bandwidth,
+     * the time line starts when a new profile is set.
+     */
+    class netEmulatorDataSource : public IDataSource {
+    public:
+        explicit netEmulatorDataSource(const std::string &url);
+
+        ~netEmulatorDataSource() override;
+
+        // enabled and the uri is a http or file one, flags of dataSourcePrototype::create
+        static bool probe(const std::string &uri, int flags);
+
+        int Open(int flags) override;
+
+        int Open(const std::string &url) override;
+
+        void Close() override;
+
+        int64_t Seek(int64_t offset, int whence) override;
+
+        int Read(void *buf, size_t nbyte) override;
+
+        void Interrupt(bool interrupt) override;
+
+        int setRange(int64_t start, int64_t end) override;
+
+        void Set_config(SourceConfig &config) override;
+
+        std::string Get_error_info(int error) override;
+
+        std::string GetOption(const std::string &key) override;
+
+        speedLevel getSpeedLevel() override
+        {
+            return speedLevel_remote;
+        }
+
+        uint64_t getFlags() override;
+
+    private:
+        // sleep to the time, return FRAMEWORK_ERR_EXIT if interrupted
+        int waitUntil(int64_t time);
+
+        int waitRequest(int rounds);
+
+    private:
+        std::shared_ptr<netEmulatorLink> mLink{};
+        std::unique_ptr<IDataSource> mSource{};
+        int64_t mPos{0};
+        int64_t mResetCount{0};
+        bool mNeedReconnect{false};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_NETEMULATORDATASOURCE_H
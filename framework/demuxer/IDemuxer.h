@@ -153,6 +153,16 @@ namespace Cicada {
             return -1;
         }
 
+        /**
+         * read the video of stream index from an I-frame only rendition, and drop the other streams,
+         * the caller should seek to the current position after changed it.
+         * @return < 0 if there is no I-frame rendition
+         */
+        virtual int setTrickPlay(bool enable, int index)
+        {
+            return -1;
+        }
+
 
         virtual void interrupt(int inter) = 0;
 
@@ -252,6 +252,7 @@ namespace Cicada {
 
         mStreamCtxMap.clear();
         mPacketQueue.clear();
+        mPacketQueueMemSize = 0;
         bOpened = false;
 
         if (mInputOpts) {
@@ -558,6 +559,7 @@ namespace Cicada {
         }
 
         mPacketQueue.clear();
+        mPacketQueueMemSize = 0;
         mError = 0;
         if (mCtx->start_time == INT64_MIN) {
             mCtx->start_time = 0;
@@ -697,6 +699,7 @@ namespace Cicada {
                 mQueCond.wait(waitLock, [this]() { return mPacketQueue.size() <= MAX_QUEUE_SIZE || bPaused || mInterrupted || bExited; });
             }
 
+            mPacketQueueMemSize += pkt->getSize();
             mPacketQueue.push_back(std::move(pkt));
         } else if (ret == 0) {
             bEOS = true;
@@ -728,6 +731,7 @@ namespace Cicada {
             if (!mPacketQueue.empty()) {
                 packet = std::move(mPacketQueue.front());
                 mPacketQueue.pop_front();
+                mPacketQueueMemSize -= packet->getSize();
                 mQueCond.notify_one();
                 return static_cast<int>(packet->getSize());
             }
@@ -750,6 +754,8 @@ namespace Cicada {
     {
         if (key == "probeInfo") {
             return mProbeString;
+        } else if (key == "readAheadBytes") {
+            return to_string(mPacketQueueMemSize.load());
         } else if (key == "containerName") {
             std::lock_guard<std::mutex> uLock(mCtxMutex);
             if (mCtx == nullptr) {
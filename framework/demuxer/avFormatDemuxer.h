@@ -146,6 +146,7 @@ namespace Cicada {
         std::map<int, std::unique_ptr<AVStreamCtx>> mStreamCtxMap{};
         AVIOContext *mPInPutPb = nullptr;
         std::deque<unique_ptr<IAFPacket>> mPacketQueue{};
+        std::atomic<int64_t> mPacketQueueMemSize{0};
         std::atomic_bool bEOS{false};
         std::atomic_bool bPaused{false};
         std::atomic_bool bExited{false};
@@ -3,19 +3,62 @@
 //
 
 #include "OpenSSAESDecrypt.h"
+#include <cstring>
 
 using namespace Cicada;
 
-OpenSSAESDecrypt::OpenSSAESDecrypt() = default;
+OpenSSAESDecrypt::OpenSSAESDecrypt()
+{
+    mCtx = EVP_CIPHER_CTX_new();
+}
 
-OpenSSAESDecrypt::~OpenSSAESDecrypt() = default;
+OpenSSAESDecrypt::~OpenSSAESDecrypt()
+{
+    EVP_CIPHER_CTX_free(mCtx);
+}
 
 int OpenSSAESDecrypt::setKey(const uint8_t *key, int key_bits)
 {
-    return AES_set_decrypt_key(key, 8 * AES_BLOCK_SIZE/*128*/, &mAesKey);
+    const EVP_CIPHER *cipher;
+
+    switch (key_bits) {
+        case 128:
+            cipher = EVP_aes_128_cbc();
+            break;
+
+        case 192:
+            cipher = EVP_aes_192_cbc();
+            break;
+
+        case 256:
+            cipher = EVP_aes_256_cbc();
+            break;
+
+        default:
+            return -1;
+    }
+
+    if (mCtx == nullptr || EVP_DecryptInit_ex(mCtx, cipher, nullptr, key, nullptr) != 1) {
+        return -1;
+    }
+
+    // the PKCS7 padding is removed by the caller
+    EVP_CIPHER_CTX_set_padding(mCtx, 0);
+    return 0;
 }
 
 void OpenSSAESDecrypt::decrypt(uint8_t *dst, const uint8_t *src, int count, uint8_t *iv)
 {
-    AES_cbc_encrypt(src, dst, count * AES_BLOCK_SIZE, &mAesKey, iv, AES_DECRYPT);
+    if (count <= 0) {
+        return;
+    }
+
+    // the last cipher block is the iv of the next call, src may be overwritten when decrypt in place
+    uint8_t nextIv[BLOCK_SIZE];
+    memcpy(nextIv, src + (count - 1) * BLOCK_SIZE, BLOCK_SIZE);
+
+    int outLen = 0;
+    EVP_DecryptInit_ex(mCtx, nullptr, nullptr, nullptr, iv);
+    EVP_DecryptUpdate(mCtx, dst, &outLen, src, count * BLOCK_SIZE);
+    memcpy(iv, nextIv, BLOCK_SIZE);
 }
@@ -5,10 +5,11 @@
 #ifndef CICADAMEDIA_OPENSSAESDECRYPT_H
 #define CICADAMEDIA_OPENSSAESDECRYPT_H
 
-#include <openssl/aes.h>
+#include <openssl/evp.h>
 #include "IAESDecrypt.h"
 
 namespace Cicada {
+    // CBC decryption by EVP, which uses AES-NI or the ARMv8 crypto extension when the CPU has them
     class OpenSSAESDecrypt : public IAESDecrypt {
     public:
         OpenSSAESDecrypt();
@@ -20,7 +21,7 @@ namespace Cicada {
         void decrypt(uint8_t *dst, const uint8_t *src, int count, uint8_t *iv) override;
 
     private:
-        AES_KEY mAesKey{};
+        EVP_CIPHER_CTX *mCtx{nullptr};
 
     };
 }
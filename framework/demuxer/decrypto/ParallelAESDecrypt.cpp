@@ -0,0 +1,107 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "ParallelAESDecrypt.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <utils/afExecutor.h>
+
+using namespace Cicada;
+
+namespace {
+    struct SliceJob {
+        std::atomic<int> next{0};
+        int slices{0};
+        int done{0};
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::function<void(int)> run;
+
+        // return false if no slice left
+        bool runOne()
+        {
+            int index = next++;
+
+            if (index >= slices) {
+                return false;
+            }
+
+            run(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done++;
+            }
+            cond.notify_one();
+            return true;
+        }
+    };
+}// namespace
+
+ParallelAESDecrypt::ParallelAESDecrypt(const creator &create, int maxSlices)
+{
+    maxSlices = std::max(maxSlices, 1);
+
+    for (int i = 0; i < maxSlices; i++) {
+        mDecrypters.push_back(std::unique_ptr<IAESDecrypt>(create()));
+    }
+}
+
+ParallelAESDecrypt::~ParallelAESDecrypt() = default;
+
+int ParallelAESDecrypt::setKey(const uint8_t *key, int key_bits)
+{
+    for (auto &decrypter : mDecrypters) {
+        int ret = decrypter->setKey(key, key_bits);
+
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+void ParallelAESDecrypt::decrypt(uint8_t *dst, const uint8_t *src, int count, uint8_t *iv)
+{
+    int slices = std::min((int) mDecrypters.size(), count / MIN_SLICE_BLOCKS);
+
+    if (slices <= 1) {
+        mDecrypters[0]->decrypt(dst, src, count, iv);
+        return;
+    }
+
+    int sliceBlocks = (count + slices - 1) / slices;
+    slices = (count + sliceBlocks - 1) / sliceBlocks;
+    // the ivs are taken before any slice starts, src may be overwritten when decrypt in place
+    std::vector<uint8_t> ivs(slices * BLOCK_SIZE);
+    memcpy(ivs.data(), iv, BLOCK_SIZE);
+
+    for (int i = 1; i < slices; i++) {
+        memcpy(ivs.data() + i * BLOCK_SIZE, src + (i * sliceBlocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+    }
+
+    memcpy(iv, src + (count - 1) * BLOCK_SIZE, BLOCK_SIZE);
+
+    auto job = std::make_shared<SliceJob>();
+    job->slices = slices;
+    job->run = [this, dst, src, count, sliceBlocks, &ivs](int index) {
+        int offset = index * sliceBlocks;
+        int blocks = std::min(sliceBlocks, count - offset);
+        mDecrypters[index]->decrypt(dst + offset * BLOCK_SIZE, src + offset * BLOCK_SIZE, blocks, ivs.data() + index * BLOCK_SIZE);
+    };
+
+    // a late task finds no slice left and touches nothing but the job
+    for (int i = 1; i < slices; i++) {
+        afExecutor::getInstance().post([job]() { job->runOne(); });
+    }
+
+    while (job->runOne()) {
+    }
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->cond.wait(lock, [&job]() { return job->done == job->slices; });
+}
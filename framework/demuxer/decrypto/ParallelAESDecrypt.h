@@ -0,0 +1,39 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_PARALLELAESDECRYPT_H
+#define CICADAMEDIA_PARALLELAESDECRYPT_H
+
+#include "IAESDecrypt.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Cicada {
+    /*
+     * CBC decryption of a block only needs the previous cipher block, so a large range is split into slices,
+     * every slice is decrypted by its own context on the afExecutor, the caller decrypts the slices not taken yet.
+     */
+    class CICADA_CPLUS_EXTERN ParallelAESDecrypt : public IAESDecrypt {
+    public:
+        typedef std::function<IAESDecrypt *()> creator;
+
+        // smaller ranges are decrypted on the caller thread
+        const static int MIN_SLICE_BLOCKS = 8 * 1024;
+
+        ParallelAESDecrypt(const creator &create, int maxSlices);
+
+        ~ParallelAESDecrypt() override;
+
+        int setKey(const uint8_t *key, int key_bits) override;
+
+        void decrypt(uint8_t *dst, const uint8_t *src, int count, uint8_t *iv) override;
+
+    private:
+        std::vector<std::unique_ptr<IAESDecrypt>> mDecrypters{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_PARALLELAESDECRYPT_H
@@ -4,6 +4,7 @@
 #define LOG_TAG "demuxer_service"
 
 #include <algorithm>
+#include <utils/afTrace.h>
 #include <utils/frame_work_log.h>
 #include <cassert>
 #include <utils/errors/framework_error.h>
@@ -175,6 +176,7 @@ namespace Cicada {
 
     int demuxer_service::readPacket(std::unique_ptr<IAFPacket> &packet, int index)
     {
+        AF_TRACE_SCOPE("demuxer", "readPacket");
         int ret;
         CHECK_DEMUXER;
         ret = mDemuxerPtr->ReadPacket(packet, index);
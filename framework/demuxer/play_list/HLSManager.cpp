@@ -35,6 +35,27 @@ namespace Cicada {
         }
 
         mStreamInfoList.clear();
+
+        if (mTrickStreamInfo) {
+            mTrickStreamInfo->mPFrame = nullptr;
+            mTrickStreamInfo->mPStream->close();
+            delete mTrickStreamInfo->mPStream;
+            delete mTrickStreamInfo;
+        }
+    }
+
+    HLSManager::HLSStreamInfo *HLSManager::createStreamInfo(Representation *rep, int id)
+    {
+        rep->mPlayListType = playList_demuxer::playList_type_hls;
+        auto *pTracker = new SegmentTracker(rep, mSourceConfig);
+        pTracker->setOptions(mOpts);
+        auto *info = new HLSStreamInfo();
+        info->mPStream = new HLSStream(pTracker, id);
+        info->mPStream->setOptions(mOpts);
+        info->mPStream->setDataSourceConfig(mSourceConfig);
+        info->mPStream->setBitStreamFormat(mMergeVideoHeader, mMergerAudioHeader);
+        info->mPStream->setUrlToUniqueIdCallback(mUrlHashCb, mUrlHashCbUserData);
+        return info;
     }
 
     int HLSManager::init()
@@ -42,6 +63,8 @@ namespace Cicada {
         int ret;
         std::list<Period *> &periodList = mPList->GetPeriods();
         int id = 0;
+        Representation *trickRep = nullptr;
+        uint64_t trickBandwidth = UINT64_MAX;
 
         for (auto &pit : periodList) {
             std::list<AdaptationSet *> &adaptSetList = pit->GetAdaptSets();
@@ -50,20 +73,31 @@ namespace Cicada {
                 auto representList = ait->getRepresentations();
 
                 for (auto &rit : representList) {
-                    rit->mPlayListType = playList_demuxer::playList_type_hls;
-                    auto *pTracker = new SegmentTracker(rit, mSourceConfig);
-                    pTracker->setOptions(mOpts);
-                    auto *info = new HLSStreamInfo();
-                    info->mPStream = new HLSStream(pTracker, id++);
-                    info->mPStream->setOptions(mOpts);
-                    info->mPStream->setDataSourceConfig(mSourceConfig);
-                    info->mPStream->setBitStreamFormat(mMergeVideoHeader, mMergerAudioHeader);
-                    info->mPStream->setUrlToUniqueIdCallback(mUrlHashCb, mUrlHashCbUserData);
-                    mStreamInfoList.push_back(info);
+                    if (rit->mIFrameOnly) {
+                        // the fetched data grows with the speed, use the lowest one
+                        int width;
+                        int height;
+                        uint64_t bandwidth = 0;
+                        std::string lang;
+                        rit->getStreamInfo(&width, &height, &bandwidth, lang);
+
+                        if (trickRep == nullptr || bandwidth < trickBandwidth) {
+                            trickRep = rit;
+                            trickBandwidth = bandwidth;
+                        }
+
+                        continue;
+                    }
+
+                    mStreamInfoList.push_back(createStreamInfo(rit, id++));
                 }
             }
         }
 
+        if (trickRep) {
+            mTrickStreamInfo = createStreamInfo(trickRep, id);
+        }
+
         if (mStreamInfoList.size() == 1) {
             // mediaPlayList
             ret = (*mStreamInfoList.begin())->mPStream->open();
@@ -87,6 +121,10 @@ namespace Cicada {
                 i->mPStream->preStop();
             }
         }
+
+        if (mTrickStreamInfo && mTrickStreamInfo->mPStream->isOpened()) {
+            mTrickStreamInfo->mPStream->preStop();
+        }
     }
 
     void HLSManager::stop()
@@ -97,6 +135,10 @@ namespace Cicada {
             }
         }
 
+        if (mTrickStreamInfo && mTrickStreamInfo->mPStream->isOpened()) {
+            mTrickStreamInfo->mPStream->stop();
+        }
+
         mStarted = false;
     }
 
@@ -190,6 +232,10 @@ namespace Cicada {
             return ret;
         }
 
+        if (mTrickIndex >= 0) {
+            return readTrickPacket(packet);
+        }
+
         // TODO: detect eos
         int ret;
 
@@ -324,6 +370,101 @@ namespace Cicada {
         return packet->getSize();
     }
 
+    int HLSManager::readTrickPacket(unique_ptr<IAFPacket> &packet)
+    {
+        if (mTrickStreamInfo->eos) {
+            AF_LOGD("EOS");
+            return 0;
+        }
+
+        int ret = mTrickStreamInfo->mPStream->read(packet);
+
+        if (ret > 0) {
+            // the I-frames take the place of the video stream, so the decoder and the buffer keep working
+            packet->getInfo().streamIndex = mTrickIndex;
+        } else if (ret == 0) {
+            AF_LOGD("trick play EOF\n");
+            mTrickStreamInfo->eos = true;
+            packet = nullptr;
+        }
+
+        return ret;
+    }
+
+    int HLSManager::setTrickPlay(bool enable, int index)
+    {
+        if (!enable) {
+            if (mTrickIndex < 0) {
+                return 0;
+            }
+
+            AF_LOGI("trick play end\n");
+            mTrickStreamInfo->mPStream->stop();
+            mTrickStreamInfo->mPFrame = nullptr;
+            mTrickStreamInfo->selected = false;
+            mTrickIndex = -1;
+
+            for (auto &i : mStreamInfoList) {
+                if (i->suspended) {
+                    i->suspended = false;
+                    i->eos = false;
+                    i->mPStream->start();
+                }
+            }
+
+            return 0;
+        }
+
+        if (mTrickStreamInfo == nullptr || mMuxedStream) {
+            return -1;
+        }
+
+        if (mTrickIndex >= 0) {
+            mTrickIndex = index;
+            return 0;
+        }
+
+        HLSStreamInfo *videoInfo = nullptr;
+
+        for (auto &i : mStreamInfoList) {
+            if (i->selected && i->mPStream->getId() == GEN_STREAM_INDEX(index)) {
+                videoInfo = i;
+                break;
+            }
+        }
+
+        if (videoInfo == nullptr ||
+            (videoInfo->mPStream->getStreamType() != STREAM_TYPE_VIDEO && videoInfo->mPStream->getStreamType() != STREAM_TYPE_MIXED)) {
+            AF_LOGW("stream %d is not a video stream\n", index);
+            return -1;
+        }
+
+        if (!mTrickStreamInfo->mPStream->isOpened()) {
+            int ret = mTrickStreamInfo->mPStream->open();
+
+            if (ret < 0) {
+                AF_LOGE("open I-frame stream error %d\n", ret);
+                return ret;
+            }
+        }
+
+        // drop the full rate streams, only the I-frames are downloaded
+        for (auto &i : mStreamInfoList) {
+            if (i->selected && i->mPStream->isOpened()) {
+                i->mPStream->stop();
+                i->mPFrame = nullptr;
+                i->suspended = true;
+            }
+        }
+
+        mTrickStreamInfo->selected = true;
+        mTrickStreamInfo->eos = false;
+        mTrickStreamInfo->mPStream->start();
+        mTrickIndex = index;
+        AF_LOGI("trick play start on stream %d\n", index);
+        return 0;
+    }
+
     int HLSManager::OpenStream(int index)
     {
         int ret = 0;
@@ -441,6 +582,13 @@ namespace Cicada {
 
     int64_t HLSManager::seek(int64_t us, int flags, int index)
     {
+        if (mTrickIndex >= 0 && index == -1) {
+            // the suspended streams are sought when trick play end
+            mTrickStreamInfo->eos = false;
+            mTrickStreamInfo->mPFrame = nullptr;
+            return mTrickStreamInfo->mPStream->seek(us, flags);
+        }
+
         bool hasOpened = false;
 
         for (auto &i : mStreamInfoList) {
@@ -605,6 +753,10 @@ namespace Cicada {
         for (auto &i : mStreamInfoList) {
             i->mPStream->interrupt(inter);
         }
+
+        if (mTrickStreamInfo) {
+            mTrickStreamInfo->mPStream->interrupt(inter);
+        }
     }
 
     bool HLSManager::isRealTimeStream(int index)
@@ -646,6 +798,9 @@ namespace Cicada {
         if (mMuxedStream) {
             return mMuxedStream->getBufferDuration();
         }
+        if (mTrickIndex >= 0) {
+            return mTrickStreamInfo->mPStream->getBufferDuration();
+        }
         for (auto &i : mStreamInfoList) {
             if (i->mPStream->getId() == index) {
                 return i->mPStream->getBufferDuration();
@@ -20,6 +20,8 @@ namespace Cicada{
             bool stopOnSegEnd = false;
             int toStreamId = -1;
             bool eos = false;
+            // stopped for trick play, restart when trick play end
+            bool suspended = false;
         };
 
     public:
@@ -49,6 +51,8 @@ namespace Cicada{
 
         int SwitchStreamAligned(int from, int to) override;
 
+        int setTrickPlay(bool enable, int index) override;
+
         int getNBSubStream(int index) const override;
 
         void interrupt(int inter) override;
@@ -63,8 +67,17 @@ namespace Cicada{
 
         int64_t getBufferDuration(int index) const override;
 
+    private:
+        HLSStreamInfo *createStreamInfo(Representation *rep, int id);
+
+        int readTrickPacket(std::unique_ptr<IAFPacket> &packet);
+
     private:
         std::list<HLSStreamInfo*> mStreamInfoList{};
+        // the I-frame rendition, not a stream the user can select
+        HLSStreamInfo *mTrickStreamInfo = nullptr;
+        // the video stream which the I-frames are read for, -1 if not in trick play
+        int mTrickIndex = -1;
         HLSStream *mMuxedStream = nullptr;
         bool mStarted = false;
         int64_t mFirstSeekPos = INT64_MIN;
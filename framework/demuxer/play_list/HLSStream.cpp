@@ -12,6 +12,7 @@
 #include "segment.h"
 #include "segment_decrypt/SegDecryptorFactory.h"
 #include "utils/DrmUtils.h"
+#include "utils/afTrace.h"
 #include "utils/af_string.h"
 #include "utils/errors/framework_error.h"
 #include "utils/frame_work_log.h"
@@ -1104,6 +1105,7 @@ namespace Cicada {
 
     int HLSStream::read_internal(std::unique_ptr<IAFPacket> &packet)
     {
+        AF_TRACE_SCOPE("hls", "read_internal");
         //TODO: move read synMsgRst to class member
         int ret = mPTracker->reLoadPlayList();
 
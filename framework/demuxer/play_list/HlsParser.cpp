@@ -82,7 +82,7 @@ namespace Cicada {
         if (uriAttr) {
             std::string uri;
 
-            if (tag->getType() == AttributesTag::EXTXMEDIA) {
+            if (tag->getType() == AttributesTag::EXTXMEDIA || tag->getType() == AttributesTag::EXTXIFRAMESTREAMINF) {
                 uri = uriAttr->quotedString();
             } else {
                 uri = uriAttr->value;
@@ -266,6 +266,10 @@ namespace Cicada {
                     ctx_byterange = dynamic_cast<const SingleValueTag *>(tag);
                     break;
 
+                case Tag::EXTXIFRAMESONLY:
+                    rep->mIFrameOnly = true;
+                    break;
+
                 case SingleValueTag::EXTXPROGRAMDATETIME: {
                     //rep->b_consistent = false;
                     std::string timeValue = dynamic_cast<const SingleValueTag *>(tag)->getValue().value;
@@ -687,6 +691,30 @@ namespace Cicada {
                 delete adaptSet;
             }
 
+            /* I-frame renditions for trick play, they are not normal streams */
+            std::list<Tag *> iFrameStreamInfoTags = getTagsFromList(tagsList, AttributesTag::EXTXIFRAMESTREAMINF);
+
+            if (!iFrameStreamInfoTags.empty()) {
+                auto *iFrameAdaptSet = new AdaptationSet(period);
+
+                for (it = iFrameStreamInfoTags.begin(); it != iFrameStreamInfoTags.end(); ++it) {
+                    auto *tag = dynamic_cast<AttributesTag *>(*it);
+
+                    if (tag && tag->getAttributeByName("URI")) {
+                        Representation *rep = createRepresentation(iFrameAdaptSet, tag);
+                        rep->mIFrameOnly = true;
+                        rep->mStreamType = STREAM_TYPE_VIDEO;
+                        iFrameAdaptSet->addRepresentation(rep);
+                    }
+                }
+
+                if (!iFrameAdaptSet->getRepresentations().empty()) {
+                    period->addAdaptationSet(iFrameAdaptSet);
+                } else {
+                    delete iFrameAdaptSet;
+                }
+            }
+
 //            unsigned set_id = 1;
             std::map<std::string, AttributesTag *>::const_iterator groupsit;
 
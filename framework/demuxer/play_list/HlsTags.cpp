@@ -298,6 +298,7 @@ namespace Cicada {
                 {"EXT-X-I-FRAMES-ONLY",          Tag::EXTXIFRAMESONLY},
                 {"EXT-X-MEDIA",                  AttributesTag::EXTXMEDIA},
                 {"EXT-X-STREAM-INF",             AttributesTag::EXTXSTREAMINF},
+                {"EXT-X-I-FRAME-STREAM-INF",     AttributesTag::EXTXIFRAMESTREAMINF},
                 {"EXTINF",                       ValuesListTag::EXTINF},
                 {"",                             SingleValueTag::URI},
                 {"EXT-X-PART",                   AttributesTag::EXTX_PART},
@@ -337,6 +338,7 @@ namespace Cicada {
                     case AttributesTag::EXTXMAP:
                     case AttributesTag::EXTXMEDIA:
                     case AttributesTag::EXTXSTREAMINF:
+                    case AttributesTag::EXTXIFRAMESTREAMINF:
                     case AttributesTag::EXTX_PART:
                     case AttributesTag::EXTX_PART_INF:
                     case AttributesTag::EXTX_SERVER_CONTROL:
@@ -82,6 +82,7 @@ namespace Cicada{
                 EXTXMAP,
                 EXTXMEDIA,
                 EXTXSTREAMINF,
+                EXTXIFRAMESTREAMINF,
                 EXTX_PART,
                 EXTX_PART_INF,
                 EXTX_SERVER_CONTROL,
@@ -108,7 +109,7 @@ namespace Cicada{
         class CICADA_CPLUS_EXTERN ValuesListTag : public AttributesTag {
         public:
             enum {
-                EXTINF = 30
+                EXTINF = 40
             };
 
             ValuesListTag(int, const std::string &);
@@ -40,6 +40,11 @@ namespace Cicada{
 
         virtual int SwitchStreamAligned(int from, int to) = 0;
 
+        virtual int setTrickPlay(bool enable, int index)
+        {
+            return -1;
+        }
+
         virtual int getNBSubStream(int index) const = 0;
 
         virtual void interrupt(int inter) = 0;
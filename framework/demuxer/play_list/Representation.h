@@ -73,6 +73,8 @@ namespace Cicada{
         int64_t targetDuration = 0;
         int64_t partTargetDuration = 0;
         bool b_live = false;
+        // EXT-X-I-FRAMES-ONLY, every segment is a byte range of one I-frame
+        bool mIFrameOnly{false};
         int mPlayListType{0};
         Stream_type mStreamType = STREAM_TYPE_MIXED;
         std::string mLang = "";
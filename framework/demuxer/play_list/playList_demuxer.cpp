@@ -208,6 +208,15 @@ namespace Cicada {
         return -EINVAL;
     }
 
+    int playList_demuxer::setTrickPlay(bool enable, int index)
+    {
+        if (mPPlaylistManager) {
+            return mPPlaylistManager->setTrickPlay(enable, index);
+        }
+
+        return -EINVAL;
+    }
+
 
     int playList_demuxer::GetNbSubStreams(int index) const
     {
@@ -72,6 +72,8 @@ namespace Cicada{
 
         int SwitchStreamAligned(int from, int to) override;
 
+        int setTrickPlay(bool enable, int index) override;
+
         int64_t getMaxGopTimeUs() override;
 
         UTCTimer *getUTCTimer() override;
@@ -10,16 +10,34 @@
 #include "AES_128Decrypter.h"
 #include "utils/frame_work_log.h"
 #include <cerrno>
+#include "../../decrypto/ParallelAESDecrypt.h"
 #include "../../decrypto/avAESDecrypt.h"
+#include <utils/afExecutor.h>
+
+#ifdef USE_OPENSSL
+#include "../../decrypto/OpenSSAESDecrypt.h"
+#endif
 
 using namespace Cicada;
 
 #define MIN(a, b) (((a)<(b))?(a):(b))
+#define MAX_DECRYPT_SLICES 4
 
 AES_128Decrypter::AES_128Decrypter(ISegDecrypter::read_cb read, void *arg) : ISegDecrypter(read, arg)
 {
     mEos = false;
-    mAESDecrypt = std::unique_ptr<Cicada::IAESDecrypt>(new avAESDecrypt());
+    mInBuffer = std::unique_ptr<uint8_t[]>(new uint8_t[BUFFER_SIZE]);
+    mOutBuffer = std::unique_ptr<uint8_t[]>(new uint8_t[BUFFER_SIZE]);
+    int slices = std::min(afExecutor::getInstance().getWorkerCount(), MAX_DECRYPT_SLICES);
+    mAESDecrypt = std::unique_ptr<Cicada::IAESDecrypt>(new ParallelAESDecrypt(
+            []() -> IAESDecrypt * {
+#ifdef USE_OPENSSL
+                return new OpenSSAESDecrypt();
+#else
+                return new avAESDecrypt();
+#endif
+            },
+            slices));
 }
 
 AES_128Decrypter::~AES_128Decrypter() = default;
@@ -41,9 +59,19 @@ retry:
         return size;
     }
 
-    while (mInData - mInDataUsed < 2 * IAESDecrypt::BLOCK_SIZE) {
-        int n = mReadCb(mReadCbArg, mInBuffer + mInData,
-                        sizeof(mInBuffer) - mInData);
+    // less than two blocks are left, cheap to move
+    if (mInDataUsed > 0) {
+        memmove(mInBuffer.get(), mInBuffer.get() + mInDataUsed, mInData - mInDataUsed);
+        mInData -= mInDataUsed;
+        mInDataUsed = 0;
+    }
+
+    /*
+     * don't wait for more than the source has, decrypt the full blocks read, only a large input
+     * from a fast source is decrypted in parallel
+     */
+    while (mInData - mInDataUsed < MIN_READ_SIZE && mInData < BUFFER_SIZE) {
+        int n = mReadCb(mReadCbArg, mInBuffer.get() + mInData, BUFFER_SIZE - mInData);
 
         if (n <= 0) {
             mEos = true;
@@ -64,18 +92,11 @@ retry:
         blocks--;
     }
 
-    mAESDecrypt->decrypt(mOutBuffer, mInBuffer + mInDataUsed, blocks, mIvec);
+    mAESDecrypt->decrypt(mOutBuffer.get(), mInBuffer.get() + mInDataUsed, blocks, mIvec);
     mOutData = IAESDecrypt::BLOCK_SIZE * blocks;
-    mOutPtr = mOutBuffer;
+    mOutPtr = mOutBuffer.get();
     mInDataUsed += IAESDecrypt::BLOCK_SIZE * blocks;
 
-    if (mInDataUsed >= sizeof(mInBuffer) / 2) {
-        memmove(mInBuffer, mInBuffer + mInDataUsed,
-                mInData - mInDataUsed);
-        mInData -= mInDataUsed;
-        mInDataUsed = 0;
-    }
-
     if (mEos) {
         // Remove PKCS7 padding at the end
         int padding = mOutBuffer[mOutData - 1];
@@ -30,15 +30,19 @@ public:
     };
 
 protected:
-    static const int MAX_BUFFER_BLOCKS = 257;
+    // 1MB, a big chunk is decrypted in slices by several threads
+    static const int MAX_BUFFER_BLOCKS = 64 * 1024 + 1;
+    static const int BUFFER_SIZE = Cicada::IAESDecrypt::BLOCK_SIZE * MAX_BUFFER_BLOCKS;
+    // a block is held back until the next one comes, it may be the last one with the padding
+    static const int MIN_READ_SIZE = 2 * Cicada::IAESDecrypt::BLOCK_SIZE;
     uint8_t mIvec[Cicada::IAESDecrypt::BLOCK_SIZE]{0};
     bool mEos;
     bool mValidKeyInfo{false};
     uint8_t *mOutPtr = nullptr;
     int mInData = 0, mInDataUsed = 0, mOutData = 0;
 
-    uint8_t mInBuffer[Cicada::IAESDecrypt::BLOCK_SIZE * MAX_BUFFER_BLOCKS]{},
-            mOutBuffer[Cicada::IAESDecrypt::BLOCK_SIZE * MAX_BUFFER_BLOCKS]{};
+    std::unique_ptr<uint8_t[]> mInBuffer{nullptr};
+    std::unique_ptr<uint8_t[]> mOutBuffer{nullptr};
 
     std::unique_ptr<Cicada::IAESDecrypt> mAESDecrypt{nullptr};
 
@@ -22,12 +22,20 @@
 #include <cstring>
 #include "../decrypto/avAESDecrypt.h"
 
+#ifdef USE_OPENSSL
+#include "../decrypto/OpenSSAESDecrypt.h"
+#endif
+
 using namespace Cicada;
 using namespace std;
 
 HLSSampleAesDecrypter::HLSSampleAesDecrypter()
 {
+#ifdef USE_OPENSSL
+    mDecrypt = std::unique_ptr<Cicada::IAESDecrypt>(new OpenSSAESDecrypt());
+#else
     mDecrypt = std::unique_ptr<Cicada::IAESDecrypt>(new avAESDecrypt());
+#endif
 }
 
 int HLSSampleAesDecrypter::SetOption(const char *key, uint8_t *buffer, int size)
@@ -177,18 +185,27 @@ void HLSSampleAesDecrypter::decrypt_nalunit(uint8_t *nal_unit, int nal_size)
      */
     nal_unit += VIDEO_CLEAR_LEAD;
     nal_size -= VIDEO_CLEAR_LEAD;
+    // the encrypted blocks are one CBC chain, gather them and decrypt by one call
+    int count = 0;
+    int offset = 0;
+    mBlocks.resize(static_cast<size_t>(nal_size / (10 * IAESDecrypt::BLOCK_SIZE) + 1) * IAESDecrypt::BLOCK_SIZE);
+
+    while (nal_size - offset > IAESDecrypt::BLOCK_SIZE) {
+        memcpy(mBlocks.data() + count * IAESDecrypt::BLOCK_SIZE, nal_unit + offset, IAESDecrypt::BLOCK_SIZE);
+        count++;
+        offset += IAESDecrypt::BLOCK_SIZE;
+        // unencrypted_block
+        offset += std::min(nal_size - offset, (9 * IAESDecrypt::BLOCK_SIZE));
+    }
 
-    while (nal_size > IAESDecrypt::BLOCK_SIZE) {
-        if (nal_size > IAESDecrypt::BLOCK_SIZE) {
-            mDecrypt->decrypt(nal_unit, nal_unit, 1, packet_iv_tmp);
-            nal_size -= IAESDecrypt::BLOCK_SIZE;
-            nal_unit += IAESDecrypt::BLOCK_SIZE;
-        }
+    if (count == 0) {
+        return;
+    }
 
-        // unencrypted_block
-        int sz = std::min(nal_size, (9 * IAESDecrypt::BLOCK_SIZE));
-        nal_size -= sz;
-        nal_unit += sz;
+    mDecrypt->decrypt(mBlocks.data(), mBlocks.data(), count, packet_iv_tmp);
+
+    for (int i = 0; i < count; i++) {
+        memcpy(nal_unit + i * 10 * IAESDecrypt::BLOCK_SIZE, mBlocks.data() + i * IAESDecrypt::BLOCK_SIZE, IAESDecrypt::BLOCK_SIZE);
     }
 }
 
@@ -196,7 +213,7 @@ int HLSSampleAesDecrypter::decryptH264Video(uint8_t *buffer, int size)
 {
     uint8_t *h264_frame_end = buffer + size;
     uint8_t *tmp = buffer;
-    uint8_t *dst = (uint8_t *) malloc(size);
+    // the output is never longer than the input, write it back in place behind the read position
     int dst_pos = 0;
 
     while (tmp < h264_frame_end) {
@@ -210,14 +227,14 @@ int HLSSampleAesDecrypter::decryptH264Video(uint8_t *buffer, int size)
         }
 
         if (startcode_len == 4) {
-            dst[dst_pos++] = 0x00;
-            dst[dst_pos++] = 0x00;
-            dst[dst_pos++] = 0x00;
-            dst[dst_pos++] = 0x01;
+            buffer[dst_pos++] = 0x00;
+            buffer[dst_pos++] = 0x00;
+            buffer[dst_pos++] = 0x00;
+            buffer[dst_pos++] = 0x01;
         } else if (startcode_len == 3) {
-            dst[dst_pos++] = 0x00;
-            dst[dst_pos++] = 0x00;
-            dst[dst_pos++] = 0x01;
+            buffer[dst_pos++] = 0x00;
+            buffer[dst_pos++] = 0x00;
+            buffer[dst_pos++] = 0x01;
         } else {
             assert(0);
             return size;
@@ -227,12 +244,15 @@ int HLSSampleAesDecrypter::decryptH264Video(uint8_t *buffer, int size)
 
         if ((nal_type != 1 && nal_type != 5) ||
                 (nal_size <= VIDEO_CLEAR_LEAD + IAESDecrypt::BLOCK_SIZE)) {
-            memcpy(dst + dst_pos, nal_unit, static_cast<size_t>(nal_size));
+            if (buffer + dst_pos != nal_unit) {
+                memmove(buffer + dst_pos, nal_unit, static_cast<size_t>(nal_size));
+            }
+
             dst_pos += nal_size;
         } else {
-            uint8_t *new_nal_start = dst + dst_pos;
+            uint8_t *new_nal_start = buffer + dst_pos;
             //remove prevension
-            int new_nal_size = remove_nalunit_prevention(nal_unit, nal_size, dst, dst_pos);
+            int new_nal_size = remove_nalunit_prevention(nal_unit, nal_size, buffer, dst_pos);
             //decrypt
             decrypt_nalunit(new_nal_start, new_nal_size);
         }
@@ -240,8 +260,6 @@ int HLSSampleAesDecrypter::decryptH264Video(uint8_t *buffer, int size)
         tmp = nal_unit + nal_size;
     }
 
-    memcpy(buffer, dst, dst_pos);
-    free(dst);
     return dst_pos;
 }
 
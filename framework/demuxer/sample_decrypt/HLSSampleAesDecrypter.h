@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include "ISampleDecryptor.h"
 #include "../decrypto/IAESDecrypt.h"
 
@@ -36,6 +37,8 @@ private:
     uint8_t mIvec[Cicada::IAESDecrypt::BLOCK_SIZE]{0};
     bool mValidKeyInfo{false};
     std::unique_ptr<Cicada::IAESDecrypt> mDecrypt{nullptr};
+    // the encrypted blocks of a NAL unit gathered together, decrypted by one call
+    std::vector<uint8_t> mBlocks{};
 };
 
 
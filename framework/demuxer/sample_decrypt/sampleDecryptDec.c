@@ -120,6 +120,14 @@ static int sampleDecrypt_read_packet(AVFormatContext *s, AVPacket *pkt)
     }
 
     if (c->decryptor) {
+        // decrypt in place, copy only if the buffer is shared
+        ret = av_packet_make_writable(pkt);
+
+        if (ret < 0) {
+            av_packet_unref(pkt);
+            return ret;
+        }
+
         int size = SampleDecryptDec((void *) c->decryptor, s->streams[pkt->stream_index]->codecpar->codec_id, pkt->data, pkt->size);
         assert(size > 0);
         if (size <= 0) {
@@ -201,6 +201,17 @@ void FilterManager::clearBuffer()
     }
 }
 
+int FilterManager::getBufferedFrameCount()
+{
+    int count = 0;
+
+    for (auto &iter : mFilterChains) {
+        count += iter.second->getBufferedCount();
+    }
+
+    return count;
+}
+
 void FilterManager::setStreamMeta(const Stream_meta* meta) {
     streamMeta = meta;
 
@@ -39,6 +39,8 @@ namespace Cicada {
 
         void clearBuffer();
 
+        int getBufferedFrameCount();
+
         int invoke(int cmd, const std::string &content) override
         {
             return 0;
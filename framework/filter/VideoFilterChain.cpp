@@ -235,6 +235,11 @@ void VideoFilterChain::clearBuffer()
     }
 }
 
+int VideoFilterChain::getBufferedCount()
+{
+    return (int) (mInPutFrames.size() + mOutPutFrames.size());
+}
+
 bool VideoFilterChain::hasFilter(const std::string &target)
 {
     return mVideoFiltersMap.find(target) != mVideoFiltersMap.end();
@@ -41,6 +41,9 @@ namespace Cicada {
 
         void clearBuffer();
 
+        // the frames queued in and out of the chain
+        int getBufferedCount();
+
         bool hasFilter(const std::string &target);
 
     private:
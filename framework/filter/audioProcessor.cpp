@@ -0,0 +1,491 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "audioProcessor"
+
+#include "audioProcessor.h"
+#include <algorithm>
+#include <base/media/AVAFPacket.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <utils/frame_work_log.h>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIO_PROCESS_NEON
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIO_PROCESS_SSE2
+#endif
+
+#define S16_SCALE 32768.0f
+// -3dB
+#define MIX_LEVEL 0.7071f
+
+namespace Cicada {
+
+    static inline int16_t clipS16(float value)
+    {
+        long v = lrintf(value);
+        return static_cast<int16_t>(std::min(std::max(v, -32768L), 32767L));
+    }
+
+    bool audioProcessor::isFormatSupported(int format)
+    {
+        return format == AF_SAMPLE_FMT_S16 || format == AF_SAMPLE_FMT_S16P || format == AF_SAMPLE_FMT_FLT ||
+               format == AF_SAMPLE_FMT_FLTP;
+    }
+
+    bool audioProcessor::isConversionSupported(const IAFFrame::audioInfo &src, const IAFFrame::audioInfo &dst)
+    {
+        if (!isFormatSupported(src.format) || !isFormatSupported(dst.format) || src.sample_rate != dst.sample_rate) {
+            return false;
+        }
+
+        return src.channels == dst.channels || dst.channels == 1 || (src.channels == 1 && dst.channels == 2) ||
+               (src.channels == 6 && dst.channels == 2);
+    }
+
+    void audioProcessor::setGain(float gain)
+    {
+        mTargetGain = std::max(gain, 0.0f);
+    }
+
+    void audioProcessor::setOutputFormat(const IAFFrame::audioInfo &info)
+    {
+        mOutputInfo = info;
+    }
+
+    void audioProcessor::flush()
+    {
+        mGain = mTargetGain;
+    }
+
+    bool audioProcessor::isBypass(const IAFFrame::audioInfo &info) const
+    {
+        bool convert = mOutputInfo.sample_rate != 0 && (info.format != mOutputInfo.format || info.channels != mOutputInfo.channels);
+        return !convert && mGain == 1.0f && mTargetGain == 1.0f;
+    }
+
+    int audioProcessor::process(std::unique_ptr<IAFFrame> &frame)
+    {
+        IAFFrame::audioInfo &info = frame->getInfo().audio;
+
+        if (isBypass(info)) {
+            return 0;
+        }
+
+        float gain = mGain;
+        float step = info.nb_samples > 0 ? (mTargetGain - mGain) / (float) info.nb_samples : 0;
+        mGain = mTargetGain;
+
+        if (mOutputInfo.sample_rate != 0 && (info.format != mOutputInfo.format || info.channels != mOutputInfo.channels)) {
+            return convert(frame, gain, step);
+        }
+
+        if (!isFormatSupported(info.format)) {
+            return -ENOTSUP;
+        }
+
+        AVFrame *avFrame = getAVFrame(frame.get());
+
+        if (avFrame == nullptr || av_frame_make_writable(avFrame) < 0) {
+            return -EINVAL;
+        }
+
+        applyGain(frame.get(), gain, step);
+        return 0;
+    }
+
+    void audioProcessor::applyGain(IAFFrame *frame, float gain, float step)
+    {
+        AVFrame *avFrame = getAVFrame(frame);
+        IAFFrame::audioInfo &info = frame->getInfo().audio;
+        int samples = info.nb_samples;
+
+        switch (info.format) {
+            case AF_SAMPLE_FMT_FLT:
+                gainFloat((float *) avFrame->extended_data[0], (float *) avFrame->extended_data[0], samples * info.channels, gain,
+                          step / info.channels);
+                break;
+
+            case AF_SAMPLE_FMT_S16:
+                gainS16((int16_t *) avFrame->extended_data[0], (int16_t *) avFrame->extended_data[0], samples * info.channels, gain,
+                        step / info.channels);
+                break;
+
+            case AF_SAMPLE_FMT_FLTP:
+                for (int i = 0; i < info.channels; i++) {
+                    gainFloat((float *) avFrame->extended_data[i], (float *) avFrame->extended_data[i], samples, gain, step);
+                }
+
+                break;
+
+            case AF_SAMPLE_FMT_S16P:
+                for (int i = 0; i < info.channels; i++) {
+                    gainS16((int16_t *) avFrame->extended_data[i], (int16_t *) avFrame->extended_data[i], samples, gain, step);
+                }
+
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    int audioProcessor::convert(std::unique_ptr<IAFFrame> &frame, float gain, float step)
+    {
+        IAFFrame::audioInfo info = frame->getInfo().audio;
+
+        if (!isConversionSupported(info, mOutputInfo)) {
+            AF_LOGE("not support convert %d(%d) to %d(%d)\n", info.format, info.channels, mOutputInfo.format, mOutputInfo.channels);
+            return -ENOTSUP;
+        }
+
+        int samples = info.nb_samples;
+        int srcChannels = info.channels;
+        int dstChannels = mOutputInfo.channels;
+        mSrcBuffer.resize(samples * std::max(srcChannels, dstChannels));
+        mDstBuffer.resize(samples * std::max(srcChannels, dstChannels));
+
+        int ret = readFloat(frame.get(), mSrcBuffer.data(), mDstBuffer.data());
+
+        if (ret < 0) {
+            return ret;
+        }
+
+        if (srcChannels != dstChannels) {
+            mixChannels(mDstBuffer.data(), dstChannels, mSrcBuffer.data(), srcChannels, samples);
+            mSrcBuffer.swap(mDstBuffer);
+        }
+
+        gainFloat(mSrcBuffer.data(), mSrcBuffer.data(), samples * dstChannels, gain, step / dstChannels);
+
+        IAFFrame::audioInfo outInfo = mOutputInfo;
+        outInfo.sample_rate = info.sample_rate;
+        outInfo.channel_layout = srcChannels == dstChannels ? info.channel_layout : 0;
+        std::unique_ptr<IAFFrame> outFrame = createFrame(outInfo, mSrcBuffer.data(), samples, mDstBuffer.data());
+
+        if (outFrame == nullptr) {
+            return -ENOMEM;
+        }
+
+        outFrame->getInfo().pts = frame->getInfo().pts;
+        outFrame->getInfo().duration = frame->getInfo().duration;
+        outFrame->getInfo().timePosition = frame->getInfo().timePosition;
+        outFrame->getInfo().utcTime = frame->getInfo().utcTime;
+        frame = std::move(outFrame);
+        return 0;
+    }
+
+    int audioProcessor::readFloat(IAFFrame *frame, float *dst, float *scratch)
+    {
+        AVFrame *avFrame = getAVFrame(frame);
+        const IAFFrame::audioInfo &info = frame->getInfo().audio;
+        int samples = info.nb_samples;
+        int channels = info.channels;
+
+        if (avFrame == nullptr) {
+            return -EINVAL;
+        }
+
+        switch (info.format) {
+            case AF_SAMPLE_FMT_S16:
+                s16ToFloat(dst, (const int16_t *) avFrame->extended_data[0], samples * channels);
+                break;
+
+            case AF_SAMPLE_FMT_FLT:
+                memcpy(dst, avFrame->extended_data[0], samples * channels * sizeof(float));
+                break;
+
+            case AF_SAMPLE_FMT_S16P: {
+                std::vector<const float *> planes(channels);
+
+                for (int i = 0; i < channels; i++) {
+                    s16ToFloat(scratch + i * samples, (const int16_t *) avFrame->extended_data[i], samples);
+                    planes[i] = scratch + i * samples;
+                }
+
+                interleave(dst, planes.data(), channels, samples);
+                break;
+            }
+
+            case AF_SAMPLE_FMT_FLTP:
+                interleave(dst, (const float *const *) avFrame->extended_data, channels, samples);
+                break;
+
+            default:
+                return -ENOTSUP;
+        }
+
+        return 0;
+    }
+
+    std::unique_ptr<IAFFrame> audioProcessor::createFrame(const IAFFrame::audioInfo &info, const float *src, int samples, float *scratch)
+    {
+        AVFrame *avFrame = av_frame_alloc();
+
+        if (avFrame == nullptr) {
+            return nullptr;
+        }
+
+        int channels = info.channels;
+        avFrame->format = info.format;
+        avFrame->channels = channels;
+        avFrame->channel_layout = info.channel_layout ? info.channel_layout : (uint64_t) av_get_default_channel_layout(channels);
+        avFrame->sample_rate = info.sample_rate;
+        avFrame->nb_samples = samples;
+
+        if (av_frame_get_buffer(avFrame, 0) < 0) {
+            av_frame_free(&avFrame);
+            return nullptr;
+        }
+
+        switch (info.format) {
+            case AF_SAMPLE_FMT_S16:
+                floatToS16((int16_t *) avFrame->extended_data[0], src, samples * channels);
+                break;
+
+            case AF_SAMPLE_FMT_FLT:
+                memcpy(avFrame->extended_data[0], src, samples * channels * sizeof(float));
+                break;
+
+            case AF_SAMPLE_FMT_S16P: {
+                std::vector<float *> planes(channels);
+
+                for (int i = 0; i < channels; i++) {
+                    planes[i] = scratch + i * samples;
+                }
+
+                deinterleave(planes.data(), src, channels, samples);
+
+                for (int i = 0; i < channels; i++) {
+                    floatToS16((int16_t *) avFrame->extended_data[i], planes[i], samples);
+                }
+
+                break;
+            }
+
+            default:
+                deinterleave((float *const *) avFrame->extended_data, src, channels, samples);
+                break;
+        }
+
+        return std::unique_ptr<IAFFrame>(new AVAFFrame(&avFrame, IAFFrame::FrameTypeAudio));
+    }
+
+    void audioProcessor::gainFloat(float *dst, const float *src, int count, float gain, float step)
+    {
+        int i = 0;
+#if defined(AUDIO_PROCESS_SSE2)
+        __m128 g = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+        __m128 s = _mm_set1_ps(4 * step);
+
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+            g = _mm_add_ps(g, s);
+        }
+
+#elif defined(AUDIO_PROCESS_NEON)
+        float init[4] = {gain, gain + step, gain + 2 * step, gain + 3 * step};
+        float32x4_t g = vld1q_f32(init);
+        float32x4_t s = vdupq_n_f32(4 * step);
+
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+            g = vaddq_f32(g, s);
+        }
+
+#endif
+
+        for (; i < count; i++) {
+            dst[i] = src[i] * (gain + (float) i * step);
+        }
+    }
+
+    void audioProcessor::gainS16(int16_t *dst, const int16_t *src, int count, float gain, float step)
+    {
+        int i = 0;
+#if defined(AUDIO_PROCESS_SSE2)
+        __m128 g0 = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+        __m128 g1 = _mm_add_ps(g0, _mm_set1_ps(4 * step));
+        __m128 s = _mm_set1_ps(8 * step);
+
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+            __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+            // saturated by the pack
+            __m128i out = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, g0)), _mm_cvtps_epi32(_mm_mul_ps(hi, g1)));
+            _mm_storeu_si128((__m128i *) (dst + i), out);
+            g0 = _mm_add_ps(g0, s);
+            g1 = _mm_add_ps(g1, s);
+        }
+
+#elif defined(AUDIO_PROCESS_NEON)
+        float init[4] = {gain, gain + step, gain + 2 * step, gain + 3 * step};
+        float32x4_t g0 = vld1q_f32(init);
+        float32x4_t g1 = vaddq_f32(g0, vdupq_n_f32(4 * step));
+        float32x4_t s = vdupq_n_f32(8 * step);
+
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t v = vld1q_s16(src + i);
+            float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+            float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+            int16x4_t outLo = vqmovn_s32(vcvtq_s32_f32(vmulq_f32(lo, g0)));
+            int16x4_t outHi = vqmovn_s32(vcvtq_s32_f32(vmulq_f32(hi, g1)));
+            vst1q_s16(dst + i, vcombine_s16(outLo, outHi));
+            g0 = vaddq_f32(g0, s);
+            g1 = vaddq_f32(g1, s);
+        }
+
+#endif
+
+        for (; i < count; i++) {
+            dst[i] = clipS16((float) src[i] * (gain + (float) i * step));
+        }
+    }
+
+    void audioProcessor::s16ToFloat(float *dst, const int16_t *src, int count)
+    {
+        int i = 0;
+#if defined(AUDIO_PROCESS_SSE2)
+        __m128 scale = _mm_set1_ps(1.0f / S16_SCALE);
+
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+        }
+
+#elif defined(AUDIO_PROCESS_NEON)
+        float32x4_t scale = vdupq_n_f32(1.0f / S16_SCALE);
+
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t v = vld1q_s16(src + i);
+            vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+            vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+        }
+
+#endif
+
+        for (; i < count; i++) {
+            dst[i] = (float) src[i] / S16_SCALE;
+        }
+    }
+
+    void audioProcessor::floatToS16(int16_t *dst, const float *src, int count)
+    {
+        int i = 0;
+#if defined(AUDIO_PROCESS_SSE2)
+        __m128 scale = _mm_set1_ps(S16_SCALE);
+        __m128 maxV = _mm_set1_ps(1.0f);
+        __m128 minV = _mm_set1_ps(-1.0f);
+
+        for (; i + 8 <= count; i += 8) {
+            __m128 lo = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), maxV), minV), scale);
+            __m128 hi = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), maxV), minV), scale);
+            _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi)));
+        }
+
+#elif defined(AUDIO_PROCESS_NEON)
+        float32x4_t scale = vdupq_n_f32(S16_SCALE);
+        float32x4_t maxV = vdupq_n_f32(1.0f);
+        float32x4_t minV = vdupq_n_f32(-1.0f);
+
+        for (; i + 8 <= count; i += 8) {
+            float32x4_t lo = vmulq_f32(vmaxq_f32(vminq_f32(vld1q_f32(src + i), maxV), minV), scale);
+            float32x4_t hi = vmulq_f32(vmaxq_f32(vminq_f32(vld1q_f32(src + i + 4), maxV), minV), scale);
+            vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(lo)), vqmovn_s32(vcvtq_s32_f32(hi))));
+        }
+
+#endif
+
+        for (; i < count; i++) {
+            dst[i] = clipS16(src[i] * S16_SCALE);
+        }
+    }
+
+    void audioProcessor::interleave(float *dst, const float *const *src, int channels, int samples)
+    {
+        if (channels == 2) {
+            const float *left = src[0];
+            const float *right = src[1];
+
+            for (int i = 0; i < samples; i++) {
+                dst[2 * i] = left[i];
+                dst[2 * i + 1] = right[i];
+            }
+
+            return;
+        }
+
+        for (int c = 0; c < channels; c++) {
+            const float *plane = src[c];
+
+            for (int i = 0; i < samples; i++) {
+                dst[i * channels + c] = plane[i];
+            }
+        }
+    }
+
+    void audioProcessor::deinterleave(float *const *dst, const float *src, int channels, int samples)
+    {
+        if (channels == 2) {
+            float *left = dst[0];
+            float *right = dst[1];
+
+            for (int i = 0; i < samples; i++) {
+                left[i] = src[2 * i];
+                right[i] = src[2 * i + 1];
+            }
+
+            return;
+        }
+
+        for (int c = 0; c < channels; c++) {
+            float *plane = dst[c];
+
+            for (int i = 0; i < samples; i++) {
+                plane[i] = src[i * channels + c];
+            }
+        }
+    }
+
+    void audioProcessor::mixChannels(float *dst, int dstChannels, const float *src, int srcChannels, int samples)
+    {
+        if (dstChannels == 1) {
+            float scale = 1.0f / (float) srcChannels;
+
+            for (int i = 0; i < samples; i++) {
+                float sum = 0;
+
+                for (int c = 0; c < srcChannels; c++) {
+                    sum += src[i * srcChannels + c];
+                }
+
+                dst[i] = sum * scale;
+            }
+        } else if (srcChannels == 1 && dstChannels == 2) {
+            for (int i = 0; i < samples; i++) {
+                dst[2 * i] = dst[2 * i + 1] = src[i];
+            }
+        } else if (srcChannels == 6 && dstChannels == 2) {
+            // FL FR FC LFE BL BR, the LFE is dropped
+            float scale = 1.0f / (1.0f + 2 * MIX_LEVEL);
+
+            for (int i = 0; i < samples; i++) {
+                const float *in = src + i * 6;
+                float center = in[2] * MIX_LEVEL;
+                dst[2 * i] = (in[0] + center + in[4] * MIX_LEVEL) * scale;
+                dst[2 * i + 1] = (in[1] + center + in[5] * MIX_LEVEL) * scale;
+            }
+        }
+    }
+}// namespace Cicada
@@ -0,0 +1,82 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_AUDIOPROCESSOR_H
+#define CICADA_PLAYER_AUDIOPROCESSOR_H
+
+#include <base/media/IAFPacket.h>
+#include <memory>
+#include <utils/CicadaType.h>
+#include <vector>
+
+namespace Cicada {
+
+    /*
+     * A light audio stage in front of the audio device, it applies the gain and converts S16/FLT(P) and the channels,
+     * the frames pass through untouched when nothing to do.
+     * The gain changes are ramped across one frame, so no click and no filter graph rebuilding.
+     */
+    class CICADA_CPLUS_EXTERN audioProcessor {
+    public:
+        audioProcessor() = default;
+
+        ~audioProcessor() = default;
+
+        // S16, S16P, FLT and FLTP
+        static bool isFormatSupported(int format);
+
+        // the conversions supported, the sample rate can't be changed
+        static bool isConversionSupported(const IAFFrame::audioInfo &src, const IAFFrame::audioInfo &dst);
+
+        void setGain(float gain);
+
+        // the format of the output frames, the frames are kept in their format if not set
+        void setOutputFormat(const IAFFrame::audioInfo &info);
+
+        // apply the target gain at once
+        void flush();
+
+        bool isBypass(const IAFFrame::audioInfo &info) const;
+
+        int process(std::unique_ptr<IAFFrame> &frame);
+
+    public:
+        // the kernels, dst and src could be the same, gain + i * step for the i-th sample
+        static void gainFloat(float *dst, const float *src, int count, float gain, float step);
+
+        static void gainS16(int16_t *dst, const int16_t *src, int count, float gain, float step);
+
+        static void s16ToFloat(float *dst, const int16_t *src, int count);
+
+        static void floatToS16(int16_t *dst, const float *src, int count);
+
+        static void interleave(float *dst, const float *const *src, int channels, int samples);
+
+        static void deinterleave(float *const *dst, const float *src, int channels, int samples);
+
+        // the samples of a frame to interleaved float, scratch holds a copy of the samples in float
+        static int readFloat(IAFFrame *frame, float *dst, float *scratch);
+
+        // a frame in the format of info from interleaved float, without timestamps
+        static std::unique_ptr<IAFFrame> createFrame(const IAFFrame::audioInfo &info, const float *src, int samples, float *scratch);
+
+        // interleaved float, supported srcChannels -> dstChannels: N -> 1, 1 -> 2, 6 -> 2
+        static void mixChannels(float *dst, int dstChannels, const float *src, int srcChannels, int samples);
+
+    private:
+        void applyGain(IAFFrame *frame, float gain, float step);
+
+        int convert(std::unique_ptr<IAFFrame> &frame, float gain, float step);
+
+    private:
+        float mGain{1.0f};
+        float mTargetGain{1.0f};
+        IAFFrame::audioInfo mOutputInfo{};
+        std::vector<float> mSrcBuffer{};
+        std::vector<float> mDstBuffer{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_AUDIOPROCESSOR_H
@@ -4,6 +4,7 @@
 
 #include "filterFactory.h"
 #include "ffmpegAudioFilter.h"
+#include "tempoAudioFilter.h"
 
 using namespace Cicada;
 
@@ -12,3 +13,12 @@ IAudioFilter *filterFactory::createAudioFilter(const IAudioFilter::format &srcFo
 {
     return new ffmpegAudioFilter(srcFormat, dstFormat, active);
 }
+
+IAudioFilter *filterFactory::createTempoFilter(const IAudioFilter::format &format)
+{
+    if (!tempoAudioFilter::isSupported(format)) {
+        return nullptr;
+    }
+
+    return new tempoAudioFilter(format);
+}
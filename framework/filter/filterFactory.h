@@ -12,6 +12,9 @@ namespace Cicada {
 
     public:
         static IAudioFilter *createAudioFilter(const IAudioFilter::format &srcFormat, const IAudioFilter::format &dstFormat, bool active);
+
+        // the tempo filter by timeStretcher, nullptr if the format is not supported
+        static IAudioFilter *createTempoFilter(const IAudioFilter::format &format);
     };
 }// namespace Cicada
 
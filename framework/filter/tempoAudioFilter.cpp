@@ -0,0 +1,113 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "tempoAudioFilter"
+
+#include "tempoAudioFilter.h"
+#include "audioProcessor.h"
+#include <cerrno>
+#include <utils/frame_work_log.h>
+
+#define MAX_OUTPUT_BUFFER_COUNT 2
+
+namespace Cicada {
+
+    tempoAudioFilter::tempoAudioFilter(const format &srcFormat) : IAudioFilter(srcFormat, srcFormat, false)
+    {}
+
+    bool tempoAudioFilter::isSupported(const format &srcFormat)
+    {
+        return audioProcessor::isFormatSupported(srcFormat.format) && srcFormat.sample_rate > 0 && srcFormat.channels > 0;
+    }
+
+    bool tempoAudioFilter::setOption(const string &key, const string &value, const string &capacity)
+    {
+        if (capacity == "atempo" && key == "rate") {
+            mStretcher.setRate((float) atof(value.c_str()));
+            return true;
+        }
+
+        return false;
+    }
+
+    int tempoAudioFilter::init(uint64_t flags)
+    {
+        if (!isSupported(mSrcFormat)) {
+            AF_LOGE("not support format %d\n", mSrcFormat.format);
+            return -ENOTSUP;
+        }
+
+        return mStretcher.init(mSrcFormat.sample_rate, mSrcFormat.channels);
+    }
+
+    int tempoAudioFilter::push(std::unique_ptr<IAFFrame> &frame, uint64_t timeOut)
+    {
+        if (mOutPut.size() >= MAX_OUTPUT_BUFFER_COUNT) {
+            return -EAGAIN;
+        }
+
+        if (!mStretcher.isActive() && mStretcher.getRate() == 1.0f) {
+            mOutPut.push(std::move(frame));
+            return 0;
+        }
+
+        const IAFFrame::audioInfo &info = frame->getInfo().audio;
+        int channels = info.channels;
+
+        if (channels != mSrcFormat.channels || info.sample_rate != mSrcFormat.sample_rate) {
+            AF_LOGE("the format changed, %d(%d) to %d(%d)\n", mSrcFormat.sample_rate, mSrcFormat.channels, info.sample_rate, channels);
+            return -EINVAL;
+        }
+
+        mInBuffer.resize(info.nb_samples * channels);
+        mScratch.resize(info.nb_samples * channels);
+        int ret = audioProcessor::readFloat(frame.get(), mInBuffer.data(), mScratch.data());
+
+        if (ret < 0) {
+            return ret;
+        }
+
+        mOutBuffer.clear();
+        int samples = mStretcher.process(mInBuffer.data(), info.nb_samples, mOutBuffer);
+
+        if (samples > 0) {
+            IAFFrame::audioInfo outInfo = info;
+            outInfo.nb_samples = samples;
+            mScratch.resize(samples * channels);
+            std::unique_ptr<IAFFrame> outFrame = audioProcessor::createFrame(outInfo, mOutBuffer.data(), samples, mScratch.data());
+
+            if (outFrame == nullptr) {
+                return -ENOMEM;
+            }
+
+            outFrame->getInfo().pts = frame->getInfo().pts;
+            outFrame->getInfo().duration = (int64_t) samples * 1000000 / info.sample_rate;
+            outFrame->getInfo().timePosition = frame->getInfo().timePosition;
+            outFrame->getInfo().utcTime = frame->getInfo().utcTime;
+            mOutPut.push(std::move(outFrame));
+        }
+
+        frame = nullptr;
+        return 0;
+    }
+
+    int tempoAudioFilter::pull(unique_ptr<IAFFrame> &frame, uint64_t timeOut)
+    {
+        if (mOutPut.empty()) {
+            return -EAGAIN;
+        }
+
+        frame = std::move(mOutPut.front());
+        mOutPut.pop();
+        return 0;
+    }
+
+    void tempoAudioFilter::flush()
+    {
+        while (!mOutPut.empty()) {
+            mOutPut.pop();
+        }
+
+        mStretcher.flush();
+    }
+}// namespace Cicada
@@ -0,0 +1,46 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_TEMPOAUDIOFILTER_H
+#define CICADA_PLAYER_TEMPOAUDIOFILTER_H
+
+#include "IAudioFilter.h"
+#include "timeStretcher.h"
+#include <queue>
+#include <vector>
+
+namespace Cicada {
+    /*
+     * The tempo filter on timeStretcher, passive only. The format is kept, the frames pass through when the rate is 1.
+     * One frame is output for one input frame at most, so the pts and the positions of the input frame are kept.
+     */
+    class tempoAudioFilter : public IAudioFilter {
+    public:
+        explicit tempoAudioFilter(const format &srcFormat);
+
+        ~tempoAudioFilter() override = default;
+
+        static bool isSupported(const format &srcFormat);
+
+        bool setOption(const string &key, const string &value, const string &capacity) override;
+
+        int init(uint64_t flags) override;
+
+        int push(std::unique_ptr<IAFFrame> &frame, uint64_t timeOut) override;
+
+        int pull(unique_ptr<IAFFrame> &frame, uint64_t timeOut) override;
+
+        void flush() override;
+
+    private:
+        timeStretcher mStretcher{};
+        std::queue<std::unique_ptr<IAFFrame>> mOutPut{};
+        std::vector<float> mInBuffer{};
+        std::vector<float> mOutBuffer{};
+        std::vector<float> mScratch{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_TEMPOAUDIOFILTER_H
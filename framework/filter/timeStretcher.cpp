@@ -0,0 +1,280 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "timeStretcher"
+
+#include "timeStretcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <utils/frame_work_log.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TIME_STRETCH_NEON
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TIME_STRETCH_SSE2
+#endif
+
+#define MIN_RATE 0.25f
+#define MAX_RATE 8.0f
+// the correlation is computed on every COARSE_STEP offset first, then refined around the best one
+#define COARSE_STEP 4
+
+namespace Cicada {
+
+    int timeStretcher::init(int sampleRate, int channels)
+    {
+        if (sampleRate <= 0 || channels <= 0) {
+            return -EINVAL;
+        }
+
+        mChannels = channels;
+        // 10ms hop, 20ms window and +-6.25ms search range
+        mHop = std::max(sampleRate / 100, COARSE_STEP);
+        mSearch = std::max(sampleRate / 160, COARSE_STEP);
+        mFadeIn.resize(mHop);
+
+        for (int i = 0; i < mHop; i++) {
+            mFadeIn[i] = 0.5f - 0.5f * cosf((float) M_PI * ((float) i + 0.5f) / (float) mHop);
+        }
+
+        mTail.resize(mHop * channels);
+        mTailMono.resize(mHop);
+        flush();
+        return 0;
+    }
+
+    void timeStretcher::setRate(float rate)
+    {
+        if (rate <= 0) {
+            return;
+        }
+
+        rate = std::min(std::max(rate, MIN_RATE), MAX_RATE);
+
+        if (fabsf(rate - 1.0f) < 0.001f) {
+            rate = 1.0f;
+        }
+
+        mRate = rate;
+    }
+
+    void timeStretcher::flush()
+    {
+        mActive = false;
+        mHasTail = false;
+        mAnalysisPos = 0;
+        mTailEnd = 0;
+        mFrames = 0;
+        mInput.clear();
+        mMono.clear();
+    }
+
+    void timeStretcher::start()
+    {
+        flush();
+        mActive = true;
+    }
+
+    int timeStretcher::process(const float *in, int samples, std::vector<float> &out)
+    {
+        if (mChannels <= 0) {
+            return -EINVAL;
+        }
+
+        size_t begin = out.size();
+
+        if (!mActive) {
+            if (mRate == 1.0f) {
+                out.insert(out.end(), in, in + samples * mChannels);
+                return samples;
+            }
+
+            start();
+        }
+
+        mInput.insert(mInput.end(), in, in + samples * mChannels);
+        mMono.resize(mFrames + samples);
+
+        for (int i = 0; i < samples; i++) {
+            float sum = 0;
+
+            for (int c = 0; c < mChannels; c++) {
+                sum += in[i * mChannels + c];
+            }
+
+            mMono[mFrames + i] = sum / (float) mChannels;
+        }
+
+        mFrames += samples;
+
+        if (mRate == 1.0f) {
+            drain(out);
+        } else {
+            while (step(out)) {
+            }
+
+            compact();
+        }
+
+        return (int) ((out.size() - begin) / mChannels);
+    }
+
+    bool timeStretcher::step(std::vector<float> &out)
+    {
+        int pos;
+        size_t outPos = out.size();
+
+        if (!mHasTail) {
+            pos = mTailEnd;
+
+            if (pos + 2 * mHop > mFrames) {
+                return false;
+            }
+
+            out.insert(out.end(), mInput.begin() + pos * mChannels, mInput.begin() + (pos + mHop) * mChannels);
+            mAnalysisPos = pos + mHop * mRate;
+        } else {
+            int center = (int) lround(mAnalysisPos);
+            int low = std::max(center - mSearch, 0);
+            int high = center + mSearch;
+
+            if (high + 2 * mHop > mFrames) {
+                return false;
+            }
+
+            pos = search(low, high);
+            out.resize(outPos + mHop * mChannels);
+            const float *src = mInput.data() + pos * mChannels;
+            float *dst = out.data() + outPos;
+
+            for (int i = 0; i < mHop; i++) {
+                float w = mFadeIn[i];
+
+                for (int c = 0; c < mChannels; c++) {
+                    int index = i * mChannels + c;
+                    dst[index] = mTail[index] + (src[index] - mTail[index]) * w;
+                }
+            }
+
+            mAnalysisPos += mHop * mRate;
+        }
+
+        // the second half of the segment is faded out by the next one
+        std::copy(mInput.begin() + (pos + mHop) * mChannels, mInput.begin() + (pos + 2 * mHop) * mChannels, mTail.begin());
+        std::copy(mMono.begin() + pos + mHop, mMono.begin() + pos + 2 * mHop, mTailMono.begin());
+        mTailEnd = pos + 2 * mHop;
+        mHasTail = true;
+        return true;
+    }
+
+    int timeStretcher::search(int low, int high)
+    {
+        int count = high - low + mHop;
+        mEnergy.resize(count + 1);
+        mEnergy[0] = 0;
+
+        for (int i = 0; i < count; i++) {
+            double v = mMono[low + i];
+            mEnergy[i + 1] = mEnergy[i] + v * v;
+        }
+
+        // the normalized cross correlation, the energy of the tail is the same for all the candidates
+        auto score = [this, low](int pos) -> double {
+            double energy = mEnergy[pos - low + mHop] - mEnergy[pos - low];
+            return dotProduct(mMono.data() + pos, mTailMono.data(), mHop) / sqrt(energy + 1e-9);
+        };
+
+        int best = std::min(std::max((int) lround(mAnalysisPos), low), high);
+        double bestScore = score(best);
+
+        for (int pos = low; pos <= high; pos += COARSE_STEP) {
+            double value = score(pos);
+
+            if (value > bestScore) {
+                bestScore = value;
+                best = pos;
+            }
+        }
+
+        int coarse = best;
+
+        for (int pos = std::max(coarse - COARSE_STEP + 1, low); pos <= std::min(coarse + COARSE_STEP - 1, high); pos++) {
+            double value = score(pos);
+
+            if (value > bestScore) {
+                bestScore = value;
+                best = pos;
+            }
+        }
+
+        return best;
+    }
+
+    void timeStretcher::drain(std::vector<float> &out)
+    {
+        // the input right after the tail is its natural continuation, so back to pass through seamlessly
+        if (mHasTail) {
+            out.insert(out.end(), mTail.begin(), mTail.end());
+        }
+
+        if (mTailEnd < mFrames) {
+            out.insert(out.end(), mInput.begin() + mTailEnd * mChannels, mInput.end());
+        }
+
+        flush();
+    }
+
+    void timeStretcher::compact()
+    {
+        int drop = std::min((int) mAnalysisPos - mSearch, mTailEnd);
+
+        if (drop <= 4 * mHop) {
+            return;
+        }
+
+        mInput.erase(mInput.begin(), mInput.begin() + drop * mChannels);
+        mMono.erase(mMono.begin(), mMono.begin() + drop);
+        mFrames -= drop;
+        mAnalysisPos -= drop;
+        mTailEnd -= drop;
+    }
+
+    float timeStretcher::dotProduct(const float *a, const float *b, int count)
+    {
+        int i = 0;
+        float sum = 0;
+#if defined(TIME_STRETCH_SSE2)
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+
+        for (; i + 8 <= count; i += 8) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(TIME_STRETCH_NEON)
+        float32x4_t sum0 = vdupq_n_f32(0);
+        float32x4_t sum1 = vdupq_n_f32(0);
+
+        for (; i + 8 <= count; i += 8) {
+            sum0 = vmlaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+            sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+
+        float32x4_t total = vaddq_f32(sum0, sum1);
+        sum = vgetq_lane_f32(total, 0) + vgetq_lane_f32(total, 1) + vgetq_lane_f32(total, 2) + vgetq_lane_f32(total, 3);
+#endif
+
+        for (; i < count; i++) {
+            sum += a[i] * b[i];
+        }
+
+        return sum;
+    }
+}// namespace Cicada
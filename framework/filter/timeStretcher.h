@@ -0,0 +1,83 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADA_PLAYER_TIMESTRETCHER_H
+#define CICADA_PLAYER_TIMESTRETCHER_H
+
+#include <utils/CicadaType.h>
+#include <vector>
+
+namespace Cicada {
+
+    /*
+     * WSOLA time stretching on interleaved float samples, the pitch is kept.
+     * Every step outputs one hop (10ms) which overlaps the tail of the previous segment, the segment is searched around
+     * the nominal input position to be the most similar to the tail, so the rate can be changed at any step without
+     * rebuilding anything. The latency is about two hops plus the search range.
+     */
+    class CICADA_CPLUS_EXTERN timeStretcher {
+    public:
+        timeStretcher() = default;
+
+        ~timeStretcher() = default;
+
+        int init(int sampleRate, int channels);
+
+        void setRate(float rate);
+
+        float getRate() const
+        {
+            return mRate;
+        }
+
+        // the samples are stretched or being drained, otherwise they pass through
+        bool isActive() const
+        {
+            return mActive;
+        }
+
+        // append the output samples to out, return the number of output samples per channel
+        int process(const float *in, int samples, std::vector<float> &out);
+
+        void flush();
+
+    public:
+        static float dotProduct(const float *a, const float *b, int count);
+
+    private:
+        void start();
+
+        bool step(std::vector<float> &out);
+
+        void drain(std::vector<float> &out);
+
+        void compact();
+
+        int search(int low, int high);
+
+    private:
+        int mChannels{0};
+        int mHop{0};
+        int mSearch{0};
+        float mRate{1.0f};
+        bool mActive{false};
+        bool mHasTail{false};
+
+        // the nominal position of the next segment in mInput
+        double mAnalysisPos{0};
+        // the input position right after the tail
+        int mTailEnd{0};
+        int mFrames{0};
+
+        std::vector<float> mInput{};
+        std::vector<float> mMono{};
+        std::vector<float> mTail{};
+        std::vector<float> mTailMono{};
+        std::vector<float> mFadeIn{};
+        std::vector<double> mEnergy{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADA_PLAYER_TIMESTRETCHER_H
@@ -12,3 +12,6 @@ option(ENABLE_CACHE_MODULE "enable cache module" ON)
 option(ENABLE_CODEC_HEVC "enable hevc codec" ON)
 
 option(ENABLE_VIDEO_FILTER "enable video filter" ON)
+
+# the tests and the benchmarks only, turned on with BUILD_TEST
+option(ENABLE_HEADLESS_RENDER "enable the headless renders selected by protected.render.headless" OFF)
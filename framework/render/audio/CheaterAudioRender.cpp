@@ -3,6 +3,7 @@
 //
 
 #include <utils/ffmpeg_utils.h>
+#include <utils/globalSettings.h>
 #include <base/media/AVAFPacket.h>
 #include "CheaterAudioRender.h"
 
@@ -15,6 +16,7 @@ int CheaterAudioRender::init_device()
     mOutputInfo.format = AF_SAMPLE_FMT_S16;
     mOutputInfo.sample_rate = 44100;
     mOutputInfo.channels = std::min(mInputInfo.channels, 2);
+    mUnthrottled = globalSettings::getSetting().getProperty("protected.clock.unthrottled") == "ON";
     mClock.set(0);
     //   mClock.start();
     if (mInputInfo != mOutputInfo) {
@@ -47,10 +49,10 @@ void CheaterAudioRender::flush_device()
 
 int64_t CheaterAudioRender::device_get_position()
 {
-    int64_t clock = mClock.get();
+    int64_t clock = mUnthrottled ? mPCMDuration : mClock.get();
     std::lock_guard<std::mutex> uMutex(mMutex);
     while (!mQueue.empty()) {
-        if (clock > mQueue.front()->getPosition()) {
+        if (mUnthrottled || clock > mQueue.front()->getPosition()) {
             if (mListener) {
                 mListener->onFrameInfoUpdate(mQueue.front()->getFrame()->getInfo(), true);
             }
@@ -91,6 +93,10 @@ int CheaterAudioRender::device_write(unique_ptr<IAFFrame> &frame)
 
 uint64_t CheaterAudioRender::device_get_que_duration()
 {
+    if (mUnthrottled) {
+        return 0;
+    }
+
     int64_t clock = mClock.get();
     return std::max((int64_t) 0, mPCMDuration - clock);
 }
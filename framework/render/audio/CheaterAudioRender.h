@@ -72,6 +72,8 @@ namespace Cicada {
 
     private:
         af_clock mClock{};
+        // the samples are played once written, the player paces them
+        bool mUnthrottled{false};
         int64_t mPCMDuration{0};
         std::mutex mMutex;
         std::queue<std::unique_ptr<positionInfo>> mQueue;
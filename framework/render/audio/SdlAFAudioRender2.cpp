@@ -5,10 +5,18 @@
 #define LOG_TAG "SdlAFAudioRender2"
 
 #include "SdlAFAudioRender2.h"
+#include <algorithm>
 #include <assert.h>
 #include <base/media/AVAFPacket.h>
 #include <utils/ffmpeg_utils.h>
 #include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+
+#define DEFAULT_LATENCY_MS 60
+#define MIN_LATENCY_MS 20
+// big enough for any frame
+#define RING_BUFFER_DURATION_MS 1000
 
 using namespace Cicada;
 
@@ -23,6 +31,10 @@ SdlAFAudioRender2::~SdlAFAudioRender2()
     }
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
+    if (mPcmRing) {
+        RingBufferDestroy(mPcmRing);
+    }
+
     if (mPcmBuffer) {
         free(mPcmBuffer);
     }
@@ -53,6 +65,12 @@ int SdlAFAudioRender2::init_device()
 
     // init sdl audio device
     if (mDevID == 0) {
+        int latencyMs = atoi(globalSettings::getSetting().getProperty("protected.audio.render.sdl.latency").c_str());
+        if (latencyMs <= 0) {
+            latencyMs = DEFAULT_LATENCY_MS;
+        }
+        latencyMs = std::max(latencyMs, MIN_LATENCY_MS);
+
         SDL_AudioSpec inputSpec{0};
         int format = mInputInfo.format;
         if (format == AF_SAMPLE_FMT_S16 || format == AF_SAMPLE_FMT_S16P) {
@@ -63,17 +81,29 @@ int SdlAFAudioRender2::init_device()
         inputSpec.freq = mInputInfo.sample_rate;
         inputSpec.channels = mInputInfo.channels;
         inputSpec.silence = 0;
-        inputSpec.samples = mInputInfo.nb_samples;
+        // the device buffer takes half of the latency at most, the ring takes the rest
+        inputSpec.samples = 256;
+        while (inputSpec.samples * 2 * 1000 * 2 <= latencyMs * mInputInfo.sample_rate) {
+            inputSpec.samples *= 2;
+        }
         inputSpec.userdata = this;
-        inputSpec.callback = nullptr;
+        inputSpec.callback = audioCallback;
         mDevID = SDL_OpenAudioDevice(NULL, false, &inputSpec, &mSpec, 0);
         if (mDevID == 0) {
             AF_LOGE("SdlAFAudioRender could not openAudio! Error: %s\n", SDL_GetError());
             return OPEN_AUDIO_DEVICE_FAILED;
         }
+        // the frames are not split to the callback size, keep nb_samples to be updated by the frames
         mOutputInfo.channels = mSpec.channels;
-        mOutputInfo.nb_samples = mSpec.samples;
         mOutputInfo.sample_rate = mSpec.freq;
+
+        mBytesPerFrame = mSpec.channels * (mSpec.format == AUDIO_S16SYS ? 2 : 4);
+        mLatency = std::max((int64_t) latencyMs * 1000 - (int64_t) mSpec.samples * 1000000 / mSpec.freq, (int64_t) 0);
+        mPcmRing = RingBufferCreate(mBytesPerFrame * mSpec.freq / 1000 * RING_BUFFER_DURATION_MS);
+        if (mPcmRing == nullptr) {
+            return -ENOMEM;
+        }
+        AF_LOGI("audio device opened, %d samples per callback, %lld us in the ring\n", mSpec.samples, mLatency);
     }
 
     return 0;
@@ -83,6 +113,9 @@ int SdlAFAudioRender2::pause_device()
 {
     if (mDevID != 0) {
         SDL_PauseAudioDevice(mDevID, 1);
+        if (mPauseTime == INT64_MIN) {
+            mPauseTime = af_gettime_relative();
+        }
     }
     return 0;
 }
@@ -90,6 +123,13 @@ int SdlAFAudioRender2::pause_device()
 int SdlAFAudioRender2::start_device()
 {
     if (mDevID != 0) {
+        // the last callback samples go on playing from where they paused
+        if (mPauseTime != INT64_MIN && mCallbackTime != INT64_MIN) {
+            beginCallbackUpdate();
+            mCallbackTime += af_gettime_relative() - mPauseTime;
+            endCallbackUpdate();
+        }
+        mPauseTime = INT64_MIN;
         SDL_PauseAudioDevice(mDevID, 0);
     }
     return 0;
@@ -97,16 +137,20 @@ int SdlAFAudioRender2::start_device()
 
 void SdlAFAudioRender2::flush_device()
 {
-    if (mRunning) {
-        pause_device();
-    }
-    if (mDevID != 0) {
-        SDL_ClearQueuedAudio(mDevID);
-    }
-    mPlayedDuration = 0;
-    if (mRunning) {
-        start_device();
+    if (mDevID == 0) {
+        return;
     }
+
+    // the callback is not running under the lock
+    SDL_LockAudioDevice(mDevID);
+    RingBufferClear(mPcmRing);
+    beginCallbackUpdate();
+    mPlayedFrames = 0;
+    mCallbackFrames = 0;
+    mCallbackTime = INT64_MIN;
+    endCallbackUpdate();
+    mUnderrun = false;
+    SDL_UnlockAudioDevice(mDevID);
 }
 
 void SdlAFAudioRender2::device_setVolume(float gain)
@@ -114,16 +158,47 @@ void SdlAFAudioRender2::device_setVolume(float gain)
 
 int64_t SdlAFAudioRender2::device_get_position()
 {
-    return mPlayedDuration - device_get_que_duration();
+    if (mDevID == 0) {
+        return 0;
+    }
+
+    // the samples of the last callback are being played since it returned
+    int64_t callbackFrames = 0;
+    int64_t frames = 0;
+    int64_t callbackTime = INT64_MIN;
+    uint32_t seq;
+
+    do {
+        seq = mCallbackSeq;
+
+        if (seq & 1) {
+            continue;
+        }
+
+        callbackFrames = mCallbackFrames;
+        frames = mPlayedFrames - callbackFrames;
+        callbackTime = mCallbackTime;
+    } while ((seq & 1) || seq != mCallbackSeq);
+
+    if (callbackTime != INT64_MIN) {
+        int64_t now = mPauseTime != INT64_MIN ? mPauseTime.load() : af_gettime_relative();
+        int64_t elapsed = (now - callbackTime) * mSpec.freq / 1000000;
+        frames += std::min(std::max(elapsed, (int64_t) 0), callbackFrames);
+    }
+
+    return frames * 1000000 / mSpec.freq;
 }
 
 int SdlAFAudioRender2::device_write(unique_ptr<IAFFrame> &frame)
 {
-    if (device_get_que_duration() > 50 * 1000) {
+    if (device_get_que_duration() > mLatency) {
         return -EAGAIN;
     }
     int pcmDataLength = getPCMDataLen(frame->getInfo().audio.channels, (enum AVSampleFormat) frame->getInfo().audio.format,
                                       frame->getInfo().audio.nb_samples);
+    if (pcmDataLength > RingBuffergetMaxWriteSize(mPcmRing)) {
+        return -EAGAIN;
+    }
     if (mPcmBufferSize < pcmDataLength) {
         mPcmBufferSize = pcmDataLength;
         mPcmBuffer = static_cast<uint8_t *>(realloc(mPcmBuffer, mPcmBufferSize));
@@ -132,47 +207,90 @@ int SdlAFAudioRender2::device_write(unique_ptr<IAFFrame> &frame)
     if (mRenderingCb) {
         rendered = mRenderingCb(mRenderingCbUserData, frame.get());
     }
-    if (!mMute && !rendered) {
+    if (!rendered) {
         copyPCMData(getAVFrame(frame.get()), mPcmBuffer);
     } else {
         memset(mPcmBuffer, 0, pcmDataLength);
     }
-    SDL_QueueAudio(mDevID, mPcmBuffer, pcmDataLength);
+    RingBufferWriteData(mPcmRing, (const char *) mPcmBuffer, pcmDataLength);
 
     assert(frame->getInfo().duration > 0);
     if (mListener) {
         mListener->onFrameInfoUpdate(frame->getInfo(), true);
     }
-    mPlayedDuration += (uint64_t) frame->getInfo().audio.nb_samples * 1000000 / frame->getInfo().audio.sample_rate;
-    //AF_LOGD("queued duration is %llu\n", getQueDuration());
     frame = nullptr;
     return 0;
 }
 
+void SDLCALL SdlAFAudioRender2::audioCallback(void *userdata, Uint8 *stream, int len)
+{
+    static_cast<SdlAFAudioRender2 *>(userdata)->fillAudio(stream, len);
+}
+
+void SdlAFAudioRender2::fillAudio(Uint8 *stream, int len)
+{
+    uint32_t size = std::min((uint32_t) len, RingBuffergetMaxReadSize(mPcmRing));
+    size -= size % mBytesPerFrame;
+
+    if (size > 0) {
+        RingBufferReadData(mPcmRing, (char *) stream, size);
+    }
+
+    // the data is consumed even if muted, to keep the clock going
+    if (mMute) {
+        memset(stream, mSpec.silence, size);
+    }
+
+    if (size < (uint32_t) len) {
+        memset(stream + size, mSpec.silence, len - size);
+
+        if (!mUnderrun && mPlayedFrames > 0) {
+            mUnderrunCount++;
+        }
+    }
+
+    mUnderrun = size < (uint32_t) len;
+    int64_t frames = size / mBytesPerFrame;
+    beginCallbackUpdate();
+    mCallbackTime = af_gettime_relative();
+    mCallbackFrames = frames;
+    mPlayedFrames += frames;
+    endCallbackUpdate();
+}
+
+void SdlAFAudioRender2::beginCallbackUpdate()
+{
+    mCallbackSeq++;
+}
+
+void SdlAFAudioRender2::endCallbackUpdate()
+{
+    mCallbackSeq++;
+}
+
 void SdlAFAudioRender2::device_mute(bool bMute)
 {
     mMute = bMute;
-    // mute all queued audio buffer
-    uint32_t queuedAudioSize = SDL_GetQueuedAudioSize(mDevID);
-    uint8_t *muteAudioBuffer = (uint8_t *) malloc(queuedAudioSize);
-    memset(muteAudioBuffer, 0, queuedAudioSize);
-    SDL_ClearQueuedAudio(mDevID);
-    SDL_QueueAudio(mDevID, muteAudioBuffer, queuedAudioSize);
-    free(muteAudioBuffer);
 }
 
 uint64_t SdlAFAudioRender2::device_get_que_duration()
 {
-    int sampleSize = 4;
-    if (mSpec.format == AUDIO_S16SYS) {
-        sampleSize = 2;
+    if (mPcmRing == nullptr) {
+        return 0;
     }
-    double byteRate = mOutputInfo.channels * sampleSize * mOutputInfo.sample_rate;
-    return (uint64_t)((SDL_GetQueuedAudioSize(mDevID) / byteRate) * 1000000);
+
+    return (uint64_t) RingBuffergetMaxReadSize(mPcmRing) / mBytesPerFrame * 1000000 / mSpec.freq;
 }
 
 int SdlAFAudioRender2::loopChecker()
 {
+    uint64_t underrunCount = mUnderrunCount;
+
+    if (underrunCount != mReportedUnderrunCount) {
+        AF_LOGW("audio underrun, count %llu\n", underrunCount);
+        mReportedUnderrunCount = underrunCount;
+    }
+
     return 0;
 }
 
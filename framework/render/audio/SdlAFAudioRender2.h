@@ -7,15 +7,28 @@
 
 #include "filterAudioRender.h"
 #include <SDL2/SDL.h>
+#include <atomic>
+#include <utils/ringBuffer.h>
 
 using namespace std;
 
 namespace Cicada {
+    /*
+     * Pull model, the SDL audio callback reads the PCM from a lock-free ring written by the render thread,
+     * the position is counted by the samples consumed by the callback.
+     * The latency is set by "protected.audio.render.sdl.latency" in ms, 20ms at least.
+     */
     class SdlAFAudioRender2 : public filterAudioRender {
     public:
         SdlAFAudioRender2();
         ~SdlAFAudioRender2() override;
 
+        // times the callback ran out of data after the playback started
+        uint64_t getUnderrunCount() const
+        {
+            return mUnderrunCount;
+        }
+
     private:
         bool device_require_format(const IAFFrame::audioInfo &info) override;
         int init_device() override;
@@ -31,14 +44,37 @@ namespace Cicada {
         void device_preClose() override;
         uint64_t device_get_ability() override;
 
+        static void SDLCALL audioCallback(void *userdata, Uint8 *stream, int len);
+
+        void fillAudio(Uint8 *stream, int len);
+
+        // the callback fields are written between, odd while writing
+        void beginCallbackUpdate();
+
+        void endCallbackUpdate();
+
     private:
         bool mSdlAudioInited = false;
         SDL_AudioDeviceID mDevID{0};
-        uint64_t mPlayedDuration = 0;
         uint8_t *mPcmBuffer = nullptr;
         int mPcmBufferSize = 0;
         std::atomic<bool> mMute{false};
         SDL_AudioSpec mSpec{0};
+
+        RingBuffer *mPcmRing{nullptr};
+        int mBytesPerFrame{0};
+        int64_t mLatency{0};
+        // the samples read by the callback, the ones of the last callback and when
+        std::atomic<int64_t> mPlayedFrames{0};
+        std::atomic<int64_t> mCallbackFrames{0};
+        std::atomic<int64_t> mCallbackTime{INT64_MIN};
+        std::atomic<int64_t> mPauseTime{INT64_MIN};
+        // a seqlock, the position is read from the three above consistently
+        std::atomic<uint32_t> mCallbackSeq{0};
+        std::atomic<uint64_t> mUnderrunCount{0};
+        // logged on the render thread, not in the callback
+        uint64_t mReportedUnderrunCount{0};
+        bool mUnderrun{false};
     };
 }// namespace Cicada
 
@@ -59,7 +59,10 @@ namespace Cicada {
             mFilterFlags |= A_FILTER_FLAG_TEMPO;
         }
 
-        if (!(device_ability & A_FILTER_FLAG_VOLUME) || 1) {// device not support volume >1
+        // the volume is applied by mProcessor, the filter is needed only when it can't handle the format
+        mNativeProcess = audioProcessor::isFormatSupported(mOutputInfo.format);
+
+        if (!mNativeProcess) {
             mFilterFlags |= A_FILTER_FLAG_VOLUME;
         }
 
@@ -76,11 +79,15 @@ namespace Cicada {
         }
 
         if (needFilter) {
-            mFilter = std::unique_ptr<IAudioFilter>(filterFactory::createAudioFilter(mInputInfo, mOutputInfo, mUseActiveFilter));
-            ret = mFilter->init(mFilterFlags);
+            if (mNativeProcess && audioProcessor::isConversionSupported(mInputInfo, mOutputInfo)) {
+                mProcessor.setOutputFormat(mOutputInfo);
+            } else {
+                mFilter = std::unique_ptr<IAudioFilter>(filterFactory::createAudioFilter(mInputInfo, mOutputInfo, mUseActiveFilter));
+                ret = mFilter->init(mFilterFlags);
 
-            if (ret < 0) {
-                return ret;
+                if (ret < 0) {
+                    return ret;
+                }
             }
         }
         mRenderThread = std::unique_ptr<afThread>(NEW_AF_THREAD(renderLoop));
@@ -245,6 +252,7 @@ namespace Cicada {
             mFilter->flush();
         }
 
+        mProcessor.flush();
         mMaxQueSize = 2;
 
         flush_device();
@@ -345,13 +353,31 @@ namespace Cicada {
             }
         }
 
+        if (filter_frame && mNativeProcess) {
+            int ret = mProcessor.process(filter_frame);
+
+            // not in the device format, drop it
+            if (ret < 0) {
+                AF_LOGE("audio process error %d, drop the frame\n", ret);
+                filter_frame = nullptr;
+            }
+        }
+
         return filter_frame;
     }
 
     int filterAudioRender::applySpeed()
     {
         if (mFilter == nullptr) {
-            mFilter = std::unique_ptr<IAudioFilter>(filterFactory::createAudioFilter(mInputInfo, mOutputInfo, mUseActiveFilter));
+            // mProcessor does the rest, so stretch in the input format natively, atempo is the fallback
+            if (mNativeProcess && (mFilterFlags & A_FILTER_FLAG_TEMPO)) {
+                mFilter = std::unique_ptr<IAudioFilter>(filterFactory::createTempoFilter(mInputInfo));
+            }
+
+            if (mFilter == nullptr) {
+                mFilter = std::unique_ptr<IAudioFilter>(filterFactory::createAudioFilter(mInputInfo, mOutputInfo, mUseActiveFilter));
+            }
+
             mFilter->setOption("rate", AfString::to_string(mSpeed), "atempo");
             int ret = mFilter->init(mFilterFlags);
 
@@ -369,6 +395,27 @@ namespace Cicada {
     {
         float gain = mVolume * mVolume * mVolume;
 
+        if (!mNativeProcess) {
+            return applyFilterVolume(gain);
+        }
+
+        if (gain > 1 || !(device_get_ability() & A_FILTER_FLAG_VOLUME)) {
+            //enlarge by mProcessor, set device volume to 1
+            mProcessor.setGain(gain);
+
+            if (device_get_ability() & A_FILTER_FLAG_VOLUME) {
+                device_setVolume(1.0);
+            }
+        } else {
+            mProcessor.setGain(1.0);
+            device_setVolume(gain);
+        }
+
+        return 0;
+    }
+
+    int filterAudioRender::applyFilterVolume(float gain)
+    {
         if (gain > 1) {
             //use filter to enlarge, set device volume to 1
             if (mFilter == nullptr) {
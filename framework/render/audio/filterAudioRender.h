@@ -10,6 +10,7 @@
 
 #include <render/audio/IAudioRender.h>
 #include <filter/IAudioFilter.h>
+#include <filter/audioProcessor.h>
 #include <utils/afThread.h>
 
 namespace Cicada {
@@ -95,6 +96,8 @@ namespace Cicada {
 
         int applyVolume();
 
+        int applyFilterVolume(float gain);
+
         void requireSetting();
 
     protected:
@@ -111,6 +114,9 @@ namespace Cicada {
         std::atomic<float> mFilterVolume{1};
         volatile std::atomic_bool mMute{false};
         std::unique_ptr<Cicada::IAudioFilter> mFilter{};
+        // gain and S16/FLT(P) conversion without mFilter, mFilter is kept for the tempo and the resampling
+        audioProcessor mProcessor{};
+        bool mNativeProcess{false};
         std::mutex mFrameQueMutex;
         std::queue<std::unique_ptr<IAFFrame>> mFrameQue{};
         std::unique_ptr<IAFFrame> mRenderFrame{nullptr};
@@ -31,18 +31,38 @@
 
 #include "audio/audioRenderPrototype.h"
 
-#ifdef ENABLE_CHEAT_RENDER
+#if defined(ENABLE_CHEAT_RENDER) || defined(ENABLE_HEADLESS_RENDER)
 
 #include "audio/CheaterAudioRender.h"
 
 #endif
 
+#ifdef ENABLE_HEADLESS_RENDER
+
+#include "video/CheaterVideoRender.h"
+#include <utils/globalSettings.h>
+
+#endif
+
 #include "video/DummyVideoRender.h"
 
 using namespace Cicada;
 
+#ifdef ENABLE_HEADLESS_RENDER
+static bool isHeadless()
+{
+    return globalSettings::getSetting().getProperty("protected.render.headless") == "ON";
+}
+#endif
+
 std::unique_ptr<IAudioRender> AudioRenderFactory::create()
 {
+#ifdef ENABLE_HEADLESS_RENDER
+    if (isHeadless()) {
+        return std::unique_ptr<IAudioRender>(new CheaterAudioRender());
+    }
+#endif
+
     std::unique_ptr<IAudioRender> render = audioRenderPrototype::create(AF_CODEC_ID_NONE);
 
     if (render) {
@@ -65,6 +85,12 @@ std::unique_ptr<IAudioRender> AudioRenderFactory::create()
 
 unique_ptr<IVideoRender> videoRenderFactory::create(uint64_t flags)
 {
+#ifdef ENABLE_HEADLESS_RENDER
+    if (isHeadless()) {
+        return std::unique_ptr<IVideoRender>(new CheaterVideoRender());
+    }
+#endif
+
     if (flags & IVideoRender::FLAG_DUMMY) {
         return std::unique_ptr<IVideoRender>(new DummyVideoRender());
     }
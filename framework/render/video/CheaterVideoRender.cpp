@@ -2,27 +2,13 @@
 // Created by moqi on 2020/1/10.
 //
 
-#include <render/video/vsync/VSyncFactory.h>
 #include "CheaterVideoRender.h"
 
-Cicada::CheaterVideoRender::CheaterVideoRender()
-{
-    mVSync = VSyncFactory::create(*this, 60);
-    mVSync->start();
-};
-
-Cicada::CheaterVideoRender::~CheaterVideoRender() = default;
-
 int Cicada::CheaterVideoRender::init()
 {
     return 0;
 }
 
-void Cicada::CheaterVideoRender::setWindowSize(int windWith, int mWindHeight)
-{
-    IVideoRender::setWindowSize(windWith, mWindHeight);
-}
-
 int Cicada::CheaterVideoRender::clearScreen()
 {
     return 0;
@@ -30,16 +16,24 @@ int Cicada::CheaterVideoRender::clearScreen()
 
 int Cicada::CheaterVideoRender::renderFrame(std::unique_ptr<IAFFrame> &frame)
 {
-
-    std::unique_lock<std::mutex> lock(mRenderMutex);
-    if (mListener) {
-        mListener->onFrameInfoUpdate(mLastVideoFrame->getInfo(), false);
+    // nullptr to flush, nothing is kept
+    if (frame == nullptr) {
+        return 0;
     }
+
+    // the frame is drawn by the callback or by nobody, it is displayed anyway
     if (mRenderingCb) {
         CicadaJSONItem params{};
-        rendered = mRenderingCb(mRenderingCbUserData, mLastVideoFrame.get(), params);
+        mRenderingCb(mRenderingCbUserData, frame.get(), params);
     }
-    mLastVideoFrame = std::move(frame);
+
+    mRenderedCount++;
+
+    if (mListener) {
+        mListener->onFrameInfoUpdate(frame->getInfo(), true);
+    }
+
+    frame = nullptr;
     return 0;
 }
 
@@ -57,24 +51,3 @@ int Cicada::CheaterVideoRender::setScale(IVideoRender::Scale scale)
 {
     return 0;
 }
-
-int Cicada::CheaterVideoRender::setDisPlay(void *view)
-{
-    return 0;
-}
-
-int Cicada::CheaterVideoRender::onVSync(int64_t tick)
-{
-    std::unique_lock<std::mutex> lock(mRenderMutex);
-    if (!mLastVideoFrame)
-        return 0;
-    if (mListener) {
-        mListener->onFrameInfoUpdate(mLastVideoFrame->getInfo(), true);
-    }
-    if (mRenderingCb) {
-        CicadaJSONItem params{};
-        rendered = mRenderingCb(mRenderingCbUserData, frame.get(), params);
-    }
-    mLastVideoFrame = nullptr;
-    return 0;
-}
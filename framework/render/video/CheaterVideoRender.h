@@ -5,22 +5,23 @@
 #ifndef CICADAMEDIA_CHEATERVIDEORENDER_H
 #define CICADAMEDIA_CHEATERVIDEORENDER_H
 
-#include <mutex>
-#include "vsync/IVSync.h"
 #include "IVideoRender.h"
+#include <atomic>
 
 namespace Cicada {
 
-    class CheaterVideoRender : public IVideoRender, private IVSync::Listener {
+    /*
+     * A headless render, the frames are taken as displayed once they are sent, so the render path runs as fast as
+     * the player feeds it.
+     */
+    class CheaterVideoRender : public IVideoRender {
     public:
-        CheaterVideoRender();
+        CheaterVideoRender() = default;
 
-        ~CheaterVideoRender() override;
+        ~CheaterVideoRender() override = default;
 
         int init() override;
 
-        void setWindowSize(int windWith, int mWindHeight) override;
-
         int clearScreen() override;
 
         int renderFrame(std::unique_ptr<IAFFrame> &frame) override;
@@ -31,43 +32,30 @@ namespace Cicada {
 
         int setScale(Scale scale) override;
 
-        int setDisPlay(void *view) override;
-
-/*
-    std::unique_ptr<ScreenShotInfo> screenShot() override;
-    */
-
         void setSpeed(float speed) override
-        {
-
-        }
+        {}
 
         float getRenderFPS() override
         {
             return 0;
         };
 
-        void setBackgroundColor(uint32_t color) override
-        {}
-
-    private:
-        int VSyncOnInit() override
+        uint64_t getFlags() override
         {
             return 0;
-        };
+        }
 
-        void VSyncOnDestroy() override
-        {
+        void setBackgroundColor(uint32_t color) override
+        {}
 
+        uint64_t getRenderedCount() const
+        {
+            return mRenderedCount;
         }
 
-        int onVSync(int64_t tick) override;
-
     private:
-        std::unique_ptr<IVSync> mVSync{nullptr};
-        std::unique_ptr<IAFFrame> mLastVideoFrame{nullptr};
-        std::mutex mRenderMutex;
+        std::atomic<uint64_t> mRenderedCount{0};
     };
-}
+}// namespace Cicada
 
 #endif //CICADAMEDIA_CHEATERVIDEORENDER_H
@@ -3,16 +3,25 @@
 //
 
 #include "gtest/gtest.h"
+#ifdef ENABLE_LOCAL_TLS_SERVER
+#include "localTlsServer.h"
+#endif
 #include <data_source/curl/curl_data_source.h>
 #include <data_source/dataSourcePrototype.h>
+#include <data_source/ioRecordDataSource.h>
+#include <data_source/ioReplayDataSource.h>
+#include <data_source/netEmulatorDataSource.h>
 #include <memory>
+#include <unistd.h>
 #include <utils/AFUtils.h>
 #include <utils/CicadaJSON.h>
 #include <utils/errors/framework_error.h>
+#include <utils/file/FileUtils.h>
 #include <utils/frame_work_log.h>
 #include <utils/globalSettings.h>
 #include <utils/property.h>
 #include <utils/timer.h>
+#include <vector>
 
 using namespace std;
 using namespace Cicada;
@@ -69,6 +78,314 @@ TEST(protocol, file)
     free(obuffer);
 }
 
+TEST(netEmulator, bandwidth)
+{
+    const int fileSize = 128 * 1024;
+    unlink("netEmulator");
+    FILE *file = fopen("netEmulator", "w");
+    vector<char> buffer(fileSize, 'a');
+    fwrite(buffer.data(), fileSize, 1, file);
+    fclose(file);
+    char path[1024];
+    string url = string(getcwd(path, sizeof(path))) + "/netEmulator";
+
+    // 128KB in 4096kbps costs 250ms, and the open costs two rtt
+    setProperty("protected.network.emulator", R"({"kbps":4096,"rttMs":50})");
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_NE(dynamic_cast<netEmulatorDataSource *>(source.get()), nullptr);
+    int64_t start = af_getsteady_ms();
+    ASSERT_GE(source->Open(0), 0);
+    int total = 0;
+    int ret;
+
+    while ((ret = source->Read(buffer.data(), fileSize)) > 0) {
+        total += ret;
+    }
+
+    int64_t cost = af_getsteady_ms() - start;
+    setProperty("protected.network.emulator", "");
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(total, fileSize);
+    ASSERT_GE(cost, 300);
+    ASSERT_LT(cost, 1000);
+}
+
+static string readSource(IDataSource *source, int64_t &cost)
+{
+    int64_t start = af_getsteady_ms();
+    string data;
+
+    if (source->Open(0) >= 0) {
+        char buffer[5000];
+        int ret;
+
+        while ((ret = source->Read(buffer, sizeof(buffer))) > 0) {
+            data.append(buffer, ret);
+        }
+    }
+
+    cost = af_getsteady_ms() - start;
+    return data;
+}
+
+static string readAll(const string &url, int64_t &cost)
+{
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    return readSource(source.get(), cost);
+}
+
+// a file of the bytes i * 7, return the absolute path
+static string writeTestFile(const string &name, int size, vector<char> &content)
+{
+    unlink(name.c_str());
+    FILE *file = fopen(name.c_str(), "w");
+    content.resize(size);
+
+    for (int i = 0; i < size; i++) {
+        content[i] = (char) (i * 7);
+    }
+
+    fwrite(content.data(), size, 1, file);
+    fclose(file);
+    char path[1024];
+    return string(getcwd(path, sizeof(path))) + "/" + name;
+}
+
+TEST(netEmulator, stall)
+{
+    vector<char> content;
+    string url = writeTestFile("netEmulatorStall", 16 * 1024, content);
+
+    // no data from 100ms to 1000ms of every second
+    setProperty("protected.network.emulator", R"({"stallIntervalMs":1000,"stallMs":900})");
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_NE(dynamic_cast<netEmulatorDataSource *>(source.get()), nullptr);
+    ASSERT_GE(source->Open(0), 0);
+    af_msleep(200);
+    vector<char> buffer(content.size());
+    int64_t start = af_getsteady_ms();
+    int ret = source->Read(buffer.data(), (int) buffer.size());
+    int64_t cost = af_getsteady_ms() - start;
+    setProperty("protected.network.emulator", "");
+    ASSERT_GT(ret, 0);
+    ASSERT_EQ(memcmp(buffer.data(), content.data(), ret), 0);
+    ASSERT_GE(cost, 600);
+    ASSERT_LT(cost, 1500);
+}
+
+static int readEmulated(IDataSource *source, string &data, int &errors)
+{
+    char buffer[5000];
+    int ret;
+    errors = 0;
+
+    while ((ret = source->Read(buffer, sizeof(buffer))) != 0) {
+        if (ret < 0) {
+            // reconnect on the next read
+            if (++errors > 100) {
+                return ret;
+            }
+
+            continue;
+        }
+
+        data.append(buffer, ret);
+    }
+
+    return 0;
+}
+
+TEST(netEmulator, reset)
+{
+    vector<char> content;
+    // 64KB in 1024kbps costs 500ms
+    string url = writeTestFile("netEmulatorReset", 64 * 1024, content);
+
+    // reconnected in place, the reader sees nothing
+    setProperty("protected.network.emulator", R"({"kbps":1024,"resetIntervalMs":150})");
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_GE(source->Open(0), 0);
+    string data;
+    int errors;
+    ASSERT_EQ(readEmulated(source.get(), data, errors), 0);
+    ASSERT_EQ(errors, 0);
+    ASSERT_EQ(data, string(content.data(), content.size()));
+
+    // returned as the network errors, the reading goes on from where it was reset
+    setProperty("protected.network.emulator", R"({"kbps":1024,"resetIntervalMs":150,"resetAsError":true})");
+    source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_GE(source->Open(0), 0);
+    data.clear();
+    ASSERT_EQ(readEmulated(source.get(), data, errors), 0);
+    setProperty("protected.network.emulator", "");
+    ASSERT_GE(errors, 2);
+    ASSERT_EQ(data, string(content.data(), content.size()));
+}
+
+TEST(netEmulator, jitter)
+{
+    vector<char> content;
+    string url = writeTestFile("netEmulatorJitter", 1024, content);
+
+    // the open costs two rtt, 100ms +- 40ms
+    setProperty("protected.network.emulator", R"({"rttMs":50,"jitterMs":40,"seed":3})");
+    int64_t minCost = INT64_MAX;
+    int64_t maxCost = 0;
+
+    for (int i = 0; i < 10; i++) {
+        unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+        int64_t start = af_getsteady_ms();
+        ASSERT_GE(source->Open(0), 0);
+        int64_t cost = af_getsteady_ms() - start;
+        minCost = std::min(minCost, cost);
+        maxCost = std::max(maxCost, cost);
+    }
+
+    setProperty("protected.network.emulator", "");
+    ASSERT_GE(minCost, 55);
+    ASSERT_LT(maxCost, 200);
+    ASSERT_GT(maxCost - minCost, 10);
+}
+
+TEST(ioRecord, replay)
+{
+    const int fileSize = 64 * 1024;
+    vector<char> buffer;
+    string url = writeTestFile("ioRecord", fileSize, buffer);
+    char path[1024];
+    string dir = string(getcwd(path, sizeof(path))) + "/ioRecordCapture";
+    FileUtils::mkdirs(dir.c_str());
+    unlink(ioRecord::getRecordPath(dir, url, 0).c_str());
+
+    // capture an emulated 2048kbps link with the payloads
+    setProperty("protected.network.emulator", R"({"kbps":2048})");
+    setProperty("protected.io.record", dir.c_str());
+    setProperty("protected.io.record.payload", "ON");
+    int64_t recordCost;
+    string recorded = readAll(url, recordCost);
+    setProperty("protected.network.emulator", "");
+    setProperty("protected.io.record", "");
+    setProperty("protected.io.record.payload", "");
+    ASSERT_EQ(recorded, string(buffer.data(), fileSize));
+
+    // the replay needs no origin
+    unlink("ioRecord");
+    setProperty("protected.io.replay", dir.c_str());
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_NE(dynamic_cast<ioReplayDataSource *>(source.get()), nullptr);
+    int64_t replayCost;
+    string replayed = readSource(source.get(), replayCost);
+    setProperty("protected.io.replay", "");
+    ASSERT_EQ(replayed, recorded);
+    ASSERT_GE(replayCost, recordCost - 100);
+    ASSERT_LT(replayCost, recordCost + 100);
+}
+
+TEST(ioRecord, sequence)
+{
+    vector<char> content;
+    string url = writeTestFile("ioRecordSequence", 4096, content);
+    char path[1024];
+    string dir = string(getcwd(path, sizeof(path))) + "/ioRecordSequenceCapture";
+    FileUtils::mkdirs(dir.c_str());
+
+    for (int i = 0; i < 2; i++) {
+        unlink(ioRecord::getRecordPath(dir, url, i).c_str());
+    }
+
+    // two captures, the first one is closed before destroyed
+    setProperty("protected.io.record", dir.c_str());
+    setProperty("protected.io.record.payload", "ON");
+    unique_ptr<IDataSource> first = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    unique_ptr<IDataSource> second = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_NE(dynamic_cast<ioRecordDataSource *>(first.get()), nullptr);
+    ASSERT_GE(second->Open(0), 0);
+    char buffer[100];
+    ASSERT_EQ(second->Read(buffer, sizeof(buffer)), sizeof(buffer));
+    ASSERT_GE(first->Open(0), 0);
+    ASSERT_EQ(first->Read(buffer, 10), 10);
+    first->Close();
+    first = nullptr;
+    second = nullptr;
+    setProperty("protected.io.record", "");
+    setProperty("protected.io.record.payload", "");
+
+    string capturedUrl;
+    vector<ioRecordEntry> entries;
+    ASSERT_GE(ioRecordReader::load(ioRecord::getRecordPath(dir, url, 0), capturedUrl, entries), 0);
+    int closes = 0;
+
+    for (auto &entry : entries) {
+        closes += entry.type == ioRecordEntry::TYPE_CLOSE ? 1 : 0;
+    }
+
+    ASSERT_EQ(closes, 1);
+
+    // numbered in the order created, the replays created together take their own captures
+    unlink("ioRecordSequence");
+    setProperty("protected.io.replay", dir.c_str());
+    first = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    second = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_NE(dynamic_cast<ioReplayDataSource *>(first.get()), nullptr);
+    ASSERT_NE(dynamic_cast<ioReplayDataSource *>(second.get()), nullptr);
+    ASSERT_GE(second->Open(0), 0);
+    ASSERT_EQ(second->Read(buffer, sizeof(buffer)), sizeof(buffer));
+    ASSERT_GE(first->Open(0), 0);
+    ASSERT_EQ(first->Read(buffer, sizeof(buffer)), 10);
+    setProperty("protected.io.replay", "");
+    ASSERT_EQ(memcmp(buffer, content.data(), 10), 0);
+}
+
+// read a few bytes through a new source, it's captured to the configured dir
+static void readOnce(const string &url)
+{
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    char buffer[16];
+    ASSERT_GE(source->Open(0), 0);
+    ASSERT_EQ(source->Read(buffer, sizeof(buffer)), sizeof(buffer));
+}
+
+TEST(ioRecord, sessions)
+{
+    vector<char> content;
+    string url = writeTestFile("ioRecordSessions", 4096, content);
+    char path[1024];
+    string cwd = getcwd(path, sizeof(path));
+    string dirs[] = {cwd + "/ioRecordSessionA", cwd + "/ioRecordSessionB"};
+
+    for (auto &dir : dirs) {
+        FileUtils::mkdirs(dir.c_str());
+
+        for (int i = 0; i < 2; i++) {
+            unlink(ioRecord::getRecordPath(dir, url, i).c_str());
+        }
+    }
+
+    // the numbers start from 0 in every session, also when a dir is configured again
+    for (auto &dir : {dirs[0], dirs[1], dirs[0]}) {
+        setProperty("protected.io.record", dir.c_str());
+        readOnce(url);
+    }
+
+    setProperty("protected.io.record", "");
+
+    for (auto &dir : dirs) {
+        EXPECT_TRUE(FileUtils::isFileExist(ioRecord::getRecordPath(dir, url, 0).c_str())) << dir;
+        EXPECT_FALSE(FileUtils::isFileExist(ioRecord::getRecordPath(dir, url, 1).c_str())) << dir;
+    }
+
+    // the replay of a session claims from the first capture again
+    unlink("ioRecordSessions");
+
+    for (int i = 0; i < 2; i++) {
+        setProperty("protected.io.replay", dirs[i].c_str());
+        unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+        EXPECT_NE(dynamic_cast<ioReplayDataSource *>(source.get()), nullptr) << dirs[i];
+    }
+
+    setProperty("protected.io.replay", "");
+}
+
 TEST(dns, https)
 {
     // https://ip.tool.chinaz.com/
@@ -192,6 +509,39 @@ TEST(http, keep_alive)
     free(buf);
 }
 
+#ifdef ENABLE_LOCAL_TLS_SERVER
+TEST(https, session_resume)
+{
+    localTlsServer server(64 * 1024);
+    ASSERT_GT(server.start(), 0);
+    string url = server.getUrl("sessionResume");
+    unique_ptr<IDataSource> source = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_GE(source->Open(0), 0);
+    char buffer[1024];
+    ASSERT_GT(source->Read(buffer, sizeof(buffer)), 0);
+    CicadaJSONItem before(source->GetOption("tlsSessionInfo"));
+    // the first connection is still alive, so a new connection must be created and resume the session
+    unique_ptr<IDataSource> source2 = unique_ptr<IDataSource>(dataSourcePrototype::create(url));
+    ASSERT_GE(source2->Open(0), 0);
+    ASSERT_GT(source2->Read(buffer, sizeof(buffer)), 0);
+    CicadaJSONItem after(source2->GetOption("tlsSessionInfo"));
+    source = nullptr;
+    source2 = nullptr;
+    server.stop();
+    ASSERT_EQ(server.getHandshakes(), 2);
+    ASSERT_EQ(server.getResumedHandshakes(), 1);
+
+    if (before.getInt64("hits", 0) < 0) {
+        // the TLS backend can't tell the resumption
+        RecordProperty("tlsSessionInfo", "unsupported");
+        ASSERT_EQ(after.getInt64("misses", 0), -1);
+        return;
+    }
+
+    ASSERT_EQ(after.getInt64("hits", 0), before.getInt64("hits", 0) + 1);
+}
+#endif
+
 TEST(http, post)
 {
     string url = "https://ptsv2.com/t/50oow-1602229322";
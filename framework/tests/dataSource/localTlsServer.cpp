@@ -0,0 +1,274 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "localTlsServer.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <netinet/in.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utils/frame_work_log.h>
+
+#define MAX_HEADER_SIZE (16 * 1024)
+
+using namespace std;
+
+static int sslWriteAll(SSL *ssl, const char *data, size_t size)
+{
+    while (size > 0) {
+        int ret = SSL_write(ssl, data, (int) size);
+
+        if (ret <= 0) {
+            return -EIO;
+        }
+
+        data += ret;
+        size -= ret;
+    }
+
+    return 0;
+}
+
+localTlsServer::localTlsServer(int bodySize)
+{
+    mBody.resize(bodySize);
+
+    for (int i = 0; i < bodySize; i++) {
+        mBody[i] = (char) (i * 7);
+    }
+}
+
+localTlsServer::~localTlsServer()
+{
+    stop();
+
+    if (mContext) {
+        SSL_CTX_free(mContext);
+    }
+}
+
+int localTlsServer::initContext()
+{
+    EVP_PKEY *key = nullptr;
+    EVP_PKEY_CTX *keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+    if (keyContext == nullptr || EVP_PKEY_keygen_init(keyContext) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(keyContext, &key) <= 0) {
+        EVP_PKEY_CTX_free(keyContext);
+        return -1;
+    }
+
+    EVP_PKEY_CTX_free(keyContext);
+    X509 *cert = X509_new();
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_get_notBefore(cert), 0);
+    X509_gmtime_adj(X509_get_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) "127.0.0.1", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    int ret = X509_sign(cert, key, EVP_sha256()) > 0 ? 0 : -1;
+
+    if (ret == 0) {
+        mContext = SSL_CTX_new(TLS_server_method());
+
+        if (mContext == nullptr || SSL_CTX_use_certificate(mContext, cert) <= 0 || SSL_CTX_use_PrivateKey(mContext, key) <= 0) {
+            ret = -1;
+        } else {
+            // the sessions are cached by the server, and resumed by the ids or the tickets
+            static const unsigned char sessionContext[] = "localTlsServer";
+            SSL_CTX_set_session_id_context(mContext, sessionContext, sizeof(sessionContext) - 1);
+            SSL_CTX_set_session_cache_mode(mContext, SSL_SESS_CACHE_SERVER);
+        }
+    }
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ret;
+}
+
+int localTlsServer::start()
+{
+    if (mContext == nullptr && initContext() < 0) {
+        AF_LOGE("local tls server can't create the certificate\n");
+        return -1;
+    }
+
+    // SSL_write to a client gone
+    signal(SIGPIPE, SIG_IGN);
+    mListenFd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (mListenFd < 0) {
+        return -errno;
+    }
+
+    int on = 1;
+    setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+
+    if (::bind(mListenFd, (sockaddr *) &addr, sizeof(addr)) < 0 || listen(mListenFd, 16) < 0 ||
+        getsockname(mListenFd, (sockaddr *) &addr, &len) < 0) {
+        int ret = -errno;
+        close(mListenFd);
+        mListenFd = -1;
+        return ret;
+    }
+
+    mPort = ntohs(addr.sin_port);
+    mStopped = false;
+    mAcceptThread = thread(&localTlsServer::acceptLoop, this);
+    AF_LOGI("local tls server on port %d\n", mPort);
+    return mPort;
+}
+
+void localTlsServer::stop()
+{
+    if (mListenFd < 0) {
+        return;
+    }
+
+    mStopped = true;
+    shutdown(mListenFd, SHUT_RDWR);
+    close(mListenFd);
+    mListenFd = -1;
+
+    if (mAcceptThread.joinable()) {
+        mAcceptThread.join();
+    }
+
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        for (int fd : mClients) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    for (auto &item : mClientThreads) {
+        item.join();
+    }
+
+    mClientThreads.clear();
+}
+
+string localTlsServer::getUrl(const string &path) const
+{
+    return "https://127.0.0.1:" + to_string(mPort) + "/" + path;
+}
+
+void localTlsServer::acceptLoop()
+{
+    while (!mStopped) {
+        int fd = accept(mListenFd, nullptr, nullptr);
+
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        lock_guard<mutex> lock(mMutex);
+
+        if (mStopped) {
+            close(fd);
+            break;
+        }
+
+        mClients.push_back(fd);
+        mClientThreads.emplace_back(&localTlsServer::serve, this, fd);
+    }
+}
+
+void localTlsServer::serve(int fd)
+{
+    SSL *ssl = SSL_new(mContext);
+    SSL_set_fd(ssl, fd);
+
+    if (SSL_accept(ssl) == 1) {
+        mHandshakes++;
+
+        if (SSL_session_reused(ssl)) {
+            mResumedHandshakes++;
+        }
+
+        string buffer;
+        char data[4096];
+
+        while (!mStopped) {
+            size_t end;
+
+            while ((end = buffer.find("\r\n\r\n")) == string::npos && buffer.size() < MAX_HEADER_SIZE) {
+                int ret = SSL_read(ssl, data, sizeof(data));
+
+                if (ret <= 0) {
+                    break;
+                }
+
+                buffer.append(data, ret);
+            }
+
+            if (end == string::npos) {
+                break;
+            }
+
+            string request = buffer.substr(0, end + 2);
+            buffer.erase(0, end + 4);
+            // only the open ended ranges the data sources send
+            const char *range = strstr(request.c_str(), "Range: bytes=");
+            long long start = range ? atoll(range + strlen("Range: bytes=")) : 0;
+            long long size = (long long) mBody.size();
+            char header[512];
+            int len;
+
+            if (start >= size && size > 0) {
+                len = snprintf(header, sizeof(header),
+                               "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%lld\r\nContent-Length: 0\r\n\r\n", size);
+                start = size;
+            } else if (range) {
+                len = snprintf(header, sizeof(header),
+                               "HTTP/1.1 206 Partial Content\r\nContent-Length: %lld\r\nContent-Range: bytes %lld-%lld/%lld\r\n"
+                               "Accept-Ranges: bytes\r\n\r\n",
+                               size - start, start, size - 1, size);
+            } else {
+                len = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: %lld\r\nAccept-Ranges: bytes\r\n\r\n",
+                               size);
+            }
+
+            bool head = request.compare(0, 5, "HEAD ") == 0;
+
+            if (sslWriteAll(ssl, header, len) < 0 ||
+                (!head && sslWriteAll(ssl, mBody.data() + start, (size_t) (size - start)) < 0)) {
+                break;
+            }
+        }
+    }
+
+    SSL_free(ssl);
+    lock_guard<mutex> lock(mMutex);
+
+    for (auto it = mClients.begin(); it != mClients.end(); ++it) {
+        if (*it == fd) {
+            mClients.erase(it);
+            break;
+        }
+    }
+
+    close(fd);
+}
@@ -0,0 +1,66 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_LOCALTLSSERVER_H
+#define FRAMEWORK_LOCALTLSSERVER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+/*
+ * A tiny HTTPS server on the loopback with a self-signed certificate generated at start, serves the same body of
+ * the size to every GET with keep-alive, and counts the handshakes and the resumed TLS sessions.
+ */
+class localTlsServer {
+public:
+    explicit localTlsServer(int bodySize);
+
+    ~localTlsServer();
+
+    // listen on a free port of 127.0.0.1, return the port, or a negative value
+    int start();
+
+    void stop();
+
+    // https://127.0.0.1:port/path
+    std::string getUrl(const std::string &path) const;
+
+    int getHandshakes() const
+    {
+        return mHandshakes;
+    }
+
+    int getResumedHandshakes() const
+    {
+        return mResumedHandshakes;
+    }
+
+private:
+    int initContext();
+
+    void acceptLoop();
+
+    void serve(int fd);
+
+private:
+    std::string mBody;
+    SSL_CTX *mContext{nullptr};
+    int mListenFd{-1};
+    int mPort{0};
+    std::atomic<bool> mStopped{false};
+    std::atomic<int> mHandshakes{0};
+    std::atomic<int> mResumedHandshakes{0};
+    std::thread mAcceptThread{};
+    std::mutex mMutex{};
+    std::vector<int> mClients{};
+    std::vector<std::thread> mClientThreads{};
+};
+
+
+#endif//FRAMEWORK_LOCALTLSSERVER_H
@@ -6,12 +6,23 @@
 #include "gtest/gtest.h"
 #include <data_source/dataSourcePrototype.h>
 #include <demuxer/demuxerPrototype.h>
+#include <demuxer/decrypto/ParallelAESDecrypt.h>
+#include <demuxer/decrypto/avAESDecrypt.h>
 #include <demuxer/demuxer_service.h>
+#include <demuxer/play_list/segment_decrypt/AES_128Decrypter.h>
+#include <demuxer/sample_decrypt/HLSSampleAesDecrypter.h>
+#include <utils/timer.h>
 #include <utils/AFUtils.h>
+#include <utils/afExecutor.h>
 #include <utils/frame_work_log.h>
 
 using namespace Cicada;
 
+// the best of the runs is compared, the others are scheduling noise
+#define DECRYPT_RUNS 3
+// the timer noise allowed when comparing to the baseline, in percent
+#define DECRYPT_NOISE_PERCENT 10
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -143,6 +154,52 @@ TEST(first_seek, hls)
     testFirstSeek(url, 100000000, 10000000);
 }
 
+TEST(trickPlay, hls)
+{
+    std::string url = "https://devstreaming-cdn.apple.com/videos/streaming/examples/img_bipbop_adv_example_ts/master.m3u8";
+    auto source = dataSourcePrototype::create(url);
+    source->Open(0);
+    unique_ptr<demuxer_service> service = unique_ptr<demuxer_service>(new demuxer_service(source));
+    int ret = service->initOpen();
+    ASSERT_GE(ret, 0);
+    int videoId = -1;
+    int nbStream = service->GetNbStreams();
+
+    for (int i = 0; i < nbStream; i++) {
+        std::unique_ptr<streamMeta> meta;
+        service->GetStreamMeta(meta, i, false);
+        Stream_type type = ((Stream_meta *) (*(meta.get())))->type;
+
+        if (type == STREAM_TYPE_VIDEO || type == STREAM_TYPE_MIXED) {
+            service->OpenStream(i);
+            videoId = i;
+            break;
+        }
+    }
+
+    ASSERT_GE(videoId, 0);
+    service->start();
+    ASSERT_GE(service->getDemuxerHandle()->setTrickPlay(true, videoId), 0);
+    service->Seek(30 * 1000000, 0, -1);
+    int keyCount = 0;
+
+    do {
+        std::unique_ptr<IAFPacket> packet{};
+        ret = service->readPacket(packet);
+
+        if (packet) {
+            ASSERT_EQ(packet->getInfo().streamIndex, videoId);
+            ASSERT_TRUE(packet->getInfo().flags & AF_PKT_FLAG_KEY);
+            keyCount++;
+        }
+    } while ((ret > 0 || ret == -EAGAIN) && keyCount < 10);
+
+    ASSERT_EQ(keyCount, 10);
+    ASSERT_GE(service->getDemuxerHandle()->setTrickPlay(false, videoId), 0);
+    service->close();
+    delete source;
+}
+
 TEST(mergeHeader, mp4)
 {
     std::string url = "http://player.alicdn.com/video/aliyunmedia.mp4";
@@ -275,4 +332,222 @@ TEST(scd_h265 , mp4)
             "https://alivc-demo-vod.aliyuncs.com/a2b7103c0bd049ecb7689472027cad2d/20144bf04b0e4f3c82ea2a7425a0a345-c4f5aabdcc7ba2861e8f0092d94db3bc-sd.mp4";
     test_csd(url , header_type_merge);
     test_csd(url , header_type_extract);
-}
\ No newline at end of file
+}
+struct memoryReader {
+    const uint8_t *data;
+    int size;
+    int pos;
+};
+
+static int readMemory(void *arg, uint8_t *buffer, int size)
+{
+    auto *reader = static_cast<memoryReader *>(arg);
+    size = std::min(size, reader->size - reader->pos);
+    memcpy(buffer, reader->data + reader->pos, size);
+    reader->pos += size;
+    return size;
+}
+
+TEST(aesDecrypt, throughput)
+{
+    const int segmentSize = 10 * 1024 * 1024;
+    const int blocks = segmentSize / IAESDecrypt::BLOCK_SIZE + 1;
+    uint8_t key[IAESDecrypt::BLOCK_SIZE];
+    uint8_t iv[IAESDecrypt::BLOCK_SIZE];
+
+    for (int i = 0; i < IAESDecrypt::BLOCK_SIZE; i++) {
+        key[i] = (uint8_t) (i * 7);
+        iv[i] = (uint8_t) (i * 13);
+    }
+
+    // a 10MB segment with a full block of PKCS7 padding
+    std::vector<uint8_t> plain(blocks * IAESDecrypt::BLOCK_SIZE, IAESDecrypt::BLOCK_SIZE);
+
+    for (int i = 0; i < segmentSize; i++) {
+        plain[i] = (uint8_t) (i * 31 + (i >> 12));
+    }
+
+    std::vector<uint8_t> cipher(plain.size());
+    avAESEncrypt encrypt;
+    uint8_t ivec[IAESDecrypt::BLOCK_SIZE];
+    encrypt.setKey(key, 128);
+    memcpy(ivec, iv, sizeof(ivec));
+    encrypt.encrypt(cipher.data(), plain.data(), blocks, ivec);
+
+    // the former path, 256 blocks a time by ffmpeg into another buffer
+    std::vector<uint8_t> out(plain.size());
+    avAESDecrypt decrypt;
+    decrypt.setKey(key, 128);
+    int64_t serialUs = INT64_MAX;
+
+    for (int run = 0; run < DECRYPT_RUNS; run++) {
+        memcpy(ivec, iv, sizeof(ivec));
+        int64_t start = af_gettime_relative();
+
+        for (int i = 0; i < blocks; i += 256) {
+            int count = std::min(256, blocks - i);
+            decrypt.decrypt(out.data() + i * IAESDecrypt::BLOCK_SIZE, cipher.data() + i * IAESDecrypt::BLOCK_SIZE, count, ivec);
+        }
+
+        serialUs = std::min(serialUs, af_gettime_relative() - start);
+    }
+
+    ASSERT_EQ(memcmp(out.data(), plain.data(), segmentSize), 0);
+
+    // the whole segment in place, sliced the same as AES_128Decrypter does
+    ParallelAESDecrypt parallel([]() -> IAESDecrypt * { return new avAESDecrypt(); },
+                                std::min(afExecutor::getInstance().getWorkerCount(), 4));
+    ASSERT_EQ(parallel.setKey(key, 128), 0);
+    std::vector<uint8_t> inPlace(cipher.size());
+    int64_t inPlaceUs = INT64_MAX;
+
+    for (int run = 0; run < DECRYPT_RUNS; run++) {
+        memcpy(inPlace.data(), cipher.data(), cipher.size());
+        memcpy(ivec, iv, sizeof(ivec));
+        int64_t start = af_gettime_relative();
+        parallel.decrypt(inPlace.data(), inPlace.data(), blocks, ivec);
+        inPlaceUs = std::min(inPlaceUs, af_gettime_relative() - start);
+        ASSERT_EQ(memcmp(inPlace.data(), out.data(), out.size()), 0) << "run " << run;
+        // the iv is chained to the next segment range
+        ASSERT_EQ(memcmp(ivec, cipher.data() + cipher.size() - IAESDecrypt::BLOCK_SIZE, sizeof(ivec)), 0);
+    }
+
+    memoryReader reader{cipher.data(), (int) cipher.size(), 0};
+    AES_128Decrypter decrypter(readMemory, &reader);
+    decrypter.SetOption("decryption key", key, sizeof(key));
+    decrypter.SetOption("decryption IV", iv, sizeof(iv));
+    std::vector<uint8_t> segment;
+    std::vector<uint8_t> buffer(64 * 1024);
+    int64_t start = af_gettime_relative();
+    int ret;
+
+    while ((ret = decrypter.Read(buffer.data(), (int) buffer.size())) > 0) {
+        segment.insert(segment.end(), buffer.begin(), buffer.begin() + ret);
+    }
+
+    int64_t chunkUs = af_gettime_relative() - start;
+    ASSERT_EQ(segment.size(), segmentSize);
+    ASSERT_EQ(memcmp(segment.data(), plain.data(), segmentSize), 0);
+    AF_LOGI("10MB segment, serial %lld us (%.1f MB/s), in place %lld us (%.1f MB/s), large chunk %lld us (%.1f MB/s)\n",
+            serialUs, 10e6 / serialUs, inPlaceUs, 10e6 / inPlaceUs, chunkUs, 10e6 / chunkUs);
+    EXPECT_LE(inPlaceUs, serialUs + serialUs * DECRYPT_NOISE_PERCENT / 100);
+}
+
+struct trickleReader {
+    memoryReader reader;
+    int chunk;
+};
+
+static int readTrickle(void *arg, uint8_t *buffer, int size)
+{
+    auto *trickle = static_cast<trickleReader *>(arg);
+    return readMemory(&trickle->reader, buffer, std::min(size, trickle->chunk));
+}
+
+TEST(aesDecrypt, smallReads)
+{
+    const int segmentSize = 64 * 1024;
+    const int blocks = segmentSize / IAESDecrypt::BLOCK_SIZE + 1;
+    uint8_t key[IAESDecrypt::BLOCK_SIZE];
+    uint8_t iv[IAESDecrypt::BLOCK_SIZE];
+
+    for (int i = 0; i < IAESDecrypt::BLOCK_SIZE; i++) {
+        key[i] = (uint8_t) (i * 3);
+        iv[i] = (uint8_t) (i * 11);
+    }
+
+    std::vector<uint8_t> plain(blocks * IAESDecrypt::BLOCK_SIZE, IAESDecrypt::BLOCK_SIZE);
+
+    for (int i = 0; i < segmentSize; i++) {
+        plain[i] = (uint8_t) (i * 17);
+    }
+
+    std::vector<uint8_t> cipher(plain.size());
+    avAESEncrypt encrypt;
+    uint8_t ivec[IAESDecrypt::BLOCK_SIZE];
+    encrypt.setKey(key, 128);
+    memcpy(ivec, iv, sizeof(ivec));
+    encrypt.encrypt(cipher.data(), plain.data(), blocks, ivec);
+
+    // a slow source gives 100 bytes a read, the blocks read are returned at once
+    trickleReader trickle{{cipher.data(), (int) cipher.size(), 0}, 100};
+    AES_128Decrypter decrypter(readTrickle, &trickle);
+    decrypter.SetOption("decryption key", key, sizeof(key));
+    decrypter.SetOption("decryption IV", iv, sizeof(iv));
+    std::vector<uint8_t> segment;
+    std::vector<uint8_t> buffer(4096);
+    int ret = decrypter.Read(buffer.data(), (int) buffer.size());
+    ASSERT_GT(ret, 0);
+    ASSERT_LE(trickle.reader.pos, 2 * trickle.chunk);
+    segment.insert(segment.end(), buffer.begin(), buffer.begin() + ret);
+
+    while ((ret = decrypter.Read(buffer.data(), (int) buffer.size())) > 0) {
+        segment.insert(segment.end(), buffer.begin(), buffer.begin() + ret);
+    }
+
+    ASSERT_EQ(segment.size(), segmentSize);
+    ASSERT_EQ(memcmp(segment.data(), plain.data(), segmentSize), 0);
+}
+
+static void addEmulationPrevention(const std::vector<uint8_t> &nal, std::vector<uint8_t> &out)
+{
+    int zeros = 0;
+
+    for (uint8_t byte : nal) {
+        if (zeros >= 2 && byte <= 3) {
+            out.push_back(3);
+            zeros = 0;
+        }
+
+        out.push_back(byte);
+        zeros = byte == 0 ? zeros + 1 : 0;
+    }
+}
+
+TEST(sampleAes, h264)
+{
+    uint8_t key[IAESDecrypt::BLOCK_SIZE];
+    uint8_t iv[IAESDecrypt::BLOCK_SIZE];
+
+    for (int i = 0; i < IAESDecrypt::BLOCK_SIZE; i++) {
+        key[i] = (uint8_t) (i * 5 + 1);
+        iv[i] = (uint8_t) (i * 11 + 3);
+    }
+
+    // an IDR slice, without emulation prevention bytes in the clear text
+    std::vector<uint8_t> plain(1000);
+
+    for (int i = 0; i < plain.size(); i++) {
+        plain[i] = (uint8_t) (i % 251 + 4);
+    }
+
+    plain[0] = 0x65;
+    // encrypt one block every ten after the 32 bytes leader
+    std::vector<uint8_t> encrypted = plain;
+    std::vector<uint8_t> blocks;
+    int pos;
+
+    for (pos = 32; encrypted.size() - pos > IAESDecrypt::BLOCK_SIZE; pos += 10 * IAESDecrypt::BLOCK_SIZE) {
+        blocks.insert(blocks.end(), encrypted.begin() + pos, encrypted.begin() + pos + IAESDecrypt::BLOCK_SIZE);
+    }
+
+    avAESEncrypt encrypt;
+    uint8_t ivec[IAESDecrypt::BLOCK_SIZE];
+    encrypt.setKey(key, 128);
+    memcpy(ivec, iv, sizeof(ivec));
+    encrypt.encrypt(blocks.data(), blocks.data(), (int) blocks.size() / IAESDecrypt::BLOCK_SIZE, ivec);
+
+    for (int i = 0; i * IAESDecrypt::BLOCK_SIZE < blocks.size(); i++) {
+        memcpy(encrypted.data() + 32 + i * 10 * IAESDecrypt::BLOCK_SIZE, blocks.data() + i * IAESDecrypt::BLOCK_SIZE,
+               IAESDecrypt::BLOCK_SIZE);
+    }
+
+    std::vector<uint8_t> packet = {0, 0, 0, 1, 0x09, 0xf0, 0, 0, 0, 1};
+    addEmulationPrevention(encrypted, packet);
+    HLSSampleAesDecrypter decrypter;
+    decrypter.SetOption("decryption key", key, sizeof(key));
+    decrypter.SetOption("decryption IV", iv, sizeof(iv));
+    int size = decrypter.decrypt(AF_CODEC_ID_H264, packet.data(), (int) packet.size());
+    ASSERT_EQ(size, 10 + plain.size());
+    ASSERT_EQ(memcmp(packet.data() + 10, plain.data(), plain.size()), 0);
+}
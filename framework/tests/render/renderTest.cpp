@@ -5,6 +5,10 @@
 #include "gtest/gtest.h"
 #include <memory>
 #include <utils/frame_work_log.h>
+#include <filter/audioProcessor.h>
+#include <filter/filterFactory.h>
+#include <filter/timeStretcher.h>
+#include <utils/globalSettings.h>
 #include <render/renderFactory.h>
 #include <data_source/dataSourcePrototype.h>
 #include <demuxer/demuxer_service.h>
@@ -12,6 +16,7 @@
 #include <utils/timer.h>
 #ifdef ENABLE_SDL
     #include <SDL2/SDL.h>
+    #include <render/audio/SdlAFAudioRender2.h>
 #endif
 #include <base/media/AVAFPacket.h>
 #include <utils/AFUtils.h>
@@ -197,6 +202,234 @@ TEST(audio, pcm_48000_2_s16)
     ASSERT_GE(ret, 0);
 }
 
+TEST(audio, processKernels)
+{
+    const int count = 1023;
+    std::vector<float> in(count);
+    std::vector<float> out(count);
+
+    for (int i = 0; i < count; i++) {
+        in[i] = (float) (i % 200 - 100) / 100.0f;
+    }
+
+    // ramp from 0.5 to 1.5
+    float step = 1.0f / count;
+    audioProcessor::gainFloat(out.data(), in.data(), count, 0.5f, step);
+
+    for (int i = 0; i < count; i++) {
+        ASSERT_NEAR(out[i], in[i] * (0.5f + i * step), 1e-4);
+    }
+
+    std::vector<int16_t> s16(count);
+    audioProcessor::floatToS16(s16.data(), in.data(), count);
+    audioProcessor::s16ToFloat(out.data(), s16.data(), count);
+
+    for (int i = 0; i < count; i++) {
+        ASSERT_NEAR(out[i], in[i], 1.0 / 32768);
+    }
+
+    // saturated
+    audioProcessor::gainS16(s16.data(), s16.data(), count, 4.0f, 0);
+
+    for (int i = 0; i < count; i++) {
+        ASSERT_NEAR(s16[i], std::max(std::min(in[i] * 4 * 32768, 32767.0f), -32768.0f), 4);
+    }
+
+    // FL FR FC LFE BL BR to stereo
+    float surround[6] = {1.0f, 0, 0.5f, 1.0f, 0, 0.5f};
+    float stereo[2];
+    audioProcessor::mixChannels(stereo, 2, surround, 6, 1);
+    ASSERT_GT(stereo[0], stereo[1]);
+    ASSERT_LE(stereo[0], 1.0f);
+
+    std::vector<float> left(count / 2);
+    std::vector<float> right(count / 2);
+    float *planes[2] = {left.data(), right.data()};
+    audioProcessor::deinterleave(planes, in.data(), 2, count / 2);
+    audioProcessor::interleave(out.data(), planes, 2, count / 2);
+
+    for (int i = 0; i < count / 2 * 2; i++) {
+        ASSERT_EQ(out[i], in[i]);
+    }
+}
+
+TEST(audio, timeStretch)
+{
+    const int sampleRate = 48000;
+    const int channels = 2;
+    const int frameSamples = 1024;
+    timeStretcher stretcher;
+    ASSERT_EQ(stretcher.init(sampleRate, channels), 0);
+
+    std::vector<float> in(frameSamples * channels);
+    std::vector<float> out;
+    int64_t inSamples = 0;
+    int64_t outSamples = 0;
+
+    auto fill = [&]() {
+        for (int i = 0; i < frameSamples; i++) {
+            float v = 0.5f * sinf(2 * (float) M_PI * 440 * (float) (inSamples + i) / sampleRate);
+            in[i * channels] = in[i * channels + 1] = v;
+        }
+    };
+
+    stretcher.setRate(1.5f);
+
+    for (int i = 0; i < 200; i++) {
+        fill();
+        outSamples += stretcher.process(in.data(), frameSamples, out);
+        inSamples += frameSamples;
+    }
+
+    ASSERT_TRUE(stretcher.isActive());
+    // the latency is a few hops only
+    ASSERT_NEAR((double) outSamples, inSamples / 1.5, sampleRate * 0.03);
+
+    // a sine stays a sine, the segments are aligned
+    for (size_t i = 2 * channels; i < out.size(); i += channels) {
+        ASSERT_NEAR(out[i], 2 * out[i - channels] * cosf(2 * (float) M_PI * 440 / sampleRate) - out[i - 2 * channels], 0.05);
+    }
+
+    // back to pass through, nothing is lost
+    stretcher.setRate(1.0f);
+    fill();
+    int drained = stretcher.process(in.data(), frameSamples, out);
+    ASSERT_GE(drained, frameSamples);
+    ASSERT_FALSE(stretcher.isActive());
+    fill();
+    ASSERT_EQ(stretcher.process(in.data(), frameSamples, out), frameSamples);
+}
+
+// push 10s of stereo float at 1.5x, the cpu time and the input duration needed for the first output frame
+static void benchTempoFilter(IAudioFilter *filter, const char *name)
+{
+    const int frameSamples = 1024;
+    const int frameCount = 10 * 48000 / frameSamples;
+    IAFFrame::audioInfo info{};
+    info.sample_rate = 48000;
+    info.channels = 2;
+    info.format = AF_SAMPLE_FMT_FLT;
+    info.nb_samples = frameSamples;
+    std::vector<float> samples(frameSamples * info.channels);
+    std::vector<float> scratch(frameSamples * info.channels);
+    filter->setOption("rate", "1.5", "atempo");
+    ASSERT_GE(filter->init(A_FILTER_FLAG_TEMPO), 0);
+
+    int64_t latencyUs = -1;
+    int64_t outSamples = 0;
+    int64_t cost = 0;
+
+    for (int i = 0; i < frameCount; i++) {
+        for (int j = 0; j < frameSamples; j++) {
+            samples[j * 2] = samples[j * 2 + 1] = 0.5f * sinf(2 * (float) M_PI * 440 * (float) (i * frameSamples + j) / 48000);
+        }
+
+        unique_ptr<IAFFrame> frame = audioProcessor::createFrame(info, samples.data(), frameSamples, scratch.data());
+        ASSERT_NE(frame, nullptr);
+        frame->getInfo().pts = (int64_t) i * frameSamples * 1000000 / 48000;
+        int64_t start = af_getsteady_ms();
+
+        while (frame != nullptr && filter->push(frame, 0) == -EAGAIN) {
+            unique_ptr<IAFFrame> outFrame;
+
+            while (filter->pull(outFrame, 0) >= 0) {
+                outSamples += outFrame->getInfo().audio.nb_samples;
+                outFrame = nullptr;
+            }
+        }
+
+        unique_ptr<IAFFrame> outFrame;
+
+        while (filter->pull(outFrame, 0) >= 0) {
+            outSamples += outFrame->getInfo().audio.nb_samples;
+            outFrame = nullptr;
+        }
+
+        cost += af_getsteady_ms() - start;
+
+        if (latencyUs < 0 && outSamples > 0) {
+            latencyUs = (int64_t) (i + 1) * frameSamples * 1000000 / 48000;
+        }
+    }
+
+    AF_LOGI("%s: %lld ms for 10s at 1.5x, %lld samples output, the first output after %lld us input\n", name, cost, outSamples,
+            latencyUs);
+    ASSERT_GT(latencyUs, 0);
+    ASSERT_NEAR((double) outSamples, frameCount * frameSamples / 1.5, 48000 * 0.2);
+}
+
+TEST(audio, tempoBenchmark)
+{
+    IAFFrame::audioInfo info{};
+    info.sample_rate = 48000;
+    info.channels = 2;
+    info.format = AF_SAMPLE_FMT_FLT;
+    std::unique_ptr<IAudioFilter> native(filterFactory::createTempoFilter(info));
+    ASSERT_NE(native, nullptr);
+    benchTempoFilter(native.get(), "timeStretcher");
+
+    std::unique_ptr<IAudioFilter> atempo(filterFactory::createAudioFilter(info, info, false));
+    benchTempoFilter(atempo.get(), "atempo");
+}
+
+#ifdef ENABLE_SDL
+// headless with the dummy driver, the position should follow the wall clock
+TEST(audio, sdlCallbackLatency)
+{
+    setenv("SDL_AUDIODRIVER", "dummy", 1);
+    const int latencyMs = 20;
+    globalSettings::getSetting().setProperty("protected.audio.render.sdl.latency", to_string(latencyMs));
+    SdlAFAudioRender2 render;
+    IAFFrame::audioInfo info{};
+    info.sample_rate = 48000;
+    info.channels = 2;
+    info.format = AF_SAMPLE_FMT_FLT;
+    info.nb_samples = 480;
+    info.channel_layout = 3;
+    ASSERT_GE(render.init(&info), 0);
+
+    std::vector<float> samples(info.nb_samples * info.channels, 0.1f);
+    std::vector<float> scratch(samples.size());
+    int64_t startTime = INT64_MIN;
+    int64_t startPos = 0;
+    int64_t maxError = 0;
+    int written = 0;
+    render.pause(false);
+
+    // 2s
+    while (written < 200) {
+        unique_ptr<IAFFrame> frame = audioProcessor::createFrame(info, samples.data(), info.nb_samples, scratch.data());
+        frame->getInfo().duration = 10000;
+
+        int ret;
+
+        while ((ret = render.renderFrame(frame, 0)) == -EAGAIN) {
+            af_msleep(2);
+        }
+
+        ASSERT_EQ(ret, 0);
+        written++;
+        int64_t position = render.getPosition();
+
+        if (startTime == INT64_MIN && position > 0) {
+            startTime = af_gettime_relative();
+            startPos = position;
+        } else if (startTime != INT64_MIN) {
+            int64_t error = llabs((position - startPos) - (af_gettime_relative() - startTime));
+            maxError = std::max(maxError, error);
+        }
+    }
+
+    AF_LOGI("max position error %lld us, %llu underrun\n", maxError, render.getUnderrunCount());
+    globalSettings::getSetting().setProperty("protected.audio.render.sdl.latency", "");
+    // the underruns depend on the load of the machine, report them
+    RecordProperty("maxPositionErrorUs", (int) maxError);
+    RecordProperty("underrunCount", (int) render.getUnderrunCount());
+    // the position is interpolated between the callbacks, it can't be off by more than a device buffer
+    ASSERT_LT(maxError, latencyMs * 1000);
+}
+#endif
+
 TEST(audio, render)
 {
     std::string url = "http://player.alicdn.com/video/aliyunmedia.mp4";
@@ -4,8 +4,20 @@
 
 #include "gtest/gtest.h"
 #include <string>
+#include <atomic>
+#include <condition_variable>
+#include <base/media/IAFPacket.h>
+#include <utils/AsyncJob.h>
 #include <utils/UTCTimer.h>
+#include <utils/afExecutor.h>
+#include <utils/afHistogram.h>
+#include <utils/afThread.h>
+#include <utils/afTrace.h>
+#include <utils/frameDropFilter.h>
+#include <utils/memoryGovernor.h>
 #include <utils/timer.h>
+#include <mutex>
+#include <vector>
 using namespace Cicada;
 using namespace std;
 int main(int argc, char **argv)
@@ -45,4 +57,341 @@ TEST(time, NTPTime)
         cout << (string) utcTime << endl;
         af_msleep(1000);
     }
-}
\ No newline at end of file
+}
+
+TEST(executor, cooperativeThread)
+{
+    const int threadCount = 32;
+    std::atomic<int> loops[threadCount];
+    std::unique_ptr<afThread> threads[threadCount];
+
+    for (int i = 0; i < threadCount; i++) {
+        loops[i] = 0;
+        std::atomic<int> *loop = &loops[i];
+        threads[i] = std::unique_ptr<afThread>(new afThread([loop]() -> int {
+            if (++(*loop) >= 10) {
+                return -1;
+            }
+            return 0;
+        }));
+        threads[i]->setCooperative(true);
+        threads[i]->start();
+    }
+
+    af_msleep(500);
+
+    for (int i = 0; i < threadCount; i++) {
+        ASSERT_EQ(loops[i], 10);
+        ASSERT_EQ(threads[i]->getStatus(), afThread::THREAD_STATUS_PAUSED);
+        threads[i]->stop();
+    }
+
+    ASSERT_LE(afExecutor::getInstance().getWorkerCount(), 16);
+}
+
+TEST(executor, delayedWakeUp)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    int done = 0;
+
+    // the workers are idle, a delayed task posted right after their polling must still wake one of them
+    for (int i = 0; i < 200; i++) {
+        afExecutor::getInstance().postDelayed(
+                [&mutex, &condition, &done]() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done++;
+                    condition.notify_one();
+                },
+                1 + i % 3);
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(condition.wait_for(lock, std::chrono::seconds(1), [&done, i]() { return done > i; })) << i;
+    }
+}
+
+TEST(executor, stickyWakeUp)
+{
+    std::atomic<int> loops{0};
+    afThread *self = nullptr;
+    std::unique_ptr<afThread> thread = std::unique_ptr<afThread>(new afThread([&loops, &self]() -> int {
+        if (++loops == 1) {
+            // the wakeUp() in the loop must not be overwritten by the delay asked later
+            self->wakeUp();
+            self->delayNextRun(10 * 1000);
+        } else {
+            self->delayNextRun(10 * 1000);
+        }
+        return 0;
+    }));
+    self = thread.get();
+    thread->setCooperative(true);
+    thread->start();
+    af_msleep(500);
+    ASSERT_EQ(loops, 2);
+    thread->stop();
+}
+
+TEST(asyncJob, delayJob)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    int runCount = 0;
+    std::atomic<int> earlyCount{0};
+    std::atomic<int> canceledCount{0};
+    std::vector<int64_t> jobIds;
+
+    for (int i = 0; i < 100; i++) {
+        int64_t delayMs = (i * 37) % 1000;
+        int64_t start = af_getsteady_ms();
+        jobIds.push_back(AsyncJob::Instance()->addDelayJob(delayMs, [&mutex, &condition, &runCount, &earlyCount, start, delayMs]() {
+            if (af_getsteady_ms() - start < delayMs) {
+                earlyCount++;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            runCount++;
+            condition.notify_one();
+        }));
+    }
+
+    // only the long ones, the short ones may have run already
+    int removed = 0;
+
+    for (int i = 0; i < jobIds.size(); i++) {
+        if ((i * 37) % 1000 >= 500) {
+            ASSERT_TRUE(AsyncJob::Instance()->removeDelayJob(jobIds[i]));
+            removed++;
+        }
+    }
+
+    auto token = std::make_shared<AsyncJobToken>();
+    AsyncJob::Instance()->addDelayJob(100, [&canceledCount]() { canceledCount++; }, token);
+    token->cancel();
+
+    // the canceled one is due before the last kept one
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(condition.wait_for(lock, std::chrono::seconds(3), [&runCount, removed]() { return runCount >= 100 - removed; }));
+    ASSERT_EQ(runCount, 100 - removed);
+    ASSERT_EQ(canceledCount, 0);
+    ASSERT_EQ(earlyCount, 0);
+    ASSERT_FALSE(AsyncJob::Instance()->removeDelayJob(jobIds[1]));
+}
+
+class videoTestPacket : public IAFPacket {
+public:
+    videoTestPacket(const uint8_t *data, int size, int64_t pts) : mData(data, data + size)
+    {
+        mInfo.pts = pts;
+        mInfo.dts = pts;
+        mInfo.duration = 40 * 1000;
+        mInfo.streamIndex = 0;
+        mInfo.flags = 0;
+    }
+
+    std::unique_ptr<IAFPacket> clone() const override
+    {
+        return std::unique_ptr<IAFPacket>(new videoTestPacket(mData.data(), (int) mData.size(), mInfo.pts));
+    }
+
+    uint8_t *getData() override
+    {
+        return mData.data();
+    }
+
+    int64_t getSize() override
+    {
+        return mData.size();
+    }
+
+    void setProtected() override
+    {}
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+static bool dropH264Frame(frameDropFilter &filter, uint8_t nalHeader, int64_t pts)
+{
+    uint8_t data[] = {0, 0, 0, 1, nalHeader, 0x88, 0x84, 0x00};
+    videoTestPacket packet(data, sizeof(data), pts);
+    return filter.needDrop(&packet);
+}
+
+static bool dropHevcFrame(frameDropFilter &filter, int nalType, int temporalId, int64_t pts)
+{
+    uint8_t data[] = {0, 0, 0, 1, (uint8_t) (nalType << 1), (uint8_t) (temporalId + 1), 0xaf, 0x08};
+    videoTestPacket packet(data, sizeof(data), pts);
+    return filter.needDrop(&packet);
+}
+
+TEST(frameDropFilter, h264)
+{
+    Stream_meta meta{};
+    meta.codec = AF_CODEC_ID_H264;
+    frameDropFilter filter;
+    filter.init(&meta);
+
+    // 0x65 IDR, 0x41 reference P slice, 0x01 non-reference slice
+    ASSERT_FALSE(dropH264Frame(filter, 0x01, 0));
+
+    filter.update(2.0f, 1000 * 1000);
+    ASSERT_EQ(filter.getLevel(), frameDropFilter::DROP_NON_REFERENCE);
+    ASSERT_FALSE(dropH264Frame(filter, 0x65, 0));
+    ASSERT_FALSE(dropH264Frame(filter, 0x41, 100 * 1000));
+    ASSERT_TRUE(dropH264Frame(filter, 0x01, 200 * 1000));
+
+    af_msleep(600);
+    filter.update(2.0f, 1000 * 1000);
+    ASSERT_EQ(filter.getLevel(), frameDropFilter::DROP_GOP_TAIL);
+    ASSERT_FALSE(dropH264Frame(filter, 0x65, 1000 * 1000));
+    ASSERT_FALSE(dropH264Frame(filter, 0x41, 1200 * 1000));
+    ASSERT_TRUE(dropH264Frame(filter, 0x41, 1600 * 1000));
+    // the reference is dropped, drop to the next key frame
+    ASSERT_TRUE(dropH264Frame(filter, 0x41, 1700 * 1000));
+    ASSERT_FALSE(dropH264Frame(filter, 0x65, 2000 * 1000));
+    ASSERT_EQ(filter.getDroppedCount(), 3);
+
+    filter.update(1.0f, 1000 * 1000);
+    ASSERT_EQ(filter.getLevel(), frameDropFilter::DROP_NONE);
+    ASSERT_FALSE(dropH264Frame(filter, 0x01, 2100 * 1000));
+}
+
+TEST(frameDropFilter, hevc)
+{
+    Stream_meta meta{};
+    meta.codec = AF_CODEC_ID_HEVC;
+    frameDropFilter filter;
+    filter.init(&meta);
+
+    // 19 IDR_W_RADL, 1 TRAIL_R, 0 TRAIL_N
+    ASSERT_FALSE(dropHevcFrame(filter, 19, 0, 0));
+    ASSERT_FALSE(dropHevcFrame(filter, 0, 1, 40 * 1000));
+
+    filter.update(2.0f, 1000 * 1000);
+    ASSERT_EQ(filter.getLevel(), frameDropFilter::DROP_NON_REFERENCE);
+    ASSERT_FALSE(dropHevcFrame(filter, 1, 0, 80 * 1000));
+    // a sub-layer non-reference picture may be referenced by the higher sub-layers
+    ASSERT_FALSE(dropHevcFrame(filter, 0, 0, 120 * 1000));
+    ASSERT_TRUE(dropHevcFrame(filter, 0, 1, 160 * 1000));
+    ASSERT_EQ(filter.getDroppedCount(), 1);
+}
+
+TEST(trace, chromeExport)
+{
+    afTrace::clear();
+    {
+        AF_TRACE_SCOPE("test", "disabledSpan");
+    }
+
+    afTrace::setEnabled(true);
+    afThread thread([]() -> int {
+        AF_TRACE_SCOPE("test", "threadSpan");
+        af_msleep(2);
+        return -1;
+    }, "traceTest");
+    thread.start();
+    af_msleep(20);
+    thread.stop();
+
+    // the oldest ones are overwritten
+    for (int i = 0; i < 10000; i++) {
+        AF_TRACE_INSTANT("test", "instant");
+    }
+
+    {
+        AF_TRACE_SCOPE("test", "mainSpan");
+    }
+
+    afTrace::setEnabled(false);
+    {
+        AF_TRACE_SCOPE("test", "disabledSpan");
+    }
+
+    std::string json = afTrace::exportChromeJson();
+    ASSERT_EQ(json.find("disabledSpan"), std::string::npos);
+    ASSERT_NE(json.find("\"name\":\"threadSpan\",\"cat\":\"test\",\"ph\":\"X\""), std::string::npos);
+    ASSERT_NE(json.find("\"name\":\"mainSpan\""), std::string::npos);
+    ASSERT_NE(json.find("\"args\":{\"name\":\"traceTest\"}"), std::string::npos);
+
+    size_t instants = 0;
+
+    for (size_t pos = json.find("\"instant\""); pos != std::string::npos; pos = json.find("\"instant\"", pos + 1)) {
+        instants++;
+    }
+
+    ASSERT_GT(instants, 0);
+    ASSERT_LT(instants, 10000);
+
+    afTrace::clear();
+    ASSERT_EQ(afTrace::exportChromeJson().find("mainSpan"), std::string::npos);
+}
+
+TEST(histogram, percentile)
+{
+    afHistogram histogram;
+    ASSERT_EQ(histogram.getPercentile(50), 0);
+
+    for (int64_t value = 1; value <= 10000; value++) {
+        histogram.record(value);
+    }
+
+    ASSERT_EQ(histogram.getCount(), 10000);
+    ASSERT_EQ(histogram.getMin(), 1);
+    ASSERT_EQ(histogram.getMax(), 10000);
+    ASSERT_DOUBLE_EQ(histogram.getMean(), 5000.5);
+
+    // the values are kept in 1/16 precision
+    ASSERT_NEAR(histogram.getPercentile(50), 5000, 5000 / 16);
+    ASSERT_NEAR(histogram.getPercentile(99), 9900, 9900 / 16);
+    ASSERT_EQ(histogram.getPercentile(100), 10000);
+
+    for (int64_t value : {0LL, 31LL, 32LL, 1000LL, 123456789LL}) {
+        int index = afHistogram::getBucketIndex(value);
+        ASSERT_GE(afHistogram::getBucketHighest(index), value);
+        ASSERT_TRUE(index == 0 || afHistogram::getBucketHighest(index - 1) < value);
+    }
+
+    histogram.reset();
+    histogram.record(-5);
+    ASSERT_EQ(histogram.getPercentile(50), 0);
+}
+
+TEST(memoryGovernor, budget)
+{
+    memoryGovernor &governor = memoryGovernor::getGovernor();
+    governor.setBudget(1000);
+    int64_t cache = 0;
+    memoryGovernor::account *cacheAccount = nullptr;
+    memoryGovernor::account sliceCache("cache", [&cache, &cacheAccount](int64_t bytes) {
+        int64_t freed = std::min(bytes, cache);
+        cache -= freed;
+        cacheAccount->setUsage(memoryGovernor::COMPONENT_SLICE_CACHE, cache);
+        return freed;
+    });
+    cacheAccount = &sliceCache;
+    memoryGovernor::account player1("player1");
+    memoryGovernor::account player2("player2");
+
+    // the players share the budget, the cache takes the rest
+    ASSERT_EQ(player1.getAllowance(), 500);
+    cache = 800;
+    sliceCache.setUsage(memoryGovernor::COMPONENT_SLICE_CACHE, cache);
+    ASSERT_EQ(sliceCache.getAllowance(), 1000);
+
+    // the cache is evicted when the players need the memory
+    player1.setUsage(memoryGovernor::COMPONENT_PACKET_QUEUE, 300);
+    player1.setUsage(memoryGovernor::COMPONENT_FRAME_QUEUE, 100);
+    ASSERT_EQ(cache, 600);
+    ASSERT_EQ(player1.getTotal(), 400);
+    ASSERT_FALSE(player1.isOverBudget());
+    player1.setUsage(memoryGovernor::COMPONENT_DEMUXER, 100);
+    ASSERT_TRUE(player1.isOverBudget());
+    ASSERT_EQ(governor.getTotal(), player1.getTotal() + cache);
+
+    player2.setLimit(200);
+    ASSERT_EQ(player2.getAllowance(), 200);
+    ASSERT_NE(governor.dump().find("player2"), string::npos);
+
+    governor.setBudget(0);
+    ASSERT_EQ(player1.getAllowance(), INT64_MAX);
+    ASSERT_FALSE(player1.isOverBudget());
+}
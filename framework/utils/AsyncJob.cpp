@@ -8,46 +8,75 @@
 
 #include "AsyncJob.h"
 #include <algorithm>
+#include <climits>
+#include <cstdlib>
 
 #define LOG_TAG "AsyncJob"
+#include "frame_work_log.h"
+#include "property.h"
 #include "timer.h"
 
+#define WHEEL_TICK_MS 10
+#define WHEEL_MASK (ASYNC_JOB_WHEEL_SLOTS - 1)
+#define DEFAULT_WORKER_COUNT 2
+#define MAX_WORKER_COUNT 8
+
 static int AsyncJobLive = -1;
 
+static int64_t getNowTick()
+{
+    return af_getsteady_ms() / WHEEL_TICK_MS;
+}
+
 namespace Cicada {
     AsyncJob AsyncJob::sInstance{};
 
     AsyncJob::AsyncJob()
     {
-        mThread = NEW_AF_THREAD(runJobs);
+        mCurrentTick = getNowTick();
         AsyncJobLive = 1;
     }
 
     AsyncJob::~AsyncJob()
     {
         AsyncJobLive = 0;
+        {
+            // same order as the timer thread
+            std::lock_guard<std::mutex> timerLock(mTimerMutex);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mExit = true;
+        }
+        mJobCond.notify_all();
+        mTimerCond.notify_all();
+
+        for (auto &worker : mWorkers) {
 #ifdef WIN32
-        mThread->forceStop();
+            worker->forceStop();
 #endif
-        delete mThread;
+            worker = nullptr;
+        }
 
-        while (!mJobItems.empty()) {
-            std::function<void()> func = mJobItems.front();
-            func();
-            mJobItems.pop();
+        if (mTimerThread) {
+#ifdef WIN32
+            mTimerThread->forceStop();
+#endif
+            delete mTimerThread;
         }
 
-        int64_t currentTime = af_getsteady_ms();
-        while (!mDelayJobItems.empty()) {
-            const DelayJobItem &jobItem = mDelayJobItems.front();
-            if (currentTime >= jobItem.mRunTime) {
-                if (jobItem.mFunc) {
-                    jobItem.mFunc();
-                }
-                mDelayJobItems.pop_front();
-            } else {
-                break;
+        {
+            // run the expired delay jobs too
+            std::lock_guard<std::mutex> timerLock(mTimerMutex);
+            advanceWheel(getNowTick());
+        }
+
+        while (!mJobItems.empty()) {
+            JobItem &job = mJobItems.front();
+
+            if (job.func && !(job.token && job.token->isCanceled())) {
+                job.func();
             }
+
+            mJobItems.pop_front();
         }
     }
 
@@ -57,87 +86,225 @@ namespace Cicada {
         return &sInstance;
     }
 
-    void AsyncJob::addJob(std::function<void()> func)
+    void AsyncJob::setWorkerCount(int count)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        mJobItems.push(func);
-        mThread->start();
-        mSleepCond.notify_all();
+        mWorkerCount = count;
     }
 
-    int64_t AsyncJob::addDelayJob(int64_t delayMs, std::function<void()> func)
+    void AsyncJob::startThreads()
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        ++mJobId;
-        DelayJobItem item(mJobId, af_getsteady_ms() + delayMs, func);
-        auto iter = std::upper_bound(mDelayJobItems.begin(), mDelayJobItems.end(), item);
-        bool needWake = false;
-        if (iter == mDelayJobItems.begin()) {
-            needWake = true;
+
+        if (!mWorkers.empty()) {
+            return;
+        }
+
+        int count = mWorkerCount;
+
+        if (count <= 0) {
+            count = atoi(getProperty("ro.asyncJob.workers"));
+        }
+
+        if (count <= 0) {
+            count = DEFAULT_WORKER_COUNT;
+        }
+
+        count = std::min(count, MAX_WORKER_COUNT);
+
+        for (int i = 0; i < count; i++) {
+            mWorkers.push_back(std::unique_ptr<afThread>(NEW_AF_THREAD(runJobs)));
+            mWorkers.back()->start();
         }
-        mDelayJobItems.insert(iter, item);
-        mThread->start();
-        if (needWake) {
-            mSleepCond.notify_all();
+
+        mTimerThread = NEW_AF_THREAD(runTimer);
+        mTimerThread->start();
+        AF_LOGI("start %d workers\n", count);
+    }
+
+    void AsyncJob::pushJob(std::function<void()> func, std::shared_ptr<AsyncJobToken> token)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobItems.push_back({std::move(func), std::move(token)});
+        }
+        mJobCond.notify_one();
+    }
+
+    void AsyncJob::addJob(std::function<void()> func, std::shared_ptr<AsyncJobToken> token)
+    {
+        startThreads();
+        pushJob(std::move(func), std::move(token));
+    }
+
+    int64_t AsyncJob::addDelayJob(int64_t delayMs, std::function<void()> func, std::shared_ptr<AsyncJobToken> token)
+    {
+        startThreads();
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+        ++mJobId;
+        int64_t now = af_getsteady_ms();
+
+        // the wheel is empty, no need to walk over the ticks passed in the idle wait
+        if (mDelayJobs.empty()) {
+            mCurrentTick = std::max(mCurrentTick, getNowTick());
         }
+
+        // round up, never run before the delay
+        int64_t runTick = (now + std::max(delayMs, (int64_t) 0) + WHEEL_TICK_MS - 1) / WHEEL_TICK_MS;
+        insertDelayJob(DelayJobItem(mJobId, runTick, std::move(func), std::move(token)));
+        mTimerCond.notify_one();
         return mJobId;
     }
 
     bool AsyncJob::removeDelayJob(int64_t jobId)
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-        if (jobId <= 0 || mDelayJobItems.empty()) {
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+        auto pos = mDelayJobs.find(jobId);
+
+        if (jobId <= 0 || pos == mDelayJobs.end()) {
             return false;
         }
-        auto iter = std::find_if(mDelayJobItems.begin(), mDelayJobItems.end(),
-                                 [jobId](const DelayJobItem &item) { return jobId == item.mJobId; });
-        bool succ = false;
-        if (iter != mDelayJobItems.end()) {
-            mDelayJobItems.erase(iter);
-            succ = true;
+
+        mWheel[pos->second.level][pos->second.slot].erase(pos->second.iter);
+        mDelayJobs.erase(pos);
+        return true;
+    }
+
+    // mTimerMutex is held
+    void AsyncJob::insertDelayJob(DelayJobItem item)
+    {
+        int64_t delta = item.mRunTick - mCurrentTick;
+
+        if (delta <= 0) {
+            if (!(item.mToken && item.mToken->isCanceled())) {
+                pushJob(std::move(item.mFunc), std::move(item.mToken));
+            }
+
+            return;
+        }
+
+        int level = 0;
+
+        while (level < ASYNC_JOB_WHEEL_LEVELS - 1 && delta >= (1LL << (ASYNC_JOB_WHEEL_BITS * (level + 1)))) {
+            level++;
         }
-        return succ;
+
+        // the far away jobs go round the top level and be cascaded again until they are near
+        int slot = (int) ((item.mRunTick >> (ASYNC_JOB_WHEEL_BITS * level)) & WHEEL_MASK);
+        int64_t jobId = item.mJobId;
+        std::list<DelayJobItem> &list = mWheel[level][slot];
+        list.push_back(std::move(item));
+        mDelayJobs[jobId] = {level, slot, std::prev(list.end())};
     }
 
-    int AsyncJob::runJobs()
+    void AsyncJob::cascade(int level, int slot)
     {
-        std::function<void()> func = nullptr;
-        int64_t sleepTime = 0;
-        {
-            std::lock_guard<std::mutex> lock(mMutex);
+        std::list<DelayJobItem> items{};
+        items.swap(mWheel[level][slot]);
+
+        for (auto &item : items) {
+            mDelayJobs.erase(item.mJobId);
+            insertDelayJob(std::move(item));
+        }
+    }
+
+    int64_t AsyncJob::advanceWheel(int64_t nowTick)
+    {
+        if (mDelayJobs.empty()) {
+            mCurrentTick = std::max(mCurrentTick, nowTick);
+            return INT64_MAX;
+        }
+
+        while (mCurrentTick < nowTick) {
+            ++mCurrentTick;
 
-            if (!mJobItems.empty()) {
-                func = mJobItems.front();
-                mJobItems.pop();
-            } else {
-                if (!mDelayJobItems.empty()) {
-                    int64_t currentTime = af_getsteady_ms();
-                    const DelayJobItem &jobItem = mDelayJobItems.front();
-                    if (currentTime >= jobItem.mRunTime) {
-                        func = jobItem.mFunc;
-                        mDelayJobItems.pop_front();
-                    } else {
-                        sleepTime = jobItem.mRunTime - currentTime;
-                    }
+            if ((mCurrentTick & WHEEL_MASK) == 0) {
+                int slot1 = (int) ((mCurrentTick >> ASYNC_JOB_WHEEL_BITS) & WHEEL_MASK);
+
+                if (slot1 == 0) {
+                    cascade(2, (int) ((mCurrentTick >> (ASYNC_JOB_WHEEL_BITS * 2)) & WHEEL_MASK));
                 }
+
+                cascade(1, slot1);
             }
+
+            std::list<DelayJobItem> &expired = mWheel[0][mCurrentTick & WHEEL_MASK];
+
+            for (auto &item : expired) {
+                mDelayJobs.erase(item.mJobId);
+
+                if (!(item.mToken && item.mToken->isCanceled())) {
+                    pushJob(std::move(item.mFunc), std::move(item.mToken));
+                }
+            }
+
+            expired.clear();
+        }
+
+        return nextExpireTick();
+    }
+
+    int64_t AsyncJob::nextExpireTick() const
+    {
+        if (mDelayJobs.empty()) {
+            return INT64_MAX;
         }
 
-        if (nullptr != func) {
-            func();
+        int64_t tick = mCurrentTick + 1;
+
+        // scan the lowest level until it turns round, the higher levels are cascaded then
+        do {
+            if (!mWheel[0][tick & WHEEL_MASK].empty()) {
+                return tick;
+            }
+        } while ((tick++ & WHEEL_MASK) != WHEEL_MASK);
+
+        return tick;
+    }
+
+    int AsyncJob::runTimer()
+    {
+        std::unique_lock<std::mutex> lock(mTimerMutex);
+
+        if (mExit) {
+            return -1;
         }
-        if (sleepTime > 0) {
-            std::unique_lock<std::mutex> lock(mMutex);
-            mSleepCond.wait_for(lock, std::chrono::milliseconds(sleepTime));
+
+        int64_t next = advanceWheel(getNowTick());
+
+        if (next == INT64_MAX) {
+            mTimerCond.wait(lock);
+        } else {
+            int64_t waitMs = next * WHEEL_TICK_MS - af_getsteady_ms();
+
+            if (waitMs > 0) {
+                mTimerCond.wait_for(lock, std::chrono::milliseconds(waitMs));
+            }
         }
 
+        return 0;
+    }
+
+    int AsyncJob::runJobs()
+    {
+        JobItem job{};
         {
-            std::lock_guard<std::mutex> lock(mMutex);
-            bool haveMore = false;
-            if (!mJobItems.empty() || !mDelayJobItems.empty()) {
-                haveMore = true;
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobCond.wait(lock, [this]() { return mExit || !mJobItems.empty(); });
+
+            if (mExit) {
+                // the rest are run in the destructor
+                return -1;
             }
-            return haveMore ? 0 : -1;
+
+            job = std::move(mJobItems.front());
+            mJobItems.pop_front();
+        }
+
+        if (job.func && !(job.token && job.token->isCanceled())) {
+            job.func();
         }
+
+        return 0;
     }
-}
+}// namespace Cicada
@@ -10,37 +10,71 @@
 #define AsyncJob_h
 
 #include "afThread.h"
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#define ASYNC_JOB_WHEEL_LEVELS 3
+#define ASYNC_JOB_WHEEL_BITS 8
+#define ASYNC_JOB_WHEEL_SLOTS (1 << ASYNC_JOB_WHEEL_BITS)
 
 namespace Cicada {
 
-    class DelayJobItem {
+    /*
+     * Cancel the jobs not run yet, a running job could poll isCanceled() to exit early.
+     * The jobs releasing resources, like deleting the curl connections, must not take a token.
+     */
+    class AsyncJobToken {
     public:
-        DelayJobItem(int64_t jobId, int64_t runTime, std::function<void()> func) : mJobId(jobId), mRunTime(runTime), mFunc(func)
-        {}
+        void cancel()
+        {
+            mCanceled = true;
+        }
 
-        bool operator<(const DelayJobItem &item) const
+        bool isCanceled() const
         {
-            return mRunTime < item.mRunTime;
+            return mCanceled;
         }
 
+    private:
+        std::atomic_bool mCanceled{false};
+    };
+
+    class DelayJobItem {
+    public:
+        DelayJobItem(int64_t jobId, int64_t runTick, std::function<void()> func, std::shared_ptr<AsyncJobToken> token)
+            : mJobId(jobId), mRunTick(runTick), mFunc(std::move(func)), mToken(std::move(token))
+        {}
+
     public:
         int64_t mJobId{0};
-        int64_t mRunTime{0};
+        int64_t mRunTick{0};
         std::function<void()> mFunc{nullptr};
+        std::shared_ptr<AsyncJobToken> mToken{nullptr};
     };
 
+    /*
+     * The jobs run on a pool of workers, the delay jobs are kept in a hierarchical timer wheel,
+     * so that add and remove a delay job is O(1).
+     */
     class AsyncJob {
     public:
         static AsyncJob *Instance(void);
-        void addJob(std::function<void()> func);
 
-        int64_t addDelayJob(int64_t delayMs, std::function<void()> func);
+        void addJob(std::function<void()> func, std::shared_ptr<AsyncJobToken> token = nullptr);
+
+        int64_t addDelayJob(int64_t delayMs, std::function<void()> func, std::shared_ptr<AsyncJobToken> token = nullptr);
+
         bool removeDelayJob(int64_t jobId);
 
+        // take effect before the first job be added, default is ro.asyncJob.workers or 2
+        void setWorkerCount(int count);
+
     private:
         AsyncJob();
 
@@ -48,14 +82,49 @@ namespace Cicada {
 
         int runJobs();
 
+        int runTimer();
+
+        void startThreads();
+
+        void pushJob(std::function<void()> func, std::shared_ptr<AsyncJobToken> token);
+
+        void insertDelayJob(DelayJobItem item);
+
+        // move the expired delay jobs to the job queue, return the ticks to wait for next one
+        int64_t advanceWheel(int64_t nowTick);
+
+        void cascade(int level, int slot);
+
+        int64_t nextExpireTick() const;
+
     private:
+        struct JobItem {
+            std::function<void()> func;
+            std::shared_ptr<AsyncJobToken> token;
+        };
+
+        struct DelayJobPos {
+            int level;
+            int slot;
+            std::list<DelayJobItem>::iterator iter;
+        };
+
         static AsyncJob sInstance;
-        afThread *mThread = nullptr;
+        std::vector<std::unique_ptr<afThread>> mWorkers{};
+        afThread *mTimerThread = nullptr;
+        int mWorkerCount{0};
+        std::atomic_bool mExit{false};
+
         std::mutex mMutex;
-        std::queue<std::function<void()>> mJobItems;
-        std::list<DelayJobItem> mDelayJobItems;
+        std::condition_variable mJobCond{};
+        std::deque<JobItem> mJobItems;
+
+        std::mutex mTimerMutex;
+        std::condition_variable mTimerCond{};
+        std::list<DelayJobItem> mWheel[ASYNC_JOB_WHEEL_LEVELS][ASYNC_JOB_WHEEL_SLOTS];
+        std::unordered_map<int64_t, DelayJobPos> mDelayJobs{};
+        int64_t mCurrentTick{0};
         int64_t mJobId{0};
-        std::condition_variable mSleepCond{};
     };
 
 }// namespace Cicada
@@ -264,6 +264,13 @@ void CicadaJSONItem::addArray(const std::string  &name, CicadaJSONArray &array)
     }
 }
 
+void CicadaJSONItem::addItem(const std::string &name, const CicadaJSONItem &item)
+{
+    if (mJSON && item.mJSON) {
+        cJSON_AddItemToObject(mJSON, name.c_str(), item.getJSONCopy());
+    }
+}
+
 
 const cJSON *CicadaJSONItem::getJSON()
 {
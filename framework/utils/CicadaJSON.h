@@ -36,6 +36,7 @@ public:
     void addValue(const std::string& name, double value);
     void addValue(const std::string& name, bool value);
     void addArray(const std::string& name, CicadaJSONArray &array);
+    void addItem(const std::string& name, const CicadaJSONItem &item);
 
     std::string getString(const std::string& name) const;
     std::string getString(const std::string& name, const std::string& defaultString) const;
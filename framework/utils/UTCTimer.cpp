@@ -12,6 +12,7 @@
 #include <iomanip>
 #include <sstream>
 #include <sys/types.h>
+#include <thread>
 #include <utility>
 #ifdef WIN32
 #include <winsock.h>
@@ -189,21 +190,21 @@ void UTCTimer::setTime(uint64_t timeMs)
 
 NTPClient::NTPClient(string server, int64_t port) : mServer(std::move(server)), mPort(port)
 {
-    if (!mThread) {
-        mThread = unique_ptr<afThread>(NEW_AF_THREAD(getNTPTime));
-        mThread->start();
-    }
+    start();
 }
 NTPClient::~NTPClient()
 {
-    //mThread->detach();
+    // don't wait for the server, the request exits at the next poll
+    mToken->cancel();
 }
 int64_t NTPClient::get() const
 {
-    if (mTime == 0) {
+    int64_t time = *mTime;
+
+    if (time == 0) {
         return -EAGAIN;
     }
-    return mTime;
+    return time;
 }
 
 int64_t NTPClient::getTimeSync(int timeoutMs) const
@@ -222,10 +223,7 @@ int64_t NTPClient::getTimeSync(int timeoutMs) const
 
 NTPClient::NTPClient()
 {
-    if (!mThread) {
-        mThread = unique_ptr<afThread>(NEW_AF_THREAD(getNTPTime));
-        mThread->start();
-    }
+    start();
 };
 
 #define JAN_1970 0x83aa7e80
@@ -266,7 +264,7 @@ static void getNewTime(unsigned int *data, struct timeval *ptimeval)
     ptimeval->tv_sec = trantime.coarse - JAN_1970;
     ptimeval->tv_usec = USEC(trantime.fine);
 }
-static int64_t getServerTime(int sockfd, sockaddr_in serv_addr)
+static int64_t getServerTime(int sockfd, sockaddr_in serv_addr, const AsyncJobToken &token)
 {
     fd_set fds;
     struct timeval timeout;
@@ -278,7 +276,7 @@ static int64_t getServerTime(int sockfd, sockaddr_in serv_addr)
     int addr_len;
     addr_len = sizeof(struct sockaddr_in);
     struct timeval TimeSet;
-    while (count < 50) {
+    while (count < 50 && !token.isCanceled()) {
         FD_ZERO(&fds);
         FD_SET(sockfd, &fds);
 
@@ -316,7 +314,7 @@ static int64_t getServerTime(int sockfd, sockaddr_in serv_addr)
     }
     return -1;
 }
-int NTPClient::getNTPTime()
+static int64_t requestNTPTime(const string &serverName, int64_t port, const AsyncJobToken &token)
 {
     int sockfd, n;
 
@@ -327,46 +325,59 @@ int NTPClient::getNTPTime()
 
     if (sockfd < 0) {
         AF_LOGE("ERROR opening socket");
-        mTime = -errno;
-        return -1;
+        return -errno;
     }
 
-    server = gethostbyname(mServer.c_str());
+    server = gethostbyname(serverName.c_str());
 
     if (server == nullptr) {
         AF_LOGE("ERROR, no such host");
-        mTime = -errno;
-        return -1;
+        // gethostbyname doesn't set the errno, and 0 means in requesting
+        return -EHOSTUNREACH;
     }
     memset((char *) &serv_addr, 0, sizeof(serv_addr));
     serv_addr.sin_family = AF_INET;
     memcpy((char *) &serv_addr.sin_addr.s_addr, (char *) server->h_addr, server->h_length);
-    serv_addr.sin_port = htons(mPort);
+    serv_addr.sin_port = htons(port);
     if (connect(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
         AF_LOGE("ERROR connecting");
-        mTime = -errno;
-        return -1;
+        return -errno;
     }
     n = sendPacket(sockfd);
     if (n < 0) {
         AF_LOGE("ERROR writing to socket");
-        mTime = -errno;
+        int64_t ret = -errno;
         shutdown(sockfd, 2);
-        return -1;
+        return ret;
     }
-    mTime = getServerTime(sockfd, serv_addr);
+    int64_t time = getServerTime(sockfd, serv_addr, token);
     shutdown(sockfd, 2);
-    return -1;
+    return time;
+}
+
+void NTPClient::start()
+{
+    std::shared_ptr<std::atomic<int64_t>> time = mTime;
+    std::shared_ptr<AsyncJobToken> token = mToken;
+    string server = mServer;
+    int64_t port = mPort;
+    /*
+     * the resolving and the polling take seconds on a bad network, not on the AsyncJob workers shared by others,
+     * the thread owns what it uses, so it is detached and exits by itself after canceled
+     */
+    std::thread([time, token, server, port]() { *time = requestNTPTime(server, port, *token); }).detach();
 }
 NTPClient::operator std::string()
 {
 #define BUFLEN 255
-    if (mTime <= 0) {
+    int64_t time = *mTime;
+
+    if (time <= 0) {
         return "";
     }
-    time_t t = mTime / 1000000;
+    time_t t = time / 1000000;
     char tmpBuf[BUFLEN];
     size_t len = strftime(tmpBuf, BUFLEN, "%Y-%m-%dT%H:%M:%S", gmtime(&t));
-    sprintf(tmpBuf + len, ".%03dZ", (int) (mTime % 1000000) / 1000);
+    sprintf(tmpBuf + len, ".%03dZ", (int) (time % 1000000) / 1000);
     return string(tmpBuf);
 }
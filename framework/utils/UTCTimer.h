@@ -5,8 +5,11 @@
 #ifndef CICADAMEDIA_UTCTIMER_H
 #define CICADAMEDIA_UTCTIMER_H
 
+#include "AsyncJob.h"
 #include "afThread.h"
 #include "af_clock.h"
+#include <atomic>
+#include <memory>
 #include <string>
 namespace Cicada {
 
@@ -47,13 +50,14 @@ namespace Cicada {
         explicit operator std::string();
 
     private:
-        int getNTPTime();
+        void start();
 
     private:
         std::string mServer = "ntp.aliyun.com";
         int64_t mPort = 123;
-        std::unique_ptr<afThread> mThread{};
-        int64_t mTime{0};
+        // the request runs on its own thread, and is canceled when the client is destroyed
+        std::shared_ptr<AsyncJobToken> mToken{std::make_shared<AsyncJobToken>()};
+        std::shared_ptr<std::atomic<int64_t>> mTime{std::make_shared<std::atomic<int64_t>>(0)};
     };
 }// namespace Cicada
 
@@ -0,0 +1,196 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#define LOG_TAG "afExecutor"
+
+#include "afExecutor.h"
+#include "frame_work_log.h"
+#include "property.h"
+#include "timer.h"
+#include <algorithm>
+#include <cstdlib>
+
+#define MAX_WORKER_COUNT 16
+
+static thread_local int sWorkerIndex = -1;
+
+afExecutor &afExecutor::getInstance()
+{
+    static afExecutor executor([]() -> int {
+        int count = atoi(getProperty("ro.executor.workers"));
+
+        if (count <= 0) {
+            count = (int) std::thread::hardware_concurrency();
+        }
+
+        return std::min(std::max(count, 2), MAX_WORKER_COUNT);
+    }());
+    return executor;
+}
+
+afExecutor::afExecutor(int workerCount)
+{
+    for (int i = 0; i < workerCount; i++) {
+        mWorkers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        mWorkers[i]->thread = new std::thread([this, i]() { workerLoop(i); });
+    }
+
+    AF_LOGI("executor start with %d workers\n", workerCount);
+}
+
+afExecutor::~afExecutor()
+{
+    {
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mExit = true;
+    }
+    mSleepCondition.notify_all();
+
+    for (auto &worker : mWorkers) {
+        if (worker->thread->joinable()) {
+            worker->thread->join();
+        }
+
+        delete worker->thread;
+    }
+}
+
+void afExecutor::post(Task task)
+{
+    pushTask(std::move(task));
+}
+
+void afExecutor::postDelayed(Task task, int delayMs)
+{
+    if (delayMs <= 0) {
+        pushTask(std::move(task));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mDelayedMutex);
+        mDelayedTasks.push({af_getsteady_ms() + delayMs, mDelayedSequence++, std::move(task)});
+    }
+    // let a sleeping worker recalculate its timeout
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+    mSleepCondition.notify_one();
+}
+
+void afExecutor::pushTask(Task task)
+{
+    int index = sWorkerIndex;
+
+    // the tasks posted by a task stay on the same worker, the others are spread
+    if (index < 0) {
+        index = (int) (mNextWorker++ % mWorkers.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+        mWorkers[index]->tasks.push_back(std::move(task));
+    }
+    mPending++;
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+    mSleepCondition.notify_one();
+}
+
+bool afExecutor::popTask(int index, Task &task)
+{
+    {
+        Worker &worker = *mWorkers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            mPending--;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < mWorkers.size(); i++) {
+        Worker &victim = *mWorkers[(index + i) % mWorkers.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+
+        if (lock.owns_lock() && !victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            mPending--;
+            mStolen++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int64_t afExecutor::pollDelayedTasks(int index, uint64_t &sequence)
+{
+    std::vector<Task> expired{};
+    int64_t next = INT64_MAX;
+    {
+        std::lock_guard<std::mutex> lock(mDelayedMutex);
+        int64_t now = af_getsteady_ms();
+
+        while (!mDelayedTasks.empty() && mDelayedTasks.top().when <= now) {
+            expired.push_back(mDelayedTasks.top().task);
+            mDelayedTasks.pop();
+        }
+
+        if (!mDelayedTasks.empty()) {
+            next = mDelayedTasks.top().when;
+        }
+
+        sequence = mDelayedSequence;
+    }
+
+    if (!expired.empty()) {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+
+        for (auto &task : expired) {
+            mWorkers[index]->tasks.push_back(std::move(task));
+            mPending++;
+        }
+    }
+
+    return next;
+}
+
+void afExecutor::workerLoop(int index)
+{
+    sWorkerIndex = index;
+    Task task{};
+    uint64_t sequence = 0;
+
+    while (!mExit) {
+        int64_t next = pollDelayedTasks(index, sequence);
+
+        if (popTask(index, task)) {
+            task();
+            task = nullptr;
+            mExecuted++;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+
+        // a delayed task posted after the polling notified before this worker waits, poll again
+        if (mExit || mPending > 0 || mDelayedSequence != sequence) {
+            continue;
+        }
+
+        if (next == INT64_MAX) {
+            mSleepCondition.wait(lock);
+        } else {
+            int64_t waitMs = next - af_getsteady_ms();
+
+            if (waitMs > 0) {
+                mSleepCondition.wait_for(lock, std::chrono::milliseconds(waitMs));
+            }
+        }
+    }
+}
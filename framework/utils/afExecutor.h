@@ -0,0 +1,108 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_AFEXECUTOR_H
+#define FRAMEWORK_AFEXECUTOR_H
+
+#include "CicadaType.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * A process wide work stealing executor.
+ * Every worker owns a task deque, it pops the newest task of its own deque and
+ * steals the oldest task of the others when its deque is empty.
+ * The tasks must not block for a long time, they share a bounded number of threads.
+ */
+class CICADA_CPLUS_EXTERN afExecutor {
+public:
+    typedef std::function<void()> Task;
+
+public:
+    static afExecutor &getInstance();
+
+    void post(Task task);
+
+    void postDelayed(Task task, int delayMs);
+
+    int getWorkerCount() const
+    {
+        return (int) mWorkers.size();
+    }
+
+    uint64_t getExecutedCount() const
+    {
+        return mExecuted;
+    }
+
+    uint64_t getStolenCount() const
+    {
+        return mStolen;
+    }
+
+private:
+    explicit afExecutor(int workerCount);
+
+    ~afExecutor();
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread *thread{nullptr};
+    };
+
+    struct DelayedTask {
+        int64_t when;
+        uint64_t sequence;
+        Task task;
+
+        bool operator<(const DelayedTask &other) const
+        {
+            // std::priority_queue is a max heap
+            if (when != other.when) {
+                return when > other.when;
+            }
+
+            return sequence > other.sequence;
+        }
+    };
+
+    void workerLoop(int index);
+
+    bool popTask(int index, Task &task);
+
+    /*
+     * move the expired delayed tasks into the deque of the worker, return the time of next one,
+     * sequence is the mDelayedSequence the result is based on
+     */
+    int64_t pollDelayedTasks(int index, uint64_t &sequence);
+
+    void pushTask(Task task);
+
+private:
+    std::vector<std::unique_ptr<Worker>> mWorkers{};
+    std::atomic_bool mExit{false};
+    std::atomic<int> mPending{0};
+    std::atomic<unsigned> mNextWorker{0};
+    std::atomic<uint64_t> mExecuted{0};
+    std::atomic<uint64_t> mStolen{0};
+
+    std::mutex mSleepMutex{};
+    std::condition_variable mSleepCondition{};
+
+    std::mutex mDelayedMutex{};
+    std::priority_queue<DelayedTask> mDelayedTasks{};
+    // read by the workers under mSleepMutex, to find the delayed tasks posted after their polling
+    std::atomic<uint64_t> mDelayedSequence{0};
+};
+
+
+#endif//FRAMEWORK_AFEXECUTOR_H
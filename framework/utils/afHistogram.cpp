@@ -0,0 +1,106 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "afHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define LINEAR_BUCKETS (2 * SUB_BUCKETS)
+#define MAX_VALUE ((1LL << 41) - 1)
+
+namespace Cicada {
+
+    afHistogram::afHistogram()
+    {
+        reset();
+    }
+
+    void afHistogram::reset()
+    {
+        memset(mBuckets, 0, sizeof(mBuckets));
+        mCount = 0;
+        mMin = INT64_MAX;
+        mMax = 0;
+        mSum = 0;
+    }
+
+    int afHistogram::getBucketIndex(int64_t value)
+    {
+        value = std::min(std::max(value, (int64_t) 0), (int64_t) MAX_VALUE);
+
+        if (value < LINEAR_BUCKETS) {
+            return (int) value;
+        }
+
+        int msb = 0;
+
+        for (int64_t v = value; v > 1; v >>= 1) {
+            msb++;
+        }
+
+        // the top SUB_BUCKET_BITS + 1 bits select the bucket
+        int shift = msb - SUB_BUCKET_BITS;
+        return SUB_BUCKETS * shift + (int) (value >> shift);
+    }
+
+    int64_t afHistogram::getBucketHighest(int index)
+    {
+        if (index < LINEAR_BUCKETS) {
+            return index;
+        }
+
+        int shift = index / SUB_BUCKETS - 1;
+        int64_t sub = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void afHistogram::record(int64_t value)
+    {
+        value = std::min(std::max(value, (int64_t) 0), (int64_t) MAX_VALUE);
+        mBuckets[getBucketIndex(value)]++;
+        mCount++;
+        mMin = std::min(mMin, value);
+        mMax = std::max(mMax, value);
+        mSum += (double) value;
+    }
+
+    int64_t afHistogram::getMin() const
+    {
+        return mCount > 0 ? mMin : 0;
+    }
+
+    int64_t afHistogram::getMax() const
+    {
+        return mMax;
+    }
+
+    double afHistogram::getMean() const
+    {
+        return mCount > 0 ? mSum / (double) mCount : 0;
+    }
+
+    int64_t afHistogram::getPercentile(double percentile) const
+    {
+        if (mCount == 0) {
+            return 0;
+        }
+
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        auto target = (uint64_t) std::max(ceil(percentile / 100.0 * (double) mCount), 1.0);
+        uint64_t total = 0;
+
+        for (int i = 0; i < MAX_BUCKETS; i++) {
+            total += mBuckets[i];
+
+            if (total >= target) {
+                return std::min(std::max(getBucketHighest(i), mMin), mMax);
+            }
+        }
+
+        return mMax;
+    }
+}// namespace Cicada
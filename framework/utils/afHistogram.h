@@ -0,0 +1,61 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_AFHISTOGRAM_H
+#define FRAMEWORK_AFHISTOGRAM_H
+
+#include "CicadaType.h"
+#include <cstdint>
+
+namespace Cicada {
+
+    /*
+     * A fixed size log-linear histogram in the HdrHistogram way, the values below 32 are exact, the bigger ones are
+     * kept with 16 sub-buckets per power of two, so the error of a percentile is less than 1/16.
+     * Not thread safe, the owner locks it.
+     */
+    class CICADA_CPLUS_EXTERN afHistogram {
+    public:
+        afHistogram();
+
+        ~afHistogram() = default;
+
+        // the negative values are counted as 0
+        void record(int64_t value);
+
+        void reset();
+
+        uint64_t getCount() const
+        {
+            return mCount;
+        }
+
+        int64_t getMin() const;
+
+        int64_t getMax() const;
+
+        double getMean() const;
+
+        // the highest value equivalent to the percentile, 0 if empty
+        int64_t getPercentile(double percentile) const;
+
+    public:
+        static int getBucketIndex(int64_t value);
+
+        static int64_t getBucketHighest(int index);
+
+    private:
+        // the values are clamped to 2^41 - 1
+        static const int MAX_BUCKETS = 16 * 36 + 32;
+
+        uint64_t mBuckets[MAX_BUCKETS];
+        uint64_t mCount{0};
+        int64_t mMin{INT64_MAX};
+        int64_t mMax{0};
+        double mSum{0};
+    };
+}// namespace Cicada
+
+
+#endif//FRAMEWORK_AFHISTOGRAM_H
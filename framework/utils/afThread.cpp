@@ -7,7 +7,10 @@
 
 #define LOG_TAG "afThread"
 #include "afThread.h"
+#include "afExecutor.h"
+#include "afTrace.h"
 #include "frame_work_log.h"
+#include "globalSettings.h"
 #include "timer.h"
 #include <cassert>
 
@@ -54,15 +57,173 @@ static void thread_set_self_name(char *name)
     set_name(name);
 #endif
 }
+struct afThread::CooperativeState {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<int()> func;
+    std::string name;
+    AF_THREAD_STATUS status{THREAD_STATUS_IDLE};
+    // the status of the owner, reset to nullptr when the owner is destroyed
+    std::atomic<AF_THREAD_STATUS> *ownerStatus{nullptr};
+    bool running{false};
+    std::thread::id runningThread{};
+    bool scheduled{false};
+    bool restarted{false};
+    uint64_t generation{0};
+    int nextDelayMs{0};
+    // a wakeUp() came when running, the next run is not delayed whatever the loop asks
+    bool wakeUpPending{false};
+
+    void setStatus(AF_THREAD_STATUS value)
+    {
+        status = value;
+
+        if (ownerStatus) {
+            *ownerStatus = value;
+        }
+    }
+};
+
 afThread::afThread(std::function<int()> func, const char *name)
     : mFunc(std::move(func)),
       mName(name)
 {
 }
 
+bool afThread::cooperativeEnabled()
+{
+    return Cicada::globalSettings::getSetting().getProperty("protected.thread.cooperative") == "ON";
+}
+
+void afThread::setCooperative(bool cooperative)
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    if (mThreadPtr != nullptr || mThreadStatus == THREAD_STATUS_RUNNING) {
+        AF_LOGE("%s: can't change the mode after started\n", mName.c_str());
+        return;
+    }
+
+    if (!cooperative) {
+        mCoState = nullptr;
+        return;
+    }
+
+    if (mCoState == nullptr) {
+        mCoState = std::make_shared<CooperativeState>();
+        mCoState->func = mFunc;
+        mCoState->name = mName;
+        mCoState->ownerStatus = &mThreadStatus;
+    }
+}
+
+void afThread::scheduleCoRun(const std::shared_ptr<CooperativeState> &state, int delayMs)
+{
+    // the lock of the state is held
+    uint64_t generation = ++state->generation;
+    state->scheduled = true;
+    afExecutor::getInstance().postDelayed([state, generation]() { coRun(state, generation); }, delayMs);
+}
+
+void afThread::coRun(const std::shared_ptr<CooperativeState> &state, uint64_t generation)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+
+    // replaced by a wakeUp() or canceled by pause()/stop()
+    if (generation != state->generation) {
+        return;
+    }
+
+    state->scheduled = false;
+
+    if (state->status != THREAD_STATUS_RUNNING) {
+        return;
+    }
+
+    state->running = true;
+    state->restarted = false;
+    state->nextDelayMs = 0;
+    state->wakeUpPending = false;
+    state->runningThread = std::this_thread::get_id();
+    lock.unlock();
+
+    int ret = state->func();
+
+    lock.lock();
+    state->running = false;
+    state->runningThread = std::thread::id();
+
+    if (ret < 0 && state->status == THREAD_STATUS_RUNNING && !state->restarted) {
+        state->setStatus(THREAD_STATUS_PAUSED);
+    }
+
+    if (state->status == THREAD_STATUS_RUNNING && !state->scheduled) {
+        scheduleCoRun(state, state->nextDelayMs);
+    }
+
+    state->condition.notify_all();
+}
+
+void afThread::waitCoRunDone(std::unique_lock<std::mutex> &lock)
+{
+    // the loop function may pause or stop itself
+    if (mCoState->runningThread == std::this_thread::get_id()) {
+        return;
+    }
+
+    mCoState->condition.wait(lock, [this]() { return !mCoState->running; });
+}
+
+void afThread::delayNextRun(int delayMs)
+{
+    if (mCoState == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mCoState->mutex);
+
+    if (!mCoState->wakeUpPending) {
+        mCoState->nextDelayMs = delayMs;
+    }
+}
+
+void afThread::wakeUp()
+{
+    if (mCoState == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mCoState->mutex);
+
+    if (mCoState->status != THREAD_STATUS_RUNNING) {
+        return;
+    }
+
+    if (mCoState->running) {
+        mCoState->nextDelayMs = 0;
+        mCoState->wakeUpPending = true;
+    } else if (mCoState->scheduled) {
+        scheduleCoRun(mCoState, 0);
+    }
+}
+
 int afThread::start()
 {
     std::lock_guard<std::mutex> guard(mMutex);
+
+    if (mCoState) {
+        std::lock_guard<std::mutex> lock(mCoState->mutex);
+        mCoState->restarted = true;
+        mCoState->setStatus(THREAD_STATUS_RUNNING);
+
+        // replace the delayed one if any
+        if (!mCoState->running) {
+            scheduleCoRun(mCoState, 0);
+        }
+
+        return 0;
+    }
+
     mTryPaused = false;
 
     if (nullptr == mThreadPtr) {
@@ -94,6 +255,7 @@ void afThread::onRun()
 
     if (mName.length() > 0) {
         thread_set_self_name(const_cast<char *>(mName.c_str()));
+        afTrace::setThreadName(mName.c_str());
     }
 
     while (THREAD_STATUS_STOPPED < mThreadStatus) {
@@ -135,6 +297,16 @@ void afThread::onRun()
 
 void afThread::prePause()
 {
+    if (mCoState) {
+        std::lock_guard<std::mutex> lock(mCoState->mutex);
+
+        if (THREAD_STATUS_RUNNING == mCoState->status) {
+            mCoState->setStatus(THREAD_STATUS_PAUSED);
+        }
+
+        return;
+    }
+
     if (mMutex.try_lock()) {
         if (THREAD_STATUS_RUNNING == mThreadStatus) {
             mTryPaused = true;
@@ -148,6 +320,17 @@ void afThread::pause()
 {
     std::lock_guard<std::mutex> guard(mMutex);
 
+    if (mCoState) {
+        std::unique_lock<std::mutex> lock(mCoState->mutex);
+
+        if (THREAD_STATUS_RUNNING == mCoState->status) {
+            mCoState->setStatus(THREAD_STATUS_PAUSED);
+        }
+
+        waitCoRunDone(lock);
+        return;
+    }
+
     if (THREAD_STATUS_RUNNING == mThreadStatus) {
         std::unique_lock<std::mutex> sleepMutex(mSleepMutex);
         mWaitPaused = true;
@@ -161,6 +344,14 @@ void afThread::stop()
 {
     AF_LOGD("%s:%d(%s) %s \n", __FILE__, __LINE__, __func__, mName.c_str());
     std::lock_guard<std::mutex> guard(mMutex);
+
+    if (mCoState) {
+        std::unique_lock<std::mutex> lock(mCoState->mutex);
+        mCoState->setStatus(THREAD_STATUS_STOPPED);
+        waitCoRunDone(lock);
+        return;
+    }
+
     mTryPaused = false;
     {
         std::unique_lock<std::mutex> sleepMutex(mSleepMutex);
@@ -183,6 +374,12 @@ void afThread::stop()
 
 void afThread::forceStop()
 {
+    if (mCoState) {
+        std::lock_guard<std::mutex> lock(mCoState->mutex);
+        mCoState->setStatus(THREAD_STATUS_STOPPED);
+        return;
+    }
+
     if (mThreadPtr) {
         mThreadPtr->detach();
         delete mThreadPtr;
@@ -200,6 +397,15 @@ void afThread::detach()
 
 afThread::~afThread()
 {
+    if (mCoState) {
+        std::unique_lock<std::mutex> lock(mCoState->mutex);
+        mCoState->setStatus(THREAD_STATUS_STOPPED);
+        waitCoRunDone(lock);
+        // the pending tasks hold the state only
+        mCoState->ownerStatus = nullptr;
+        return;
+    }
+
     if (mThreadPtr) {
         std::lock_guard<std::mutex> guard(mMutex);
         mTryPaused = false;
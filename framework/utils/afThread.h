@@ -12,6 +12,7 @@
 #include <functional>
 #include "CicadaType.h"
 #include <atomic>
+#include <memory>
 
 #define NEW_AF_THREAD(func) (new afThread([this]() -> int { return this->func(); }, LOG_TAG))
 
@@ -56,11 +57,41 @@ public:
 
     std::thread::id getId();
 
+    /*
+     * Run the loop function as tasks on the afExecutor instead of a dedicated thread,
+     * must be called before start(). The loop function must not block, it could call
+     * delayNextRun() instead of sleeping, and be woken up early by wakeUp().
+     * The begin/end callbacks are not called in this mode.
+     */
+    void setCooperative(bool cooperative);
+
+    bool isCooperative() const
+    {
+        return mCoState != nullptr;
+    }
+
+    // returns true if the cooperative mode is enabled by the global setting "protected.thread.cooperative"
+    static bool cooperativeEnabled();
+
+    // called by the loop function in cooperative mode, run the next loop after delayMs
+    void delayNextRun(int delayMs);
+
+    // run the delayed loop now
+    void wakeUp();
+
 private:
+    struct CooperativeState;
+
     static void threadRun(void *arg);
 
     void onRun();
 
+    static void scheduleCoRun(const std::shared_ptr<CooperativeState> &state, int delayMs);
+
+    static void coRun(const std::shared_ptr<CooperativeState> &state, uint64_t generation);
+
+    void waitCoRunDone(std::unique_lock<std::mutex> &lock);
+
 private:
 //    thread_func mFunc = nullptr;
     std::function<int()> mFunc;
@@ -77,6 +108,8 @@ private:
     thread_beginCallback mThreadBeginCallback = nullptr;
     thread_endCallback mThreadEndCallback = nullptr;
 
+    std::shared_ptr<CooperativeState> mCoState{nullptr};
+
 protected:
     std::atomic<AF_THREAD_STATUS> mThreadStatus{THREAD_STATUS_IDLE};
 };
@@ -0,0 +1,242 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "afTrace"
+
+#include "afTrace.h"
+#include "frame_work_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// events per thread, a power of 2
+#define TRACE_RING_SIZE 8192
+#define TRACE_INSTANT (-1)
+// the rings of the exited threads are kept for export until there are so many
+#define MAX_TRACE_THREADS 64
+
+namespace {
+    struct TraceEvent {
+        const char *category;
+        const char *name;
+        int64_t begin;
+        int64_t duration;
+    };
+
+    // written by its owner thread only
+    struct TraceRing {
+        std::atomic<uint64_t> writeIndex{0};
+        // the events before are cleared
+        std::atomic<uint64_t> clearIndex{0};
+        std::atomic<bool> alive{true};
+        int tid{0};
+        char name[32]{};
+        TraceEvent events[TRACE_RING_SIZE];
+    };
+
+    struct TraceRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<TraceRing>> rings;
+    };
+
+    TraceRegistry &getRegistry()
+    {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    struct RingHolder {
+        TraceRing *ring{nullptr};
+        char name[32]{};
+
+        ~RingHolder()
+        {
+            if (ring) {
+                ring->alive = false;
+            }
+        }
+    };
+
+    thread_local RingHolder sHolder;
+
+    TraceRing *getThreadRing()
+    {
+        if (sHolder.ring) {
+            return sHolder.ring;
+        }
+
+        TraceRegistry &registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        TraceRing *ring = nullptr;
+
+        // the threads come and go, reuse the rings of the exited ones
+        if (registry.rings.size() >= MAX_TRACE_THREADS) {
+            for (auto &item : registry.rings) {
+                if (!item->alive) {
+                    ring = item.get();
+                    ring->writeIndex = 0;
+                    ring->clearIndex = 0;
+                    ring->alive = true;
+                    break;
+                }
+            }
+        }
+
+        if (ring == nullptr) {
+            registry.rings.emplace_back(new TraceRing());
+            ring = registry.rings.back().get();
+            ring->tid = (int) registry.rings.size();
+        }
+
+        memcpy(ring->name, sHolder.name, sizeof(ring->name));
+        sHolder.ring = ring;
+        return ring;
+    }
+
+    void writeEvent(const char *category, const char *name, int64_t begin, int64_t duration)
+    {
+        TraceRing *ring = getThreadRing();
+        uint64_t index = ring->writeIndex.load(std::memory_order_relaxed);
+        TraceEvent &event = ring->events[index & (TRACE_RING_SIZE - 1)];
+        event.category = category;
+        event.name = name;
+        event.begin = begin;
+        event.duration = duration;
+        ring->writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    void appendEscaped(std::string &out, const char *str)
+    {
+        for (; *str; str++) {
+            if (*str == '"' || *str == '\\') {
+                out += '\\';
+                out += *str;
+            } else if ((unsigned char) *str >= 0x20) {
+                out += *str;
+            }
+        }
+    }
+}// namespace
+
+std::atomic<bool> afTrace::sEnabled{false};
+
+void afTrace::setEnabled(bool enabled)
+{
+    AF_LOGI("trace %s\n", enabled ? "enabled" : "disabled");
+    sEnabled = enabled;
+}
+
+void afTrace::setThreadName(const char *name)
+{
+    if (name == nullptr) {
+        return;
+    }
+
+    strncpy(sHolder.name, name, sizeof(sHolder.name) - 1);
+
+    if (sHolder.ring) {
+        std::lock_guard<std::mutex> lock(getRegistry().mutex);
+        memcpy(sHolder.ring->name, sHolder.name, sizeof(sHolder.name));
+    }
+}
+
+void afTrace::addSpan(const char *category, const char *name, int64_t beginUs, int64_t endUs)
+{
+    writeEvent(category, name, beginUs, endUs - beginUs);
+}
+
+void afTrace::addInstant(const char *category, const char *name)
+{
+    writeEvent(category, name, af_gettime_relative(), TRACE_INSTANT);
+}
+
+void afTrace::clear()
+{
+    TraceRegistry &registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // the owners may be writing, so skip the events instead of resetting the rings
+    for (auto &item : registry.rings) {
+        item->clearIndex = item->writeIndex.load();
+    }
+}
+
+std::string afTrace::exportChromeJson()
+{
+    TraceRegistry &registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<TraceEvent> events;
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    char buffer[128];
+
+    for (auto &item : registry.rings) {
+        TraceRing *ring = item.get();
+        uint64_t end = ring->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+        begin = std::max(begin, std::min(ring->clearIndex.load(), end));
+        events.resize(end - begin);
+
+        for (uint64_t i = begin; i < end; i++) {
+            events[i - begin] = ring->events[i & (TRACE_RING_SIZE - 1)];
+        }
+
+        // the owner may overwrite the oldest ones while copying, and is writing the slot of newEnd
+        uint64_t newEnd = ring->writeIndex.load(std::memory_order_acquire);
+        uint64_t valid = newEnd + 1 > TRACE_RING_SIZE ? newEnd + 1 - TRACE_RING_SIZE : 0;
+        size_t skip = valid > begin ? std::min((size_t) (valid - begin), events.size()) : 0;
+
+        snprintf(buffer, sizeof(buffer), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", first ? "" : ",",
+                 ring->tid);
+        out += buffer;
+        appendEscaped(out, ring->name[0] ? ring->name : "unnamed");
+        out += "\"}}";
+        first = false;
+
+        for (size_t i = skip; i < events.size(); i++) {
+            const TraceEvent &event = events[i];
+            out += "\n,{\"name\":\"";
+            appendEscaped(out, event.name);
+            out += "\",\"cat\":\"";
+            appendEscaped(out, event.category);
+
+            if (event.duration == TRACE_INSTANT) {
+                snprintf(buffer, sizeof(buffer), "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%d}", event.begin, ring->tid);
+            } else {
+                snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRId64 ",\"pid\":1,\"tid\":%d}", event.begin,
+                         event.duration, ring->tid);
+            }
+
+            out += buffer;
+        }
+    }
+
+    out += "],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
+
+int afTrace::exportChromeJson(const std::string &path)
+{
+    std::string json = exportChromeJson();
+    FILE *file = fopen(path.c_str(), "wb");
+
+    if (file == nullptr) {
+        AF_LOGE("can't open %s\n", path.c_str());
+        return -errno;
+    }
+
+    size_t written = fwrite(json.data(), 1, json.size(), file);
+    fclose(file);
+
+    if (written != json.size()) {
+        return -EIO;
+    }
+
+    AF_LOGI("%zu bytes trace exported to %s\n", json.size(), path.c_str());
+    return 0;
+}
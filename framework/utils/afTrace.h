@@ -0,0 +1,85 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_AFTRACE_H
+#define FRAMEWORK_AFTRACE_H
+
+#include "CicadaType.h"
+#include "timer.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * Low overhead tracing across the pipeline threads, exported as Chrome trace event json, loaded by chrome://tracing
+ * and Perfetto.
+ * Every thread writes its events to its own lock-free ring, the oldest ones are overwritten, so nothing blocks.
+ * When disabled, a span costs one relaxed load and one branch.
+ * The names and the categories must be string literals, only the pointers are kept.
+ */
+class CICADA_CPLUS_EXTERN afTrace {
+public:
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled()
+    {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    // the name of the current thread in the trace
+    static void setThreadName(const char *name);
+
+    static void addSpan(const char *category, const char *name, int64_t beginUs, int64_t endUs);
+
+    static void addInstant(const char *category, const char *name);
+
+    // drop all the recorded events
+    static void clear();
+
+    static std::string exportChromeJson();
+
+    static int exportChromeJson(const std::string &path);
+
+private:
+    static std::atomic<bool> sEnabled;
+};
+
+class afTraceScope {
+public:
+    afTraceScope(const char *category, const char *name) : mCategory(category), mName(name)
+    {
+        mBegin = afTrace::isEnabled() ? af_gettime_relative() : INT64_MIN;
+    }
+
+    ~afTraceScope()
+    {
+        if (mBegin != INT64_MIN) {
+            afTrace::addSpan(mCategory, mName, mBegin, af_gettime_relative());
+        }
+    }
+
+    afTraceScope(const afTraceScope &) = delete;
+
+    afTraceScope &operator=(const afTraceScope &) = delete;
+
+private:
+    const char *mCategory;
+    const char *mName;
+    int64_t mBegin;
+};
+
+#define AF_TRACE_CONCAT_INNER(a, b) a##b
+#define AF_TRACE_CONCAT(a, b) AF_TRACE_CONCAT_INNER(a, b)
+
+// trace the rest of the scope
+#define AF_TRACE_SCOPE(category, name) afTraceScope AF_TRACE_CONCAT(afTraceScope_, __LINE__)(category, name)
+
+#define AF_TRACE_INSTANT(category, name)              \
+    do {                                              \
+        if (afTrace::isEnabled()) {                   \
+            afTrace::addInstant(category, name);      \
+        }                                             \
+    } while (0)
+
+#endif//FRAMEWORK_AFTRACE_H
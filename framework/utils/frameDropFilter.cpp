@@ -0,0 +1,262 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#define LOG_TAG "frameDropFilter"
+
+#include "frameDropFilter.h"
+#include "frame_work_log.h"
+#include "timer.h"
+
+// the packet is so late that the decoder is the bottleneck
+#define LATE_THRESHOLD_US (100 * 1000)
+// the packets are decoded in advance, try a lower level
+#define EARLY_THRESHOLD_US (300 * 1000)
+#define RAISE_INTERVAL_MS 500
+#define LOWER_INTERVAL_MS 3000
+
+namespace Cicada {
+
+    void frameDropFilter::init(const Stream_meta *meta)
+    {
+        mCodec = meta->codec;
+        mNalLengthSize = 4;
+
+        // avcC and hvcC, the size of the NAL length field is in the header
+        if (meta->extradata && meta->extradata_size > 0 && meta->extradata[0] == 1) {
+            if (mCodec == AF_CODEC_ID_H264 && meta->extradata_size > 4) {
+                mNalLengthSize = (meta->extradata[4] & 0x03) + 1;
+            } else if (mCodec == AF_CODEC_ID_HEVC && meta->extradata_size > 21) {
+                mNalLengthSize = (meta->extradata[21] & 0x03) + 1;
+            }
+        }
+
+        mLevel = DROP_NONE;
+        mDroppedCount = 0;
+        mMaxTemporalId = 0;
+        reset();
+    }
+
+    void frameDropFilter::reset()
+    {
+        mKeyPts = INT64_MIN;
+        mGopDuration = 0;
+        mDropToKey = false;
+    }
+
+    void frameDropFilter::update(float speed, int64_t lateUs)
+    {
+        if (speed <= 1.0f) {
+            if (mLevel != DROP_NONE) {
+                AF_LOGI("speed %f, stop dropping frames\n", speed);
+                mLevel = DROP_NONE;
+            }
+
+            return;
+        }
+
+        int64_t now = af_getsteady_ms();
+
+        if (lateUs > LATE_THRESHOLD_US) {
+            if (mLevel < DROP_NON_KEY && now - mLevelChangeTime > RAISE_INTERVAL_MS) {
+                mLevel++;
+                mLevelChangeTime = now;
+                AF_LOGI("speed %f, late %lld, drop level up to %d\n", speed, lateUs, mLevel);
+            }
+        } else if (lateUs < -EARLY_THRESHOLD_US) {
+            if (mLevel > DROP_NONE && now - mLevelChangeTime > LOWER_INTERVAL_MS) {
+                mLevel--;
+                mLevelChangeTime = now;
+                AF_LOGI("speed %f, early %lld, drop level down to %d\n", speed, -lateUs, mLevel);
+            }
+        }
+    }
+
+    bool frameDropFilter::needDrop(IAFPacket *packet)
+    {
+        if (packet == nullptr) {
+            return false;
+        }
+
+        int64_t pts = packet->getInfo().pts;
+        FrameType type = getFrameType(packet);
+
+        if (type == FRAME_KEY) {
+            if (mKeyPts != INT64_MIN && pts != INT64_MIN && pts > mKeyPts) {
+                mGopDuration = pts - mKeyPts;
+            }
+
+            mKeyPts = pts;
+            mDropToKey = false;
+            return false;
+        }
+
+        // the references of this frame were dropped
+        if (mDropToKey) {
+            mDroppedCount++;
+            return true;
+        }
+
+        bool drop = false;
+
+        switch (mLevel) {
+            case DROP_NON_REFERENCE:
+                drop = (type == FRAME_NON_REFERENCE);
+                break;
+
+            case DROP_GOP_TAIL:
+                if (type == FRAME_NON_REFERENCE) {
+                    drop = true;
+                } else if (mGopDuration > 0 && mKeyPts != INT64_MIN && pts != INT64_MIN && pts - mKeyPts > mGopDuration / 2) {
+                    mDropToKey = true;
+                    drop = true;
+                }
+
+                break;
+
+            case DROP_NON_KEY:
+                mDropToKey = true;
+                drop = true;
+                break;
+
+            default:
+                break;
+        }
+
+        if (drop) {
+            mDroppedCount++;
+        }
+
+        return drop;
+    }
+
+    frameDropFilter::FrameType frameDropFilter::getFrameType(IAFPacket *packet)
+    {
+        if (packet->getInfo().flags & AF_PKT_FLAG_KEY) {
+            return FRAME_KEY;
+        }
+
+        // the NAL headers are not readable
+        if (packet->isProtected() || (mCodec != AF_CODEC_ID_H264 && mCodec != AF_CODEC_ID_HEVC)) {
+            return FRAME_UNKNOWN;
+        }
+
+        const uint8_t *data = packet->getData();
+        int size = (int) packet->getSize();
+        bool annexB = size > 4 && data[0] == 0 && data[1] == 0 && (data[2] == 1 || (data[2] == 0 && data[3] == 1));
+        FrameType frameType = FRAME_UNKNOWN;
+        int pos = 0;
+
+        while (pos < size) {
+            int nalStart;
+            int nalEnd;
+
+            if (annexB) {
+                // skip the start code
+                while (pos + 2 < size && !(data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1)) {
+                    pos++;
+                }
+
+                if (pos + 2 >= size) {
+                    break;
+                }
+
+                nalStart = pos + 3;
+                nalEnd = nalStart;
+
+                while (nalEnd + 2 < size && !(data[nalEnd] == 0 && data[nalEnd + 1] == 0 && (data[nalEnd + 2] <= 1))) {
+                    nalEnd++;
+                }
+
+                if (nalEnd + 2 >= size) {
+                    nalEnd = size;
+                }
+            } else {
+                if (pos + mNalLengthSize > size) {
+                    break;
+                }
+
+                int64_t nalSize = 0;
+
+                for (int i = 0; i < mNalLengthSize; i++) {
+                    nalSize = (nalSize << 8) | data[pos + i];
+                }
+
+                nalStart = pos + mNalLengthSize;
+
+                if (nalSize <= 0 || nalStart + nalSize > size) {
+                    break;
+                }
+
+                nalEnd = nalStart + (int) nalSize;
+            }
+
+            FrameType nalType = getNalType(data + nalStart, nalEnd - nalStart);
+
+            // a frame is non-reference only if all the slices are
+            if (nalType == FRAME_KEY) {
+                return FRAME_KEY;
+            } else if (nalType == FRAME_REFERENCE) {
+                frameType = FRAME_REFERENCE;
+            } else if (nalType == FRAME_NON_REFERENCE && frameType == FRAME_UNKNOWN) {
+                frameType = FRAME_NON_REFERENCE;
+            }
+
+            pos = nalEnd;
+        }
+
+        return frameType;
+    }
+
+    frameDropFilter::FrameType frameDropFilter::getNalType(const uint8_t *nal, int size)
+    {
+        if (size < 2) {
+            return FRAME_UNKNOWN;
+        }
+
+        if (mCodec == AF_CODEC_ID_H264) {
+            int type = nal[0] & 0x1f;
+            int refIdc = (nal[0] >> 5) & 0x03;
+
+            if (type == 5) {
+                return FRAME_KEY;
+            }
+
+            // coded slice and slice data partition A
+            if (type == 1 || type == 2) {
+                return refIdc ? FRAME_REFERENCE : FRAME_NON_REFERENCE;
+            }
+
+            return FRAME_UNKNOWN;
+        }
+
+        int type = (nal[0] >> 1) & 0x3f;
+        int temporalIdPlus1 = nal[1] & 0x07;
+
+        if (temporalIdPlus1 == 0) {
+            return FRAME_UNKNOWN;
+        }
+
+        int temporalId = temporalIdPlus1 - 1;
+
+        if (temporalId > mMaxTemporalId) {
+            mMaxTemporalId = temporalId;
+        }
+
+        // BLA, IDR and CRA
+        if (type >= 16 && type <= 21) {
+            return FRAME_KEY;
+        }
+
+        /*
+         * TRAIL, TSA, STSA, RADL and RASL, the even ones are sub-layer non-reference pictures,
+         * they are not referenced by the same sub-layer, but may be by the higher ones,
+         * so only the ones in the highest sub-layer are non-reference.
+         */
+        if (type <= 9) {
+            return (type % 2 == 0 && temporalId >= mMaxTemporalId) ? FRAME_NON_REFERENCE : FRAME_REFERENCE;
+        }
+
+        return FRAME_UNKNOWN;
+    }
+}// namespace Cicada
@@ -0,0 +1,87 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_FRAMEDROPFILTER_H
+#define FRAMEWORK_FRAMEDROPFILTER_H
+
+#include "AFMediaType.h"
+#include "CicadaType.h"
+#include <base/media/IAFPacket.h>
+
+namespace Cicada {
+
+    /*
+     * Drop the video packets before decode when the decoder can't keep up with the playback speed.
+     * The frames are classified by the NAL headers (H.264 nal_ref_idc, HEVC nal_unit_type),
+     * the level goes up step by step, the frames dropped never be referenced by the kept ones.
+     */
+    class CICADA_CPLUS_EXTERN frameDropFilter {
+    public:
+        enum DropLevel {
+            DROP_NONE = 0,
+            // the non-reference frames, most of the B-frames
+            DROP_NON_REFERENCE,
+            // and the second half of the GOP, from a P-frame to the next key frame
+            DROP_GOP_TAIL,
+            // keep the key frames only
+            DROP_NON_KEY,
+        };
+
+    public:
+        frameDropFilter() = default;
+
+        ~frameDropFilter() = default;
+
+        void init(const Stream_meta *meta);
+
+        // after flush, the next kept frame must be a key frame
+        void reset();
+
+        /*
+         * adapt the level to the speed and the lateness of the packet to decode,
+         * lateUs > 0 means the packet is behind the clock.
+         */
+        void update(float speed, int64_t lateUs);
+
+        bool needDrop(IAFPacket *packet);
+
+        int getLevel() const
+        {
+            return mLevel;
+        }
+
+        uint64_t getDroppedCount() const
+        {
+            return mDroppedCount;
+        }
+
+    private:
+        enum FrameType {
+            FRAME_UNKNOWN = 0,
+            FRAME_KEY,
+            FRAME_REFERENCE,
+            FRAME_NON_REFERENCE,
+        };
+
+        FrameType getFrameType(IAFPacket *packet);
+
+        // return the type of one NAL, FRAME_UNKNOWN if it is not a slice
+        FrameType getNalType(const uint8_t *nal, int size);
+
+    private:
+        AFCodecID mCodec{AF_CODEC_ID_NONE};
+        int mNalLengthSize{4};
+        int mLevel{DROP_NONE};
+        int64_t mLevelChangeTime{0};
+        int64_t mKeyPts{INT64_MIN};
+        int64_t mGopDuration{0};
+        bool mDropToKey{false};
+        uint64_t mDroppedCount{0};
+        // the highest HEVC temporal sub-layer seen
+        int mMaxTemporalId{0};
+    };
+}// namespace Cicada
+
+
+#endif//FRAMEWORK_FRAMEDROPFILTER_H
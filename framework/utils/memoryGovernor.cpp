@@ -0,0 +1,252 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "memoryGovernor"
+
+#include "memoryGovernor.h"
+#include "CicadaJSON.h"
+#include "frame_work_log.h"
+#include "globalSettings.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+namespace Cicada {
+
+    memoryGovernor::account::account(const string &name, evictor evict) : mName(name), mEvictor(std::move(evict))
+    {
+        for (auto &usage : mUsage) {
+            usage = 0;
+        }
+
+        getGovernor().addAccount(this);
+    }
+
+    memoryGovernor::account::~account()
+    {
+        getGovernor().removeAccount(this);
+    }
+
+    void memoryGovernor::account::setUsage(component type, int64_t bytes)
+    {
+        int64_t increment = bytes - mUsage[type].exchange(bytes);
+
+        if (increment == 0) {
+            return;
+        }
+
+        memoryGovernor &governor = getGovernor();
+        governor.addUsage(this, increment);
+
+        if (increment > 0) {
+            governor.reclaim();
+        }
+    }
+
+    int64_t memoryGovernor::account::getUsage(component type) const
+    {
+        return mUsage[type];
+    }
+
+    int64_t memoryGovernor::account::getTotal() const
+    {
+        int64_t total = 0;
+
+        for (auto &usage : mUsage) {
+            total += usage;
+        }
+
+        return total;
+    }
+
+    void memoryGovernor::account::setLimit(int64_t bytes)
+    {
+        mLimit = std::max(bytes, (int64_t) 0);
+    }
+
+    int64_t memoryGovernor::account::getAllowance() const
+    {
+        return getGovernor().getAllowance(this);
+    }
+
+    bool memoryGovernor::account::isOverBudget() const
+    {
+        return getTotal() >= getAllowance();
+    }
+
+    string memoryGovernor::account::toString() const
+    {
+        CicadaJSONItem item{};
+        item.addValue("name", mName);
+        item.addValue("total", (double) getTotal());
+        int64_t allowance = getAllowance();
+        item.addValue("allowance", allowance == INT64_MAX ? -1.0 : (double) allowance);
+
+        for (int i = 0; i < COMPONENT_NUM; i++) {
+            item.addValue(getComponentName((component) i), (double) mUsage[i]);
+        }
+
+        return item.printJSON();
+    }
+
+    memoryGovernor &memoryGovernor::getGovernor()
+    {
+        static memoryGovernor governor{};
+        return governor;
+    }
+
+    void memoryGovernor::setBudget(int64_t bytes)
+    {
+        mBudget = std::max(bytes, (int64_t) 0);
+        reclaim();
+    }
+
+    int64_t memoryGovernor::getBudget() const
+    {
+        int64_t budget = mBudget;
+        return budget >= 0 ? budget : mPropertyBudget.load();
+    }
+
+    int64_t memoryGovernor::getTotal() const
+    {
+        return mTotal;
+    }
+
+    string memoryGovernor::dump() const
+    {
+        CicadaJSONItem json{};
+        json.addValue("budget", (double) getBudget());
+        json.addValue("total", (double) getTotal());
+        CicadaJSONArray accounts{};
+        // the accounts are not removed when holding the reclaim lock
+        lock_guard<mutex> reclaimLock(mReclaimMutex);
+        vector<account *> items;
+        {
+            lock_guard<mutex> lock(mMutex);
+            items.assign(mAccounts.begin(), mAccounts.end());
+        }
+
+        for (auto item : items) {
+            accounts.addJSON(CicadaJSONItem(item->toString()));
+        }
+
+        json.addArray("accounts", accounts);
+        return json.printJSON();
+    }
+
+    const char *memoryGovernor::getComponentName(component type)
+    {
+        switch (type) {
+            case COMPONENT_PACKET_QUEUE:
+                return "packetQueue";
+            case COMPONENT_DEMUXER:
+                return "demuxer";
+            case COMPONENT_FRAME_QUEUE:
+                return "frameQueue";
+            case COMPONENT_FILTER:
+                return "filter";
+            case COMPONENT_SLICE_CACHE:
+                return "sliceCache";
+            default:
+                return "unknown";
+        }
+    }
+
+    void memoryGovernor::addAccount(account *item)
+    {
+        mPropertyBudget = atoll(globalSettings::getSetting().getProperty("protected.memory.budgetKB").c_str()) * 1024;
+        lock_guard<mutex> lock(mMutex);
+        mAccounts.push_back(item);
+
+        if (item->mEvictor == nullptr) {
+            mOwners++;
+        }
+    }
+
+    void memoryGovernor::removeAccount(account *item)
+    {
+        // not to be evicted when removing
+        lock_guard<mutex> reclaimLock(mReclaimMutex);
+        lock_guard<mutex> lock(mMutex);
+        mAccounts.remove(item);
+        addUsage(item, -item->getTotal());
+
+        if (item->mEvictor == nullptr) {
+            mOwners--;
+        }
+    }
+
+    void memoryGovernor::addUsage(const account *item, int64_t bytes)
+    {
+        mTotal += bytes;
+
+        if (item->mEvictor == nullptr) {
+            mOwnerTotal += bytes;
+        }
+    }
+
+    int64_t memoryGovernor::getAllowance(const account *item) const
+    {
+        int64_t budget = getBudget();
+        int64_t allowance = INT64_MAX;
+
+        if (budget > 0) {
+            if (item->mEvictor) {
+                allowance = std::max(budget - mOwnerTotal.load(), (int64_t) 0);
+            } else {
+                allowance = budget / std::max(mOwners.load(), 1);
+            }
+        }
+
+        if (item->mLimit > 0) {
+            allowance = std::min(allowance, item->mLimit.load());
+        }
+
+        return allowance;
+    }
+
+    void memoryGovernor::reclaim()
+    {
+        int64_t budget = getBudget();
+
+        if (budget <= 0) {
+            return;
+        }
+
+        // the evictors update their usage, don't reclaim again
+        unique_lock<mutex> reclaimLock(mReclaimMutex, try_to_lock);
+
+        if (!reclaimLock.owns_lock()) {
+            return;
+        }
+
+        int64_t over = getTotal() - budget;
+
+        if (over <= 0) {
+            return;
+        }
+
+        vector<account *> evictables;
+        {
+            lock_guard<mutex> lock(mMutex);
+
+            for (auto item : mAccounts) {
+                if (item->mEvictor) {
+                    evictables.push_back(item);
+                }
+            }
+        }
+
+        for (auto item : evictables) {
+            int64_t freed = item->mEvictor(over);
+            AF_LOGI("%lld bytes over the budget, %s freed %lld\n", (long long) over, item->mName.c_str(), (long long) freed);
+            over -= freed;
+
+            if (over <= 0) {
+                break;
+            }
+        }
+    }
+}// namespace Cicada
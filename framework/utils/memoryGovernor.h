@@ -0,0 +1,112 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef FRAMEWORK_MEMORYGOVERNOR_H
+#define FRAMEWORK_MEMORYGOVERNOR_H
+
+#include "CicadaType.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace Cicada {
+
+    /*
+     * The process wide memory budget of the buffers. Every owner (a player, the slice cache) keeps its usage per
+     * component in an account, the players share the budget equally, the evictable accounts (the slice cache) get
+     * what the players leave, and are evicted when the process goes over the budget.
+     * The budget is set by setBudget() or the property "protected.memory.budgetKB", 0 means no limit. The property is
+     * read when an account is opened, not on the buffering path.
+     * The totals are kept in atomics, setUsage(), getAllowance() and isOverBudget() take no lock.
+     */
+    class CICADA_CPLUS_EXTERN memoryGovernor {
+    public:
+        enum component {
+            COMPONENT_PACKET_QUEUE = 0,
+            COMPONENT_DEMUXER,
+            COMPONENT_FRAME_QUEUE,
+            COMPONENT_FILTER,
+            COMPONENT_SLICE_CACHE,
+            COMPONENT_NUM,
+        };
+
+        // free the bytes, return the bytes freed
+        typedef std::function<int64_t(int64_t bytes)> evictor;
+
+        class CICADA_CPLUS_EXTERN account {
+        public:
+            explicit account(const std::string &name, evictor evict = nullptr);
+
+            ~account();
+
+            void setUsage(component type, int64_t bytes);
+
+            int64_t getUsage(component type) const;
+
+            int64_t getTotal() const;
+
+            // the limit of the owner in bytes, 0 means no limit but the share of the budget
+            void setLimit(int64_t bytes);
+
+            // the bytes the account may hold, INT64_MAX if no limit
+            int64_t getAllowance() const;
+
+            bool isOverBudget() const;
+
+            std::string toString() const;
+
+        private:
+            friend class memoryGovernor;
+
+            std::string mName;
+            evictor mEvictor;
+            std::atomic<int64_t> mUsage[COMPONENT_NUM];
+            std::atomic<int64_t> mLimit{0};
+        };
+
+        static memoryGovernor &getGovernor();
+
+        void setBudget(int64_t bytes);
+
+        int64_t getBudget() const;
+
+        int64_t getTotal() const;
+
+        // all the accounts in json
+        std::string dump() const;
+
+        static const char *getComponentName(component type);
+
+    private:
+        memoryGovernor() = default;
+
+        void addAccount(account *item);
+
+        void removeAccount(account *item);
+
+        void addUsage(const account *item, int64_t bytes);
+
+        int64_t getAllowance(const account *item) const;
+
+        // evict the evictable accounts if the process is over the budget
+        void reclaim();
+
+    private:
+        mutable std::mutex mMutex{};
+        mutable std::mutex mReclaimMutex{};
+        std::list<account *> mAccounts{};
+        std::atomic<int64_t> mBudget{-1};
+        std::atomic<int64_t> mPropertyBudget{0};
+        std::atomic<int64_t> mTotal{0};
+        // the accounts can't be evicted, the players
+        std::atomic<int64_t> mOwnerTotal{0};
+        std::atomic<int> mOwners{0};
+    };
+}// namespace Cicada
+
+
+#endif//FRAMEWORK_MEMORYGOVERNOR_H
@@ -19,6 +19,7 @@
 #include "analytics/AnalyticsQueryListener.h"
 #include "media_player_error_def.h"
 #include "PlayerCacheDataSource.h"
+#include "SMPPipelineReaper.h"
 #include "QueryListener.h"
 
 using namespace Cicada;
@@ -131,6 +132,10 @@ namespace Cicada {
 
     MediaPlayer::~MediaPlayer()
     {
+#ifdef ENABLE_CACHE_MODULE
+        // the cache stopping in background calls back to this player
+        SMPPipelineReaper::getInstance().wait(this);
+#endif
         auto *handle = (playerHandle *) mPlayerHandle;
         CicadaReleasePlayer(&handle);
         delete mQueryListener;
@@ -150,6 +155,41 @@ namespace Cicada {
 #endif
     }
 
+    void MediaPlayer::SetPreloadConfig(const PlayerPreloadManager::Config &config)
+    {
+        PlayerPreloadManager::getInstance()->setConfig(config);
+    }
+
+    PlayerPreloadManager::Config MediaPlayer::GetPreloadConfig()
+    {
+        return PlayerPreloadManager::getInstance()->getConfig();
+    }
+
+    void MediaPlayer::SetPreloadUrls(const std::vector<std::string> &urls)
+    {
+        PlayerPreloadManager::getInstance()->setUrls(urls);
+    }
+
+    void MediaPlayer::AddPreloadUrl(const std::string &url)
+    {
+        PlayerPreloadManager::getInstance()->addUrl(url);
+    }
+
+    void MediaPlayer::RemovePreloadUrl(const std::string &url)
+    {
+        PlayerPreloadManager::getInstance()->removeUrl(url);
+    }
+
+    void MediaPlayer::ClearPreloadUrls()
+    {
+        PlayerPreloadManager::getInstance()->clear();
+    }
+
+    std::string MediaPlayer::GetPreloadInfo()
+    {
+        return PlayerPreloadManager::getInstance()->getInfo();
+    }
+
     int64_t MediaPlayer::GetMasterClockPts()
     {
         GET_PLAYER_HANDLE
@@ -223,6 +263,7 @@ namespace Cicada {
 #ifdef ENABLE_CACHE_MODULE
         if (mCacheConfig.mEnable) {
             if (mCacheManager != nullptr) {
+                SMPPipelineReaper::getInstance().wait(this);
                 delete mCacheManager;
                 mCacheManager = nullptr;
             }
@@ -306,6 +347,12 @@ namespace Cicada {
             mCollector->ReportPrepare();
         }
 
+#ifdef ENABLE_CACHE_MODULE
+        // the cache of the last asynchronous stop may be still stopping, don't send it the frames of this one
+        if (mCacheManager != nullptr) {
+            SMPPipelineReaper::getInstance().wait(this);
+        }
+#endif
         GET_PLAYER_HANDLE
         CicadaPreparePlayer(handle);
     }
@@ -363,6 +410,12 @@ namespace Cicada {
         mAbrManager->Pause();
     }
 
+    void MediaPlayer::SetScrubbing(bool scrubbing)
+    {
+        GET_PLAYER_HANDLE
+        CicadaSetOption(handle, "scrubbing", scrubbing ? "1" : "0");
+    }
+
     void MediaPlayer::CaptureScreen()
     {
         GET_PLAYER_HANDLE
@@ -389,7 +442,7 @@ namespace Cicada {
             CicadaSetLoop(handle, true);
         }
         mCacheSuccess = false;
-        if (mCacheManager != nullptr) {
+        if (mCacheManager != nullptr && !mAsyncStop) {
             mCacheManager->stop("cache stopped by stop");
         }
 #endif
@@ -397,6 +450,13 @@ namespace Cicada {
         waitingForStart = false;
         GET_PLAYER_HANDLE
         CicadaStopPlayer(handle);
+#ifdef ENABLE_CACHE_MODULE
+        // joining the remuxer may take long, stop it after the player sends no frame to it
+        if (mCacheManager != nullptr && mAsyncStop) {
+            CacheManager *cacheManager = mCacheManager;
+            SMPPipelineReaper::getInstance().post(this, [cacheManager]() { cacheManager->stop("cache stopped by stop"); });
+        }
+#endif
     }
 
     int64_t MediaPlayer::GetDuration()
@@ -516,6 +576,7 @@ namespace Cicada {
         CicadaSetOption(handle, "timerInterval", to_string(playerConfig.mPositionTimerIntervalMs).c_str());
         CicadaSetOption(handle, "networkRetryCount", to_string(playerConfig.networkRetryCount).c_str());
         CicadaSetOption(handle, "maxBackwardBufferDuration", to_string(playerConfig.mMaxBackwardBufferDuration).c_str());
+        CicadaSetOption(handle, "maxBufferMemoryKB", to_string(playerConfig.maxBufferMemoryKB).c_str());
         CicadaSetOption(handle, "preferAudio", playerConfig.preferAudio ? "1" : "0");
         if (playerConfig.pixelBufferOutputFormat != 0) {
             CicadaSetOption(handle, "pixelBufferOutputFormat", to_string(playerConfig.pixelBufferOutputFormat).c_str());
@@ -678,6 +739,10 @@ namespace Cicada {
     {
         GET_PLAYER_HANDLE
         CicadaSetOption(handle, key, value);
+
+        if (key && value && strcmp(key, "asyncStop") == 0) {
+            mAsyncStop = atol(value) != 0;
+        }
     }
 
     void MediaPlayer::GetOption(const char *key, char *value)
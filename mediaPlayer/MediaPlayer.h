@@ -9,6 +9,7 @@
 #define CicadaPlayer_h
 
 #include "MediaPlayerConfig.h"
+#include "PlayerPreloadManager.h"
 #include "abr/AbrBufferRefererData.h"
 #include "native_cicada_player_def.h"
 #include <cstdio>
@@ -62,6 +63,29 @@ namespace Cicada {
             return "paas 0.9";//TODO version
         }
 
+        /*
+         * preload the urls to be played next, shared by all the players,
+         * a player prepares a preloaded url from its warm pipeline.
+         */
+        static void SetPreloadConfig(const PlayerPreloadManager::Config &config);
+
+        static PlayerPreloadManager::Config GetPreloadConfig();
+
+        /*
+         * the urls will be played next in order, only the first maxItems urls are preloaded,
+         * the preloaded ones not in the list are dropped.
+         */
+        static void SetPreloadUrls(const std::vector<std::string> &urls);
+
+        static void AddPreloadUrl(const std::string &url);
+
+        static void RemovePreloadUrl(const std::string &url);
+
+        static void ClearPreloadUrls();
+
+        // status of the preloaded items in json
+        static std::string GetPreloadInfo();
+
         std::string getName();
 
     public:
@@ -150,6 +174,12 @@ namespace Cicada {
          */
         void SeekTo(int64_t seekPos, SeekMode mode);
 
+        /*
+         * enter or leave scrub mode, in scrub mode SeekTo only shows the nearest key frame without audio,
+         * an accurate seek to the last position is done when leaving
+         */
+        void SetScrubbing(bool scrubbing);
+
         /*
          * capture screen, buffer will get by callback
          */
@@ -468,6 +498,8 @@ namespace Cicada {
         CacheManager *mCacheManager{};
         CacheConfig mCacheConfig{};
         std::atomic<bool> mCacheSuccess{false};
+        // stop the cache remuxer in background too
+        bool mAsyncStop{false};
         PlayerStatus mOldPlayStatus{PLAYER_IDLE};
         playerMediaFrameCb mMediaFrameFunc{nullptr};
         void *mMediaFrameArg{nullptr};
@@ -24,6 +24,7 @@ namespace Cicada {
         mDisableVideo = false;
         mPositionTimerIntervalMs = 500;
         mMaxBackwardBufferDuration = 0;
+        maxBufferMemoryKB = 0;
         preferAudio = false;
     }
 
@@ -45,6 +46,7 @@ namespace Cicada {
         item.addValue("mDisableVideo", mDisableVideo);
         item.addValue("mPositionTimerIntervalMs", mPositionTimerIntervalMs);
         item.addValue("mMaxBackwardBufferDuration", (double) mMaxBackwardBufferDuration);
+        item.addValue("maxBufferMemoryKB", maxBufferMemoryKB);
         item.addValue("preferAudio", preferAudio);
         return item.printJSON();
     }
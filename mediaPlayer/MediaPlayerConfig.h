@@ -48,6 +48,7 @@ namespace Cicada {
 
         int mPositionTimerIntervalMs;
         uint64_t mMaxBackwardBufferDuration;
+        // the memory limit of the buffers, 0 means the share of the process memory budget only
         int maxBufferMemoryKB;
         std::string localCacheDir;
         bool preferAudio;
@@ -0,0 +1,553 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "PlayerPreloadManager"
+
+#include "PlayerPreloadManager.h"
+#include <algorithm>
+#include <climits>
+#include <codec/decoderFactory.h>
+#include <data_source/dataSourcePrototype.h>
+#include <utils/CicadaJSON.h>
+#include <utils/errors/framework_error.h>
+#include <utils/frame_work_log.h>
+#include <utils/timer.h>
+
+#define FIRST_FRAME_DECODE_TIMEOUT_MS 500
+
+using namespace Cicada;
+
+PreloadItem::PreloadItem(const std::string &url, PlayerPreloadManager &manager) : mUrl(url), mManager(manager)
+{
+    mThread = std::unique_ptr<afThread>(NEW_AF_THREAD(preloadLoop));
+}
+
+PreloadItem::~PreloadItem()
+{
+    stop();
+    releasePipeline();
+}
+
+void PreloadItem::start()
+{
+    if (mStatus == Status_Idle) {
+        mStatus = Status_Opening;
+    }
+    mCanceled = false;
+    mThread->start();
+}
+
+void PreloadItem::stop()
+{
+    mCanceled = true;
+
+    if (mDataSource) {
+        mDataSource->Interrupt(true);
+    }
+
+    if (mDemuxerService) {
+        mDemuxerService->interrupt(1);
+    }
+
+    mThread->stop();
+
+    if (mDemuxerService) {
+        mDemuxerService->interrupt(0);
+        // keep the pipeline quiet until the player take it
+        mDemuxerService->stop();
+    }
+
+    if (mDataSource) {
+        mDataSource->Interrupt(false);
+    }
+}
+
+int64_t PreloadItem::getBufferedDuration() const
+{
+    int64_t duration = INT64_MAX;
+    bool have = false;
+
+    for (int i = 0; i < 2; i++) {
+        if (mFirstPts[i] != INT64_MIN && mLastPts[i] != INT64_MIN) {
+            duration = std::min(duration, mLastPts[i] - mFirstPts[i]);
+            have = true;
+        }
+    }
+
+    return have ? duration : 0;
+}
+
+std::unique_ptr<IAFPacket> PreloadItem::popPacket()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mPackets.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<IAFPacket> packet = move(mPackets.front());
+    mPackets.pop_front();
+    mBufferedBytes -= packet->getSize();
+    return packet;
+}
+
+int PreloadItem::preloadLoop()
+{
+    if (mCanceled) {
+        return -1;
+    }
+
+    if (mStatus == Status_Opening) {
+        int ret = openPipeline();
+
+        if (ret < 0) {
+            if (!mCanceled) {
+                AF_LOGE("preload %s failed %s\n", mUrl.c_str(), framework_err2_string(ret));
+                mStatus = Status_Error;
+            }
+
+            return -1;
+        }
+
+        mStatus = Status_Buffering;
+    }
+
+    if (mStatus != Status_Buffering) {
+        return -1;
+    }
+
+    PlayerPreloadManager::Config config = mManager.getConfig();
+
+    if (mEOS || getBufferedDuration() >= config.bufferDurationUs) {
+        if (config.decodeFirstVideoFrame) {
+            decodeFirstVideoFrame();
+        }
+
+        mStatus = Status_Ready;
+        AF_LOGI("preload %s ready, buffered %lld us %lld bytes\n", mUrl.c_str(), getBufferedDuration(), mBufferedBytes.load());
+        return -1;
+    }
+
+    int ret = readPacket();
+
+    if (ret == -EAGAIN) {
+        af_msleep(10);
+        return 0;
+    }
+
+    if (ret < 0) {
+        if (!mCanceled) {
+            mStatus = Status_Error;
+        }
+
+        return -1;
+    }
+
+    return 0;
+}
+
+int PreloadItem::openPipeline()
+{
+    PlayerPreloadManager::Config config = mManager.getConfig();
+    mDataSource = dataSourcePrototype::create(mUrl, &mOptions, DS_NEED_CACHE);
+
+    if (mDataSource == nullptr) {
+        return -EINVAL;
+    }
+
+    mDataSource->Set_config(config.sourceConfig);
+    int ret = mDataSource->Open(0);
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (mCanceled) {
+        return FRAMEWORK_ERR_EXIT;
+    }
+
+    mDemuxerService = std::unique_ptr<demuxer_service>(new demuxer_service(mDataSource));
+    mDemuxerService->setOptions(&mOptions);
+    ret = mDemuxerService->createDemuxer(demuxer_type_unknown);
+
+    if (ret < 0) {
+        return ret;
+    }
+    // keep the same bit stream format as SuperMediaPlayer
+#ifdef __APPLE__
+    mDemuxerService->getDemuxerHandle()->setBitStreamFormat(header_type::header_type_extract, header_type::header_type_extract);
+#else
+    mDemuxerService->getDemuxerHandle()->setBitStreamFormat(header_type::header_type_merge, header_type::header_type_merge);
+#endif
+    ret = mDemuxerService->initOpen(demuxer_type_unknown);
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    int nbStream = mDemuxerService->GetNbStreams();
+    int bandWidthNearStreamIndex = -1;
+    int minBandWidthDelta = INT_MAX;
+    std::unique_ptr<streamMeta> pMeta;
+
+    for (int i = 0; i < nbStream; ++i) {
+        mDemuxerService->GetStreamMeta(pMeta, i, false);
+        auto *meta = (Stream_meta *) (pMeta.get());
+
+        if (meta->type == STREAM_TYPE_MIXED || meta->type == STREAM_TYPE_VIDEO) {
+            int metaBandWidth = (int) meta->bandwidth;
+
+            if (abs(config.defaultBandWidth - metaBandWidth) < minBandWidthDelta) {
+                bandWidthNearStreamIndex = i;
+                minBandWidthDelta = abs(config.defaultBandWidth - metaBandWidth);
+            }
+        }
+    }
+
+    // same selection as SMPMessageControllerListener::ProcessPrepareMsg, so that the player can reuse the opened streams
+    for (int i = 0; i < nbStream; ++i) {
+        mDemuxerService->GetStreamMeta(pMeta, i, false);
+        auto *meta = (Stream_meta *) (pMeta.get());
+
+        if (meta->type == STREAM_TYPE_VIDEO && mVideoIndex < 0 && meta->attached_pic == 0 && i == bandWidthNearStreamIndex) {
+            ret = mDemuxerService->OpenStream(i);
+            mVideoIndex = i;
+        } else if (meta->type == STREAM_TYPE_AUDIO && mAudioIndex < 0) {
+            ret = mDemuxerService->OpenStream(i);
+            mAudioIndex = i;
+        } else if (meta->type == STREAM_TYPE_MIXED && i == bandWidthNearStreamIndex) {
+            ret = mDemuxerService->OpenStream(i);
+            mVideoIndex = i;
+        }
+
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (mVideoIndex < 0 && mAudioIndex < 0) {
+        return FRAMEWORK_ERR_FORMAT_NOT_SUPPORT;
+    }
+
+    mDemuxerService->start();
+    return 0;
+}
+
+int PreloadItem::readPacket()
+{
+    if (!mManager.requestBandwidth(0)) {
+        return -EAGAIN;
+    }
+
+    std::unique_ptr<IAFPacket> packet{};
+    int ret = mDemuxerService->readPacket(packet, -1);
+
+    if (ret == 0) {
+        mEOS = true;
+        return 0;
+    }
+
+    if (packet == nullptr) {
+        return ret;
+    }
+
+    int64_t size = packet->getSize();
+    mManager.requestBandwidth(size);
+
+    if (!mManager.requestMemory(size)) {
+        // out of the global budget, keep this packet so the buffer has no hole, and stop after it
+        AF_LOGW("preload %s out of memory budget\n", mUrl.c_str());
+        mEOS = true;
+        ret = 0;
+    }
+
+    int index = GEN_STREAM_INDEX(packet->getInfo().streamIndex);
+    int type = -1;
+
+    if (index == mVideoIndex) {
+        type = 0;
+    } else if (index == mAudioIndex) {
+        type = 1;
+    }
+
+    if (type >= 0 && packet->getInfo().pts != INT64_MIN) {
+        if (mFirstPts[type] == INT64_MIN) {
+            mFirstPts[type] = packet->getInfo().pts;
+        }
+
+        mLastPts[type] = std::max(mLastPts[type], packet->getInfo().pts);
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBufferedBytes += size;
+    mPackets.push_back(move(packet));
+    return ret;
+}
+
+void PreloadItem::decodeFirstVideoFrame()
+{
+    if (mVideoIndex < 0 || mFirstVideoFrame != nullptr) {
+        return;
+    }
+
+    std::unique_ptr<streamMeta> pMeta;
+    mDemuxerService->GetStreamMeta(pMeta, mVideoIndex, false);
+    auto *meta = (Stream_meta *) (pMeta.get());
+
+    if (meta->type != STREAM_TYPE_VIDEO || meta->keyFormat != nullptr) {
+        return;
+    }
+
+    std::unique_ptr<IDecoder> decoder = decoderFactory::create(*meta, DECFLAG_SW, std::max(meta->height, meta->width), nullptr);
+
+    if (decoder == nullptr || decoder->open(meta, nullptr, DECFLAG_SW, nullptr) < 0) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<IAFPacket>> packets;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        bool gotKey = false;
+
+        for (auto &packet : mPackets) {
+            if (GEN_STREAM_INDEX(packet->getInfo().streamIndex) != mVideoIndex) {
+                continue;
+            }
+
+            if (!gotKey && !(packet->getInfo().flags & AF_PKT_FLAG_KEY)) {
+                continue;
+            }
+
+            gotKey = true;
+            packets.push_back(packet->clone());
+        }
+    }
+
+    int64_t start = af_getsteady_ms();
+    auto packetIter = packets.begin();
+
+    while (!mCanceled && mFirstVideoFrame == nullptr && af_getsteady_ms() - start < FIRST_FRAME_DECODE_TIMEOUT_MS) {
+        if (packetIter != packets.end()) {
+            int ret = decoder->send_packet(*packetIter, 0);
+
+            if (!(ret & STATUS_RETRY_IN)) {
+                ++packetIter;
+            }
+        }
+
+        decoder->getFrame(mFirstVideoFrame, 10 * 1000);
+    }
+
+    decoder->close();
+}
+
+void PreloadItem::releasePipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPackets.clear();
+        mBufferedBytes = 0;
+    }
+    mFirstVideoFrame = nullptr;
+
+    if (mDemuxerService) {
+        mDemuxerService->close();
+        mDemuxerService = nullptr;
+    }
+
+    if (mDataSource) {
+        mDataSource->Close();
+        delete mDataSource;
+        mDataSource = nullptr;
+    }
+}
+
+PlayerPreloadManager *PlayerPreloadManager::getInstance()
+{
+    static PlayerPreloadManager sManager;
+    return &sManager;
+}
+
+PlayerPreloadManager::~PlayerPreloadManager()
+{
+    clear();
+}
+
+void PlayerPreloadManager::setConfig(const Config &config)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    {
+        std::lock_guard<std::mutex> configLock(mConfigMutex);
+        mConfig = config;
+    }
+    schedule();
+}
+
+PlayerPreloadManager::Config PlayerPreloadManager::getConfig()
+{
+    // the items read the config in their threads, so don't lock mMutex here
+    std::lock_guard<std::mutex> lock(mConfigMutex);
+    return mConfig;
+}
+
+void PlayerPreloadManager::setUrls(const std::vector<std::string> &urls)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUrls.assign(urls.begin(), urls.end());
+    schedule();
+}
+
+void PlayerPreloadManager::addUrl(const std::string &url)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (std::find(mUrls.begin(), mUrls.end(), url) == mUrls.end()) {
+        mUrls.push_back(url);
+    }
+
+    schedule();
+}
+
+void PlayerPreloadManager::removeUrl(const std::string &url)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUrls.remove(url);
+    schedule();
+}
+
+void PlayerPreloadManager::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUrls.clear();
+    schedule();
+}
+
+// must be called with mMutex locked
+void PlayerPreloadManager::schedule()
+{
+    std::list<std::string> wanted{};
+    int maxItems = getConfig().maxItems;
+
+    for (auto &url : mUrls) {
+        if (wanted.size() >= maxItems) {
+            break;
+        }
+
+        wanted.push_back(url);
+    }
+
+    for (auto item = mItems.begin(); item != mItems.end();) {
+        if (std::find(wanted.begin(), wanted.end(), (*item)->getUrl()) == wanted.end()) {
+            // no more bytes are buffered after the thread stopped
+            (*item)->stop();
+            releaseMemory((*item)->getBufferedBytes());
+            item = mItems.erase(item);
+        } else {
+            ++item;
+        }
+    }
+
+    for (auto &url : wanted) {
+        auto item = std::find_if(mItems.begin(), mItems.end(),
+                                 [&url](const std::unique_ptr<PreloadItem> &preloadItem) { return preloadItem->getUrl() == url; });
+
+        if (item == mItems.end()) {
+            std::unique_ptr<PreloadItem> preloadItem = std::unique_ptr<PreloadItem>(new PreloadItem(url, *this));
+            preloadItem->start();
+            mItems.push_back(move(preloadItem));
+        }
+    }
+}
+
+std::unique_ptr<PreloadItem> PlayerPreloadManager::acquire(const std::string &url)
+{
+    std::unique_ptr<PreloadItem> preloadItem{nullptr};
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto item = std::find_if(mItems.begin(), mItems.end(),
+                                 [&url](const std::unique_ptr<PreloadItem> &item) { return item->getUrl() == url; });
+
+        if (item == mItems.end()) {
+            return nullptr;
+        }
+
+        preloadItem = move(*item);
+        mItems.erase(item);
+        mUrls.remove(url);
+    }
+
+    preloadItem->stop();
+    // the player owns the buffer now
+    releaseMemory(preloadItem->getBufferedBytes());
+    {
+        // the slot is free even if the item is not usable, start next one
+        std::lock_guard<std::mutex> lock(mMutex);
+        schedule();
+    }
+
+    PreloadItem::Status status = preloadItem->getStatus();
+
+    if (status != PreloadItem::Status_Buffering && status != PreloadItem::Status_Ready) {
+        return nullptr;
+    }
+
+    AF_LOGI("acquire preloaded %s, buffered %lld us\n", url.c_str(), preloadItem->getBufferedDuration());
+    return preloadItem;
+}
+
+std::string PlayerPreloadManager::getInfo()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    CicadaJSONArray items{};
+
+    for (auto &item : mItems) {
+        CicadaJSONItem json{};
+        json.addValue("url", item->getUrl());
+        json.addValue("status", (int) item->getStatus());
+        json.addValue("bufferedDuration", (long) item->getBufferedDuration());
+        json.addValue("bufferedBytes", (long) item->getBufferedBytes());
+        items.addJSON(json);
+    }
+
+    CicadaJSONItem json{};
+    json.addValue("usedMemory", (long) mUsedMemory.load());
+    json.addArray("items", items);
+    return json.printJSON();
+}
+
+bool PlayerPreloadManager::requestMemory(int64_t bytes)
+{
+    int64_t maxMemory = getConfig().maxMemoryBytes;
+    // take and check in one atomic step, so the items can't pass the budget together
+    int64_t used = mUsedMemory.fetch_add(bytes) + bytes;
+    return maxMemory <= 0 || used <= maxMemory;
+}
+
+void PlayerPreloadManager::releaseMemory(int64_t bytes)
+{
+    mUsedMemory -= bytes;
+}
+
+bool PlayerPreloadManager::requestBandwidth(int64_t bytes)
+{
+    int64_t maxBandwidth = getConfig().maxBandwidthBytesPerSecond;
+
+    if (maxBandwidth <= 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mBandwidthMutex);
+    int64_t now = af_getsteady_ms();
+
+    if (now - mBandwidthWindowStart >= 1000) {
+        mBandwidthWindowStart = now;
+        mBandwidthWindowBytes = 0;
+    }
+
+    if (mBandwidthWindowBytes >= maxBandwidth) {
+        return false;
+    }
+
+    mBandwidthWindowBytes += bytes;
+    return true;
+}
@@ -0,0 +1,173 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_PLAYERPRELOADMANAGER_H
+#define CICADAMEDIA_PLAYERPRELOADMANAGER_H
+
+#include <atomic>
+#include <base/media/IAFPacket.h>
+#include <base/options.h>
+#include <data_source/IDataSource.h>
+#include <deque>
+#include <demuxer/demuxer_service.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utils/afThread.h>
+#include <vector>
+
+namespace Cicada {
+    class PlayerPreloadManager;
+
+    /*
+     * A warm pipeline of one url: the opened data source and demuxer, the packets
+     * read ahead and optionally the first decoded video frame.
+     * The SuperMediaPlayer takes the ownership of the pipeline when it prepares the same url.
+     */
+    class PreloadItem {
+        friend class PlayerPreloadManager;
+        friend class SMPMessageControllerListener;
+
+    public:
+        enum Status {
+            Status_Idle,
+            Status_Opening,
+            Status_Buffering,
+            Status_Ready,
+            Status_Error,
+        };
+
+    public:
+        PreloadItem(const std::string &url, PlayerPreloadManager &manager);
+
+        ~PreloadItem();
+
+        void start();
+
+        void stop();
+
+        const std::string &getUrl() const
+        {
+            return mUrl;
+        }
+
+        Status getStatus() const
+        {
+            return mStatus;
+        }
+
+        int64_t getBufferedBytes() const
+        {
+            return mBufferedBytes;
+        }
+
+        int64_t getBufferedDuration() const;
+
+        std::unique_ptr<IAFPacket> popPacket();
+
+    private:
+        int preloadLoop();
+
+        int openPipeline();
+
+        int readPacket();
+
+        void decodeFirstVideoFrame();
+
+        void releasePipeline();
+
+    private:
+        std::string mUrl;
+        PlayerPreloadManager &mManager;
+        std::atomic<Status> mStatus{Status_Idle};
+        std::atomic_bool mCanceled{false};
+        std::unique_ptr<afThread> mThread{nullptr};
+
+        options mOptions{};
+        IDataSource *mDataSource{nullptr};
+        std::unique_ptr<demuxer_service> mDemuxerService{nullptr};
+        std::mutex mMutex{};
+        std::deque<std::unique_ptr<IAFPacket>> mPackets{};
+        std::unique_ptr<IAFFrame> mFirstVideoFrame{nullptr};
+        std::atomic<int64_t> mBufferedBytes{0};
+        int64_t mFirstPts[2]{INT64_MIN, INT64_MIN};
+        int64_t mLastPts[2]{INT64_MIN, INT64_MIN};
+        int mVideoIndex{-1};
+        int mAudioIndex{-1};
+        bool mEOS{false};
+    };
+
+    class PlayerPreloadManager {
+    public:
+        struct Config {
+            // how many urls could be preloaded at the same time
+            int maxItems{3};
+            int64_t bufferDurationUs{2 * 1000 * 1000};
+            bool decodeFirstVideoFrame{false};
+            int defaultBandWidth{0};
+            // budget of all the items, 0 is unlimited
+            int64_t maxMemoryBytes{20 * 1024 * 1024};
+            int64_t maxBandwidthBytesPerSecond{0};
+            IDataSource::SourceConfig sourceConfig{};
+        };
+
+    public:
+        static PlayerPreloadManager *getInstance();
+
+        void setConfig(const Config &config);
+
+        Config getConfig();
+
+        /*
+         * the urls will be played next in order, the items not in the list are dropped,
+         * only the first maxItems urls will be preloaded.
+         */
+        void setUrls(const std::vector<std::string> &urls);
+
+        void addUrl(const std::string &url);
+
+        void removeUrl(const std::string &url);
+
+        void clear();
+
+        /*
+         * take the warm pipeline of the url, return nullptr if the url is not preloaded,
+         * the item is stopped and removed from the manager.
+         */
+        std::unique_ptr<PreloadItem> acquire(const std::string &url);
+
+        std::string getInfo();
+
+        // for the items, the bytes are taken anyway, return false if the budget is exceeded
+        bool requestMemory(int64_t bytes);
+
+        void releaseMemory(int64_t bytes);
+
+        bool requestBandwidth(int64_t bytes);
+
+    private:
+        PlayerPreloadManager() = default;
+
+        ~PlayerPreloadManager();
+
+        void schedule();
+
+    private:
+        std::mutex mMutex{};
+        std::mutex mConfigMutex{};
+        Config mConfig{};
+        std::list<std::string> mUrls{};
+        std::list<std::unique_ptr<PreloadItem>> mItems{};
+
+        std::atomic<int64_t> mUsedMemory{0};
+
+        std::mutex mBandwidthMutex{};
+        int64_t mBandwidthWindowStart{0};
+        int64_t mBandwidthWindowBytes{0};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_PLAYERPRELOADMANAGER_H
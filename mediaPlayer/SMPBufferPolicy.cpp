@@ -0,0 +1,146 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "SMPBufferPolicy"
+
+#include "SMPBufferPolicy.h"
+#include <algorithm>
+#include <cmath>
+
+// short windows, the startup buffer is filled in a few hundreds ms on a fast link
+#define SAMPLE_WINDOW_US (50 * 1000)
+#define MIN_SAMPLES 3
+#define SMOOTH_ALPHA 0.2
+// the start buffer is shortened to 1/4 at most
+#define MAX_SPEED_RATIO 4.0
+// the resume buffer is lengthened to 4x at most on a slow link
+#define MIN_SLOW_RATIO 0.25
+
+namespace Cicada {
+
+    void SMPBufferPolicy::onRead(int64_t bytes, int64_t timeUs)
+    {
+        // the bytes of the first read came in an unknown time
+        if (mWindowStart == INT64_MIN) {
+            mWindowStart = timeUs;
+            mWindowBytes = 0;
+            return;
+        }
+
+        mWindowBytes += bytes;
+        int64_t duration = timeUs - mWindowStart;
+
+        if (duration < SAMPLE_WINDOW_US) {
+            return;
+        }
+
+        if (mDropWindow) {
+            mDropWindow = false;
+            mWindowStart = timeUs;
+            mWindowBytes = 0;
+            return;
+        }
+
+        double sample = (double) mWindowBytes * 8 * 1000000 / duration;
+
+        if (mSamples == 0) {
+            mMean = sample;
+            mVariance = 0;
+        } else {
+            double diff = sample - mMean;
+            double increment = SMOOTH_ALPHA * diff;
+            mMean += increment;
+            mVariance = (1 - SMOOTH_ALPHA) * (mVariance + diff * increment);
+        }
+
+        mSamples++;
+        mWindowStart = timeUs;
+        mWindowBytes = 0;
+    }
+
+    void SMPBufferPolicy::onReadBlocked()
+    {
+        mWindowStart = INT64_MIN;
+        mWindowBytes = 0;
+        mDropWindow = true;
+    }
+
+    double SMPBufferPolicy::getSpeedRatio() const
+    {
+        if (mSamples < MIN_SAMPLES || mBitrate <= 0) {
+            return -1;
+        }
+
+        return std::max(mMean - sqrt(mVariance), 0.0) / mBitrate;
+    }
+
+    int64_t SMPBufferPolicy::getStartBufferDuration(int64_t configured, int64_t high) const
+    {
+        double ratio = getSpeedRatio();
+
+        if (ratio < 0) {
+            return configured;
+        }
+
+        if (ratio >= 1) {
+            return (int64_t) (configured / std::min(ratio, MAX_SPEED_RATIO));
+        }
+
+        // buffer more to play longer before the next stall
+        return configured + (int64_t) ((1 - ratio) * std::max(high - configured, (int64_t) 0));
+    }
+
+    int64_t SMPBufferPolicy::getHighBufferDuration(int64_t configured, int64_t max) const
+    {
+        double ratio = getSpeedRatio();
+
+        if (ratio < 0) {
+            return configured;
+        }
+
+        double variation = mMean > 0 ? std::min(sqrt(mVariance) / mMean, 1.0) : 0;
+        double duration = configured * (1 + variation);
+
+        if (ratio < 1) {
+            duration /= std::max(ratio, MIN_SLOW_RATIO);
+        }
+
+        return std::max(std::min((int64_t) duration, max), configured);
+    }
+
+    int64_t SMPBufferPolicy::getMaxBufferDuration(int64_t configured, int64_t high) const
+    {
+        if (mMemoryCap == INT64_MAX || mBitrate <= 0) {
+            return configured;
+        }
+
+        int64_t cap = (int64_t) ((double) mMemoryCap * 8 * 1000000 / mBitrate);
+        return std::max(std::min(configured, cap), high);
+    }
+
+    int64_t SMPBufferPolicy::getMemoryFloor(int64_t start, int64_t high, bool buffering)
+    {
+        return buffering ? std::max(start, high) : start;
+    }
+
+    bool SMPBufferPolicy::isBufferingDone(int64_t buffered, int64_t high, int64_t max, bool full, bool memoryLimited)
+    {
+        return buffered > high || (high >= max && full) || memoryLimited;
+    }
+
+    int64_t SMPBufferPolicy::getThroughput() const
+    {
+        return mSamples > 0 ? (int64_t) mMean : 0;
+    }
+
+    void SMPBufferPolicy::reset()
+    {
+        mMean = 0;
+        mVariance = 0;
+        mSamples = 0;
+        mWindowStart = INT64_MIN;
+        mWindowBytes = 0;
+        mDropWindow = false;
+        mBitrate = 0;
+    }
+}// namespace Cicada
@@ -0,0 +1,79 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_SMPBUFFERPOLICY_H
+#define CICADAMEDIA_SMPBUFFERPOLICY_H
+
+#include <cstdint>
+
+namespace Cicada {
+    /*
+     * Derive the buffer durations from the bytes instead of using the configured ones as they are. The download
+     * throughput is sampled in short windows when the reading is not blocked, its mean and variance are smoothed,
+     * and compared with the bitrate of the buffered packets:
+     * - the start buffer is shorter on a link faster than the media, and longer on a slower one
+     * - the buffer to resume after a rebuffering is longer on a slow or unstable link
+     * - the max buffer is capped by the memory the packets may use
+     * The configured durations are used until there are enough samples.
+     */
+    class SMPBufferPolicy {
+    public:
+        SMPBufferPolicy() = default;
+
+        ~SMPBufferPolicy() = default;
+
+        // the bytes read in, at the time
+        void onRead(int64_t bytes, int64_t timeUs);
+
+        // the reading is stopped by a full buffer or the end, the time until the next read is not counted, neither the
+        // first window after it, the data piled in the socket comes in a burst
+        void onReadBlocked();
+
+        // the bitrate of the buffered packets in bps, 0 if unknown
+        void setBitrate(int64_t bitrate)
+        {
+            mBitrate = bitrate;
+        }
+
+        // the bytes the packets may take, INT64_MAX if no limit
+        void setMemoryCap(int64_t bytes)
+        {
+            mMemoryCap = bytes;
+        }
+
+        int64_t getStartBufferDuration(int64_t configured, int64_t high) const;
+
+        int64_t getHighBufferDuration(int64_t configured, int64_t max) const;
+
+        int64_t getMaxBufferDuration(int64_t configured, int64_t high) const;
+
+        // the buffer the memory budget can't shrink, a rebuffering must reach the high buffer to end
+        static int64_t getMemoryFloor(int64_t start, int64_t high, bool buffering);
+
+        // the buffering ends at the high buffer, or when the buffer is stopped by the max duration or the memory
+        static bool isBufferingDone(int64_t buffered, int64_t high, int64_t max, bool full, bool memoryLimited);
+
+        // the smoothed throughput in bps, 0 if not measured
+        int64_t getThroughput() const;
+
+        void reset();
+
+    private:
+        // the conservative throughput over the bitrate, -1 if unknown
+        double getSpeedRatio() const;
+
+    private:
+        double mMean{0};
+        double mVariance{0};
+        int mSamples{0};
+        int64_t mWindowStart{INT64_MIN};
+        int64_t mWindowBytes{0};
+        bool mDropWindow{false};
+        int64_t mBitrate{0};
+        int64_t mMemoryCap{INT64_MAX};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_SMPBUFFERPOLICY_H
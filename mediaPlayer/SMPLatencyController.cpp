@@ -0,0 +1,85 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "SMPLatencyController"
+
+#include "SMPLatencyController.h"
+#include <algorithm>
+#include <cmath>
+#include <utils/frame_work_log.h>
+
+// the time constant of the delay smoothing, the buffered duration jumps with every packet arrived
+#define SMOOTH_TIME_MS 500
+// 1s late to play at 1.1x
+#define RATE_PER_SECOND 0.1
+// slower than this is hard to converge
+#define MIN_RATE_DELTA 0.02f
+#define RATE_STEP 0.01f
+#define MIN_CHANGE_INTERVAL_MS 500
+
+namespace Cicada {
+
+    void SMPLatencyController::setRateRange(float minRate, float maxRate)
+    {
+        mMinRate = std::min(minRate, 1.0f);
+        mMaxRate = std::max(maxRate, 1.0f);
+    }
+
+    void SMPLatencyController::reset()
+    {
+        mRate = 1.0f;
+        mHasDelay = false;
+        mLastChangeTime = 0;
+    }
+
+    float SMPLatencyController::update(int64_t delayUs, int64_t targetUs, int64_t bandUs, int64_t nowMs)
+    {
+        if (!mHasDelay) {
+            mDelay = (double) delayUs;
+            mHasDelay = true;
+        } else {
+            double factor = std::min((double) (nowMs - mLastUpdateTime) / SMOOTH_TIME_MS, 1.0);
+            mDelay += ((double) delayUs - mDelay) * factor;
+        }
+
+        mLastUpdateTime = nowMs;
+        double error = mDelay - (double) targetUs;
+        float rate = mRate;
+
+        if (mRate == 1.0f) {
+            if (fabs(error) > (double) bandUs / 2) {
+                rate = 1.0f + (float) (error / 1000000 * RATE_PER_SECOND);
+            }
+        } else if ((mRate > 1.0f && error <= 0) || (mRate < 1.0f && error >= 0)) {
+            // back to the target, the error is in the band now
+            rate = 1.0f;
+        } else {
+            rate = 1.0f + (float) (error / 1000000 * RATE_PER_SECOND);
+        }
+
+        if (rate != 1.0f) {
+            if (rate > 1.0f) {
+                rate = std::max(rate, 1.0f + MIN_RATE_DELTA);
+            } else {
+                rate = std::min(rate, 1.0f - MIN_RATE_DELTA);
+            }
+
+            rate = std::min(std::max(rate, mMinRate), mMaxRate);
+            rate = roundf(rate / RATE_STEP) * RATE_STEP;
+
+            if (fabsf(rate - 1.0f) < RATE_STEP / 2) {
+                rate = 1.0f;
+            }
+        }
+
+        // stop at once, but not change the correction too often
+        if (fabsf(rate - mRate) < RATE_STEP / 2 || (rate != 1.0f && mRate != 1.0f && nowMs - mLastChangeTime < MIN_CHANGE_INTERVAL_MS)) {
+            return mRate;
+        }
+
+        AF_LOGD("latency %lld target %lld, rate %f to %f\n", (int64_t) mDelay, targetUs, mRate, rate);
+        mRate = rate;
+        mLastChangeTime = nowMs;
+        return mRate;
+    }
+}// namespace Cicada
@@ -0,0 +1,46 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_SMPLATENCYCONTROLLER_H
+#define CICADAMEDIA_SMPLATENCYCONTROLLER_H
+
+#include <cstdint>
+
+namespace Cicada {
+    /*
+     * Hold the live latency in [target - band, target + band] by small playback rate changes instead of dropping data.
+     * The delay is smoothed, the correction starts when it is out of half of the band and stops when it is back to the
+     * target. The rate is proportional to the error and quantized, so the audio stretcher sees a few steps only.
+     */
+    class SMPLatencyController {
+    public:
+        SMPLatencyController() = default;
+
+        ~SMPLatencyController() = default;
+
+        void setRateRange(float minRate, float maxRate);
+
+        // return the rate to play at, nowMs is the steady time
+        float update(int64_t delayUs, int64_t targetUs, int64_t bandUs, int64_t nowMs);
+
+        void reset();
+
+        bool isAdjusting() const
+        {
+            return mRate != 1.0f;
+        }
+
+    private:
+        float mMinRate{0.95f};
+        float mMaxRate{1.1f};
+        float mRate{1.0f};
+        double mDelay{0};
+        bool mHasDelay{false};
+        int64_t mLastUpdateTime{0};
+        int64_t mLastChangeTime{0};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_SMPLATENCYCONTROLLER_H
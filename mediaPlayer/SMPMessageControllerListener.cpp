@@ -6,6 +6,7 @@
 
 #include "SuperMediaPlayer.h"
 #include "media_player_error_def.h"
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <data_source/dataSourcePrototype.h>
@@ -19,6 +20,8 @@
 #define HAVE_AUDIO (mPlayer.mCurrentAudioIndex >= 0)
 #define HAVE_SUBTITLE (mPlayer.mCurrentSubtitleIndex >= 0)
 #define PTS_DISCONTINUE_DELTA (20 * 1000 * 1000)
+#define MAX_AUDIO_SPEED 2.0f
+#define MAX_TRICK_PLAY_SPEED 16.0f
 using namespace Cicada;
 SMPMessageControllerListener::SMPMessageControllerListener(SuperMediaPlayer &player) : mPlayer(player)
 {}
@@ -42,7 +45,8 @@ bool SMPMessageControllerListener::OnPlayerMsgIsPadding(PlayMsgType msg, MsgPara
             break;
 
         case MSG_SEEKTO:
-            if (mPlayer.mSeekFlag) {
+            // wait for the frame of the last seek, unless a newer target arrived
+            if (mPlayer.mSeekFlag && !mPlayer.mSeekSuperseded) {
                 padding = true;
             }
 
@@ -55,6 +59,29 @@ bool SMPMessageControllerListener::OnPlayerMsgIsPadding(PlayMsgType msg, MsgPara
     return padding;
 }
 
+bool SMPMessageControllerListener::OnPlayerMsgIsPlaying()
+{
+    return mPlayer.mPlayStatus == PLAYER_PLAYING;
+}
+
+void SMPMessageControllerListener::OnPlayerMsgSuperseded(PlayMsgType msg, MsgParam msgContent)
+{
+    if (msg != MSG_SEEKTO) {
+        return;
+    }
+
+    // reset by ProcessSeekToMsg, so it only affects the seek in processing
+    mPlayer.mSeekSuperseded = true;
+    std::lock_guard<std::mutex> lock(mPlayer.mSeekAbortMutex);
+
+    // the demuxer seek may block on network, interrupt it, it'll be resumed after Seek returned
+    if (mPlayer.mInDemuxerSeek && !mPlayer.mDemuxerSeekAborted) {
+        AF_LOGI("abort the seek to %lld for %lld\n", mPlayer.mSeekPos.load(), msgContent.seekParam.seekPos);
+        mPlayer.mDemuxerSeekAborted = true;
+        mPlayer.mDemuxerService->interrupt(1);
+    }
+}
+
 void SMPMessageControllerListener::ProcessPrepareMsg()
 {
     AF_LOGD("ProcessPrepareMsg start");
@@ -77,9 +104,11 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
 
     if (!(mPlayer.mBSReadCb != nullptr && mPlayer.mBSSeekCb != nullptr && mPlayer.mBSCbArg != nullptr)) {
         if (!mPlayer.mSet->url.empty()) {
+            mPlayer.mMetrics.start(SMPMetrics::TIMING_OPEN, af_getsteady_ms());
             ret = openUrl();
 
             if (ret < 0) {
+                mPlayer.mMetrics.cancel(SMPMetrics::TIMING_OPEN);
                 AF_LOGD("%s mDataSource open failed,url is %s %s", __FUNCTION__, mPlayer.mSet->url.c_str(), framework_err2_string(ret));
 
                 if (ret == FRAMEWORK_ERR_EXIT) {
@@ -96,6 +125,9 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
                 if (mPlayer.mDataSource->getFlags() & IDataSource::flag_report_speed) {
                     mPlayer.mCalculateSpeedUsePacket = false;
                 }
+
+                mPlayer.mMetrics.end(SMPMetrics::TIMING_OPEN, af_getsteady_ms());
+                recordConnectMetrics();
             }
         }
     }
@@ -106,7 +138,13 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
 
     {
         std::lock_guard<std::mutex> locker(mPlayer.mCreateMutex);
-        mPlayer.mDemuxerService = static_cast<unique_ptr<demuxer_service>>(new demuxer_service(mPlayer.mDataSource));
+
+        if (mPlayer.mPreloadItem && mPlayer.mPreloadItem->mDemuxerService) {
+            mPlayer.mDemuxerService = move(mPlayer.mPreloadItem->mDemuxerService);
+        } else {
+            mPlayer.mDemuxerService = static_cast<unique_ptr<demuxer_service>>(new demuxer_service(mPlayer.mDataSource));
+        }
+
         mPlayer.mDemuxerService->setOptions(&mPlayer.mSet->mOptions);
     }
 
@@ -116,7 +154,9 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
     mPlayer.mDemuxerService->setDemuxerCb(demuxerCB);
     mPlayer.mDemuxerService->setNoFile(noFile);
 
-    if (!noFile) {
+    bool preloaded = mPlayer.mPreloadItem != nullptr && mPlayer.mDemuxerService->getDemuxerHandle() != nullptr;
+
+    if (!noFile && !preloaded) {
         mPlayer.mDemuxerService->SetDataCallBack(mPlayer.mBSReadCb, mPlayer.mBSCbArg, mPlayer.mBSSeekCb, mPlayer.mBSCbArg, nullptr);
     }
 
@@ -137,7 +177,10 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
 #endif
 
     AF_LOGD("initOpen start");
-    ret = mPlayer.mDemuxerService->createDemuxer((mPlayer.mBSReadCb || noFile) ? demuxer_type_bit_stream : demuxer_type_unknown);
+
+    if (!preloaded) {
+        ret = mPlayer.mDemuxerService->createDemuxer((mPlayer.mBSReadCb || noFile) ? demuxer_type_bit_stream : demuxer_type_unknown);
+    }
 
     // TODO: video tool box HW decoder not merge the header
     if (mPlayer.mDemuxerService->getDemuxerHandle()) {
@@ -161,9 +204,15 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
 
 
     //step2: Demuxer init and getstream index
-    ret = mPlayer.mDemuxerService->initOpen((mPlayer.mBSReadCb || noFile) ? demuxer_type_bit_stream : demuxer_type_unknown);
+    if (!preloaded) {
+        mPlayer.mMetrics.start(SMPMetrics::TIMING_PROBE, af_getsteady_ms());
+    }
+
+    ret = preloaded ? 0 : mPlayer.mDemuxerService->initOpen((mPlayer.mBSReadCb || noFile) ? demuxer_type_bit_stream : demuxer_type_unknown);
 
     if (ret < 0) {
+        mPlayer.mMetrics.cancel(SMPMetrics::TIMING_PROBE);
+
         if (ret != FRAMEWORK_ERR_EXIT && !mPlayer.mCanceled) {
             mPlayer.NotifyError(ret);
         }
@@ -171,6 +220,7 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
         return;
     }
 
+    mPlayer.mMetrics.end(SMPMetrics::TIMING_PROBE, af_getsteady_ms());
     int nbStream = mPlayer.mDemuxerService->GetNbStreams();
     AF_LOGD("Demuxer service get nubmer streams is %d", nbStream);
     unique_ptr<streamMeta> pMeta;
@@ -337,6 +387,10 @@ void SMPMessageControllerListener::ProcessPrepareMsg()
         }
     }
 
+    if (preloaded) {
+        adoptPreloadItem();
+    }
+
     Media_meta pMediaMeta{};
     mPlayer.mDemuxerService->GetMediaMeta(&pMediaMeta);
     mPlayer.mMediaInfo.totalBitrate = pMediaMeta.totalBitrate;
@@ -389,6 +443,32 @@ void SMPMessageControllerListener::buildContainerInfo()
     mPlayer.mContainerInfo = containerInfo.printJSON();
 }
 
+void SMPMessageControllerListener::recordConnectMetrics()
+{
+    CicadaJSONItem connectInfo(mPlayer.mDataSource->GetOption("connectInfo"));
+
+    if (!connectInfo.isValid()) {
+        return;
+    }
+
+    // the costs are accumulated from the request start, split them into the phases
+    int dnsCost = connectInfo.getInt("dnsCost", -1);
+    int connectCost = connectInfo.getInt("connectCost", -1);
+    int ttfbCost = connectInfo.getInt("ttfbCost", -1);
+
+    if (dnsCost >= 0) {
+        mPlayer.mMetrics.recordLatency("startup.dns", dnsCost);
+    }
+
+    if (connectCost >= 0) {
+        mPlayer.mMetrics.recordLatency("startup.connect", connectCost - std::max(dnsCost, 0));
+    }
+
+    if (ttfbCost >= 0) {
+        mPlayer.mMetrics.recordLatency("startup.ttfb", ttfbCost - std::max(connectCost, 0));
+    }
+}
+
 void SMPMessageControllerListener::ProcessStartMsg()
 {
     if (mPlayer.mPlayStatus == PLAYER_PAUSED || mPlayer.mPlayStatus == PLAYER_PREPARED || mPlayer.mPlayStatus == PLAYER_COMPLETION) {
@@ -403,6 +483,17 @@ void SMPMessageControllerListener::ProcessStartMsg()
         }
 
         mPlayer.ChangePlayerStatus(PLAYER_PLAYING);
+
+        if (!mPlayer.mFirstRendered) {
+            if (mPlayer.mRecorderSet->startTimeMs == INT64_MIN) {
+                mPlayer.mRecorderSet->startTimeMs = af_getsteady_ms();
+            }
+
+            // the pre-rolled frame is ready, show it now, the clock is started by the loop when the audio is ready
+            if (mPlayer.mSet->mPreRoll && HAVE_VIDEO && !mPlayer.mVideoFrameQue.empty() && !mPlayer.mBufferingFlag) {
+                mPlayer.RenderVideo(true);
+            }
+        }
     }
 }
 
@@ -478,6 +569,7 @@ void SMPMessageControllerListener::ProcessSetBitStreamMsg(readCB read, seekCB se
 
 void SMPMessageControllerListener::ProcessSeekToMsg(int64_t seekPos, bool bAccurate)
 {
+    mPlayer.mSeekSuperseded = false;
     mPlayer.mSeekNeedCatch = bAccurate;
     mPlayer.mSeekPos = seekPos;
 
@@ -493,6 +585,13 @@ void SMPMessageControllerListener::ProcessSeekToMsg(int64_t seekPos, bool bAccur
         mPlayer.ResetSeekStatus();
         return;
     }
+
+    if (mPlayer.mScrubbing) {
+        seekPos = mPlayer.getScrubKeyFramePos(seekPos);
+        mPlayer.mSeekNeedCatch = false;
+        mPlayer.mSeekPos = seekPos;
+    }
+
     //checkPosInPackQueue cache in seek
     //TODO: seek sync
     mPlayer.mSeekFlag = true;
@@ -513,9 +612,24 @@ void SMPMessageControllerListener::ProcessSeekToMsg(int64_t seekPos, bool bAccur
 */
     if (!mPlayer.mSeekInCache) {
         mPlayer.mBufferController->ClearPacket(BUFFER_TYPE_ALL);
+        {
+            std::lock_guard<std::mutex> lock(mPlayer.mSeekAbortMutex);
+            mPlayer.mInDemuxerSeek = true;
+        }
         int64_t ret = mPlayer.mDemuxerService->Seek(seekPos, 0, -1);
+        bool aborted;
+        {
+            std::lock_guard<std::mutex> lock(mPlayer.mSeekAbortMutex);
+            mPlayer.mInDemuxerSeek = false;
+            aborted = mPlayer.mDemuxerSeekAborted;
+
+            if (aborted) {
+                mPlayer.mDemuxerService->interrupt(0);
+                mPlayer.mDemuxerSeekAborted = false;
+            }
+        }
 
-        if (ret < 0) {
+        if (ret < 0 && !aborted) {
             mPlayer.NotifyError(ret);
         }
         //in case of seekpos larger than duration.
@@ -621,6 +735,11 @@ void SMPMessageControllerListener::ProcessSwitchStreamMsg(int index)
             return;
         }
         mPlayer.mVideoChangedFirstPts = INT64_MAX;
+
+        if (type != STREAM_TYPE_AUDIO && type != STREAM_TYPE_SUB) {
+            mPlayer.mMetrics.start(SMPMetrics::TIMING_ABR_SWITCH, af_getsteady_ms());
+        }
+
         mPlayer.mDemuxerService->SwitchStreamAligned(fromIndex, toIndex);
         return;
     }
@@ -636,6 +755,7 @@ void SMPMessageControllerListener::ProcessSwitchStreamMsg(int index)
         mPlayer.mVideoChangedFirstPts = INT64_MAX;
         mPlayer.mAudioChangedFirstPts = INT64_MAX;
         mPlayer.mEof = false;
+        mPlayer.mMetrics.start(SMPMetrics::TIMING_ABR_SWITCH, af_getsteady_ms());
         switchVideoStream(id, type);
         return;
     }
@@ -645,6 +765,7 @@ void SMPMessageControllerListener::ProcessSwitchStreamMsg(int index)
     } else if (type == STREAM_TYPE_AUDIO && mPlayer.mCurrentAudioIndex >= 0 && mPlayer.mCurrentAudioIndex != index) {
         return switchAudio(index);
     } else if (type == STREAM_TYPE_VIDEO && mPlayer.mCurrentVideoIndex >= 0 && mPlayer.mCurrentVideoIndex != index) {
+        mPlayer.mMetrics.start(SMPMetrics::TIMING_ABR_SWITCH, af_getsteady_ms());
         return switchVideoStream(index, type);
     }
 }
@@ -694,6 +815,7 @@ void SMPMessageControllerListener::ProcessRenderedMsg(StreamType type, IAFFrame:
         }
         if (rendered) {
             mPlayer.checkFirstRender();
+            mPlayer.mMetrics.addCount("render.videoFrames");
         }
 
         if (!mPlayer.mSeekFlag) {
@@ -707,6 +829,7 @@ void SMPMessageControllerListener::ProcessRenderedMsg(StreamType type, IAFFrame:
             StreamInfo *pInfo = mPlayer.GetCurrentStreamInfo(ST_TYPE_VIDEO);
             mPlayer.mPNotifier->NotifyStreamChanged(pInfo, ST_TYPE_VIDEO);
             mPlayer.mVideoChangedFirstPts = INT64_MIN;
+            mPlayer.mMetrics.end(SMPMetrics::TIMING_ABR_SWITCH, af_getsteady_ms());
         }
 
         assert(mPlayer.mDemuxerService);
@@ -756,12 +879,26 @@ void SMPMessageControllerListener::ProcessSetSpeed(float speed)
 {
     if (speed < 0.5f) {
         speed = 0.5f;
-    } else if (speed > 2.0f) {
-        speed = 2.0f;
+    } else if (speed > MAX_AUDIO_SPEED) {
+        // too fast for the audio, only the I-frames are played if the source has an I-frame rendition
+        if (mPlayer.setTrickPlay(true)) {
+            speed = std::min(speed, MAX_TRICK_PLAY_SPEED);
+        } else {
+            speed = MAX_AUDIO_SPEED;
+        }
+    }
+
+    if (speed <= MAX_AUDIO_SPEED) {
+        mPlayer.setTrickPlay(false);
     }
 
     if (!CicadaUtils::isEqual(mPlayer.mSet->rate, speed)) {
-        mPlayer.mAVDeviceManager->setSpeed(speed);
+        if (!mPlayer.mTrickPlay) {
+            mPlayer.mAVDeviceManager->setSpeed(speed);
+        } else if (mPlayer.mAVDeviceManager->isVideoRenderValid()) {
+            mPlayer.mAVDeviceManager->getVideoRender()->setSpeed(speed);
+        }
+
         mPlayer.mSet->rate = speed;
         mPlayer.mMasterClock.SetScale(speed);
 #ifdef ENABLE_VIDEO_FILTER
@@ -923,6 +1060,28 @@ void SMPMessageControllerListener::switchSubTitle(int index)
     mPlayer.mDemuxerService->Seek(mPlayer.getCurrentPosition(), 0, index);
 }
 
+void SMPMessageControllerListener::adoptPreloadItem()
+{
+    PreloadItem *item = mPlayer.mPreloadItem.get();
+    int videoIndex = mPlayer.mMixMode ? mPlayer.mMainStreamId : mPlayer.mCurrentVideoIndex;
+
+    // close the streams that preloaded but not selected by the player
+    if (item->mVideoIndex >= 0 && item->mVideoIndex != videoIndex) {
+        mPlayer.mDemuxerService->CloseStream(item->mVideoIndex);
+    }
+
+    if (item->mAudioIndex >= 0 && item->mAudioIndex != mPlayer.mCurrentAudioIndex && item->mAudioIndex != mPlayer.mMainStreamId) {
+        mPlayer.mDemuxerService->CloseStream(item->mAudioIndex);
+    }
+
+    if (item->mFirstVideoFrame && item->mVideoIndex == videoIndex && !mPlayer.mMixMode) {
+        mPlayer.mPreloadedVideoPts = item->mFirstVideoFrame->getInfo().pts;
+        mPlayer.mVideoFrameQue.push(move(item->mFirstVideoFrame));
+    }
+
+    AF_LOGI("prepare with preloaded pipeline, %lld bytes buffered\n", item->getBufferedBytes());
+}
+
 int SMPMessageControllerListener::openUrl()
 {
     IDataSource::SourceConfig config{};
@@ -953,6 +1112,22 @@ int SMPMessageControllerListener::openUrl()
         return FRAMEWORK_ERR_EXIT;
     }
 
+    if (mPlayer.mSeekPos <= 0) {
+        mPlayer.mPreloadItem = PlayerPreloadManager::getInstance()->acquire(mPlayer.mSet->url);
+    }
+
+    if (mPlayer.mPreloadItem) {
+        // the data source is opened already by the preload manager
+        {
+            std::lock_guard<std::mutex> locker(mPlayer.mCreateMutex);
+            mPlayer.mDataSource = mPlayer.mPreloadItem->mDataSource;
+            mPlayer.mPreloadItem->mDataSource = nullptr;
+        }
+        mPlayer.mDataSource->setUrlToUniqueIdCallback(mPlayer.mUrlHashCb, mPlayer.mUrlHashCbUserData);
+        mPlayer.mDataSource->Set_config(config);
+        return 0;
+    }
+
     {
         std::lock_guard<std::mutex> locker(mPlayer.mCreateMutex);
         mPlayer.mDataSource = dataSourcePrototype::create(mPlayer.mSet->url, &(mPlayer.mSet->mOptions), DS_NEED_CACHE);
@@ -25,6 +25,10 @@ namespace Cicada {
     private:
         bool OnPlayerMsgIsPadding(PlayMsgType msg, MsgParam msgContent) final;
 
+        void OnPlayerMsgSuperseded(PlayMsgType msg, MsgParam msgContent) final;
+
+        bool OnPlayerMsgIsPlaying() final;
+
         void ProcessPrepareMsg() final;
 
         void ProcessStartMsg() final;
@@ -58,8 +62,12 @@ namespace Cicada {
         void switchSubTitle(int index);
         int openUrl();
 
+        void adoptPreloadItem();
+
         void buildContainerInfo();
 
+        void recordConnectMetrics();
+
     private:
         SuperMediaPlayer &mPlayer;
     };
@@ -0,0 +1,172 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "SMPMetrics.h"
+#include <utils/CicadaJSON.h>
+
+// the decoder is taken as idle if no frame out for a while, paused or buffering
+#define DECODE_IDLE_MS 500
+#define DECODE_WINDOW_MS 1000
+
+using namespace std;
+
+namespace Cicada {
+
+    const char *SMPMetrics::getTimingName(Timing timing)
+    {
+        switch (timing) {
+            case TIMING_STARTUP:
+                return "startup.firstFrame";
+            case TIMING_OPEN:
+                return "startup.open";
+            case TIMING_PROBE:
+                return "startup.probe";
+            case TIMING_SEEK:
+                return "seek.firstFrame";
+            case TIMING_SEEK_AUDIO:
+                return "seek.audioResume";
+            case TIMING_REBUFFER:
+                return "rebuffer.duration";
+            case TIMING_ABR_SWITCH:
+                return "abr.switch";
+            default:
+                return "unknown";
+        }
+    }
+
+    const char *SMPMetrics::getDropReasonName(DropReason reason)
+    {
+        switch (reason) {
+            case DROP_REASON_LATE:
+                return "drop.late";
+            case DROP_REASON_CATCH_UP:
+                return "drop.catchUp";
+            case DROP_REASON_DECODER_BEHIND:
+                return "drop.decoderBehind";
+            default:
+                return "drop.unknown";
+        }
+    }
+
+    void SMPMetrics::start(Timing timing, int64_t nowMs)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStartTimes[timing] = nowMs;
+    }
+
+    int64_t SMPMetrics::end(Timing timing, int64_t nowMs)
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        if (mStartTimes[timing] == INT64_MIN) {
+            return -1;
+        }
+
+        int64_t value = nowMs - mStartTimes[timing];
+        mStartTimes[timing] = INT64_MIN;
+        mHistograms[getTimingName(timing)].record(value);
+        return value;
+    }
+
+    void SMPMetrics::cancel(Timing timing)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStartTimes[timing] = INT64_MIN;
+    }
+
+    bool SMPMetrics::isStarted(Timing timing)
+    {
+        lock_guard<mutex> lock(mMutex);
+        return mStartTimes[timing] != INT64_MIN;
+    }
+
+    void SMPMetrics::recordLatency(const string &name, int64_t value)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mHistograms[name].record(value);
+    }
+
+    void SMPMetrics::addCount(const string &name, int64_t delta)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mCounters[name] += delta;
+    }
+
+    void SMPMetrics::addDrop(DropReason reason, int64_t count)
+    {
+        addCount(getDropReasonName(reason), count);
+    }
+
+    void SMPMetrics::onVideoFrameDecoded(int64_t nowMs)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mCounters["decode.videoFrames"]++;
+
+        if (mLastDecodedTime == INT64_MIN || nowMs - mLastDecodedTime > DECODE_IDLE_MS) {
+            mDecodeWindowStart = nowMs;
+            mDecodedFrames = 0;
+        }
+
+        mLastDecodedTime = nowMs;
+        mDecodedFrames++;
+
+        if (nowMs - mDecodeWindowStart >= DECODE_WINDOW_MS) {
+            mHistograms["decode.videoFps"].record(mDecodedFrames * 1000 / (nowMs - mDecodeWindowStart));
+            mDecodeWindowStart = nowMs;
+            mDecodedFrames = 0;
+        }
+    }
+
+    void SMPMetrics::reset()
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        for (int64_t &time : mStartTimes) {
+            time = INT64_MIN;
+        }
+
+        mDecodeWindowStart = INT64_MIN;
+        mLastDecodedTime = INT64_MIN;
+        mDecodedFrames = 0;
+    }
+
+    void SMPMetrics::clear()
+    {
+        reset();
+        lock_guard<mutex> lock(mMutex);
+        mHistograms.clear();
+        mCounters.clear();
+    }
+
+    string SMPMetrics::snapshot()
+    {
+        lock_guard<mutex> lock(mMutex);
+        CicadaJSONItem histograms{};
+
+        for (auto &item : mHistograms) {
+            const afHistogram &histogram = item.second;
+            CicadaJSONItem value{};
+            value.addValue("count", (double) histogram.getCount());
+            value.addValue("min", (double) histogram.getMin());
+            value.addValue("max", (double) histogram.getMax());
+            value.addValue("mean", histogram.getMean());
+            value.addValue("p50", (double) histogram.getPercentile(50));
+            value.addValue("p90", (double) histogram.getPercentile(90));
+            value.addValue("p95", (double) histogram.getPercentile(95));
+            value.addValue("p99", (double) histogram.getPercentile(99));
+            histograms.addItem(item.first, value);
+        }
+
+        CicadaJSONItem counters{};
+
+        for (auto &item : mCounters) {
+            counters.addValue(item.first, (double) item.second);
+        }
+
+        CicadaJSONItem json{};
+        json.addItem("histograms", histograms);
+        json.addItem("counters", counters);
+        return json.printJSON();
+    }
+}// namespace Cicada
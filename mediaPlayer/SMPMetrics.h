@@ -0,0 +1,97 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_SMPMETRICS_H
+#define CICADAMEDIA_SMPMETRICS_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utils/afHistogram.h>
+
+namespace Cicada {
+    /*
+     * The latency histograms and counters of a player, they are kept across the plays until cleared,
+     * so the p50/p99 of many sessions could be aggregated from the snapshots.
+     * The latencies are in ms, the timings started and not ended are dropped by reset.
+     */
+    class SMPMetrics {
+    public:
+        enum Timing {
+            TIMING_STARTUP = 0,
+            TIMING_OPEN,
+            TIMING_PROBE,
+            TIMING_SEEK,
+            // the first audio frame rendered after seek
+            TIMING_SEEK_AUDIO,
+            TIMING_REBUFFER,
+            TIMING_ABR_SWITCH,
+            TIMING_MAX,
+        };
+
+        enum DropReason {
+            // rendered too late
+            DROP_REASON_LATE = 0,
+            // skipped to the next key frame to catch up with the clock
+            DROP_REASON_CATCH_UP,
+            // dropped before decoding as the decoder can't keep up
+            DROP_REASON_DECODER_BEHIND,
+            DROP_REASON_MAX,
+        };
+
+    public:
+        SMPMetrics() = default;
+
+        ~SMPMetrics() = default;
+
+        void start(Timing timing, int64_t nowMs);
+
+        // record the time since start, return it, or -1 if not started
+        int64_t end(Timing timing, int64_t nowMs);
+
+        void cancel(Timing timing);
+
+        bool isStarted(Timing timing);
+
+        void recordLatency(const std::string &name, int64_t value);
+
+        void addCount(const std::string &name, int64_t delta = 1);
+
+        void addDrop(DropReason reason, int64_t count = 1);
+
+        // the output decoded frames, sampled to frames per second while the decoder is busy
+        void onVideoFrameDecoded(int64_t nowMs);
+
+        // cancel all the timings
+        void reset();
+
+        // remove all the values
+        void clear();
+
+        /*
+         * {"histograms":{"seek.firstFrame":{"count":1,"min":..,"max":..,"mean":..,"p50":..,"p90":..,"p95":..,"p99":..}},
+         *  "counters":{"drop.late":1}}
+         */
+        std::string snapshot();
+
+    public:
+        static const char *getTimingName(Timing timing);
+
+        static const char *getDropReasonName(DropReason reason);
+
+    private:
+        std::mutex mMutex{};
+        std::map<std::string, afHistogram> mHistograms{};
+        std::map<std::string, int64_t> mCounters{};
+        int64_t mStartTimes[TIMING_MAX]{INT64_MIN, INT64_MIN, INT64_MIN, INT64_MIN, INT64_MIN, INT64_MIN, INT64_MIN};
+
+        int64_t mDecodeWindowStart{INT64_MIN};
+        int64_t mLastDecodedTime{INT64_MIN};
+        int mDecodedFrames{0};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_SMPMETRICS_H
@@ -0,0 +1,108 @@
+//
+// Created by agent on 2026/10/19.
+//
+#define LOG_TAG "SMPPipelineReaper"
+
+#include "SMPPipelineReaper.h"
+#include <utils/frame_work_log.h>
+#include <utils/timer.h>
+
+#define REAPER_THREAD_NUM 2
+// the pipelines may be in releasing at the same time, a player stops synchronously beyond it
+#define MAX_PENDING_PIPELINES 8
+#define IDLE_WAIT_MS 100
+
+using namespace Cicada;
+
+SMPPipelineReaper &SMPPipelineReaper::getInstance()
+{
+    static SMPPipelineReaper sReaper;
+    return sReaper;
+}
+
+SMPPipelineReaper::SMPPipelineReaper()
+{
+    for (int i = 0; i < REAPER_THREAD_NUM; i++) {
+        mThreads.push_back(std::unique_ptr<afThread>(NEW_AF_THREAD(reapLoop)));
+    }
+}
+
+SMPPipelineReaper::~SMPPipelineReaper()
+{
+    for (auto &thread : mThreads) {
+        thread->stop();
+    }
+
+    mThreads.clear();
+
+    // release the left ones before exiting
+    for (auto &item : mItems) {
+        item.task();
+    }
+
+    mItems.clear();
+}
+
+void SMPPipelineReaper::post(const void *owner, Task task)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mPending >= MAX_PENDING_PIPELINES) {
+        AF_LOGW("%d pipelines in releasing, release synchronously\n", mPending);
+        lock.unlock();
+        task();
+        return;
+    }
+
+    mItems.push_back({owner, std::move(task)});
+    mPending++;
+    mOwnerPending[owner]++;
+
+    for (auto &thread : mThreads) {
+        if (thread->getStatus() != afThread::THREAD_STATUS_RUNNING) {
+            thread->start();
+        }
+    }
+
+    mCondition.notify_all();
+}
+
+void SMPPipelineReaper::wait(const void *owner)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this, owner]() { return mOwnerPending.find(owner) == mOwnerPending.end(); });
+}
+
+int SMPPipelineReaper::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending;
+}
+
+int SMPPipelineReaper::reapLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mItems.empty()) {
+        mCondition.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+        return 0;
+    }
+
+    Item item = std::move(mItems.front());
+    mItems.pop_front();
+    lock.unlock();
+
+    int64_t startTime = af_getsteady_ms();
+    item.task();
+    AF_LOGD("pipeline released in %lld ms\n", (long long) (af_getsteady_ms() - startTime));
+
+    lock.lock();
+    mPending--;
+
+    if (--mOwnerPending[item.owner] == 0) {
+        mOwnerPending.erase(item.owner);
+    }
+
+    mCondition.notify_all();
+    return 0;
+}
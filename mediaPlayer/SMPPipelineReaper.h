@@ -0,0 +1,66 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_SMPPIPELINEREAPER_H
+#define CICADAMEDIA_SMPPIPELINEREAPER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utils/afThread.h>
+#include <vector>
+
+namespace Cicada {
+    /*
+     * Release the detached pipelines (the demuxer and the data source) of the stopped players in background,
+     * the closing of the connections may block for seconds on a bad network.
+     * The number of the pipelines in releasing is bounded, beyond it post() runs the task on the calling thread, so
+     * the resources held by the old pipelines can't pile up, and post() never waits for the other players.
+     * So an asynchronous Stop only costs the detaching while fewer than the bound are in releasing, beyond it
+     * Stop costs the release of its own pipeline, as a synchronous one does.
+     * The owner must wait() its pipelines released before destroying the objects they refer to.
+     */
+    class SMPPipelineReaper {
+    public:
+        typedef std::function<void()> Task;
+
+    public:
+        static SMPPipelineReaper &getInstance();
+
+        // release in background, or on the calling thread if too many are in releasing
+        void post(const void *owner, Task task);
+
+        // wait until all the pipelines of the owner are released
+        void wait(const void *owner);
+
+        int getPendingCount();
+
+    private:
+        SMPPipelineReaper();
+
+        ~SMPPipelineReaper();
+
+        int reapLoop();
+
+    private:
+        struct Item {
+            const void *owner;
+            Task task;
+        };
+
+        std::mutex mMutex{};
+        std::condition_variable mCondition{};
+        std::deque<Item> mItems{};
+        // the pipelines queued or in releasing
+        int mPending{0};
+        std::map<const void *, int> mOwnerPending{};
+        std::vector<std::unique_ptr<afThread>> mThreads{};
+    };
+}// namespace Cicada
+
+
+#endif//CICADAMEDIA_SMPPIPELINEREAPER_H
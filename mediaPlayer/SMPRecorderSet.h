@@ -51,6 +51,8 @@ public:
     void reset() {
         createAudioDecoderCostMs = INT64_MIN;
         createVideoDecoderCostMs = INT64_MIN;
+        startTimeMs = INT64_MIN;
+        startToFirstFrameCostMs = INT64_MIN;
 
         decodeFirstAudioFrameInfo.reset();
         decodeFirstVideoFrameInfo.reset();
@@ -59,6 +61,9 @@ public:
 public:
     std::atomic<int64_t> createAudioDecoderCostMs{INT64_MIN};
     std::atomic<int64_t> createVideoDecoderCostMs{INT64_MIN};
+    // from the first start to the first frame shown
+    std::atomic<int64_t> startTimeMs{INT64_MIN};
+    std::atomic<int64_t> startToFirstFrameCostMs{INT64_MIN};
 
     DecodeFirstFrameInfo decodeFirstAudioFrameInfo{};
     DecodeFirstFrameInfo decodeFirstVideoFrameInfo{};
@@ -6,6 +6,7 @@
 #include "utils/CicadaJSON.h"
 #include "utils/CicadaUtils.h"
 #include "utils/UrlUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <codec/avcodecDecoder.h>
@@ -14,6 +15,7 @@
 #include <demuxer/IDemuxer.h>
 #include <render/renderFactory.h>
 #include <utils/AFMediaType.h>
+#include <utils/afTrace.h>
 #include <utils/af_string.h>
 #include <utils/err.h>
 #include <utils/errors/framework_error.h>
@@ -35,6 +37,9 @@
 
 #define PTS_DISCONTINUE_DELTA (20 * 1000 * 1000)
 #define VIDEO_PICTURE_MAX_CACHE_SIZE 2
+#ifdef ENABLE_HEADLESS_RENDER
+#define UNTHROTTLED_AUDIO_LEAD (40 * 1000)
+#endif
 
 static int MAX_DECODE_ERROR_FRAME = 1000;
 
@@ -64,6 +69,7 @@ SuperMediaPlayer::SuperMediaPlayer()
     mAudioRenderCB = static_cast<unique_ptr<ApsaraAudioRenderCallback>>(new ApsaraAudioRenderCallback(*this));
     mVideoRenderListener = static_cast<unique_ptr<ApsaraVideoRenderListener>>(new ApsaraVideoRenderListener(*this));
     mVideoProcessCb = static_cast<unique_ptr<ApsaraVideoProcessTextureCallback>>(new ApsaraVideoProcessTextureCallback(*this));
+    // not cooperative, the prepare and the stop do blocking io in the main service
     mApsaraThread = static_cast<unique_ptr<afThread>>(new afThread([this]() -> int { return this->mainService(); }, LOG_TAG));
     mSourceListener = static_cast<unique_ptr<SuperMediaPlayerDataSourceListener>>(new SuperMediaPlayerDataSourceListener(*this));
     mDcaManager = static_cast<unique_ptr<SMP_DCAManager>>(new SMP_DCAManager(*this));
@@ -81,6 +87,8 @@ SuperMediaPlayer::~SuperMediaPlayer()
         return;
     }
     Stop();
+    // the detached pipelines refer to the options and the listeners of this player
+    SMPPipelineReaper::getInstance().wait(this);
     AF_LOGD("~SuperMediaPlayer");
     mCanceled = true;
     mPlayerCondition.notify_one();
@@ -156,6 +164,10 @@ void SuperMediaPlayer::Prepare()
     AFAudioSessionWrapper::activeAudio();
 #endif
     mPrepareStartTime = af_gettime_relative();
+#ifdef ENABLE_HEADLESS_RENDER
+    mUnthrottled = string(getProperty("protected.clock.unthrottled")) == "ON";
+#endif
+    mMetrics.start(SMPMetrics::TIMING_STARTUP, af_getsteady_ms());
     std::unique_lock<std::mutex> uMutex(mPlayerMutex);
     putMsg(MSG_PREPARE, dummyMsg);
     mApsaraThread->start();
@@ -213,12 +225,25 @@ void SuperMediaPlayer::SeekTo(int64_t pos, bool bAccurate)
 {
     MsgParam param;
     MsgSeekParam seekParam;
+
+    if (mScrubbing) {
+        // preview the key frame only, the accurate seek is done when scrubbing end
+        mScrubPos = pos * 1000;
+        bAccurate = false;
+    }
+
     seekParam.seekPos = (int64_t) pos * 1000;
     seekParam.bAccurate = bAccurate;
     param.seekParam = seekParam;
     this->putMsg(MSG_SEEKTO, param);
     mSeekPos = pos * 1000;
     mSeekNeedCatch = bAccurate;
+    mMetrics.cancel(SMPMetrics::TIMING_REBUFFER);
+    mMetrics.start(SMPMetrics::TIMING_SEEK, af_getsteady_ms());
+
+    if (!mScrubbing) {
+        mMetrics.start(SMPMetrics::TIMING_SEEK_AUDIO, af_getsteady_ms());
+    }
 }
 
 void SuperMediaPlayer::Mute(bool bMute)
@@ -367,6 +392,10 @@ int SuperMediaPlayer::Stop()
     mMessageControl->clear();
     AF_TRACE;
 
+    if (mSet->mAsyncStop) {
+        releasePipelineAsync();
+    }
+
     if (mDemuxerService) {
         mDemuxerService->interrupt(1);
 
@@ -408,6 +437,8 @@ int SuperMediaPlayer::Stop()
         mDataSource = nullptr;
     }
 
+    mPreloadItem = nullptr;
+
     if (mAVDeviceManager->getVideoRender()) {
         // lock mAppStatusMutex before mCreateMutex
         std::lock_guard<std::mutex> lock(mAppStatusMutex);
@@ -442,6 +473,62 @@ int SuperMediaPlayer::Stop()
     return 0;
 }
 
+void SuperMediaPlayer::releasePipelineAsync()
+{
+    std::shared_ptr<demuxer_service> demuxer;
+    IDataSource *dataSource;
+    std::shared_ptr<PreloadItem> preloadItem;
+    std::vector<int> streams;
+
+    if (mDemuxerService) {
+        mDemuxerService->interrupt(1);
+
+        if (mMixMode) {
+            streams = {mMainStreamId, mCurrentSubtitleIndex};
+        } else {
+            streams = {mCurrentAudioIndex, mCurrentVideoIndex, mCurrentSubtitleIndex};
+        }
+    }
+
+    if (mDataSource) {
+        mDataSource->Interrupt(true);
+    }
+
+    {
+        std::lock_guard<std::mutex> uMutex(mCreateMutex);
+        demuxer = std::move(mDemuxerService);
+        dataSource = mDataSource;
+        mDataSource = nullptr;
+        // a preloaded pipeline refers to the options of the item, release it after the pipeline
+        preloadItem = std::move(mPreloadItem);
+    }
+
+    if (demuxer == nullptr && dataSource == nullptr) {
+        return;
+    }
+
+    SMPPipelineReaper::getInstance().post(this, [demuxer, dataSource, streams, preloadItem]() mutable {
+        if (demuxer) {
+            demuxer->stop();
+            demuxer->close();
+
+            for (int stream : streams) {
+                if (stream >= 0) {
+                    demuxer->CloseStream(stream);
+                }
+            }
+        }
+
+        if (dataSource) {
+            dataSource->Close();
+            delete dataSource;
+        }
+
+        demuxer = nullptr;
+        preloadItem = nullptr;
+    });
+}
+
 void SuperMediaPlayer::releaseStreamInfo(const StreamInfo *info) const
 {
     if (info->subtitleLang) {
@@ -544,6 +631,21 @@ int SuperMediaPlayer::SetOption(const char *key, const char *value)
         mSet->bDisableVideo = (atoi(value) != 0);
     } else if (theKey == "timerInterval") {
         mTimerInterval = atoi(value);
+    } else if (theKey == "stateEventInterval") {
+        mPNotifier->setStateEventInterval(atoi(value));
+    } else if (theKey == "coalesceRenderedEvents") {
+        mPNotifier->setCoalesceRenderedEvents(atoi(value) != 0);
+    } else if (theKey == "scrubbing") {
+        bool scrubbing = (atoi(value) != 0);
+
+        if (mScrubbing.exchange(scrubbing) && !scrubbing) {
+            int64_t scrubPos = mScrubPos.exchange(INT64_MIN);
+
+            if (scrubPos != INT64_MIN) {
+                AF_LOGI("scrubbing end at %lld\n", scrubPos);
+                SeekTo(scrubPos / 1000, true);
+            }
+        }
     } else if (theKey == "Analytics.ReportID") {
         if (nullptr == value) {
             return -1;
@@ -582,6 +684,10 @@ int SuperMediaPlayer::SetOption(const char *key, const char *value)
         mSet->mIpType = static_cast<IpResolveType>(type);
     } else if (theKey == "fastStart") {
         mSet->mFastStart = atol(value) != 0;
+    } else if (theKey == "preRoll") {
+        mSet->mPreRoll = atol(value) != 0;
+    } else if (theKey == "asyncStop") {
+        mSet->mAsyncStop = atol(value) != 0;
     } else if (theKey == "pixelBufferOutputFormat") {
         mSet->pixelBufferOutputFormat = atol(value);
     } else if (theKey == "liveStartIndex") {
@@ -597,6 +703,10 @@ int SuperMediaPlayer::SetOption(const char *key, const char *value)
         }
     } else if (theKey == "networkRetryCount") {
         mSet->netWorkRetryCount = (int) atol(value);
+    } else if (theKey == "adaptiveBuffer") {
+        mAdaptiveBuffer = (atoi(value) != 0);
+    } else if (theKey == "maxBufferMemoryKB") {
+        mMemAccount.setLimit(atoll(value) * 1024);
     } else if (theKey == "maxBackwardBufferDuration") {
         mBufferController->SetMaxBackwardDuration(BUFFER_TYPE_ALL, atoll(value) * 1000);
     } else if (theKey == "preferAudio") {
@@ -912,6 +1022,14 @@ std::string SuperMediaPlayer::GetPropertyString(PropertyKey key, const CicadaJSO
             item.addValue("startBufferDuration", (int) mSet->startBufferDuration);
             item.addValue("highLevelBufferDuration", (int) mSet->highLevelBufferDuration);
             item.addValue("maxBufferDuration", (int) mSet->maxBufferDuration);
+
+            if (mAdaptiveBuffer) {
+                item.addValue("adaptiveStartBufferDuration", (int) getStartBufferDuration());
+                item.addValue("adaptiveHighBufferDuration", (int) getHighBufferDuration());
+                item.addValue("adaptiveMaxBufferDuration", (int) getMaxBufferDuration());
+                item.addValue("throughput", (double) mBufferPolicy.getThroughput());
+            }
+
             return item.printJSON();
         }
         case PROPERTY_KEY_DECODE_INFO: {
@@ -932,6 +1050,8 @@ std::string SuperMediaPlayer::GetPropertyString(PropertyKey key, const CicadaJSO
                 videoDecodeInfo.addValue("decodeFirstCost", (int) mRecorderSet->decodeFirstVideoFrameInfo.getDecodeFirstFrameCost());
                 videoDecodeInfo.addValue("firstSize", (int) mRecorderSet->decodeFirstVideoFrameInfo.firstPacketSize);
                 videoDecodeInfo.addValue("firstPts", (double) mRecorderSet->decodeFirstVideoFrameInfo.firstPacketPts);
+                videoDecodeInfo.addValue("preRoll", mSet->mPreRoll);
+                videoDecodeInfo.addValue("startToFirstFrameCost", (int) mRecorderSet->startToFirstFrameCostMs);
                 decodeInfos.addJSON(videoDecodeInfo);
             }
 
@@ -984,6 +1104,22 @@ std::string SuperMediaPlayer::GetPropertyString(PropertyKey key, const CicadaJSO
         case PROPERTY_KEY_CONTAINER_INFO: {
             return mContainerInfo;
         }
+        case PROPERTY_KEY_METRICS: {
+            std::string metrics = mMetrics.snapshot();
+
+            if (param.getBool("clear", false)) {
+                mMetrics.clear();
+            }
+
+            return metrics;
+        }
+        case PROPERTY_KEY_MEMORY_USAGE: {
+            if (param.getBool("all", false)) {
+                return memoryGovernor::getGovernor().dump();
+            }
+
+            return mMemAccount.toString();
+        }
         default:
             break;
     }
@@ -1169,6 +1305,13 @@ int SuperMediaPlayer::mainService()
 
     if (mMessageControl->empty() || (0 == mMessageControl->processMsg())) {
         ProcessVideoLoop();
+
+#ifdef ENABLE_HEADLESS_RENDER
+        if (mUnthrottled && mPlayStatus == PLAYER_PLAYING) {
+            return 0;
+        }
+#endif
+
         int loopGap = updateLoopGap();
         int64_t use = (af_gettime_relative() - curTime) / 1000;
         int64_t needWait = loopGap - use;
@@ -1251,7 +1394,8 @@ void SuperMediaPlayer::ProcessVideoLoop()
     if (!mBRendingStart && mPlayStatus == PLAYER_PLAYING && !mBufferingFlag) {
         if ((mEof && (!HAVE_AUDIO || mAVDeviceManager->isAudioRenderValid()) && (!HAVE_VIDEO || mAVDeviceManager->isVideoRenderValid())) ||
             // render out the cache frame in renders
-            ((!HAVE_VIDEO || !mVideoFrameQue.empty() || (APP_BACKGROUND == mAppStatus)) && (!HAVE_AUDIO || !mAudioFrameQue.empty()))) {
+            ((!HAVE_VIDEO || !mVideoFrameQue.empty() || (APP_BACKGROUND == mAppStatus)) &&
+             (!HAVE_AUDIO || mTrickPlay || !mAudioFrameQue.empty()))) {
             startRendering(true);
         }
     }
@@ -1311,14 +1455,72 @@ void SuperMediaPlayer::updateBufferInfo(bool force)
     mMPAUtil->updateBufferInfo(force, videoBufferDuration, audioBufferDuration);
 }
 
+void SuperMediaPlayer::updateMemoryUsage()
+{
+    mMemAccount.setUsage(memoryGovernor::COMPONENT_PACKET_QUEUE, mBufferController->GetPacketMemSize(BUFFER_TYPE_ALL));
+    // the decoded frames are estimated as yuv420
+    int64_t frameSize = (int64_t) mVideoWidth * mVideoHeight * 3 / 2;
+    mMemAccount.setUsage(memoryGovernor::COMPONENT_FRAME_QUEUE, (int64_t) mVideoFrameQue.size() * frameSize);
+#ifdef ENABLE_VIDEO_FILTER
+    {
+        std::lock_guard<std::mutex> filterLock(mFilterManagerMutex);
+        int count = mFilterManager ? mFilterManager->getBufferedFrameCount() : 0;
+        mMemAccount.setUsage(memoryGovernor::COMPONENT_FILTER, count * frameSize);
+    }
+#endif
+    int64_t readAhead = 0;
+
+    if (mDemuxerService) {
+        readAhead = atoll(mDemuxerService->GetProperty(0, "readAheadBytes").c_str());
+    }
+
+    mMemAccount.setUsage(memoryGovernor::COMPONENT_DEMUXER, readAhead);
+
+    if (mAdaptiveBuffer) {
+        int64_t allowance = mMemAccount.getAllowance();
+        int64_t packetSize = mMemAccount.getUsage(memoryGovernor::COMPONENT_PACKET_QUEUE);
+        mBufferPolicy.setBitrate(mBufferController->GetPacketBitrate(BUFFER_TYPE_AV));
+        mBufferPolicy.setMemoryCap(allowance == INT64_MAX ? INT64_MAX : allowance - (mMemAccount.getTotal() - packetSize));
+    }
+}
+
+int64_t SuperMediaPlayer::getStartBufferDuration()
+{
+    if (!mAdaptiveBuffer) {
+        return mSet->startBufferDuration;
+    }
+
+    return mBufferPolicy.getStartBufferDuration(mSet->startBufferDuration, getHighBufferDuration());
+}
+
+int64_t SuperMediaPlayer::getHighBufferDuration()
+{
+    if (!mAdaptiveBuffer) {
+        return mSet->highLevelBufferDuration;
+    }
+
+    return mBufferPolicy.getHighBufferDuration(mSet->highLevelBufferDuration, getMaxBufferDuration());
+}
+
+int64_t SuperMediaPlayer::getMaxBufferDuration()
+{
+    if (!mAdaptiveBuffer) {
+        return mSet->maxBufferDuration;
+    }
+
+    return mBufferPolicy.getMaxBufferDuration(mSet->maxBufferDuration, mSet->highLevelBufferDuration);
+}
+
 void SuperMediaPlayer::doReadPacket()
 {
+    updateMemoryUsage();
     //check packet queue full
     int64_t cur_buffer_duration = getPlayerBufferDuration(false, false);
     //100s
     mUtil->notifyRead(MediaPlayerUtil::readEvent_Loop, 0);
 
     if (mEof) {
+        mBufferPolicy.onReadBlocked();
         return;
     }
 
@@ -1327,28 +1529,49 @@ void SuperMediaPlayer::doReadPacket()
     int timeout = 10000;
     mem_info info{};
     int checkStep = 0;
+    int64_t maxBufferDuration = getMaxBufferDuration();
 
     while (true) {
         // once buffer is full, we will try to read again if buffer consume more then BufferGap
         if (mBufferIsFull) {
             static const int BufferGap = 1000 * 1000;
 
-            if ((mSet->maxBufferDuration > 2 * BufferGap) && (cur_buffer_duration > mSet->maxBufferDuration - BufferGap) &&
+            if ((maxBufferDuration > 2 * BufferGap) && (cur_buffer_duration > maxBufferDuration - BufferGap) &&
                 getPlayerBufferDuration(false, true) > mSet->startBufferDuration) {
+                mBufferPolicy.onReadBlocked();
                 break;
             }
         }
 
-        if (cur_buffer_duration > mSet->maxBufferDuration &&
+        if (cur_buffer_duration > maxBufferDuration &&
             getPlayerBufferDuration(false, true) > mSet->startBufferDuration
             // we need readout the buffer in demuxer when no buffer in player, player keep at least start buffer duration
         ) {
             mBufferIsFull = true;
+            mBufferPolicy.onReadBlocked();
             break;
         }
 
         mBufferIsFull = false;
 
+        // the memory governor shrinks the buffer to the share of the budget, but keeps the start buffer, and the high
+        // buffer in a rebuffering, or it would never end
+        mMemAccount.setUsage(memoryGovernor::COMPONENT_PACKET_QUEUE, mBufferController->GetPacketMemSize(BUFFER_TYPE_ALL));
+
+        if (mMemAccount.isOverBudget() &&
+            getPlayerBufferDuration(false, true) >
+                    SMPBufferPolicy::getMemoryFloor(mSet->startBufferDuration, getHighBufferDuration(), mBufferingFlag)) {
+            if (!mMemoryLimited) {
+                AF_LOGI("buffer is limited by the memory budget at %lld ms\n", cur_buffer_duration / 1000);
+                mMemoryLimited = true;
+            }
+
+            mBufferPolicy.onReadBlocked();
+            break;
+        }
+
+        mMemoryLimited = false;
+
         if ((0 >= checkStep--) && (cur_buffer_duration > 1000 * 1000) && (AFGetSystemMemInfo(&info) >= 0)) {
             //AF_LOGD("system_availableram is %" PRIu64 "",info.system_availableram);
             if (info.system_availableram > 2 * mSet->lowMemSize) {
@@ -1370,6 +1593,7 @@ void SuperMediaPlayer::doReadPacket()
                     mSet->startBufferDuration = 800 * 1000;
                 }
 
+                mBufferPolicy.onReadBlocked();
                 break;
             } else {
                 checkStep = 5;
@@ -1452,20 +1676,21 @@ void SuperMediaPlayer::OnDemuxerCallback(const std::string &key, const std::stri
 bool SuperMediaPlayer::DoCheckBufferPass()
 {
     int64_t cur_buffer_duration = getPlayerBufferDuration(false, false);
-    int64_t HighBufferDur = mSet->highLevelBufferDuration;
+    int64_t maxBufferDuration = getMaxBufferDuration();
+    int64_t HighBufferDur = getHighBufferDuration();
 
     if (mEof) {
         mDemuxerService->getDemuxerHandle()->setClientBufferLevel(client_buffer_level_normal);
     } else {
-        if (cur_buffer_duration < mSet->highLevelBufferDuration) {
+        if (cur_buffer_duration < HighBufferDur) {
             if (mPlayStatus == PLAYER_PLAYING) {
                 mDemuxerService->getDemuxerHandle()->setClientBufferLevel(client_buffer_level_low);
             } else {
                 mDemuxerService->getDemuxerHandle()->setClientBufferLevel(client_buffer_level_normal);
             }
-        } else if (cur_buffer_duration >= mSet->maxBufferDuration - 3 * 1000 * 1000) {
+        } else if (cur_buffer_duration >= maxBufferDuration - 3 * 1000 * 1000) {
             mDemuxerService->getDemuxerHandle()->setClientBufferLevel(client_buffer_level_low_full);
-        } else if (cur_buffer_duration > 2 * mSet->highLevelBufferDuration) {
+        } else if (cur_buffer_duration > 2 * HighBufferDur) {
             mDemuxerService->getDemuxerHandle()->setClientBufferLevel(client_buffer_level_normal);
         } else {
             // TODO:
@@ -1473,7 +1698,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
     }
 
     if (mFirstBufferFlag && !mEof) {
-        HighBufferDur = mSet->startBufferDuration;
+        HighBufferDur = getStartBufferDuration();
 
         //clean late audio data
         if (cur_buffer_duration > HighBufferDur && HAVE_VIDEO && HAVE_AUDIO) {
@@ -1522,7 +1747,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
 
         if ((cur_buffer_duration >= HighBufferDur &&
              (!HAVE_VIDEO || !mAVDeviceManager->isDecoderValid(SMPAVDeviceManager::DEVICE_TYPE_VIDEO) || videoDecoderFull ||
-              APP_BACKGROUND == mAppStatus || !mSet->mFastStart)) ||
+              APP_BACKGROUND == mAppStatus || (!mSet->mFastStart && !mSet->mPreRoll))) ||
             (mEof)) {
             if (mEof && getPlayerBufferDuration(true, false) <= 0) {
                 // If player don`t get any packets when read eof
@@ -1584,6 +1809,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
         mBufferingFlag = true;
         mPNotifier->NotifyLoading(loading_event_start, 0);
         AF_LOGD("loading start");
+        mMetrics.start(SMPMetrics::TIMING_REBUFFER, af_getsteady_ms());
         mLoadingProcess = 0;
         mTimeoutStartTime = INT64_MIN;
         mMasterClock.pause();
@@ -1605,6 +1831,8 @@ bool SuperMediaPlayer::DoCheckBufferPass()
             if (maxBufferDuration > mSet->RTMaxDelayTime + 1000 * 1000 * 5) {
                 int64_t lastKeyPos = mBufferController->GetPacketLastKeyTimePos(BUFFER_TYPE_VIDEO);
                 mBufferController->ClearPacketBeforeTimePos(BUFFER_TYPE_VIDEO, lastKeyPos);
+                // the delay jumps, not to correct with the smoothed one
+                mLatencyController.reset();
                 break;
             }
 
@@ -1640,6 +1868,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
                 int64_t clearPos = (lastVideoKeyTimePos != INT64_MIN) ? lastVideoKeyTimePos : lastPos;
                 int64_t dropVideoCount = mBufferController->ClearPacketBeforeTimePos(BUFFER_TYPE_VIDEO, clearPos);
                 int64_t dropAudioCount = mBufferController->ClearPacketBeforeTimePos(BUFFER_TYPE_AUDIO, clearPos);
+                mLatencyController.reset();
 
                 if (dropVideoCount > 0) {
                     FlushVideoPath();
@@ -1675,7 +1904,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
 
     //check buffering status
     if ((mBufferingFlag || mFirstBufferFlag)) {
-        if (((cur_buffer_duration > HighBufferDur || (HighBufferDur >= mSet->maxBufferDuration && mBufferIsFull)) &&
+        if ((SMPBufferPolicy::isBufferingDone(cur_buffer_duration, HighBufferDur, maxBufferDuration, mBufferIsFull, mMemoryLimited) &&
              (!HAVE_VIDEO || videoDecoderFull || APP_BACKGROUND == mAppStatus)) ||
             mEof) {
             // if still in seek, wait for seek status be changed.
@@ -1685,6 +1914,7 @@ bool SuperMediaPlayer::DoCheckBufferPass()
                     updateBufferInfo(true);
                     mPNotifier->NotifyLoading(loading_event_end, 0);
                     AF_LOGD("loading end");
+                    mMetrics.end(SMPMetrics::TIMING_REBUFFER, af_getsteady_ms());
 
                     if (mPlayStatus == PLAYER_PLAYING) {
                         mMasterClock.start();
@@ -1759,10 +1989,13 @@ void SuperMediaPlayer::LiveCatchUp(int64_t delayTime)
         recoverGap = 100 * 1000;
     }
 
-    if ((delayTime > mSet->RTMaxDelayTime) && (150 * 1000 < delayTime)) {
-        mMsgCtrlListener->ProcessSetSpeed(1.2);
-    } else if ((delayTime < mSet->RTMaxDelayTime - recoverGap) || (100 * 1000 > delayTime)) {
-        mMsgCtrlListener->ProcessSetSpeed(1.0);
+    // RTMaxDelayTime is the upper bound, only catch up, keep at least 100ms buffered
+    int64_t target = std::max<int64_t>(mSet->RTMaxDelayTime - recoverGap, 100 * 1000);
+    mLatencyController.setRateRange(1.0f, MAX_LIVE_SYNC_SPEED);
+    float speed = mLatencyController.update(delayTime, target, std::min((int64_t) 2 * recoverGap, LIVE_SYNC_BAND), af_getsteady_ms());
+
+    if (!CicadaUtils::isEqual(mSet->rate, speed)) {
+        mMsgCtrlListener->ProcessSetSpeed(speed);
     }
 }
 
@@ -1802,6 +2035,7 @@ void SuperMediaPlayer::LiveTimeSync(int64_t delayTime)
             AF_LOGD("drop left lateUTCTime %lld, lastVideoKeyPts %lld", lateUTCTime, lastKeyTimePos);
             int64_t dropVideoCount = mBufferController->ClearPacketBeforeTimePos(BUFFER_TYPE_VIDEO, lastKeyTimePos);
             int64_t dropAudioCount = mBufferController->ClearPacketBeforeTimePos(BUFFER_TYPE_AUDIO, lastKeyTimePos);
+            mLatencyController.reset();
 
             if (dropVideoCount > 0) {
                 FlushVideoPath();
@@ -1817,39 +2051,13 @@ void SuperMediaPlayer::LiveTimeSync(int64_t delayTime)
             }
         }
     }
-    int64_t bufferDelay = mSuggestedPresentationDelay;
-
-    switch (mLiveTimeSyncType) {
+    // not to catch up when the buffer is low, it would run out
+    mLatencyController.setRateRange(MIN_LIVE_SYNC_SPEED,
+                                    getPlayerBufferDuration(false, false) > catchUpBufferDelta ? MAX_LIVE_SYNC_SPEED : 1.0f);
+    float speed = mLatencyController.update(delayTime, mSuggestedPresentationDelay, std::min(maxGopTime, LIVE_SYNC_BAND), af_getsteady_ms());
 
-        case LiveTimeSyncType::LiveTimeSyncNormal:
-            assert(mSet->rate == 1.0f);
-            if ((delayTime > bufferDelay + maxGopTime / 2) && getPlayerBufferDuration(false, false) > catchUpBufferDelta) {
-                mMsgCtrlListener->ProcessSetSpeed(1.2);
-                mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncCatchUp;
-            } else if (delayTime < bufferDelay - maxGopTime / 2) {
-                mMsgCtrlListener->ProcessSetSpeed(0.9);
-                mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncSlowDown;
-                AF_LOGD("LiveTimeSync, delayTime=%lld, set speed 0.9", delayTime);
-            }
-            break;
-
-        case LiveTimeSyncType::LiveTimeSyncCatchUp:
-            //   AF_LOGD("CatchUp speed is %f\n", mSet->rate.load());
-            assert(mSet->rate == 1.2f);
-            if ((delayTime < bufferDelay) || (getPlayerBufferDuration(false, false) < catchUpBufferDelta)) {
-                mMsgCtrlListener->ProcessSetSpeed(1.0);
-                mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncNormal;
-                AF_LOGD("LiveTimeSync, delayTime=%lld, recover from catch up", delayTime);
-            }
-            break;
-        case LiveTimeSyncType::LiveTimeSyncSlowDown:
-            assert(mSet->rate == 0.9f);
-            if (delayTime > bufferDelay) {
-                mMsgCtrlListener->ProcessSetSpeed(1.0);
-                mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncNormal;
-                AF_LOGD("LiveTimeSync, delayTime=%lld, recover from slow down", delayTime);
-            }
-            break;
+    if (!CicadaUtils::isEqual(mSet->rate, speed)) {
+        mMsgCtrlListener->ProcessSetSpeed(speed);
     }
 }
 
@@ -1936,6 +2144,12 @@ void SuperMediaPlayer::doRender()
                 // fix bug the mCurrentPos not accuracy
                 NotifyPosition(getCurrentPosition());
                 ResetSeekStatus();
+                int64_t seekCost = mMetrics.end(SMPMetrics::TIMING_SEEK, af_getsteady_ms());
+
+                if (seekCost >= 0 && mSeekInCache) {
+                    mMetrics.recordLatency("seek.firstFrame.inCache", seekCost);
+                }
+
                 mPNotifier->NotifySeekEnd(mSeekInCache);
                 mSeekInCache = false;
             }
@@ -1945,8 +2159,11 @@ void SuperMediaPlayer::doRender()
 
 void SuperMediaPlayer::doDeCode()
 {
+    // the preview frame of the scrub seek is shown, nothing more to decode until the next one
+    bool scrubPreviewed = mScrubbing && !mSeekFlag && mFirstRendered;
+
     //get video packet to decode
-    if (HAVE_VIDEO && !videoDecoderEOS && mAVDeviceManager->isDecoderValid(SMPAVDeviceManager::DEVICE_TYPE_VIDEO)) {
+    if (HAVE_VIDEO && !videoDecoderEOS && !scrubPreviewed && mAVDeviceManager->isDecoderValid(SMPAVDeviceManager::DEVICE_TYPE_VIDEO)) {
         int max_cache_size = VIDEO_PICTURE_MAX_CACHE_SIZE;
 
         if (mPictureCacheType == picture_cache_type_cannot) {
@@ -1971,6 +2188,25 @@ void SuperMediaPlayer::doDeCode()
 
                 if (mVideoPacket == nullptr) {
                     mVideoPacket = mBufferController->getPacket(BUFFER_TYPE_VIDEO);
+
+                    // drop the frames the decoder can't catch up with on high speed, before decoding them
+                    while (mVideoPacket && mFirstRendered && !mSeekNeedCatch && !mScrubbing && !mTrickPlay) {
+                        int64_t dts = mVideoPacket->getInfo().dts;
+                        mFrameDropFilter.update(mSet->rate, dts != INT64_MIN ? mMasterClock.GetTime() - dts : 0);
+
+                        if (!mFrameDropFilter.needDrop(mVideoPacket.get())) {
+                            break;
+                        }
+
+                        mMetrics.addDrop(SMPMetrics::DROP_REASON_DECODER_BEHIND);
+
+                        mVideoPacket = mBufferController->getPacket(BUFFER_TYPE_VIDEO);
+                    }
+
+                    // scrub preview only decodes the key frame, the others are not sent to the decoder at all
+                    while (mVideoPacket && mScrubbing && !(mVideoPacket->getInfo().flags & AF_PKT_FLAG_KEY)) {
+                        mVideoPacket = mBufferController->getPacket(BUFFER_TYPE_VIDEO);
+                    }
                 }
 
                 videoEarlyUs = mVideoPacket ? mVideoPacket->getInfo().dts - mMasterClock.GetTime() : 0;
@@ -2008,12 +2244,14 @@ void SuperMediaPlayer::doDeCode()
                 if (af_getsteady_ms() - startDecodeTime > 50) {
                     break;
                 }
-            } while ((mSeekNeedCatch || dropLateVideoFrames) && (videoEarlyUs < 200 * 1000));
+            } while (((mSeekNeedCatch || dropLateVideoFrames) && (videoEarlyUs < 200 * 1000)) ||
+                     // push the decoder until the key frame out, the preview should be shown as soon as possible
+                     (mScrubbing && mSeekFlag && mVideoFrameQue.empty()));
         }
     }
 
-    //get audio packet to decode
-    if (HAVE_AUDIO && mAVDeviceManager->isDecoderValid(SMPAVDeviceManager::DEVICE_TYPE_AUDIO)) {
+    //get audio packet to decode, audio is not needed by scrub preview
+    if (HAVE_AUDIO && !mScrubbing && !mTrickPlay && mAVDeviceManager->isDecoderValid(SMPAVDeviceManager::DEVICE_TYPE_AUDIO)) {
 
         while (mAudioFrameQue.size() < 2 && !audioDecoderEOS && !mCanceled) {
 
@@ -2052,7 +2290,7 @@ void SuperMediaPlayer::doDeCode()
 bool SuperMediaPlayer::checkEOSAudio()
 {
 
-    if (!HAVE_AUDIO) {
+    if (!HAVE_AUDIO || mTrickPlay) {
         return true;
     }
     if (!audioDecoderEOS) {
@@ -2132,6 +2370,8 @@ void SuperMediaPlayer::playCompleted()
 
         if (!mMessageControl->findMsgByType(MSG_SEEKTO)) {
             ResetSeekStatus();
+            mMetrics.cancel(SMPMetrics::TIMING_SEEK);
+            mMetrics.cancel(SMPMetrics::TIMING_SEEK_AUDIO);
             mPNotifier->NotifySeekEnd(mSeekInCache);
             mSeekInCache = false;
         }
@@ -2246,6 +2486,7 @@ int SuperMediaPlayer::FillVideoFrame()
             info.waitFirstFrame = false;
         }
 
+        mMetrics.onVideoFrameDecoded(af_getsteady_ms());
         mAVDeviceManager->getDecoder(SMPAVDeviceManager::DEVICE_TYPE_VIDEO)->clean_error();
 
         if (mSecretPlayBack) {
@@ -2257,6 +2498,15 @@ int SuperMediaPlayer::FillVideoFrame()
             mSeekNeedCatch = false;
         }
 
+        if (mPreloadedVideoPts != INT64_MIN) {
+            // already rendered the frame decoded by the preload manager
+            if (pts != INT64_MIN && pts <= mPreloadedVideoPts) {
+                return ret;
+            }
+
+            mPreloadedVideoPts = INT64_MIN;
+        }
+
         auto *meta = (Stream_meta *) (mCurrentVideoMeta.get());
 
         if (!mAdaptiveVideo && mVideoWidth > 0 && (pFrame->getInfo().video.width != mVideoWidth || pFrame->getInfo().video.height != mVideoHeight)) {
@@ -2332,9 +2582,23 @@ bool SuperMediaPlayer::render()
     bool audioRendered = false;
     bool videoRendered = false;
 
-    if ((mCurrentAudioIndex >= 0) && !mSeekNeedCatch) {
+#ifdef ENABLE_HEADLESS_RENDER
+    if (mUnthrottled) {
+        advanceUnthrottledClock();
+    }
+#endif
+
+    if ((mCurrentAudioIndex >= 0) && !mSeekNeedCatch && !mScrubbing && !mTrickPlay) {
         int ret;
         do {
+#ifdef ENABLE_HEADLESS_RENDER
+            // the audio device plays at once, don't run ahead of the video
+            if (mUnthrottled && !mAudioFrameQue.empty() &&
+                mAudioFrameQue.front()->getInfo().pts > mMasterClock.GetTime() + UNTHROTTLED_AUDIO_LEAD) {
+                break;
+            }
+#endif
+
             ret = RenderAudio();
             if (RENDER_NONE != ret) {
                 audioRendered = true;
@@ -2366,6 +2630,34 @@ bool SuperMediaPlayer::render()
     return audioRendered || videoRendered;
 }
 
+#ifdef ENABLE_HEADLESS_RENDER
+void SuperMediaPlayer::advanceUnthrottledClock()
+{
+    int64_t next = INT64_MAX;
+
+    if (HAVE_AUDIO && !mSeekNeedCatch && !mScrubbing && !mTrickPlay) {
+        if (!mAudioFrameQue.empty()) {
+            next = std::min(next, mAudioFrameQue.front()->getInfo().pts);
+        } else if (!audioDecoderEOS) {
+            return;
+        }
+    }
+
+    if (HAVE_VIDEO) {
+        if (!mVideoFrameQue.empty() && mVideoFrameQue.front()) {
+            next = std::min(next, mVideoFrameQue.front()->getInfo().pts);
+        } else if (!videoDecoderEOS) {
+            return;
+        }
+    }
+
+    // the real time still goes on when a stream is waited, so it can't be stuck
+    if (next != INT64_MAX && next != INT64_MIN && next > mMasterClock.GetTime()) {
+        mMasterClock.setTime(next);
+    }
+}
+#endif
+
 RENDER_RESULT SuperMediaPlayer::RenderAudio()
 {
     RENDER_RESULT ret = RENDER_NONE;
@@ -2447,10 +2739,18 @@ RENDER_RESULT SuperMediaPlayer::RenderAudio()
     }
 
     if (mPlayedAudioPts == INT64_MIN) {
+        mMetrics.end(SMPMetrics::TIMING_SEEK_AUDIO, af_getsteady_ms());
         mAudioTime.startTime = pts;
         mAudioTime.deltaTime = 0;
         mAudioTime.deltaTimeTmp = 0;
+
+#ifdef ENABLE_HEADLESS_RENDER
+        if (!mUnthrottled) {
+            mMasterClock.setReferenceClock(getAudioPlayTimeStampCB, this);
+        }
+#else
         mMasterClock.setReferenceClock(getAudioPlayTimeStampCB, this);
+#endif
     } else {
         if (mLastAudioFrameDuration > 0) {
             if (!mAudioPtsRevert) {
@@ -2506,6 +2806,7 @@ RENDER_RESULT SuperMediaPlayer::RenderAudio()
 
 bool SuperMediaPlayer::RenderVideo(bool force_render)
 {
+    AF_TRACE_SCOPE("render", "RenderVideo");
 
     if (!mAVDeviceManager->isVideoRenderValid()) {
         return false;
@@ -2600,6 +2901,7 @@ bool SuperMediaPlayer::RenderVideo(bool force_render)
                 if (dropVideoCount > 0) {
                     FlushVideoPath();
                     AF_LOGD("videolaterUs is %lld,drop video count is %d", videoLateUs, dropVideoCount);
+                    mMetrics.addDrop(SMPMetrics::DROP_REASON_CATCH_UP, dropVideoCount);
                     mVideoCatchingUp = true;
                     return false;
                 }
@@ -2631,7 +2933,8 @@ bool SuperMediaPlayer::RenderVideo(bool force_render)
             mPNotifier->NotifyVideoSizeChanged(mVideoWidth, mVideoHeight);
         }
 
-        if (!HAVE_AUDIO) {
+        // no audio is played in trick play, the video drives the clock
+        if (!HAVE_AUDIO || mTrickPlay) {
             if (mPlayedVideoPts == INT64_MIN) {
                 mMasterClock.setTime(videoPts);
                 mMasterClock.setReferenceClock(mClockRef, mCRArg);
@@ -2642,6 +2945,7 @@ bool SuperMediaPlayer::RenderVideo(bool force_render)
         videoFrame->setDiscard(true);
         mUtil->videoRendered(false);
         mMPAUtil->videoRendered(false);
+        mMetrics.addDrop(SMPMetrics::DROP_REASON_LATE);
         mVideoCatchingUp = true;
 
         if (mFrameCb && (!mSecretPlayBack || mDrmKeyValid)) {
@@ -2917,7 +3221,7 @@ void SuperMediaPlayer::setUpAVPath()
         return;
     }
 
-    if (!mSet->mFastStart && mPlayStatus < PLAYER_PLAYING) {
+    if (!mSet->mFastStart && !mSet->mPreRoll && mPlayStatus < PLAYER_PLAYING) {
         AF_LOGI("not fast start mode\n");
         return;
     }
@@ -2975,7 +3279,17 @@ int SuperMediaPlayer::ReadPacket()
         }
     }
 
-    int ret = mDemuxerService->readPacket(pMedia_Frame, index);
+    int ret = 0;
+
+    // the packets read ahead by the preload manager come first
+    if (mPreloadItem && index == -1) {
+        pMedia_Frame = mPreloadItem->popPacket();
+        ret = pMedia_Frame ? pMedia_Frame->getSize() : 0;
+    }
+
+    if (pMedia_Frame == nullptr) {
+        ret = mDemuxerService->readPacket(pMedia_Frame, index);
+    }
 
     if (pMedia_Frame == nullptr) {
         //  AF_LOGD("Can't read packet %d\n", ret);
@@ -3015,6 +3329,10 @@ int SuperMediaPlayer::ReadPacket()
     mUtil->notifyRead(MediaPlayerUtil::readEvent_Got, size);
     mMPAUtil->updateNetworkReadSize(size);
 
+    if (mAdaptiveBuffer) {
+        mBufferPolicy.onRead(pFrame->getSize(), af_gettime_relative());
+    }
+
     // TODO: get the min first stream pts
     if (pFrame->getInfo().timePosition >= 0 && mMediaStartPts == INT64_MIN && pFrame->getInfo().streamIndex != mCurrentSubtitleIndex &&
         pFrame->getInfo().streamIndex != mWillChangedSubtitleStreamIndex) {
@@ -3163,6 +3481,11 @@ int SuperMediaPlayer::ReadPacket()
             return ret;
         }
 
+        // not played in scrubbing, the accurate seek on scrubbing end reads them again
+        if (isScrubSeeking()) {
+            return ret;
+        }
+
         if (pFrame->getInfo().streamIndex == mWillChangedAudioStreamIndex) {
             mCurrentAudioIndex = mWillChangedAudioStreamIndex;
             mCATimeBase = mWATimeBase;
@@ -3303,6 +3626,7 @@ void SuperMediaPlayer::FlushVideoPath()
     videoDecoderFull = false;
     mVideoPtsRevert = false;
     mVideoPacket = nullptr;
+    mFrameDropFilter.reset();
     dropLateVideoFrames = false;
     mVideoCatchingUp = false;
     mVideoEOS = false;
@@ -3355,7 +3679,7 @@ int64_t SuperMediaPlayer::getPlayerBufferDuration(bool gotMax, bool internal)
     int i = 0;
     int64_t duration = -1;
 
-    if (HAVE_AUDIO) {
+    if (HAVE_AUDIO && !mTrickPlay && !isScrubSeeking()) {
         int64_t &duration_c = durations[i++];
         duration_c = mBufferController->GetPacketDuration(BUFFER_TYPE_AUDIO);
         //            AF_LOGD("audioDuration is %lld\n",audioDuration);
@@ -3381,7 +3705,7 @@ int64_t SuperMediaPlayer::getPlayerBufferDuration(bool gotMax, bool internal)
         duration_c = mBufferController->GetPacketDuration(BUFFER_TYPE_VIDEO);
 
         //            AF_LOGD("videoDuration is %lld\n",videoDuration);
-        if (duration_c < 0 && !HAVE_AUDIO) {
+        if (duration_c < 0 && (!HAVE_AUDIO || mTrickPlay || isScrubSeeking())) {
             duration_c = mBufferController->GetPacketLastPTS(BUFFER_TYPE_VIDEO) - mBufferController->GetPacketPts(BUFFER_TYPE_VIDEO);
 
             if (duration_c <= 0) {
@@ -3426,6 +3750,82 @@ int64_t SuperMediaPlayer::getPlayerBufferDuration(bool gotMax, bool internal)
     return duration;
 }
 
+bool SuperMediaPlayer::setTrickPlay(bool enable)
+{
+    if (enable == mTrickPlay) {
+        return true;
+    }
+
+    if (!HAVE_VIDEO || mDemuxerService == nullptr || mDemuxerService->getDemuxerHandle() == nullptr) {
+        return false;
+    }
+
+    if (mDemuxerService->getDemuxerHandle()->setTrickPlay(enable, mCurrentVideoIndex) < 0) {
+        return false;
+    }
+
+    int64_t pos = getCurrentPosition();
+    AF_LOGI("trick play %d at %lld\n", enable, pos);
+    mTrickPlay = enable;
+
+    if (enable) {
+        // the audio is dropped, the video drives the clock
+        mMasterClock.setReferenceClock(nullptr, nullptr);
+    }
+
+    // restart from the current position on the new rendition, go back accurately
+    mMsgCtrlListener->ProcessSeekToMsg(pos, !enable);
+    return true;
+}
+
+int64_t SuperMediaPlayer::getScrubKeyFramePos(int64_t pos)
+{
+    if (mDemuxerService == nullptr || mDemuxerService->getDemuxerHandle() == nullptr) {
+        return pos;
+    }
+
+    int64_t keyPos = pos;
+    int64_t minDelta = INT64_MAX;
+
+    for (auto &info : mDemuxerService->getDemuxerHandle()->getStreamIndexEntryInfo()) {
+        if (info.type != STREAM_TYPE_VIDEO) {
+            continue;
+        }
+
+        // entries are in timestamp order, look at the key frames around pos
+        auto entry = std::upper_bound(info.mEntry.begin(), info.mEntry.end(), pos,
+                                      [](int64_t value, const IDemuxer::streamIndexEntryInfo::entryInfo &item) { return value < item.mTimestamp; });
+
+        for (auto it = entry; it != info.mEntry.end(); ++it) {
+            if (it->mKey && !it->mDiscard) {
+                if (it->mTimestamp - pos < minDelta) {
+                    minDelta = it->mTimestamp - pos;
+                    keyPos = it->mTimestamp;
+                }
+
+                break;
+            }
+        }
+
+        while (entry != info.mEntry.begin()) {
+            --entry;
+
+            if (entry->mKey && !entry->mDiscard) {
+                if (pos - entry->mTimestamp < minDelta) {
+                    minDelta = pos - entry->mTimestamp;
+                    keyPos = entry->mTimestamp;
+                }
+
+                break;
+            }
+        }
+
+        break;
+    }
+
+    return std::max(keyPos, (int64_t) 0);
+}
+
 bool SuperMediaPlayer::SeekInCache(int64_t pos)
 {
     int64_t audioLastPos = mBufferController->GetPacketLastTimePos(BUFFER_TYPE_AUDIO);
@@ -3947,6 +4347,7 @@ int SuperMediaPlayer::CreateVideoDecoder(bool bHW, Stream_meta &meta)
     if (ret < 0) {
         return ret;
     }
+    mFrameDropFilter.init(&meta);
     {
         std::lock_guard<std::mutex> lock(mAppStatusMutex);
         mMsgCtrlListener->ProcessVideoHoldMsg(mAppStatus == APP_BACKGROUND);
@@ -3995,6 +4396,10 @@ void SuperMediaPlayer::Reset()
     mVideoChangedFirstPts = INT64_MIN;
     mSubtitleChangedFirstPts = INT64_MIN;
     mSoughtVideoPos = INT64_MIN;
+    mPreloadedVideoPts = INT64_MIN;
+    mScrubbing = false;
+    mScrubPos = INT64_MIN;
+    mTrickPlay = false;
     mFirstReadPacketSucMS = 0;
     mCanceled = false;
     mPNotifier->Enable(true);
@@ -4012,6 +4417,13 @@ void SuperMediaPlayer::Reset()
     mVideoPtsRevert = mAudioPtsRevert = false;
     mHaveVideoPkt = mHaveAudioPkt = false;
     mLowMem = false;
+    mMemoryLimited = false;
+    mBufferPolicy.reset();
+
+    for (int i = 0; i < memoryGovernor::COMPONENT_NUM; i++) {
+        mMemAccount.setUsage((memoryGovernor::component) i, 0);
+    }
+
     mCurrentVideoMeta = nullptr;
     mAdaptiveVideo = false;
     dropLateVideoFrames = false;
@@ -4026,7 +4438,8 @@ void SuperMediaPlayer::Reset()
     mCATimeBase = 0;
     mWATimeBase = 0;
     mSuggestedPresentationDelay = 0;
-    mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncNormal;
+    mLatencyController.reset();
+    mMetrics.reset();
     mCalculateSpeedUsePacket = true;
     mUtcTimer = nullptr;
     mContainerInfo = {};
@@ -4116,6 +4529,20 @@ void SuperMediaPlayer::checkFirstRender()
         mFirstRendered = true;
         AF_LOGI("Player NotifyFirstFrame");
         mPNotifier->NotifyFirstFrame();
+
+        if (mMetrics.end(SMPMetrics::TIMING_STARTUP, af_getsteady_ms()) >= 0) {
+            DecodeFirstFrameInfo &info = HAVE_VIDEO ? mRecorderSet->decodeFirstVideoFrameInfo : mRecorderSet->decodeFirstAudioFrameInfo;
+            int64_t decodeCost = info.getDecodeFirstFrameCost();
+
+            if (decodeCost != INT64_MIN) {
+                mMetrics.recordLatency("startup.decode", decodeCost);
+            }
+        }
+
+        if (mRecorderSet->startTimeMs != INT64_MIN) {
+            mRecorderSet->startToFirstFrameCostMs = af_getsteady_ms() - mRecorderSet->startTimeMs;
+            mMetrics.recordLatency("startup.startToFirstFrame", mRecorderSet->startToFirstFrameCostMs);
+        }
     }
 }
 
@@ -9,6 +9,7 @@ using namespace std;
 #include "demuxer/demuxer_service.h"
 
 #include "MediaPlayerUtil.h"
+#include "PlayerPreloadManager.h"
 
 #include "player_msg_control.h"
 #include "buffer_controller.h"
@@ -17,6 +18,10 @@ using namespace std;
 #include "system_refer_clock.h"
 
 #include "SMPAVDeviceManager.h"
+#include "SMPBufferPolicy.h"
+#include "SMPPipelineReaper.h"
+#include "SMPLatencyController.h"
+#include "SMPMetrics.h"
 #include "SMPMessageControllerListener.h"
 #include "SMP_DCAManager.h"
 #include "SuperMediaPlayerDataSourceListener.h"
@@ -27,6 +32,8 @@ using namespace std;
 #include <queue>
 #include <render/audio/IAudioRender.h>
 #include <utils/bitStreamParser.h>
+#include <utils/frameDropFilter.h>
+#include <utils/memoryGovernor.h>
 
 #include "CicadaPlayerPrototype.h"
 #include <cacheModule/CacheModule.h>
@@ -71,14 +78,13 @@ namespace Cicada {
         Yes,
     };
 
-    enum class LiveTimeSyncType {
-        LiveTimeSyncNormal,
-        LiveTimeSyncCatchUp,
-        LiveTimeSyncSlowDown
-    };
-
     const static float MIN_SPEED = 0.5;
     const static float MAX_SPEED = 5;
+    // the live latency is corrected by the speed in this range
+    const static float MIN_LIVE_SYNC_SPEED = 0.95;
+    const static float MAX_LIVE_SYNC_SPEED = 1.1;
+    // hold the live latency in target +- 200ms
+    const static int64_t LIVE_SYNC_BAND = 400 * 1000;
 
     class SuperMediaPlayer : public ICicadaPlayer, private CicadaPlayerPrototype {
 
@@ -308,6 +314,18 @@ namespace Cicada {
 
         bool SeekInCache(int64_t pos);
 
+        // the nearest video key frame of pos in the demuxer index, pos if no index
+        int64_t getScrubKeyFramePos(int64_t pos);
+
+        // scrubbing to a position, the audio is neither read nor buffered until the accurate seek on scrubbing end
+        bool isScrubSeeking() const
+        {
+            return mScrubbing && mScrubPos != INT64_MIN;
+        }
+
+        // switch to or back from the I-frame rendition, return false if the source has no one
+        bool setTrickPlay(bool enable);
+
         void SwitchVideo(int64_t startTime);
 
         int64_t getPlayerBufferDuration(bool gotMax, bool internal);
@@ -324,6 +342,11 @@ namespace Cicada {
 
         bool render();
 
+#ifdef ENABLE_HEADLESS_RENDER
+        // move the clock to the earliest frame to render, no waiting for the real time
+        void advanceUnthrottledClock();
+#endif
+
         void RenderSubtitle(int64_t pts);
 
         bool RenderVideo(bool force_render);
@@ -393,6 +416,19 @@ namespace Cicada {
 
         void updateBufferInfo(bool force);
 
+        // report the bytes held by the buffers to the memory governor
+        void updateMemoryUsage();
+
+        // detach the demuxer and the data source, release them by the reaper
+        void releasePipelineAsync();
+
+        // the buffer durations in use, adapted by the buffer policy if enabled
+        int64_t getStartBufferDuration();
+
+        int64_t getHighBufferDuration();
+
+        int64_t getMaxBufferDuration();
+
         class ApsaraAudioRenderCallback : public IAudioRenderListener {
         public:
             explicit ApsaraAudioRenderCallback(SuperMediaPlayer &player) : mPlayer(player)
@@ -463,6 +499,9 @@ namespace Cicada {
 
 
     private:
+        // owns the options of the preloaded data source and demuxer, release it after them
+        std::unique_ptr<PreloadItem> mPreloadItem{nullptr};
+        int64_t mPreloadedVideoPts{INT64_MIN};
         IDataSource *mDataSource{nullptr};
         std::atomic_bool mCanceled{false};
         std::atomic_bool mMainServiceCanceled{true};
@@ -529,6 +568,16 @@ namespace Cicada {
         bool mSubtitleEOS{false};
         bool mLowMem{false};
         bool mSeekFlag{false};
+        // a newer seek arrived when the last one is in processing
+        std::atomic_bool mSeekSuperseded{false};
+        std::mutex mSeekAbortMutex{};
+        bool mInDemuxerSeek{false};
+        bool mDemuxerSeekAborted{false};
+        // scrub preview, seeks go to key frames, only the key frame is decoded and rendered, audio is skipped
+        std::atomic_bool mScrubbing{false};
+        std::atomic<int64_t> mScrubPos{INT64_MIN};
+        // playing the I-frame rendition for the speeds the audio can't follow
+        bool mTrickPlay{false};
         bool mSeekInCache{false};
         bool mFirstBufferFlag{true}; // first play and after seek play
         bool mBufferingFlag{false};
@@ -556,6 +605,7 @@ namespace Cicada {
         int mVideoParserTimes = 0;
         InterlacedType mVideoInterlaced = InterlacedType_UNKNOWN;
         bitStreamParser *mVideoParser = nullptr;
+        frameDropFilter mFrameDropFilter{};
         int64_t mPtsDiscontinueDelta{INT64_MIN};
         std::unique_ptr<MediaPlayerUtil> mUtil{};
         std::unique_ptr<MediaPlayerAnalyticsUtil> mMPAUtil{};
@@ -597,8 +647,18 @@ namespace Cicada {
         seekCB mBSSeekCb = nullptr;
         void *mBSCbArg = nullptr;
         int64_t mSuggestedPresentationDelay = 0;
-        LiveTimeSyncType mLiveTimeSyncType = LiveTimeSyncType::LiveTimeSyncNormal;
+        SMPLatencyController mLatencyController{};
+        SMPMetrics mMetrics{};
+        memoryGovernor::account mMemAccount{"player"};
+        // reading is stopped by the memory budget
+        bool mMemoryLimited{false};
+        SMPBufferPolicy mBufferPolicy{};
+        bool mAdaptiveBuffer{false};
         bool mVideoCatchingUp{false};
+#ifdef ENABLE_HEADLESS_RENDER
+        // a benchmark mode, the clock is driven by the frames instead of the audio device or the real time
+        bool mUnthrottled{false};
+#endif
         bool mAudioEOS{false};
         bool mVideoEOS{false};
         int64_t mVideoDelayTime{0};
@@ -391,6 +391,44 @@ namespace Cicada {
         return size;
     }
 
+    int64_t BufferController::GetPacketMemSize(BUFFER_TYPE type)
+    {
+        int64_t size = 0;
+
+        if (type & BUFFER_TYPE_AUDIO) {
+            size += mAudioPacketQueue.GetMemSize();
+        }
+
+        if (type & BUFFER_TYPE_VIDEO) {
+            size += mVideoPacketQueue.GetMemSize();
+        }
+
+        if (type & BUFFER_TYPE_SUBTITLE) {
+            size += mSubtitlePacketQueue.GetMemSize();
+        }
+
+        return size;
+    }
+
+    int64_t BufferController::GetPacketBitrate(BUFFER_TYPE type)
+    {
+        int64_t bitrate = 0;
+
+        if (type & BUFFER_TYPE_AUDIO) {
+            bitrate += mAudioPacketQueue.GetBitrate();
+        }
+
+        if (type & BUFFER_TYPE_VIDEO) {
+            bitrate += mVideoPacketQueue.GetBitrate();
+        }
+
+        if (type & BUFFER_TYPE_SUBTITLE) {
+            bitrate += mSubtitlePacketQueue.GetBitrate();
+        }
+
+        return bitrate;
+    }
+
     void BufferController::ClearPacket(BUFFER_TYPE type)
     {
         if (type & BUFFER_TYPE_AUDIO) {
@@ -31,6 +31,11 @@ namespace Cicada {
 
         int GetPacketSize(BUFFER_TYPE type);
 
+        int64_t GetPacketMemSize(BUFFER_TYPE type);
+
+        // the sum of the bitrates of the types
+        int64_t GetPacketBitrate(BUFFER_TYPE type);
+
         bool IsPacketEmtpy(BUFFER_TYPE type);
 
         std::unique_ptr<IAFPacket> getPacket(BUFFER_TYPE type);
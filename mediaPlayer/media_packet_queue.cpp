@@ -24,6 +24,7 @@ void MediaPacketQueue::ClearQueue()
     mQueue.clear();
     mDuration = 0;
     mTotalDuration = 0;
+    mMemSize = 0;
     mPacketDuration = 0;
     mCurrent = mQueue.end();
 }
@@ -68,6 +69,7 @@ void MediaPacketQueue::AddPacket(mediaPacket frame)
         mDropedExtra_data_size = 0;
     }
 
+    mMemSize += frame->getSize();
     mQueue.push_back(move(frame));
     if (empty) {
         mCurrent = mQueue.begin();
@@ -255,6 +257,9 @@ std::unique_ptr<IAFPacket> MediaPacketQueue::getPacket()
         if (packet && packet->getInfo().duration > 0 && !packet->getDiscard()) {
             mTotalDuration -= packet->getInfo().duration;
         }
+        if (packet) {
+            mMemSize -= packet->getSize();
+        }
     } else {
         packet = (*mCurrent)->clone();
         ++mCurrent;
@@ -271,6 +276,7 @@ std::unique_ptr<IAFPacket> MediaPacketQueue::getPacket()
             if (mQueue.front()->getInfo().duration > 0 && !mQueue.front()->getDiscard()) {
                 mTotalDuration -= mQueue.front()->getInfo().duration;
             }
+            mMemSize -= mQueue.front()->getSize();
             mQueue.pop_front();
             if (begin) {
                 mCurrent = mQueue.begin();
@@ -309,6 +315,7 @@ void MediaPacketQueue::PopFrontPacket()
         if (!mQueue.front()->getDiscard()) {
             mTotalDuration -= mQueue.front()->getInfo().duration;
         }
+        mMemSize -= mQueue.front()->getSize();
         mQueue.pop_front();
         mCurrent = mQueue.begin();
     } else {
@@ -385,6 +392,23 @@ int64_t MediaPacketQueue::GetDuration()
     return mDuration;
 }
 
+int64_t MediaPacketQueue::GetMemSize()
+{
+    ADD_LOCK;
+    return mMemSize;
+}
+
+int64_t MediaPacketQueue::GetBitrate()
+{
+    ADD_LOCK;
+
+    if (mTotalDuration <= 0) {
+        return 0;
+    }
+
+    return (int64_t) ((double) mMemSize * 8 * 1000000 / mTotalDuration);
+}
+
 int64_t MediaPacketQueue::ClearPacketBeforePTS(int64_t pts)
 {
     ADD_LOCK;
@@ -444,6 +468,7 @@ void MediaPacketQueue::ClearPacketAfterTimePosition(int64_t pts)
             mTotalDuration -= packet->getInfo().duration;
         }
 
+        mMemSize -= packet->getSize();
         mQueue.pop_back();
     }
 
@@ -30,6 +30,12 @@ namespace Cicada {
 
         int64_t GetDuration();
 
+        // the bytes of the packets held, including the backward ones
+        int64_t GetMemSize();
+
+        // the bitrate of the packets held in bps, 0 if unknown
+        int64_t GetBitrate();
+
         int64_t GetPts();
 
         int64_t GetKeyTimePositionBefore(int64_t pts);
@@ -73,6 +79,7 @@ namespace Cicada {
         int64_t mPacketDuration = 0;
         int64_t mDuration = 0;
         int64_t mTotalDuration = 0;
+        int64_t mMemSize = 0;
         uint64_t mMAXBackwardDuration{0};
 
         uint8_t *mDropedExtra_data{nullptr};
@@ -170,6 +170,8 @@ typedef enum PropertyKey {
     PROPERTY_KEY_NETWORK_REQUEST_LIST,
     PROPERTY_KEY_RENDER_INFO,
     PROPERTY_KEY_CONTAINER_INFO,
+    PROPERTY_KEY_METRICS,
+    PROPERTY_KEY_MEMORY_USAGE,
 } PropertyKey;
 
 typedef enum VideoTag {
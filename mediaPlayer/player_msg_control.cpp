@@ -7,8 +7,10 @@ namespace Cicada {
 
 #define REPLACE_NONE 0
 #define REPLACE_ALL (-1)
-#define REPLACE_LAST (-2)
-#define SEEK_REPEAT_TIME 500 //ms
+// overwrite the queued one where it is, keep its order to the others
+#define REPLACE_IN_PLACE (-2)
+// replace the last one if it is the opposite, e.g. start after pause
+#define REPLACE_OPPOSITE (-3)
 #define ADD_LOCK std::lock_guard<std::mutex> uMutex(mMutex)
 
     static int getRepeatTimeMS(PlayMsgType type)
@@ -26,15 +28,16 @@ namespace Cicada {
             case MSG_SET_ROTATE_MODE:
             case MSG_SET_MIRROR_MODE:
             case MSG_SET_VIDEO_BACKGROUND_COLOR:
+            case MSG_SET_SPEED:
                 return REPLACE_ALL;
 
+            // only the newest seek target matters
+            case MSG_SEEKTO:
+                return REPLACE_IN_PLACE;
+
             case MSG_START:
             case MSG_PAUSE:
-            case MSG_SET_SPEED:
-                return REPLACE_LAST;
-
-            case MSG_SEEKTO:
-                return SEEK_REPEAT_TIME;
+                return REPLACE_OPPOSITE;
 
             case MSG_INTERNAL_RENDERED:
             case MSG_ADD_EXT_SUBTITLE:
@@ -83,6 +86,11 @@ namespace Cicada {
 
     void PlayerMessageControl::putMsg(PlayMsgType type, const MsgParam &msgContent)
     {
+        if (MSG_SEEKTO == type) {
+            // abort the seek in processing before queue the new one
+            mProcessor.OnPlayerMsgSuperseded(type, msgContent);
+        }
+
         QueueMsgStruct qm;
         qm.msgType = type;
         qm.msgParam = msgContent;
@@ -103,49 +111,49 @@ namespace Cicada {
 
                 break;
 
-            case REPLACE_LAST:
-                if (!mMsgQueue.empty() && mMsgQueue.back().msgType == type) {
-                    recycleMsg(mMsgQueue.back());
-                    mMsgQueue.pop_back();
-                }
-
-                break;
-
-            case REPLACE_NONE:
-            default:
-                assert(repeatTime >= 0);
-
-                if (0 < repeatTime) {
-                    int count = 0;
-                    auto first = mMsgQueue.end();
-                    auto last = mMsgQueue.end();
-
-                    for (auto it = mMsgQueue.begin(); it != mMsgQueue.end(); ++it) {
-                        if (it->msgType == type) {
-                            ++count;
-
-                            if (mMsgQueue.end() == first) {
-                                first = it;
-                            }
+            case REPLACE_IN_PLACE: {
+                auto found = mMsgQueue.end();
 
-                            last = it;
-                        }
+                for (auto it = mMsgQueue.begin(); it != mMsgQueue.end();) {
+                    if (it->msgType != type) {
+                        ++it;
+                    } else if (found == mMsgQueue.end()) {
+                        recycleMsg(*it);
+                        *it = qm;
+                        found = it++;
+                    } else {
+                        recycleMsg(*it);
+                        it = mMsgQueue.erase(it);
                     }
+                }
 
-                    if (mMsgQueue.end() != last) {
-                        if (qm.msgTime - last->msgTime < repeatTime) {
-                            recycleMsg(*last);
-                            mMsgQueue.erase(last);
-                        }
-                    }
+                if (found != mMsgQueue.end()) {
+                    return;
+                }
+
+                break;
+            }
 
-                    if (2 <= count) {
-                        recycleMsg(*first);
-                        mMsgQueue.erase(first);
+            case REPLACE_OPPOSITE:
+                if (!mMsgQueue.empty()) {
+                    PlayMsgType last = mMsgQueue.back().msgType;
+
+                    /*
+                     * the pause/start pairs cancel out, only the last one decides the state, but a pause can't
+                     * cancel the start before playing, e.g. in prepared, it would be dropped and keep the player there
+                     */
+                    if (last == type || (last == MSG_PAUSE && type == MSG_START)
+                            || (last == MSG_START && type == MSG_PAUSE && mProcessor.OnPlayerMsgIsPlaying())) {
+                        recycleMsg(mMsgQueue.back());
+                        mMsgQueue.pop_back();
                     }
                 }
 
                 break;
+
+            case REPLACE_NONE:
+            default:
+                break;
         }
 
         mMsgQueue.push_back(qm);
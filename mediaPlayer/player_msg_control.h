@@ -126,6 +126,19 @@ namespace Cicada {
             return false;
         };
 
+        /*
+         * called in the thread of putMsg when a newer message supersedes the pending ones of the same type,
+         * the in processing one could be aborted here, such as a blocking demuxer seek.
+         */
+        virtual void OnPlayerMsgSuperseded(PlayMsgType msg, MsgParam msgContent)
+        {}
+
+        // called in the thread of putMsg, whether a pause could cancel a queued start
+        virtual bool OnPlayerMsgIsPlaying()
+        {
+            return false;
+        }
+
         virtual void ProcessPrepareMsg() = 0;
 
         virtual void ProcessStartMsg() = 0;
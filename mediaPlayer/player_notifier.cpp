@@ -5,6 +5,8 @@
 #define LOG_TAG "PlayerNotifier"
 #include <utils/timer.h>
 #include "player_notifier.h"
+#include <algorithm>
+#include <climits>
 #include <type_traits>
 
 #include <utils/frame_work_log.h>
@@ -25,6 +27,15 @@ namespace Cicada {
 #define ARG_FLAGS_13  (ARG_TYPE_1 | ARG_TYPE_3)
 #define ARG_FLAGS_123 (ARG_FLAGS_12 | ARG_TYPE_3)
 
+// must be power of 2
+#define EVENT_RING_SIZE 256
+#define SLEEPING_NONE 0
+// wake up by any event
+#define SLEEPING_ALL 1
+// the state events are rate limited, wake up by the other events only
+#define SLEEPING_EVENTS 2
+#define MAX_SLEEP_MS 1000
+
     static void releaseIPacket(void *data)
     {
         delete (IAFPacket *) data;
@@ -54,6 +65,9 @@ namespace Cicada {
 
         };
     public:
+        player_event() : data(nullptr), argFlags(-1)
+        {}
+
         explicit player_event(playerVoidCallback func)
             : arg1(0),
               arg2(0),
@@ -138,7 +152,48 @@ namespace Cicada {
             }
         }
 
+        player_event(const player_event &) = delete;
+
+        player_event &operator=(const player_event &) = delete;
+
+        player_event(player_event &&other) noexcept : data(nullptr), argFlags(-1)
+        {
+            *this = std::move(other);
+        }
+
+        player_event &operator=(player_event &&other) noexcept
+        {
+            if (this != &other) {
+                release();
+                mFunc = other.mFunc;
+                mRelease = other.mRelease;
+                mGeneration = other.mGeneration;
+                mMediaInfoGeneration = other.mMediaInfoGeneration;
+                mSequence = other.mSequence;
+                arg1 = other.arg1;
+                arg2 = other.arg2;
+                data = other.data;
+                argFlags = other.argFlags;
+                mKeepData = other.mKeepData;
+                other.data = nullptr;
+                other.argFlags = -1;
+            }
+
+            return *this;
+        }
+
+        bool isCallback(playerType13Callback func) const
+        {
+            return argFlags == ARG_FLAGS_13 && mFunc.p13 == func;
+        }
+
         ~player_event()
+        {
+            release();
+        }
+
+    private:
+        void release()
         {
             if (!mKeepData && data) {
                 if (mRelease) {
@@ -147,11 +202,16 @@ namespace Cicada {
                     free(data);
                 }
             }
+
+            data = nullptr;
         }
 
     public:
         function mFunc{nullptr};
         releaseFunc mRelease = nullptr;
+        uint32_t mGeneration{0};
+        uint32_t mMediaInfoGeneration{0};
+        uint64_t mSequence{0};
 
     private:
         int64_t arg1{};
@@ -161,9 +221,22 @@ namespace Cicada {
         bool mKeepData = false;
     };
 
+    struct player_event_cell {
+        std::atomic<size_t> sequence{0};
+        player_event event{};
+    };
+
     PlayerNotifier::PlayerNotifier()
     {
+        mRing = std::unique_ptr<player_event_cell[]>(new player_event_cell[EVENT_RING_SIZE]);
+        mRingMask = EVENT_RING_SIZE - 1;
+
+        for (size_t i = 0; i < EVENT_RING_SIZE; i++) {
+            mRing[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
         mpThread = NEW_AF_THREAD(post_loop);
+        mpThread->setCooperative(afThread::cooperativeEnabled());
     }
 
     PlayerNotifier::~PlayerNotifier()
@@ -171,12 +244,23 @@ namespace Cicada {
         {
             std::unique_lock<std::mutex> uMutex(mMutex);
             mRunning = false;
+            mSleeping = SLEEPING_NONE;
         }
         mCondition.notify_one();
         delete mpThread;
         Clean();
     }
 
+    void PlayerNotifier::setStateEventInterval(int intervalMs)
+    {
+        mStateEventIntervalMs = std::max(intervalMs, 0);
+    }
+
+    void PlayerNotifier::setCoalesceRenderedEvents(bool coalesce)
+    {
+        mCoalesceRendered = coalesce;
+    }
+
     void PlayerNotifier::setListener(const playerListener &listener)
     {
         mpThread->pause();
@@ -192,14 +276,12 @@ namespace Cicada {
         }
 
         if (width == -1 && height == -1) {
-            auto *event = new player_event(width, height, buffer, mListener.CaptureScreen, false, releaseAppleImage);
-            pushEvent(event);
+            pushEvent(player_event(width, height, buffer, mListener.CaptureScreen, false, releaseAppleImage));
             return;
         }
         auto *dupBuffer = static_cast<uint8_t *>(malloc(width * height * 4));
         memcpy(dupBuffer, buffer, width * height * 4);
-        auto *event = new player_event(width, height, dupBuffer, mListener.CaptureScreen, false);
-        pushEvent(event);
+        pushEvent(player_event(width, height, dupBuffer, mListener.CaptureScreen, false));
     }
 
     void PlayerNotifier::NotifyPosition(int64_t pos)
@@ -210,8 +292,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(pos, mListener.PositionUpdate);
-        pushEvent(event);
+        setStateEvent(state_event_position, pos, 0);
     }
 
     void PlayerNotifier::NotifyUtcTime(int64_t time)
@@ -222,8 +303,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(time, mListener.UtcTimeUpdate);
-        pushEvent(event);
+        setStateEvent(state_event_utc_time, time, 0);
     }
 
     void PlayerNotifier::NotifyBufferPosition(int64_t pos)
@@ -232,8 +312,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(pos, mListener.BufferPositionUpdate);
-        pushEvent(event);
+        setStateEvent(state_event_buffer_position, pos, 0);
     }
 
     void PlayerNotifier::NotifyVideoSizeChanged(int64_t width, int64_t height)
@@ -242,8 +321,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(width, height, mListener.VideoSizeChanged);
-        pushEvent(event);
+        pushEvent(player_event(width, height, mListener.VideoSizeChanged));
     }
 
     void PlayerNotifier::NotifyVideoRendered(int64_t timeMs, int64_t pts)
@@ -252,8 +330,12 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(timeMs, pts, mListener.VideoRendered);
-        pushEvent(event);
+        if (mCoalesceRendered) {
+            setStateEvent(state_event_video_rendered, timeMs, pts);
+            return;
+        }
+
+        pushEvent(player_event(timeMs, pts, mListener.VideoRendered));
     }
 
     void PlayerNotifier::NotifyAudioRendered(int64_t timeMs, int64_t pts)
@@ -262,8 +344,12 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(timeMs, pts, mListener.AudioRendered);
-        pushEvent(event);
+        if (mCoalesceRendered) {
+            setStateEvent(state_event_audio_rendered, timeMs, pts);
+            return;
+        }
+
+        pushEvent(player_event(timeMs, pts, mListener.AudioRendered));
     }
 
     void PlayerNotifier::NotifyFirstFrame()
@@ -281,8 +367,9 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(0, mediaInfo, mListener.MediaInfoGet, true);
-        pushEvent(event);
+        player_event event(0, mediaInfo, mListener.MediaInfoGet, true);
+        event.mMediaInfoGeneration = mMediaInfoGeneration;
+        pushEvent(std::move(event));
     }
 
     void PlayerNotifier::CancelNotifyMediaInfo()
@@ -291,13 +378,8 @@ namespace Cicada {
             return;
         }
 
-        std::unique_lock<std::mutex> uMutex(mMutex);
-
-        for (auto &event : mEventQueue) {
-            if (event->mFunc.p13 == mListener.MediaInfoGet) {
-                mEventQueue.remove(event);
-            }
-        }
+        // the queued ones are dropped in post_loop
+        mMediaInfoGeneration++;
     }
 
     void PlayerNotifier::NotifySubtitleEvent(subTitle_event id, IAFPacket *packet, int64_t index, const char *url)
@@ -351,8 +433,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(code, strdup(desc), mListener.EventCallback);
-        pushEvent(event);
+        pushEvent(player_event(code, strdup(desc), mListener.EventCallback));
     }
 
     void PlayerNotifier::NotifyError(int code, const char *desc)
@@ -361,8 +442,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(code, strdup(desc), mListener.ErrorCallback);
-        pushEvent(event);
+        pushEvent(player_event(code, strdup(desc), mListener.ErrorCallback));
     }
 
     void PlayerNotifier::NotifyCompletion()
@@ -389,8 +469,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(listener);
-        pushEvent(event);
+        pushEvent(player_event(listener));
     }
 
     void PlayerNotifier::NotifySeeking(bool seekInCache) {
@@ -398,8 +477,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(seekInCache ? 1 : 0 , mListener.Seeking);
-        pushEvent(event);
+        pushEvent(player_event(seekInCache ? 1 : 0 , mListener.Seeking));
     }
 
     void PlayerNotifier::NotifySeekEnd(bool seekInCache)
@@ -408,8 +486,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(seekInCache ? 1 : 0, mListener.SeekEnd);
-        pushEvent(event);
+        pushEvent(player_event(seekInCache ? 1 : 0, mListener.SeekEnd));
     }
 
     void PlayerNotifier::NotifyStreamChanged(StreamInfo *info, StreamType type)
@@ -418,8 +495,7 @@ namespace Cicada {
             return;
         }
 
-        auto *event = new player_event(type, info, mListener.StreamSwitchSuc, true);
-        pushEvent(event);
+        pushEvent(player_event(type, info, mListener.StreamSwitchSuc, true));
     }
 
     void PlayerNotifier::NotifyPrepared()
@@ -471,19 +547,217 @@ namespace Cicada {
 
     void PlayerNotifier::pushEvent(player_event *event)
     {
+        pushEvent(std::move(*event));
+        delete event;
+    }
+
+    void PlayerNotifier::pushEvent(player_event &&event)
+    {
+        event.mGeneration = mGeneration;
+        event.mSequence = mPushedCount++;
+
+        // keep the order, don't use the ring until the overflowed ones are delivered
+        if (mOverflowCount > 0 || !tryPushRing(event)) {
+            std::unique_lock<std::mutex> uMutex(mMutex);
+            mOverflow.push_back(std::move(event));
+            mOverflowCount++;
+        }
+
+        if (mSleeping.exchange(SLEEPING_NONE) != SLEEPING_NONE) {
+            wakeUpLoop();
+        }
+    }
+
+    bool PlayerNotifier::tryPushRing(player_event &event)
+    {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        player_event_cell *cell;
+
+        while (true) {
+            cell = &mRing[pos & mRingMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t) sequence - (intptr_t) pos;
+
+            if (diff == 0) {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // full
+                return false;
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->event = std::move(event);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only called by post_loop
+    bool PlayerNotifier::popEvent(player_event &event)
+    {
+        player_event_cell &cell = mRing[mDequeuePos & mRingMask];
+
+        if (cell.sequence.load(std::memory_order_acquire) == mDequeuePos + 1) {
+            event = std::move(cell.event);
+            cell.sequence.store(mDequeuePos + mRingMask + 1, std::memory_order_release);
+            mDequeuePos++;
+            return true;
+        }
+
+        if (mOverflowCount > 0) {
+            std::unique_lock<std::mutex> uMutex(mMutex);
+
+            if (!mOverflow.empty()) {
+                event = std::move(mOverflow.front());
+                mOverflow.pop_front();
+                mOverflowCount--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void PlayerNotifier::setStateEvent(StateEvent type, int64_t arg1, int64_t arg2)
+    {
+        StateSlot &slot = mStateSlots[type];
+        uint32_t sequence;
+
+        // writers are serialized by the odd sequence, readers retry on it
+        do {
+            sequence = slot.sequence.load(std::memory_order_relaxed) & ~1u;
+        } while (!slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire));
+
+        slot.arg1.store(arg1, std::memory_order_relaxed);
+        slot.arg2.store(arg2, std::memory_order_relaxed);
+        slot.pushedBefore.store(mPushedCount, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        slot.dirty = true;
+
+        int sleeping = SLEEPING_ALL;
+
+        if (mSleeping.compare_exchange_strong(sleeping, SLEEPING_NONE)) {
+            wakeUpLoop();
+        }
+    }
+
+    void PlayerNotifier::wakeUpLoop()
+    {
+        if (mpThread->isCooperative()) {
+            mpThread->wakeUp();
+            return;
+        }
+
         std::unique_lock<std::mutex> uMutex(mMutex);
-        mEventQueue.push_back(unique_ptr<player_event>(event));
         mCondition.notify_one();
     }
 
+    int64_t PlayerNotifier::deliverStateEvents(bool force, uint64_t eventSequence)
+    {
+        int64_t waitMs = INT64_MAX;
+        int interval = mStateEventIntervalMs;
+        int64_t now = af_getsteady_ms();
+
+        for (int type = 0; type < state_event_max; type++) {
+            StateSlot &slot = mStateSlots[type];
+
+            if (!slot.dirty) {
+                continue;
+            }
+
+            if (!force && interval > 0 && slot.lastDeliverMs != INT64_MIN && now - slot.lastDeliverMs < interval) {
+                waitMs = std::min(waitMs, interval - (now - slot.lastDeliverMs));
+                continue;
+            }
+
+            int64_t arg1;
+            int64_t arg2;
+            uint64_t pushedBefore;
+            uint32_t sequence;
+
+            do {
+                sequence = slot.sequence.load(std::memory_order_acquire);
+                arg1 = slot.arg1.load(std::memory_order_relaxed);
+                arg2 = slot.arg2.load(std::memory_order_relaxed);
+                pushedBefore = slot.pushedBefore.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((sequence & 1) || sequence != slot.sequence.load(std::memory_order_relaxed));
+
+            // the value is newer than the event, keep it after the event
+            if (pushedBefore > eventSequence) {
+                continue;
+            }
+
+            slot.dirty = false;
+
+            // set again while reading, the newer value will be delivered next time
+            if (sequence != slot.sequence.load(std::memory_order_acquire)) {
+                slot.dirty = true;
+            }
+
+            slot.lastDeliverMs = now;
+            deliverStateEvent((StateEvent) type, arg1, arg2);
+        }
+
+        return waitMs;
+    }
+
+    void PlayerNotifier::deliverStateEvent(StateEvent type, int64_t arg1, int64_t arg2)
+    {
+        void *userData = mListener.userData;
+
+        switch (type) {
+            case state_event_position:
+                if (mListener.PositionUpdate) {
+                    mListener.PositionUpdate(arg1, userData);
+                }
+                break;
+
+            case state_event_buffer_position:
+                if (mListener.BufferPositionUpdate) {
+                    mListener.BufferPositionUpdate(arg1, userData);
+                }
+                break;
+
+            case state_event_download_speed:
+                if (mListener.CurrentDownLoadSpeed) {
+                    mListener.CurrentDownLoadSpeed(arg1, userData);
+                }
+                break;
+
+            case state_event_utc_time:
+                if (mListener.UtcTimeUpdate) {
+                    mListener.UtcTimeUpdate(arg1, userData);
+                }
+                break;
+
+            case state_event_video_rendered:
+                if (mListener.VideoRendered) {
+                    mListener.VideoRendered(arg1, arg2, userData);
+                }
+                break;
+
+            case state_event_audio_rendered:
+                if (mListener.AudioRendered) {
+                    mListener.AudioRendered(arg1, arg2, userData);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
     void PlayerNotifier::NotifyPlayerStatusChanged(PlayerStatus from, PlayerStatus to)
     {
         if (!mEnable || mListener.StatusChanged == nullptr) {
             return;
         }
 
-        auto *event = new player_event(from, to, mListener.StatusChanged);
-        pushEvent(event);
+        pushEvent(player_event(from, to, mListener.StatusChanged));
     }
 
     int PlayerNotifier::post_loop()
@@ -492,28 +766,51 @@ namespace Cicada {
             return -1;
         }
 
-        std::unique_ptr<player_event> playerEvent = nullptr;
-        {
-            std::unique_lock<std::mutex> uMutex(mMutex);
+        player_event event{};
+
+        if (popEvent(event)) {
+            // deliver the state events happened before it, the newer ones stay after it
+            deliverStateEvents(true, event.mSequence);
+
+            if (event.mGeneration == mGeneration &&
+                !(event.isCallback(mListener.MediaInfoGet) && event.mMediaInfoGeneration != mMediaInfoGeneration)) {
+                event.onEvent(mListener.userData);
+            }
+
+            return 0;
+        }
+
+        int64_t waitMs = deliverStateEvents(false);
+        mSleeping = waitMs == INT64_MAX ? SLEEPING_ALL : SLEEPING_EVENTS;
 
-            if (mEventQueue.empty()) {
-                mCondition.wait(uMutex, [this]() {
-                    return !mRunning || !mEventQueue.empty();
-                });
+        // check again after mSleeping is set, the producers check mSleeping after pushed
+        if (mRing[mDequeuePos & mRingMask].sequence.load() == mDequeuePos + 1 || mOverflowCount > 0) {
+            mSleeping = SLEEPING_NONE;
+            return 0;
+        }
 
-                if (mEventQueue.empty()) {
+        if (waitMs == INT64_MAX) {
+            for (auto &slot : mStateSlots) {
+                if (slot.dirty) {
+                    mSleeping = SLEEPING_NONE;
                     return 0;
                 }
             }
-
-            playerEvent = move(mEventQueue.front());
-            mEventQueue.pop_front();
         }
 
-        if (playerEvent != nullptr) {
-            playerEvent->onEvent(mListener.userData);
+        waitMs = std::min(waitMs, (int64_t) MAX_SLEEP_MS);
+
+        if (mpThread->isCooperative()) {
+            // don't hold the worker, the producers will wake us up
+            mpThread->delayNextRun((int) waitMs);
+            return 0;
         }
 
+        std::unique_lock<std::mutex> uMutex(mMutex);
+        mCondition.wait_for(uMutex, std::chrono::milliseconds(waitMs), [this]() {
+            return !mRunning || mSleeping == SLEEPING_NONE;
+        });
+        mSleeping = SLEEPING_NONE;
         return 0;
     }
 
@@ -524,19 +821,23 @@ namespace Cicada {
 
     void PlayerNotifier::Clean()
     {
-        std::unique_lock<std::mutex> uMutex(mMutex);
+        // the events in the ring are dropped in post_loop
+        mGeneration++;
 
-        while (!mEventQueue.empty()) {
-            mEventQueue.pop_front();
+        for (auto &slot : mStateSlots) {
+            slot.dirty = false;
         }
+
+        std::unique_lock<std::mutex> uMutex(mMutex);
+        mOverflow.clear();
+        mOverflowCount = 0;
     }
     void PlayerNotifier::NotifyCurrentDownloadSpeed(float speed)
     {
         if (speed != mCurrentDownloadSpeed) {
             mCurrentDownloadSpeed = speed;
 
-            auto *event = new player_event((int64_t) speed, mListener.CurrentDownLoadSpeed);
-            pushEvent(event);
+            setStateEvent(state_event_download_speed, (int64_t) speed, 0);
         }
     }
 }
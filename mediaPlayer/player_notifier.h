@@ -5,9 +5,11 @@
 #ifndef CICADA_PLAYER_PLAYER_NOTIFIER_H
 #define CICADA_PLAYER_PLAYER_NOTIFIER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
 //#include "apsara_player_event_def.h"
 #include "native_cicada_player_def.h"
 #include "utils/afThread.h"
@@ -27,6 +29,8 @@ namespace Cicada {
 
     class player_event;
 
+    struct player_event_cell;
+
     class PlayerNotifier {
     public:
         PlayerNotifier();
@@ -88,20 +92,87 @@ namespace Cicada {
 
         void NotifySeeking(bool seekInCache);
 
+        /*
+         * The minimum interval of the state events (position, buffer position, download speed,
+         * utc time and the coalesced rendered ones), only the newest value is delivered, 0 means no limit.
+         */
+        void setStateEventInterval(int intervalMs);
+
+        // deliver only the newest VideoRendered/AudioRendered as state events, every one is delivered by default
+        void setCoalesceRenderedEvents(bool coalesce);
+
     private:
+        enum StateEvent {
+            state_event_position,
+            state_event_buffer_position,
+            state_event_download_speed,
+            state_event_utc_time,
+            state_event_video_rendered,
+            state_event_audio_rendered,
+            state_event_max,
+        };
+
+        // the last value of a state event, written by a seqlock
+        struct StateSlot {
+            std::atomic<uint32_t> sequence{0};
+            std::atomic<int64_t> arg1{0};
+            std::atomic<int64_t> arg2{0};
+            // the count of the events pushed before the value, it is delivered after them
+            std::atomic<uint64_t> pushedBefore{0};
+            std::atomic_bool dirty{false};
+            int64_t lastDeliverMs{INT64_MIN};
+        };
 
         void NotifyVoidEvent(playerVoidCallback listener);
 
         void pushEvent(player_event *event);
 
+        void pushEvent(player_event &&event);
+
+        bool tryPushRing(player_event &event);
+
+        bool popEvent(player_event &event);
+
+        void setStateEvent(StateEvent type, int64_t arg1, int64_t arg2);
+
+        /*
+         * deliver the dirty state events, return the time to wait for the rate limited ones,
+         * force is to deliver the ones set before the event of eventSequence without the rate limit
+         */
+        int64_t deliverStateEvents(bool force, uint64_t eventSequence = UINT64_MAX);
+
+        void deliverStateEvent(StateEvent type, int64_t arg1, int64_t arg2);
+
+        void wakeUpLoop();
+
         int post_loop();
 
     private:
         playerListener mListener{nullptr};
-        std::list<std::unique_ptr<player_event>> mEventQueue;
+
+        // the bounded MPSC ring of preallocated events
+        std::unique_ptr<player_event_cell[]> mRing{nullptr};
+        size_t mRingMask{0};
+        std::atomic<size_t> mEnqueuePos{0};
+        size_t mDequeuePos{0};
+        // used when the ring is full, keep in order with the ring
+        std::list<player_event> mOverflow;
+        std::atomic<int> mOverflowCount{0};
+        // the sequence of the next pushed event
+        std::atomic<uint64_t> mPushedCount{0};
+
+        StateSlot mStateSlots[state_event_max];
+        std::atomic<int> mStateEventIntervalMs{0};
+        std::atomic_bool mCoalesceRendered{false};
+
+        // the events pushed before Clean() are dropped
+        std::atomic<uint32_t> mGeneration{0};
+        std::atomic<uint32_t> mMediaInfoGeneration{0};
+
         std::mutex mMutex;
         afThread *mpThread;
         std::condition_variable mCondition;
+        std::atomic<int> mSleeping{0};
         bool mEnable = true;
         std::atomic_bool mRunning{true};
         float mCurrentDownloadSpeed{0};
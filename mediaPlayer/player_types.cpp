@@ -63,6 +63,8 @@ namespace Cicada {
         maxASeekDelta = 21 * 1000 * 1000;
         maxVideoRecoverSize = 300;
         mFastStart = true;
+        mPreRoll = false;
+        mAsyncStop = false;
         pixelBufferOutputFormat = 0;
         drmMagicKey = "";
         sessionId = "";
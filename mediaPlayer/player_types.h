@@ -62,6 +62,10 @@ namespace Cicada {
 
         int maxVideoRecoverSize{};
         bool mFastStart{true};
+        // decode the first frame in prepare, show it at once when start
+        bool mPreRoll{false};
+        // release the demuxer and the data source in background when stop, see SMPPipelineReaper for the bound
+        bool mAsyncStop{false};
         uint32_t pixelBufferOutputFormat{};
         string drmMagicKey;
         string sessionId{};
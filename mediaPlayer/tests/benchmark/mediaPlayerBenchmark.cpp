@@ -0,0 +1,309 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+/*
+ * Drive the whole player pipeline headless and as fast as it can go over a matrix of local fixtures, then print the
+ * results as JSON, so the regressions can be tracked per commit.
+ *
+ *   mediaPlayerBenchmark <fixture dir> [result.json]
+ *
+ * The fixtures are named as <codec>_<resolution><container>, e.g. h264_1080p.ts, hevc_2160p_frag.mp4,
+ * the missing ones are reported as skipped.
+ */
+
+#include <MediaPlayer.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <data_source/dataSourcePrototype.h>
+#include <demuxer/demuxer_service.h>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utils/CicadaJSON.h>
+#include <utils/file/FileUtils.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#define PLAY_TIMEOUT_MS (10 * 60 * 1000)
+#define SAMPLE_INTERVAL_MS 10
+
+using namespace Cicada;
+using namespace std;
+
+// the C++ heap only, the buffers allocated by ffmpeg are not counted
+static atomic<uint64_t> gAllocations{0};
+
+void *operator new(size_t size)
+{
+    gAllocations++;
+    void *ptr = malloc(size ? size : 1);
+
+    if (ptr == nullptr) {
+        throw bad_alloc();
+    }
+
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+static int64_t getResidentBytes()
+{
+#ifdef __linux__
+    long pages = 0;
+    long resident = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+
+    if (file == nullptr) {
+        return -1;
+    }
+
+    if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+        resident = -1;
+    }
+
+    fclose(file);
+    return resident < 0 ? -1 : (int64_t) resident * sysconf(_SC_PAGESIZE);
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) {
+        return -1;
+    }
+
+    return (int64_t) info.resident_size;
+#else
+    return -1;
+#endif
+}
+
+typedef struct benchCase {
+    string name;
+    string path;
+} benchCase;
+
+typedef struct playContext {
+    atomic<bool> completed{false};
+    atomic<bool> error{false};
+} playContext;
+
+static void onCompletion(void *userData)
+{
+    static_cast<playContext *>(userData)->completed = true;
+}
+
+static void onError(int64_t errorCode, const void *errorMsg, void *userData)
+{
+    AF_LOGE("play error %lld %s\n", errorCode, errorMsg ? (const char *) errorMsg : "");
+    static_cast<playContext *>(userData)->error = true;
+}
+
+static int demuxFile(const string &path, CicadaJSONItem &result)
+{
+    IDataSource *source = dataSourcePrototype::create(path);
+
+    if (source == nullptr) {
+        return -EINVAL;
+    }
+
+    int64_t start = af_gettime_relative();
+    int64_t packets = 0;
+    int64_t bytes = 0;
+    int ret = source->Open(0);
+
+    if (ret >= 0) {
+        unique_ptr<demuxer_service> service = unique_ptr<demuxer_service>(new demuxer_service(source));
+        service->createDemuxer(demuxer_type_unknown);
+        ret = service->initOpen();
+
+        if (ret >= 0) {
+            int nbStream = service->GetNbStreams();
+
+            for (int i = 0; i < nbStream; i++) {
+                service->OpenStream(i);
+            }
+
+            service->start();
+
+            do {
+                unique_ptr<IAFPacket> packet{};
+                ret = service->readPacket(packet);
+
+                if (packet) {
+                    packets++;
+                    bytes += packet->getSize();
+                }
+            } while (ret > 0 || ret == -EAGAIN);
+        }
+
+        service->close();
+    }
+
+    delete source;
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    double seconds = (double) (af_gettime_relative() - start) / 1000000;
+    int64_t fileSize = FileUtils::getFileLength(path.c_str());
+    result.addValue("demuxMs", seconds * 1000);
+    result.addValue("demuxPackets", (double) packets);
+    result.addValue("demuxMBps", (double) fileSize / (1024 * 1024) / std::max(seconds, 0.000001));
+    result.addValue("payloadBytes", (double) bytes);
+    return 0;
+}
+
+static int playFile(const string &path, CicadaJSONItem &result)
+{
+    playContext context{};
+    playerListener listener{nullptr};
+    listener.Completion = onCompletion;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    int64_t baseRss = getResidentBytes();
+    int64_t peakRss = baseRss;
+    uint64_t allocations = gAllocations;
+    int64_t start = af_gettime_relative();
+    int64_t duration;
+    string metrics;
+
+    {
+        unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+        int view;
+        player->SetView(&view);
+        player->SetListener(listener);
+        player->SetDataSource(path.c_str());
+        player->SetAutoPlay(true);
+        player->Prepare();
+
+        while (!context.completed && !context.error && af_gettime_relative() - start < PLAY_TIMEOUT_MS * 1000LL) {
+            af_msleep(SAMPLE_INTERVAL_MS);
+            peakRss = std::max(peakRss, getResidentBytes());
+        }
+
+        metrics = player->GetPropertyString(PROPERTY_KEY_METRICS);
+        duration = player->GetDuration();
+        player->Stop();
+    }
+
+    if (!context.completed) {
+        return context.error ? -EIO : -ETIMEDOUT;
+    }
+
+    double seconds = (double) (af_gettime_relative() - start) / 1000000;
+    allocations = gAllocations - allocations;
+    CicadaJSONItem json(metrics);
+    CicadaJSONItem counters = json.getItem("counters");
+    CicadaJSONItem startup = json.getItem("histograms").getItem("startup.firstFrame");
+    int64_t decoded = counters.getInt64("decode.videoFrames", 0);
+    int64_t rendered = counters.getInt64("render.videoFrames", 0);
+    int64_t dropped = counters.getInt64("drop.late", 0) + counters.getInt64("drop.catchUp", 0) +
+                      counters.getInt64("drop.decoderBehind", 0);
+
+    result.addValue("playMs", seconds * 1000);
+    result.addValue("mediaMs", (double) duration);
+    result.addValue("speed", (double) duration / 1000 / seconds);
+    result.addValue("firstFrameMs", startup.getDouble("max", -1));
+    result.addValue("decodeFps", (double) decoded / seconds);
+    result.addValue("renderFps", (double) rendered / seconds);
+    result.addValue("droppedFrames", (double) dropped);
+    result.addValue("peakRssMB", (double) peakRss / (1024 * 1024));
+    result.addValue("peakRssDeltaMB", (double) (peakRss - baseRss) / (1024 * 1024));
+    result.addValue("allocsPerFrame", decoded > 0 ? (double) allocations / (double) decoded : -1.0);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    string dir = argc > 1 ? argv[1] : ".";
+    string output = argc > 2 ? argv[2] : "";
+    log_set_level(AF_LOG_LEVEL_WARNING, 1);
+
+    globalSettings::getSetting().setProperty("protected.render.headless", "ON");
+    globalSettings::getSetting().setProperty("protected.clock.unthrottled", "ON");
+
+    const char *codecs[] = {"h264", "hevc"};
+    const char *resolutions[] = {"1080p", "2160p"};
+    const char *containers[][2] = {{"ts", ".ts"}, {"mp4", ".mp4"}, {"fmp4", "_frag.mp4"}};
+    vector<benchCase> cases;
+
+    for (const char *codec : codecs) {
+        for (const char *resolution : resolutions) {
+            for (auto &container : containers) {
+                string base = string(codec) + "_" + resolution;
+                cases.push_back({base + "_" + container[0], dir + "/" + base + container[1]});
+            }
+        }
+    }
+
+    CicadaJSONArray results{};
+    int failed = 0;
+
+    for (auto &item : cases) {
+        CicadaJSONItem result{};
+        result.addValue("name", item.name);
+
+        if (!FileUtils::isFileExist(item.path.c_str())) {
+            result.addValue("skipped", true);
+            results.addJSON(result);
+            continue;
+        }
+
+        int ret = demuxFile(item.path, result);
+
+        if (ret >= 0) {
+            ret = playFile(item.path, result);
+        }
+
+        if (ret < 0) {
+            AF_LOGE("%s failed %d\n", item.name.c_str(), ret);
+            result.addValue("error", ret);
+            failed++;
+        }
+
+        results.addJSON(result);
+        fprintf(stderr, "%s\n", result.printJSON().c_str());
+    }
+
+    CicadaJSONItem report{};
+    report.addValue("fixtures", dir);
+    report.addArray("results", results);
+    string json = report.printJSON();
+    printf("%s\n", json.c_str());
+
+    if (!output.empty()) {
+        ofstream file(output);
+        file << json << endl;
+    }
+
+    return failed > 0 ? 1 : 0;
+}
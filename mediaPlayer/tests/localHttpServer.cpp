@@ -0,0 +1,341 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "localHttpServer.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/frame_work_log.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define MAX_HEADER_SIZE (16 * 1024)
+#define SEND_CHUNK_SIZE (64 * 1024)
+
+using namespace std;
+
+static int sendAll(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return -errno;
+        }
+
+        data += ret;
+        size -= ret;
+    }
+
+    return 0;
+}
+
+static string getHeader(const string &request, const char *name)
+{
+    size_t nameLen = strlen(name);
+    size_t pos = request.find("\r\n");
+
+    while (pos != string::npos && pos + 2 < request.size()) {
+        size_t start = pos + 2;
+        pos = request.find("\r\n", start);
+        string line = request.substr(start, pos == string::npos ? string::npos : pos - start);
+
+        if (line.size() > nameLen && strncasecmp(line.c_str(), name, nameLen) == 0 && line[nameLen] == ':') {
+            size_t valueStart = line.find_first_not_of(' ', nameLen + 1);
+            return valueStart == string::npos ? "" : line.substr(valueStart);
+        }
+    }
+
+    return "";
+}
+
+localHttpServer::localHttpServer(const string &root) : mRoot(root)
+{}
+
+localHttpServer::~localHttpServer()
+{
+    stop();
+}
+
+int localHttpServer::start()
+{
+    mListenFd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (mListenFd < 0) {
+        return -errno;
+    }
+
+    int on = 1;
+    setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+
+    if (::bind(mListenFd, (sockaddr *) &addr, sizeof(addr)) < 0 || listen(mListenFd, 16) < 0 ||
+        getsockname(mListenFd, (sockaddr *) &addr, &len) < 0) {
+        int ret = -errno;
+        close(mListenFd);
+        mListenFd = -1;
+        return ret;
+    }
+
+    mPort = ntohs(addr.sin_port);
+    mStopped = false;
+    mAcceptThread = thread(&localHttpServer::acceptLoop, this);
+    AF_LOGI("local http server on port %d, root %s\n", mPort, mRoot.c_str());
+    return mPort;
+}
+
+void localHttpServer::stop()
+{
+    if (mListenFd < 0) {
+        return;
+    }
+
+    mStopped = true;
+    shutdown(mListenFd, SHUT_RDWR);
+    close(mListenFd);
+    mListenFd = -1;
+
+    if (mAcceptThread.joinable()) {
+        mAcceptThread.join();
+    }
+
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        for (int fd : mClients) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    for (auto &item : mClientThreads) {
+        item.join();
+    }
+
+    mClientThreads.clear();
+}
+
+string localHttpServer::getUrl(const string &path) const
+{
+    return "http://127.0.0.1:" + to_string(mPort) + "/" + path;
+}
+
+void localHttpServer::acceptLoop()
+{
+    while (!mStopped) {
+        int fd = accept(mListenFd, nullptr, nullptr);
+
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        lock_guard<mutex> lock(mMutex);
+
+        if (mStopped) {
+            close(fd);
+            break;
+        }
+
+        mClients.push_back(fd);
+        mClientThreads.emplace_back(&localHttpServer::serve, this, fd);
+    }
+}
+
+void localHttpServer::serve(int fd)
+{
+    string buffer;
+    char data[4096];
+    bool keepAlive = true;
+
+    while (keepAlive && !mStopped) {
+        size_t end;
+
+        while ((end = buffer.find("\r\n\r\n")) == string::npos && buffer.size() < MAX_HEADER_SIZE) {
+            ssize_t ret = recv(fd, data, sizeof(data), 0);
+
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (ret <= 0) {
+                keepAlive = false;
+                break;
+            }
+
+            buffer.append(data, ret);
+        }
+
+        if (end == string::npos) {
+            break;
+        }
+
+        string request = buffer.substr(0, end + 2);
+        buffer.erase(0, end + 4);
+        char method[16] = {0};
+        char target[2048] = {0};
+
+        if (sscanf(request.c_str(), "%15s %2047s", method, target) != 2) {
+            break;
+        }
+
+        string path = target;
+        path = path.substr(0, path.find('?'));
+        keepAlive = strcasecmp(getHeader(request, "Connection").c_str(), "close") != 0;
+        bool head = strcmp(method, "HEAD") == 0;
+
+        if ((!head && strcmp(method, "GET") != 0) || path.find("..") != string::npos) {
+            const char *response = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            sendAll(fd, response, strlen(response));
+            break;
+        }
+
+        if (sendFile(fd, mRoot + path, getHeader(request, "Range"), head, keepAlive) < 0) {
+            break;
+        }
+    }
+
+    lock_guard<mutex> lock(mMutex);
+
+    for (auto it = mClients.begin(); it != mClients.end(); ++it) {
+        if (*it == fd) {
+            mClients.erase(it);
+            break;
+        }
+    }
+
+    close(fd);
+}
+
+int localHttpServer::sendFile(int fd, const string &path, const string &range, bool head, bool keepAlive)
+{
+    const char *connection = keepAlive ? "keep-alive" : "close";
+    char header[1024];
+    int file = open(path.c_str(), O_RDONLY);
+    struct stat fileStat {};
+
+    if (file < 0 || fstat(file, &fileStat) < 0 || !S_ISREG(fileStat.st_mode)) {
+        if (file >= 0) {
+            close(file);
+        }
+
+        int len = snprintf(header, sizeof(header), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n",
+                           connection);
+        return sendAll(fd, header, len);
+    }
+
+    int64_t size = fileStat.st_size;
+    int64_t start = 0;
+    int64_t last = size - 1;
+    bool partial = false;
+
+    if (range.compare(0, 6, "bytes=") == 0) {
+        const char *spec = range.c_str() + 6;
+        char *next = nullptr;
+        partial = true;
+
+        if (*spec == '-') {
+            // the suffix range, the last n bytes
+            start = std::max(size - (int64_t) strtoll(spec + 1, nullptr, 10), (int64_t) 0);
+        } else {
+            start = strtoll(spec, &next, 10);
+
+            if (next && *next == '-' && *(next + 1) != '\0') {
+                last = std::min((int64_t) strtoll(next + 1, nullptr, 10), last);
+            }
+        }
+    }
+
+    if (start > last) {
+        close(file);
+        int len = snprintf(header, sizeof(header),
+                           "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%lld\r\nContent-Length: 0\r\n"
+                           "Connection: %s\r\n\r\n",
+                           (long long) size, connection);
+        return sendAll(fd, header, len);
+    }
+
+    int64_t length = last - start + 1;
+    int len;
+
+    if (partial) {
+        len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 206 Partial Content\r\nContent-Type: %s\r\nContent-Length: %lld\r\n"
+                       "Content-Range: bytes %lld-%lld/%lld\r\nAccept-Ranges: bytes\r\nConnection: %s\r\n\r\n",
+                       getContentType(path), (long long) length, (long long) start, (long long) last, (long long) size,
+                       connection);
+    } else {
+        len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %lld\r\nAccept-Ranges: bytes\r\n"
+                       "Connection: %s\r\n\r\n",
+                       getContentType(path), (long long) length, connection);
+    }
+
+    int ret = sendAll(fd, header, len);
+
+    if (ret >= 0 && !head) {
+        char data[SEND_CHUNK_SIZE];
+        lseek(file, start, SEEK_SET);
+
+        while (length > 0 && !mStopped) {
+            ssize_t readSize = read(file, data, (size_t) std::min(length, (int64_t) sizeof(data)));
+
+            if (readSize <= 0) {
+                ret = -EIO;
+                break;
+            }
+
+            ret = sendAll(fd, data, readSize);
+
+            if (ret < 0) {
+                break;
+            }
+
+            length -= readSize;
+        }
+    }
+
+    close(file);
+    return ret;
+}
+
+const char *localHttpServer::getContentType(const string &path)
+{
+    size_t pos = path.rfind('.');
+    string ext = pos == string::npos ? "" : path.substr(pos + 1);
+
+    if (ext == "m3u8") {
+        return "application/vnd.apple.mpegurl";
+    } else if (ext == "mpd") {
+        return "application/dash+xml";
+    } else if (ext == "ts") {
+        return "video/mp2t";
+    } else if (ext == "mp4" || ext == "m4s" || ext == "m4v") {
+        return "video/mp4";
+    } else if (ext == "m4a" || ext == "aac") {
+        return "audio/mp4";
+    }
+
+    return "application/octet-stream";
+}
@@ -0,0 +1,53 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_LOCALHTTPSERVER_H
+#define CICADAMEDIA_LOCALHTTPSERVER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * A tiny HTTP/1.1 file server on the loopback, serves GET and HEAD with the Range and keep-alive,
+ * so the HLS/DASH fixtures can be played locally without the network.
+ */
+class localHttpServer {
+public:
+    explicit localHttpServer(const std::string &root);
+
+    ~localHttpServer();
+
+    // listen on a free port of 127.0.0.1, return the port, or a negative errno
+    int start();
+
+    void stop();
+
+    // http://127.0.0.1:port/path
+    std::string getUrl(const std::string &path) const;
+
+private:
+    void acceptLoop();
+
+    void serve(int fd);
+
+    int sendFile(int fd, const std::string &path, const std::string &range, bool head, bool keepAlive);
+
+    static const char *getContentType(const std::string &path);
+
+private:
+    std::string mRoot;
+    int mListenFd{-1};
+    int mPort{0};
+    std::atomic<bool> mStopped{false};
+    std::thread mAcceptThread{};
+    std::mutex mMutex{};
+    std::vector<int> mClients{};
+    std::vector<std::thread> mClientThreads{};
+};
+
+
+#endif//CICADAMEDIA_LOCALHTTPSERVER_H
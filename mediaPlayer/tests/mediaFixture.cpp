@@ -0,0 +1,474 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "mediaFixture.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utils/file/FileUtils.h>
+#include <utils/frame_work_log.h>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mem.h>
+}
+
+// the frame_num and the idr_pic_id are coded in 8 bits
+#define LOG2_MAX_FRAME_NUM 8
+#define PCM_CHROMA_VALUE 128
+
+using namespace std;
+using namespace Cicada;
+
+namespace {
+    class bitWriter {
+    public:
+        void putBit(int bit)
+        {
+            if (mBits == 0) {
+                mData.push_back(0);
+            }
+
+            if (bit) {
+                mData.back() |= (uint8_t) (0x80 >> mBits);
+            }
+
+            mBits = (mBits + 1) & 7;
+        }
+
+        void putBits(uint32_t value, int count)
+        {
+            for (int i = count - 1; i >= 0; i--) {
+                putBit((value >> i) & 1);
+            }
+        }
+
+        // ue(v), the Exp-Golomb code
+        void putUe(uint32_t value)
+        {
+            uint32_t code = value + 1;
+            int length = 0;
+
+            for (uint32_t i = code; i > 1; i >>= 1) {
+                length++;
+            }
+
+            putBits(0, length);
+            putBits(code, length + 1);
+        }
+
+        void putSe(int value)
+        {
+            putUe(value > 0 ? (uint32_t) (2 * value - 1) : (uint32_t) (-2 * value));
+        }
+
+        void alignZero()
+        {
+            while (mBits != 0) {
+                putBit(0);
+            }
+        }
+
+        void putByte(uint8_t value)
+        {
+            if (mBits == 0) {
+                mData.push_back(value);
+            } else {
+                putBits(value, 8);
+            }
+        }
+
+        void putTrailingBits()
+        {
+            putBit(1);
+            alignZero();
+        }
+
+        const vector<uint8_t> &getData() const
+        {
+            return mData;
+        }
+
+    private:
+        vector<uint8_t> mData{};
+        int mBits{0};
+    };
+
+    struct frameLayout {
+        int mbWidth;
+        int mbHeight;
+    };
+}// namespace
+
+// a NAL unit in the Annex B byte stream, with the emulation prevention
+static void appendNal(vector<uint8_t> &out, int refIdc, int type, const bitWriter &rbsp)
+{
+    static const uint8_t startCode[] = {0, 0, 0, 1};
+    out.insert(out.end(), startCode, startCode + sizeof(startCode));
+    out.push_back((uint8_t) ((refIdc << 5) | type));
+    int zeros = 0;
+
+    for (uint8_t byte : rbsp.getData()) {
+        if (zeros >= 2 && byte <= 3) {
+            out.push_back(3);
+            zeros = 0;
+        }
+
+        out.push_back(byte);
+        zeros = byte == 0 ? zeros + 1 : 0;
+    }
+}
+
+static void appendParameterSets(vector<uint8_t> &out, const mediaFixture::Config &config, const frameLayout &layout)
+{
+    bitWriter sps;
+    // constrained baseline, level 4.0
+    sps.putBits(66, 8);
+    sps.putBits(0xC0, 8);
+    sps.putBits(40, 8);
+    sps.putUe(0);
+    sps.putUe(LOG2_MAX_FRAME_NUM - 4);
+    // pic_order_cnt_type 2, the output order is the decoding order
+    sps.putUe(2);
+    sps.putUe(1);
+    sps.putBit(0);
+    sps.putUe(layout.mbWidth - 1);
+    sps.putUe(layout.mbHeight - 1);
+    // frame_mbs_only_flag, direct_8x8_inference_flag
+    sps.putBit(1);
+    sps.putBit(1);
+    int cropRight = (layout.mbWidth * 16 - config.width) / 2;
+    int cropBottom = (layout.mbHeight * 16 - config.height) / 2;
+
+    if (cropRight > 0 || cropBottom > 0) {
+        sps.putBit(1);
+        sps.putUe(0);
+        sps.putUe(cropRight);
+        sps.putUe(0);
+        sps.putUe(cropBottom);
+    } else {
+        sps.putBit(0);
+    }
+
+    // vui_parameters_present_flag
+    sps.putBit(0);
+    sps.putTrailingBits();
+    appendNal(out, 3, 7, sps);
+
+    bitWriter pps;
+    pps.putUe(0);
+    pps.putUe(0);
+    // CAVLC, no slice groups, one reference
+    pps.putBit(0);
+    pps.putBit(0);
+    pps.putUe(0);
+    pps.putUe(0);
+    pps.putUe(0);
+    pps.putBit(0);
+    pps.putBits(0, 2);
+    pps.putSe(0);
+    pps.putSe(0);
+    pps.putSe(0);
+    // deblocking_filter_control_present_flag, so the slices can turn it off
+    pps.putBit(1);
+    pps.putBit(0);
+    pps.putBit(0);
+    pps.putTrailingBits();
+    appendNal(out, 3, 8, pps);
+}
+
+// an IDR of I_PCM macroblocks with a flat luma
+static void appendKeyFrame(vector<uint8_t> &out, const frameLayout &layout, int idrId, uint8_t luma)
+{
+    bitWriter slice;
+    slice.putUe(0);
+    // slice_type I, all the slices of the picture
+    slice.putUe(7);
+    slice.putUe(0);
+    slice.putBits(0, LOG2_MAX_FRAME_NUM);
+    slice.putUe((uint32_t) (idrId & 0xFF));
+    // no_output_of_prior_pics_flag, long_term_reference_flag
+    slice.putBit(0);
+    slice.putBit(0);
+    slice.putSe(0);
+    // disable_deblocking_filter_idc
+    slice.putUe(1);
+
+    for (int mb = 0; mb < layout.mbWidth * layout.mbHeight; mb++) {
+        // mb_type I_PCM
+        slice.putUe(25);
+        slice.alignZero();
+
+        for (int i = 0; i < 256; i++) {
+            slice.putByte(luma);
+        }
+
+        for (int i = 0; i < 2 * 64; i++) {
+            slice.putByte(PCM_CHROMA_VALUE);
+        }
+    }
+
+    slice.putTrailingBits();
+    appendNal(out, 3, 5, slice);
+}
+
+// a reference P frame of P_Skip macroblocks, the same picture as the previous one
+static void appendSkipFrame(vector<uint8_t> &out, const frameLayout &layout, int frameNum)
+{
+    bitWriter slice;
+    slice.putUe(0);
+    // slice_type P, all the slices of the picture
+    slice.putUe(5);
+    slice.putUe(0);
+    slice.putBits((uint32_t) frameNum & ((1 << LOG2_MAX_FRAME_NUM) - 1), LOG2_MAX_FRAME_NUM);
+    // num_ref_idx_active_override_flag, ref_pic_list_modification_flag_l0, adaptive_ref_pic_marking_mode_flag
+    slice.putBit(0);
+    slice.putBit(0);
+    slice.putBit(0);
+    slice.putSe(0);
+    slice.putUe(1);
+    // mb_skip_run over the whole picture
+    slice.putUe((uint32_t) (layout.mbWidth * layout.mbHeight));
+    slice.putTrailingBits();
+    appendNal(out, 2, 1, slice);
+}
+
+namespace {
+    class clipWriter {
+    public:
+        explicit clipWriter(const mediaFixture::Config &config)
+            : mConfig(config), mLayout{(config.width + 15) / 16, (config.height + 15) / 16}
+        {
+            appendParameterSets(mExtraData, mConfig, mLayout);
+        }
+
+        ~clipWriter()
+        {
+            close();
+        }
+
+        int open(const string &path, const char *format)
+        {
+            int ret = avformat_alloc_output_context2(&mContext, nullptr, format, path.c_str());
+
+            if (ret < 0) {
+                return ret;
+            }
+
+            AVStream *stream = avformat_new_stream(mContext, nullptr);
+
+            if (stream == nullptr) {
+                return -ENOMEM;
+            }
+
+            stream->time_base = AVRational{1, 90000};
+            AVCodecParameters *par = stream->codecpar;
+            par->codec_type = AVMEDIA_TYPE_VIDEO;
+            par->codec_id = AV_CODEC_ID_H264;
+            par->width = mConfig.width;
+            par->height = mConfig.height;
+            par->extradata = (uint8_t *) av_mallocz(mExtraData.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+
+            if (par->extradata == nullptr) {
+                return -ENOMEM;
+            }
+
+            memcpy(par->extradata, mExtraData.data(), mExtraData.size());
+            par->extradata_size = (int) mExtraData.size();
+
+            if (!(mContext->oformat->flags & AVFMT_NOFILE)) {
+                ret = avio_open(&mContext->pb, path.c_str(), AVIO_FLAG_WRITE);
+
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+
+            AVDictionary *options = nullptr;
+            // the moov first, so that the clip can be played while downloading
+            av_dict_set(&options, "movflags", "faststart", 0);
+            ret = avformat_write_header(mContext, &options);
+            av_dict_free(&options);
+
+            if (ret < 0) {
+                return ret;
+            }
+
+            mHeaderWritten = true;
+            return 0;
+        }
+
+        int writeFrame(int index)
+        {
+            int framesPerGop = std::max(mConfig.fps * mConfig.gopMs / 1000, 1);
+            int gop = index / framesPerGop;
+            vector<uint8_t> data{};
+            bool key = index % framesPerGop == 0;
+
+            if (key) {
+                // the parameter sets in band too, every TS segment could be decoded alone
+                data = mExtraData;
+                appendKeyFrame(data, mLayout, gop, (uint8_t) (32 + gop * 53 % 192));
+            } else {
+                appendSkipFrame(data, mLayout, index % framesPerGop);
+            }
+
+            AVStream *stream = mContext->streams[0];
+            AVPacket packet{};
+            av_init_packet(&packet);
+            packet.data = data.data();
+            packet.size = (int) data.size();
+            packet.stream_index = 0;
+            packet.pts = packet.dts = av_rescale_q(index, AVRational{1, mConfig.fps}, stream->time_base);
+            packet.duration = av_rescale_q(1, AVRational{1, mConfig.fps}, stream->time_base);
+            packet.flags = key ? AV_PKT_FLAG_KEY : 0;
+            return av_write_frame(mContext, &packet);
+        }
+
+        int close()
+        {
+            int ret = 0;
+
+            if (mContext == nullptr) {
+                return 0;
+            }
+
+            if (mHeaderWritten) {
+                ret = av_write_trailer(mContext);
+            }
+
+            if (!(mContext->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&mContext->pb);
+            }
+
+            avformat_free_context(mContext);
+            mContext = nullptr;
+            mHeaderWritten = false;
+            return ret;
+        }
+
+    private:
+        mediaFixture::Config mConfig;
+        frameLayout mLayout;
+        vector<uint8_t> mExtraData{};
+        AVFormatContext *mContext{nullptr};
+        bool mHeaderWritten{false};
+    };
+}// namespace
+
+static int getFrameCount(const mediaFixture::Config &config)
+{
+    return (int) ((int64_t) config.durationMs * config.fps / 1000);
+}
+
+int mediaFixture::writeClip(const string &path, const char *format, const Config &config)
+{
+    clipWriter writer(config);
+    int ret = writer.open(path, format);
+
+    for (int i = 0; ret >= 0 && i < getFrameCount(config); i++) {
+        ret = writer.writeFrame(i);
+    }
+
+    if (ret >= 0) {
+        ret = writer.close();
+    }
+
+    if (ret < 0) {
+        AF_LOGE("write fixture %s error %d\n", path.c_str(), ret);
+        writer.close();
+        remove(path.c_str());
+    }
+
+    return ret < 0 ? ret : 0;
+}
+
+int mediaFixture::writeHls(const string &dir, const Config &config)
+{
+    int framesPerGop = std::max(config.fps * config.gopMs / 1000, 1);
+    int gopsPerSegment = std::max((config.segmentMs + config.gopMs - 1) / config.gopMs, 1);
+    int framesPerSegment = framesPerGop * gopsPerSegment;
+    int frameCount = getFrameCount(config);
+    string playlist{};
+    double maxDuration = 0;
+
+    if (!FileUtils::mkdirs(dir.c_str())) {
+        return -EIO;
+    }
+
+    for (int segment = 0; segment * framesPerSegment < frameCount; segment++) {
+        string name = "seg" + to_string(segment) + ".ts";
+        clipWriter writer(config);
+        int ret = writer.open(dir + "/" + name, "mpegts");
+        int start = segment * framesPerSegment;
+        int end = std::min(start + framesPerSegment, frameCount);
+
+        for (int i = start; ret >= 0 && i < end; i++) {
+            ret = writer.writeFrame(i);
+        }
+
+        if (ret >= 0) {
+            ret = writer.close();
+        }
+
+        if (ret < 0) {
+            AF_LOGE("write fixture %s/%s error %d\n", dir.c_str(), name.c_str(), ret);
+            return ret;
+        }
+
+        double duration = (double) (end - start) / config.fps;
+        maxDuration = std::max(maxDuration, duration);
+        char extInf[64];
+        snprintf(extInf, sizeof(extInf), "#EXTINF:%.3f,\n", duration);
+        playlist += extInf + name + "\n";
+    }
+
+    FILE *file = fopen((dir + "/index.m3u8").c_str(), "w");
+
+    if (file == nullptr) {
+        return -errno;
+    }
+
+    fprintf(file, "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:%d\n#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-PLAYLIST-TYPE:VOD\n",
+            (int) ceil(maxDuration));
+    fprintf(file, "%s#EXT-X-ENDLIST\n", playlist.c_str());
+    fclose(file);
+    return 0;
+}
+
+string mediaFixture::getDir()
+{
+    const char *env = getenv("CICADA_TEST_FIXTURES");
+    return env ? env : "test_fixtures";
+}
+
+int mediaFixture::generate(const string &dir, const string &name, const Config &config)
+{
+    int ret;
+
+    if (!FileUtils::mkdirs(dir.c_str())) {
+        return -EIO;
+    }
+
+    string base = dir + "/" + name;
+
+    if (!FileUtils::isFileExist((base + ".mp4").c_str()) && (ret = writeClip(base + ".mp4", "mp4", config)) < 0) {
+        return ret;
+    }
+
+    if (!FileUtils::isFileExist((base + ".ts").c_str()) && (ret = writeClip(base + ".ts", "mpegts", config)) < 0) {
+        return ret;
+    }
+
+    // the playlist is written at last, the segments are complete when it exists
+    if (!FileUtils::isFileExist((base + "_hls/index.m3u8").c_str()) && (ret = writeHls(base + "_hls", config)) < 0) {
+        return ret;
+    }
+
+    return 0;
+}
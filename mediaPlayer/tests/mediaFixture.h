@@ -0,0 +1,44 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#ifndef CICADAMEDIA_MEDIAFIXTURE_H
+#define CICADAMEDIA_MEDIAFIXTURE_H
+
+#include <string>
+
+/*
+ * Generates the video only H.264 clips for the player tests, so they don't depend on the fixtures
+ * shipped out of the tree nor on an encoder: the key frames are coded in I_PCM and the others are all
+ * P_Skip macroblocks, and they are muxed by the ffmpeg muxers the player is built with.
+ */
+class mediaFixture {
+public:
+    struct Config {
+        int width{640};
+        int height{360};
+        int fps{25};
+        int gopMs{1000};
+        int durationMs{20 * 1000};
+        // the HLS segments are cut on the key frames, not shorter than this
+        int segmentMs{2000};
+    };
+
+public:
+    // $CICADA_TEST_FIXTURES, default ./test_fixtures
+    static std::string getDir();
+
+    /*
+     * generate <dir>/<name>.mp4, <dir>/<name>.ts and <dir>/<name>_hls/index.m3u8 if not exist,
+     * return 0 or a negative error
+     */
+    static int generate(const std::string &dir, const std::string &name, const Config &config);
+
+    // format is the name of the ffmpeg muxer, "mp4" or "mpegts"
+    static int writeClip(const std::string &path, const char *format, const Config &config);
+
+    static int writeHls(const std::string &dir, const Config &config);
+};
+
+
+#endif//CICADAMEDIA_MEDIAFIXTURE_H
@@ -1,6 +1,8 @@
 //
 // Created by moqi on 2021/11/1.
 //
+#include "tests/localHttpServer.h"
+#include "tests/mediaFixture.h"
 #include "tests/mediaPlayerTest.h"
 #include "tests/player_command.h"
 #include "gtest/gtest.h"
@@ -155,6 +157,98 @@ TEST(performance, prepare)
     }
     AF_LOGI("avg time cost2 is %lld\n", sum / size);
 }
+typedef struct preRollContent {
+    bool preRoll;
+    bool prepared;
+    bool started;
+    bool firstFrameShown;
+    int64_t startToFirstFrame;
+} preRollContent;
+
+static void preRollOnPrepared(void *userData)
+{
+    auto *content = static_cast<preRollContent *>(userData);
+    content->prepared = true;
+}
+
+static void preRollOnFirstFrameShow(void *userData)
+{
+    auto *content = static_cast<preRollContent *>(userData);
+    content->firstFrameShown = true;
+}
+
+static int preRollOnCreate(Cicada::MediaPlayer *player, void *arg)
+{
+    auto *content = static_cast<preRollContent *>(arg);
+    // the baseline is the default, the fast start without the pre-roll
+    player->SetOption("preRoll", content->preRoll ? "1" : "0");
+    return 0;
+}
+
+static int preRollOnLoop(Cicada::MediaPlayer *player, void *arg)
+{
+    auto *content = static_cast<preRollContent *>(arg);
+
+    if (content->prepared && !content->started) {
+        content->started = true;
+        player->Start();
+    }
+
+    if (content->firstFrameShown) {
+        CicadaJSONArray infos(player->GetPropertyString(PROPERTY_KEY_DECODE_INFO));
+
+        for (int i = 0; i < infos.getSize(); ++i) {
+            CicadaJSONItem &item = infos.getItem(i);
+            if (item.getString("type") == "video") {
+                content->startToFirstFrame = item.getInt("startToFirstFrameCost", -1);
+            }
+        }
+
+        return -1;
+    }
+
+    af_msleep(1);
+    return 0;
+}
+
+static int64_t preRollOnce(const string &url, bool preRoll)
+{
+    preRollContent content{preRoll, false, false, false, -1};
+    playerListener listener{nullptr};
+    listener.Prepared = preRollOnPrepared;
+    listener.FirstFrameShow = preRollOnFirstFrameShow;
+    listener.userData = &content;
+    test_simple(url, preRollOnCreate, preRollOnLoop, &content, &listener, false);
+    return content.startToFirstFrame;
+}
+
+TEST(performance, preRoll)
+{
+    string dir = mediaFixture::getDir();
+    ASSERT_GE(mediaFixture::generate(dir, "preRoll", mediaFixture::Config{}), 0);
+    localHttpServer server(dir);
+    ASSERT_GT(server.start(), 0);
+    string url = server.getUrl("preRoll.mp4");
+    const static int size = 10;
+    int64_t sum = 0;
+    int64_t preRollSum = 0;
+
+    for (int i = 0; i < size; ++i) {
+        int64_t cost = preRollOnce(url, false);
+        int64_t preRollCost = preRollOnce(url, true);
+        AF_LOGI("start to first frame %lld, with pre-roll %lld\n", cost, preRollCost);
+        ASSERT_GE(cost, 0);
+        ASSERT_GE(preRollCost, 0);
+        sum += cost;
+        preRollSum += preRollCost;
+    }
+
+    server.stop();
+    AF_LOGI("avg start to first frame %lld, with pre-roll %lld\n", sum / size, preRollSum / size);
+    // the pre-rolled frame is shown in Start, the baseline shows it on the next loop
+    EXPECT_LE(preRollSum / size, sum / size);
+}
+
 typedef struct seekContent {
     bool playing;
     int64_t seekStart;
@@ -0,0 +1,221 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+/*
+ * The preload manager with the generated clips on a loopback http server: the urls are preloaded in order
+ * up to maxItems, the ones dropped from the list are evicted, a player prepares a preloaded url from its
+ * warm pipeline, and the next url is scheduled once an item is acquired, even if it was not usable.
+ */
+
+#include "gtest/gtest.h"
+#include "tests/localHttpServer.h"
+#include "tests/mediaFixture.h"
+#include <MediaPlayer.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utils/AFUtils.h>
+#include <utils/CicadaJSON.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+
+#define PRELOAD_TIMEOUT_MS (10 * 1000)
+#define PREPARE_TIMEOUT_MS (10 * 1000)
+#define ITEM_ABSENT (-1)
+
+using namespace Cicada;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ignore_signal(SIGPIPE);
+    globalSettings::getSetting().setProperty("protected.render.headless", "ON");
+    return RUN_ALL_TESTS();
+}
+
+typedef struct preloadContext {
+    mutex mMutex;
+    condition_variable mCond;
+    bool prepared{false};
+    bool error{false};
+} preloadContext;
+
+static void onPrepared(void *userData)
+{
+    auto *context = static_cast<preloadContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->prepared = true;
+    context->mCond.notify_all();
+}
+
+static void onError(int64_t errorCode, const void *errorMsg, void *userData)
+{
+    auto *context = static_cast<preloadContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->error = true;
+    context->mCond.notify_all();
+}
+
+class preloadServer {
+public:
+    preloadServer() : mServer(mediaFixture::getDir())
+    {}
+
+    ~preloadServer()
+    {
+        mServer.stop();
+        MediaPlayer::ClearPreloadUrls();
+    }
+
+    bool start()
+    {
+        mediaFixture::Config config{};
+        config.durationMs = 10 * 1000;
+
+        if (mediaFixture::generate(mediaFixture::getDir(), "preload", config) < 0) {
+            return false;
+        }
+
+        return mServer.start() > 0;
+    }
+
+    string getUrl(const string &path) const
+    {
+        return mServer.getUrl(path);
+    }
+
+private:
+    localHttpServer mServer;
+};
+
+// the status of the preloaded url, or ITEM_ABSENT
+static int getItemStatus(const string &url, int64_t *usedMemory = nullptr)
+{
+    CicadaJSONItem info(MediaPlayer::GetPreloadInfo());
+    CicadaJSONArray items = info.getArray("items");
+
+    if (usedMemory) {
+        *usedMemory = info.getInt64("usedMemory", -1);
+    }
+
+    for (int i = 0; i < items.getSize(); i++) {
+        if (items.getItem(i).getString("url") == url) {
+            return items.getItem(i).getInt("status", ITEM_ABSENT);
+        }
+    }
+
+    return ITEM_ABSENT;
+}
+
+static bool waitItemStatus(const string &url, int status)
+{
+    int64_t start = af_getsteady_ms();
+
+    while (af_getsteady_ms() - start < PRELOAD_TIMEOUT_MS) {
+        if (getItemStatus(url) == status) {
+            return true;
+        }
+
+        af_msleep(20);
+    }
+
+    return false;
+}
+
+static void setPreloadConfig(int maxItems)
+{
+    PlayerPreloadManager::Config config = MediaPlayer::GetPreloadConfig();
+    config.maxItems = maxItems;
+    config.bufferDurationUs = 1000 * 1000;
+    MediaPlayer::SetPreloadConfig(config);
+}
+
+TEST(preload, scheduleAndEvict)
+{
+    preloadServer server;
+    ASSERT_TRUE(server.start());
+    string ts = server.getUrl("preload.ts");
+    string mp4 = server.getUrl("preload.mp4");
+    string hls = server.getUrl("preload_hls/index.m3u8");
+    setPreloadConfig(2);
+    MediaPlayer::SetPreloadUrls({ts, mp4, hls});
+
+    EXPECT_TRUE(waitItemStatus(ts, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+    EXPECT_TRUE(waitItemStatus(mp4, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+    EXPECT_EQ(getItemStatus(hls), ITEM_ABSENT);
+
+    // the evicted slot goes to the next url
+    MediaPlayer::RemovePreloadUrl(ts);
+    EXPECT_EQ(getItemStatus(ts), ITEM_ABSENT);
+    EXPECT_NE(getItemStatus(hls), ITEM_ABSENT);
+    EXPECT_TRUE(waitItemStatus(hls, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+
+    MediaPlayer::ClearPreloadUrls();
+    int64_t usedMemory = -1;
+    EXPECT_EQ(getItemStatus(mp4, &usedMemory), ITEM_ABSENT);
+    EXPECT_EQ(usedMemory, 0);
+}
+
+static bool prepare(MediaPlayer &player, preloadContext &context, const string &url)
+{
+    playerListener listener{nullptr};
+    listener.Prepared = onPrepared;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+    player.SetListener(listener);
+    player.SetDataSource(url.c_str());
+    player.Prepare();
+    unique_lock<mutex> lock(context.mMutex);
+    return context.mCond.wait_for(lock, chrono::milliseconds(PREPARE_TIMEOUT_MS),
+                                  [&context]() { return context.prepared || context.error; });
+}
+
+TEST(preload, acquire)
+{
+    preloadServer server;
+    ASSERT_TRUE(server.start());
+    string ts = server.getUrl("preload.ts");
+    string mp4 = server.getUrl("preload.mp4");
+    setPreloadConfig(1);
+    MediaPlayer::SetPreloadUrls({ts, mp4});
+    ASSERT_TRUE(waitItemStatus(ts, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+    EXPECT_EQ(getItemStatus(mp4), ITEM_ABSENT);
+
+    preloadContext context{};
+    MediaPlayer player;
+    int64_t start = af_getsteady_ms();
+    ASSERT_TRUE(prepare(player, context, ts));
+    int64_t cost = af_getsteady_ms() - start;
+    EXPECT_TRUE(context.prepared);
+    printf("{\"preloadedPrepare\":%lld}\n", (long long) cost);
+
+    // the player owns the pipeline, the freed slot goes to the next url
+    EXPECT_EQ(getItemStatus(ts), ITEM_ABSENT);
+    EXPECT_TRUE(waitItemStatus(mp4, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+    player.Stop();
+}
+
+TEST(preload, rescheduleAfterError)
+{
+    preloadServer server;
+    ASSERT_TRUE(server.start());
+    string missing = server.getUrl("missing.ts");
+    string mp4 = server.getUrl("preload.mp4");
+    setPreloadConfig(1);
+    MediaPlayer::SetPreloadUrls({missing, mp4});
+    ASSERT_TRUE(waitItemStatus(missing, PreloadItem::Status_Error)) << MediaPlayer::GetPreloadInfo();
+
+    preloadContext context{};
+    MediaPlayer player;
+    ASSERT_TRUE(prepare(player, context, missing));
+    EXPECT_TRUE(context.error);
+
+    // the failed item is dropped on acquiring, not holding the slot
+    EXPECT_EQ(getItemStatus(missing), ITEM_ABSENT);
+    EXPECT_NE(getItemStatus(mp4), ITEM_ABSENT);
+    EXPECT_TRUE(waitItemStatus(mp4, PreloadItem::Status_Ready)) << MediaPlayer::GetPreloadInfo();
+    player.Stop();
+}
@@ -0,0 +1,126 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+/*
+ * A playback of the generated HLS clip from the loopback http server is captured with the payloads by the io
+ * record, then replayed by a new player with the server stopped, it should play to the end the same as captured.
+ */
+
+#include "gtest/gtest.h"
+#include "tests/localHttpServer.h"
+#include "tests/mediaFixture.h"
+#include <MediaPlayer.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utils/AFUtils.h>
+#include <utils/file/FileUtils.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+
+#define CLIP_DURATION_MS (4 * 1000)
+#define COMPLETION_TIMEOUT_MS (CLIP_DURATION_MS + 10 * 1000)
+
+using namespace Cicada;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ignore_signal(SIGPIPE);
+    globalSettings::getSetting().setProperty("protected.render.headless", "ON");
+    return RUN_ALL_TESTS();
+}
+
+typedef struct replayContext {
+    mutex mMutex;
+    condition_variable mCond;
+    int videoRendered{0};
+    bool completion{false};
+    bool error{false};
+} replayContext;
+
+static void onVideoRendered(int64_t timeMs, int64_t pts, void *userData)
+{
+    auto *context = static_cast<replayContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->videoRendered++;
+}
+
+static void onCompletion(void *userData)
+{
+    auto *context = static_cast<replayContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->completion = true;
+    context->mCond.notify_all();
+}
+
+static void onError(int64_t errorCode, const void *errorMsg, void *userData)
+{
+    AF_LOGE("replay error %lld %s\n", errorCode, errorMsg ? (const char *) errorMsg : "");
+    auto *context = static_cast<replayContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->error = true;
+    context->mCond.notify_all();
+}
+
+// play to the end, return the rendered video frames, or -1
+static int playToEnd(const string &url)
+{
+    replayContext context{};
+    playerListener listener{nullptr};
+    listener.VideoRendered = onVideoRendered;
+    listener.Completion = onCompletion;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+    int view;
+    player->SetView(&view);
+    player->SetListener(listener);
+    player->SetDataSource(url.c_str());
+    player->SetAutoPlay(true);
+    player->Prepare();
+    bool completion;
+    {
+        unique_lock<mutex> lock(context.mMutex);
+        context.mCond.wait_for(lock, chrono::milliseconds(COMPLETION_TIMEOUT_MS),
+                               [&context]() { return context.completion || context.error; });
+        completion = context.completion && !context.error;
+    }
+    player->Stop();
+    player = nullptr;
+    return completion ? context.videoRendered : -1;
+}
+
+TEST(ioReplay, player)
+{
+    string dir = mediaFixture::getDir();
+    mediaFixture::Config fixture{};
+    fixture.durationMs = CLIP_DURATION_MS;
+    ASSERT_GE(mediaFixture::generate(dir, "replay", fixture), 0);
+    string captures = dir + "/replay_captures";
+    FileUtils::rmrf(captures.c_str());
+    FileUtils::mkdirs(captures.c_str());
+
+    localHttpServer server(dir);
+    ASSERT_GT(server.start(), 0);
+    string url = server.getUrl("replay_hls/index.m3u8");
+    globalSettings::getSetting().setProperty("protected.io.record", captures);
+    globalSettings::getSetting().setProperty("protected.io.record.payload", "ON");
+    int recorded = playToEnd(url);
+    globalSettings::getSetting().setProperty("protected.io.record", "");
+    globalSettings::getSetting().setProperty("protected.io.record.payload", "");
+    server.stop();
+    ASSERT_GT(recorded, 0) << "the capture is not played to the end";
+
+    // the origin is gone, all the bytes come from the captures
+    globalSettings::getSetting().setProperty("protected.io.replay", captures);
+    int replayed = playToEnd(url);
+    globalSettings::getSetting().setProperty("protected.io.replay", "");
+    printf("{\"recordedFrames\":%d,\"replayedFrames\":%d}\n", recorded, replayed);
+    ASSERT_GT(replayed, 0) << "the replay is not played to the end";
+    // a late frame may be dropped by the render on a loaded machine
+    EXPECT_NEAR(replayed, recorded, fixture.fps / 5);
+}
@@ -0,0 +1,463 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+/*
+ * Randomized seeks over a matrix of containers and GOP structures, the seek-to-first-frame and seek-to-audio-resume
+ * latencies are read from the player metrics, and the p50/p95/p99 are checked against a budget.
+ *
+ * The fixtures are read from $CICADA_SEEK_FIXTURES (default the generated fixtures dir), named as
+ *   gop1s.mp4 gop1s.ts gop1s_hls/index.m3u8 gop1s_dash/index.mpd, and the same for gop5s,
+ * the HLS/DASH ones are played from a loopback http server. The missing mp4/ts/HLS ones are generated,
+ * the DASH ones are only played if provided.
+ *
+ *   CICADA_SEEK_BUDGET_MS  p50,p95,p99 in ms, default 500,1000,2000
+ *   CICADA_SEEK_COUNT      seeks of each kind, default 20
+ *   CICADA_SEEK_SEED       the random seed, default 1
+ *
+ * The scrubbing is checked on a generated clip from the loopback http server, the superseded seeks are dropped and
+ * the last target is shown in SCRUB_BUDGET_MS. In the scrub mode, the key frame previews of a 1080p clip keep up
+ * with SCRUB_PREVIEW_FPS seeks per second.
+ */
+
+#include "gtest/gtest.h"
+#include "tests/localHttpServer.h"
+#include "tests/mediaFixture.h"
+#include <MediaPlayer.h>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <utils/AFUtils.h>
+#include <utils/CicadaJSON.h>
+#include <utils/file/FileUtils.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+
+#define SEEK_END_TIMEOUT_MS (10 * 1000)
+#define PREPARE_TIMEOUT_MS (10 * 1000)
+#define BUFFER_AHEAD_TIMEOUT_MS (5 * 1000)
+// let the audio resume and the buffer refill before the next seek
+#define SEEK_SETTLE_MS 500
+#define IN_CACHE_AHEAD_MS 3000
+#define BACKWARD_BUFFER_MS (30 * 1000)
+// 30 seeks per second while scrubbing
+#define SCRUB_SEEKS 30
+#define SCRUB_INTERVAL_MS 33
+#define SCRUB_STEP_MS 500
+#define SCRUB_BUDGET_MS 1000
+#define SCRUB_PREVIEW_FPS 20
+#define SCRUB_PREVIEW_MS 2000
+// a preview may be superseded by the next seek before shown
+#define SCRUB_PREVIEW_MIN_FPS (SCRUB_PREVIEW_FPS * 9 / 10)
+
+using namespace Cicada;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ignore_signal(SIGPIPE);
+    globalSettings::getSetting().setProperty("protected.render.headless", "ON");
+    return RUN_ALL_TESTS();
+}
+
+typedef struct seekContext {
+    mutex mMutex;
+    condition_variable mCond;
+    int seekEnds{0};
+    int inCacheHits{0};
+    int videoRendered{0};
+    bool firstFrame{false};
+    bool error{false};
+} seekContext;
+
+typedef struct seekBudget {
+    int64_t p50{500};
+    int64_t p95{1000};
+    int64_t p99{2000};
+} seekBudget;
+
+enum seekKind { SEEK_KIND_ACCURATE, SEEK_KIND_INACCURATE, SEEK_KIND_IN_CACHE, SEEK_KIND_BACKWARD, SEEK_KIND_MAX };
+
+static const char *getSeekKindName(int kind)
+{
+    switch (kind) {
+        case SEEK_KIND_ACCURATE:
+            return "accurate";
+        case SEEK_KIND_INACCURATE:
+            return "inaccurate";
+        case SEEK_KIND_IN_CACHE:
+            return "inCache";
+        case SEEK_KIND_BACKWARD:
+            return "backward";
+        default:
+            return "unknown";
+    }
+}
+
+static void onFirstFrameShow(void *userData)
+{
+    auto *context = static_cast<seekContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->firstFrame = true;
+    context->mCond.notify_all();
+}
+
+static void onVideoRendered(int64_t timeMs, int64_t pts, void *userData)
+{
+    auto *context = static_cast<seekContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->videoRendered++;
+}
+
+static void onSeekEnd(int64_t inCache, void *userData)
+{
+    auto *context = static_cast<seekContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->seekEnds++;
+    context->inCacheHits += inCache ? 1 : 0;
+    context->mCond.notify_all();
+}
+
+static void onError(int64_t errorCode, const void *errorMsg, void *userData)
+{
+    AF_LOGE("seek perf error %lld %s\n", errorCode, errorMsg ? (const char *) errorMsg : "");
+    auto *context = static_cast<seekContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->error = true;
+    context->mCond.notify_all();
+}
+
+static int getEnvInt(const char *name, int defaultValue)
+{
+    const char *value = getenv(name);
+    return value ? atoi(value) : defaultValue;
+}
+
+static seekBudget getBudget()
+{
+    seekBudget budget{};
+    const char *value = getenv("CICADA_SEEK_BUDGET_MS");
+    long long p50, p95, p99;
+
+    if (value && sscanf(value, "%lld,%lld,%lld", &p50, &p95, &p99) == 3) {
+        budget.p50 = p50;
+        budget.p95 = p95;
+        budget.p99 = p99;
+    }
+
+    return budget;
+}
+
+// wait until the player has buffered aheadMs more than the current position
+static bool waitBufferAhead(MediaPlayer *player, int64_t aheadMs)
+{
+    int64_t start = af_getsteady_ms();
+
+    while (af_getsteady_ms() - start < BUFFER_AHEAD_TIMEOUT_MS) {
+        if (player->GetBufferedPosition() - player->GetCurrentPosition() >= aheadMs) {
+            return true;
+        }
+
+        af_msleep(20);
+    }
+
+    return false;
+}
+
+static void checkLatency(const string &name, const CicadaJSONItem &histogram, const seekBudget &budget)
+{
+    EXPECT_LE(histogram.getInt64("p50", 0), budget.p50) << name;
+    EXPECT_LE(histogram.getInt64("p95", 0), budget.p95) << name;
+    EXPECT_LE(histogram.getInt64("p99", 0), budget.p99) << name;
+}
+
+static void runSeeks(const string &name, const string &url, CicadaJSONArray &report)
+{
+    const seekBudget budget = getBudget();
+    const int count = getEnvInt("CICADA_SEEK_COUNT", 20);
+    mt19937 random((uint32_t) getEnvInt("CICADA_SEEK_SEED", 1));
+    seekContext context{};
+    playerListener listener{nullptr};
+    listener.FirstFrameShow = onFirstFrameShow;
+    listener.SeekEnd = onSeekEnd;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+    int view;
+    player->SetView(&view);
+    player->SetListener(listener);
+    MediaPlayerConfig config = *player->GetConfig();
+    config.mMaxBackwardBufferDuration = BACKWARD_BUFFER_MS;
+    player->SetConfig(&config);
+    player->SetDataSource(url.c_str());
+    player->SetAutoPlay(true);
+    player->Prepare();
+
+    {
+        unique_lock<mutex> lock(context.mMutex);
+        context.mCond.wait_for(lock, chrono::milliseconds(PREPARE_TIMEOUT_MS),
+                               [&context]() { return context.firstFrame || context.error; });
+        ASSERT_TRUE(context.firstFrame) << name << " not started";
+    }
+
+    int64_t duration = player->GetDuration();
+    ASSERT_GT(duration, IN_CACHE_AHEAD_MS * 2) << name;
+    // clear the startup values
+    CicadaJSONItem clear{};
+    clear.addValue("clear", true);
+    player->GetPropertyString(PROPERTY_KEY_METRICS, clear);
+
+    for (int kind = 0; kind < SEEK_KIND_MAX; kind++) {
+        int timeouts = 0;
+        int inCacheHits;
+        {
+            lock_guard<mutex> lock(context.mMutex);
+            inCacheHits = context.inCacheHits;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int64_t current = player->GetCurrentPosition();
+            int64_t pos;
+            SeekMode mode = SEEK_MODE_ACCURATE;
+
+            switch (kind) {
+                case SEEK_KIND_INACCURATE:
+                    mode = SEEK_MODE_INACCURATE;
+                    // fall through
+                case SEEK_KIND_ACCURATE:
+                    pos = uniform_int_distribution<int64_t>(0, duration - IN_CACHE_AHEAD_MS)(random);
+                    break;
+
+                case SEEK_KIND_IN_CACHE:
+                    waitBufferAhead(player.get(), IN_CACHE_AHEAD_MS);
+                    current = player->GetCurrentPosition();
+                    pos = current + uniform_int_distribution<int64_t>(500, IN_CACHE_AHEAD_MS - 500)(random);
+                    break;
+
+                default:
+                    pos = current - uniform_int_distribution<int64_t>(500, 10 * 1000)(random);
+                    pos = std::max(pos, (int64_t) 0);
+                    break;
+            }
+
+            unique_lock<mutex> lock(context.mMutex);
+            int seekEnds = context.seekEnds;
+            player->SeekTo(pos, mode);
+
+            if (!context.mCond.wait_for(lock, chrono::milliseconds(SEEK_END_TIMEOUT_MS),
+                                        [&context, seekEnds]() { return context.seekEnds > seekEnds || context.error; })) {
+                timeouts++;
+            }
+
+            ASSERT_FALSE(context.error) << name;
+            lock.unlock();
+            af_msleep(SEEK_SETTLE_MS);
+        }
+
+        CicadaJSONItem metrics(player->GetPropertyString(PROPERTY_KEY_METRICS, clear));
+        CicadaJSONItem histograms = metrics.getItem("histograms");
+        CicadaJSONItem firstFrame = histograms.getItem("seek.firstFrame");
+        CicadaJSONItem audioResume = histograms.getItem("seek.audioResume");
+        string caseName = name + "/" + getSeekKindName(kind);
+
+        {
+            lock_guard<mutex> lock(context.mMutex);
+            inCacheHits = context.inCacheHits - inCacheHits;
+        }
+
+        CicadaJSONItem result{};
+        result.addValue("name", caseName);
+        result.addValue("seeks", count);
+        result.addValue("timeouts", timeouts);
+        result.addValue("inCacheHits", inCacheHits);
+        result.addItem("firstFrame", firstFrame);
+        result.addItem("audioResume", audioResume);
+        report.addJSON(result);
+
+        EXPECT_EQ(timeouts, 0) << caseName;
+        EXPECT_GT(firstFrame.getInt64("count", 0), 0) << caseName;
+
+        // the targets are in the buffer, not to measure the reopen path instead
+        if (kind == SEEK_KIND_IN_CACHE || kind == SEEK_KIND_BACKWARD) {
+            EXPECT_GT(inCacheHits, 0) << caseName;
+        }
+        checkLatency(caseName + " firstFrame", firstFrame, budget);
+
+        if (audioResume.getInt64("count", 0) > 0) {
+            checkLatency(caseName + " audioResume", audioResume, budget);
+        }
+    }
+
+    player->Stop();
+}
+
+TEST(seekPerf, matrix)
+{
+    const char *env = getenv("CICADA_SEEK_FIXTURES");
+    string dir = env ? env : mediaFixture::getDir();
+    const char *gops[] = {"gop1s", "gop5s"};
+    mediaFixture::Config fixture{};
+    fixture.durationMs = 30 * 1000;
+    fixture.gopMs = 1000;
+    ASSERT_GE(mediaFixture::generate(dir, gops[0], fixture), 0);
+    fixture.gopMs = 5000;
+    ASSERT_GE(mediaFixture::generate(dir, gops[1], fixture), 0);
+    // container, path suffix
+    const char *containers[][2] = {{"mp4", ".mp4"}, {"ts", ".ts"}, {"hls", "_hls/index.m3u8"}, {"dash", "_dash/index.mpd"}};
+    localHttpServer server(dir);
+    ASSERT_GT(server.start(), 0);
+    CicadaJSONArray report{};
+    int played = 0;
+
+    for (const char *gop : gops) {
+        for (auto &container : containers) {
+            string path = string(gop) + container[1];
+
+            if (!FileUtils::isFileExist((dir + "/" + path).c_str())) {
+                AF_LOGW("seek fixture %s not found, skipped\n", path.c_str());
+                continue;
+            }
+
+            bool http = container[0] == string("hls") || container[0] == string("dash");
+            runSeeks(string(container[0]) + "/" + gop, http ? server.getUrl(path) : dir + "/" + path, report);
+            played++;
+        }
+    }
+
+    server.stop();
+    printf("%s\n", report.printJSON().c_str());
+    // mp4, ts and HLS of both GOPs at least
+    EXPECT_GE(played, 6) << "seek fixtures not found in " << dir;
+}
+
+TEST(seekPerf, scrub)
+{
+    string dir = mediaFixture::getDir();
+    ASSERT_GE(mediaFixture::generate(dir, "scrub", mediaFixture::Config{}), 0);
+    localHttpServer server(dir);
+    ASSERT_GT(server.start(), 0);
+    seekContext context{};
+    playerListener listener{nullptr};
+    listener.FirstFrameShow = onFirstFrameShow;
+    listener.SeekEnd = onSeekEnd;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+    int view;
+    player->SetView(&view);
+    player->SetListener(listener);
+    player->SetDataSource(server.getUrl("scrub.mp4").c_str());
+    player->SetAutoPlay(true);
+    player->Prepare();
+
+    {
+        unique_lock<mutex> lock(context.mMutex);
+        context.mCond.wait_for(lock, chrono::milliseconds(PREPARE_TIMEOUT_MS),
+                               [&context]() { return context.firstFrame || context.error; });
+        ASSERT_TRUE(context.firstFrame) << "scrub not started";
+    }
+
+    int64_t target = 0;
+    int seekEnds = 0;
+
+    for (int i = 1; i <= SCRUB_SEEKS; i++) {
+        if (i == SCRUB_SEEKS) {
+            lock_guard<mutex> lock(context.mMutex);
+            seekEnds = context.seekEnds;
+        }
+
+        target = i * SCRUB_STEP_MS;
+        player->SeekTo(target, SEEK_MODE_ACCURATE);
+        af_msleep(SCRUB_INTERVAL_MS);
+    }
+
+    // the last target is shown, not a superseded one ending late
+    int64_t lastSeek = af_getsteady_ms() - SCRUB_INTERVAL_MS;
+    int64_t cost = -1;
+
+    while (af_getsteady_ms() - lastSeek < SEEK_END_TIMEOUT_MS) {
+        {
+            lock_guard<mutex> lock(context.mMutex);
+            ASSERT_FALSE(context.error);
+
+            if (context.seekEnds > seekEnds && llabs(player->GetCurrentPosition() - target) < SCRUB_STEP_MS) {
+                cost = af_getsteady_ms() - lastSeek;
+                seekEnds = context.seekEnds;
+                break;
+            }
+        }
+
+        af_msleep(5);
+    }
+
+    player->Stop();
+    server.stop();
+    printf("{\"scrubSeekEnds\":%d,\"scrubLastSeek\":%lld}\n", seekEnds, (long long) cost);
+    EXPECT_GE(cost, 0) << "the last scrub target is not reached";
+    EXPECT_LE(cost, SCRUB_BUDGET_MS);
+    EXPECT_LT(seekEnds, SCRUB_SEEKS);
+}
+
+TEST(seekPerf, scrubPreview1080p)
+{
+    string dir = mediaFixture::getDir();
+    mediaFixture::Config fixture{};
+    fixture.width = 1920;
+    fixture.height = 1080;
+    fixture.durationMs = 6 * 1000;
+    ASSERT_GE(mediaFixture::generate(dir, "scrub1080p", fixture), 0);
+    seekContext context{};
+    playerListener listener{nullptr};
+    listener.FirstFrameShow = onFirstFrameShow;
+    listener.VideoRendered = onVideoRendered;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+    int view;
+    player->SetView(&view);
+    player->SetListener(listener);
+    player->SetDataSource((dir + "/scrub1080p.mp4").c_str());
+    player->SetAutoPlay(true);
+    player->Prepare();
+
+    {
+        unique_lock<mutex> lock(context.mMutex);
+        context.mCond.wait_for(lock, chrono::milliseconds(PREPARE_TIMEOUT_MS),
+                               [&context]() { return context.firstFrame || context.error; });
+        ASSERT_TRUE(context.firstFrame) << "scrub preview not started";
+    }
+
+    player->SetScrubbing(true);
+    int rendered;
+    {
+        lock_guard<mutex> lock(context.mMutex);
+        rendered = context.videoRendered;
+    }
+    int64_t start = af_getsteady_ms();
+    int seeks = 0;
+
+    // a different key frame on every seek
+    while (af_getsteady_ms() - start < SCRUB_PREVIEW_MS) {
+        player->SeekTo((seeks++ % (fixture.durationMs / fixture.gopMs)) * fixture.gopMs, SEEK_MODE_ACCURATE);
+        af_msleep(1000 / SCRUB_PREVIEW_FPS);
+    }
+
+    int64_t elapsed = af_getsteady_ms() - start;
+    {
+        lock_guard<mutex> lock(context.mMutex);
+        rendered = context.videoRendered - rendered;
+        EXPECT_FALSE(context.error);
+    }
+    player->SetScrubbing(false);
+    player->Stop();
+    int64_t fps = rendered * 1000 / elapsed;
+    printf("{\"scrubSeeks\":%d,\"scrubPreviews\":%d,\"scrubPreviewFps\":%lld}\n", seeks, rendered, (long long) fps);
+    EXPECT_GE(fps, SCRUB_PREVIEW_MIN_FPS);
+}
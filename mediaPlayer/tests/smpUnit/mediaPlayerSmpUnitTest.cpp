@@ -0,0 +1,504 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "gtest/gtest.h"
+#include <SMPBufferPolicy.h>
+#include <SMPLatencyController.h>
+#include <SMPPipelineReaper.h>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <player_notifier.h>
+#include <thread>
+#include <utils/timer.h>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace Cicada;
+
+#define STEP_MS 50
+
+/*
+ * play a live stream at the rate given by the controller, the data comes in at 1x,
+ * the measured delay jitters with the packets arrived
+ */
+static int64_t runLatency(SMPLatencyController &controller, int64_t delayUs, int64_t targetUs, int64_t bandUs, int seconds,
+                          int64_t *maxErrorInTail)
+{
+    int64_t now = 1000;
+    int steps = seconds * 1000 / STEP_MS;
+    *maxErrorInTail = 0;
+
+    for (int i = 0; i < steps; i++) {
+        int64_t jitter = (i % 4) * 40 * 1000 - 60 * 1000;
+        float rate = controller.update(delayUs + jitter, targetUs, bandUs, now);
+        delayUs -= (int64_t) ((rate - 1.0f) * STEP_MS * 1000);
+        now += STEP_MS;
+
+        // the last quarter
+        if (i >= steps * 3 / 4) {
+            *maxErrorInTail = std::max(*maxErrorInTail, std::abs(delayUs - targetUs));
+        }
+    }
+
+    return delayUs;
+}
+
+TEST(latencyController, catchUp)
+{
+    SMPLatencyController controller;
+    controller.setRateRange(1.0f, 1.1f);
+    int64_t maxError;
+    int64_t delay = runLatency(controller, 5000 * 1000, 2000 * 1000, 400 * 1000, 120, &maxError);
+    ASSERT_LE(std::abs(delay - 2000 * 1000), 200 * 1000);
+    ASSERT_LE(maxError, 200 * 1000);
+    ASSERT_FALSE(controller.isAdjusting());
+}
+
+TEST(latencyController, slowDown)
+{
+    SMPLatencyController controller;
+    controller.setRateRange(0.95f, 1.1f);
+    int64_t maxError;
+    int64_t delay = runLatency(controller, 1000 * 1000, 2000 * 1000, 400 * 1000, 120, &maxError);
+    ASSERT_LE(std::abs(delay - 2000 * 1000), 200 * 1000);
+    ASSERT_LE(maxError, 200 * 1000);
+    ASSERT_FALSE(controller.isAdjusting());
+}
+
+TEST(latencyController, inBand)
+{
+    SMPLatencyController controller;
+    controller.setRateRange(0.95f, 1.1f);
+    int64_t maxError;
+    // not to touch the rate in the band
+    int64_t delay = runLatency(controller, 2150 * 1000, 2000 * 1000, 400 * 1000, 10, &maxError);
+    ASSERT_EQ(delay, 2150 * 1000);
+    ASSERT_FALSE(controller.isAdjusting());
+}
+
+/*
+ * rebuffer with the reading stopped by the memory budget as doReadPacket does, the packets under the budget last
+ * budgetUs, return the buffer when the rebuffering ends, -1 if it never ends
+ */
+static int64_t runRebuffer(int64_t budgetUs, int64_t startUs, int64_t highUs, int64_t maxUs)
+{
+    int64_t buffered = 0;
+    bool memoryLimited = false;
+
+    for (int i = 0; i < 1000; i++) {
+        if (SMPBufferPolicy::isBufferingDone(buffered, highUs, maxUs, false, memoryLimited)) {
+            return buffered;
+        }
+
+        memoryLimited = buffered >= budgetUs && buffered > SMPBufferPolicy::getMemoryFloor(startUs, highUs, true);
+
+        if (!memoryLimited) {
+            buffered += STEP_MS * 1000;
+        }
+    }
+
+    return -1;
+}
+
+TEST(bufferPolicy, memoryLimitedRebuffer)
+{
+    // the budget holds more than the start buffer but less than the high one, the rebuffering still ends
+    int64_t buffered = runRebuffer(1000 * 1000, 500 * 1000, 3000 * 1000, 50 * 1000 * 1000);
+    ASSERT_GT(buffered, 3000 * 1000);
+    ASSERT_LT(buffered, 3200 * 1000);
+
+    // only the playing buffer is shrunk to the start one
+    ASSERT_EQ(SMPBufferPolicy::getMemoryFloor(500 * 1000, 3000 * 1000, false), 500 * 1000);
+    ASSERT_TRUE(SMPBufferPolicy::isBufferingDone(1000 * 1000, 3000 * 1000, 50 * 1000 * 1000, false, true));
+    ASSERT_FALSE(SMPBufferPolicy::isBufferingDone(1000 * 1000, 3000 * 1000, 50 * 1000 * 1000, false, false));
+}
+
+#define START_US (1000 * 1000)
+#define HIGH_US (3000 * 1000)
+#define MAX_US (50 * 1000 * 1000)
+
+/*
+ * read a link in 10ms reads for the seconds, the kbps of the link change every 100ms in turn, return the time
+ */
+static int64_t readLink(SMPBufferPolicy &policy, int64_t nowUs, const std::vector<int> &kbps, int seconds)
+{
+    for (int i = 0; i < seconds * 100; i++) {
+        policy.onRead((int64_t) kbps[(i / 10) % kbps.size()] * 10 / 8, nowUs);
+        nowUs += 10 * 1000;
+    }
+
+    return nowUs;
+}
+
+TEST(bufferPolicy, fastLink)
+{
+    SMPBufferPolicy policy{};
+    policy.setBitrate(1000 * 1000);
+    ASSERT_EQ(policy.getStartBufferDuration(START_US, HIGH_US), START_US);
+    readLink(policy, 0, {4000}, 2);
+    ASSERT_NEAR(policy.getThroughput(), 4000 * 1000, 100 * 1000);
+    ASSERT_NEAR(policy.getStartBufferDuration(START_US, HIGH_US), START_US / 4, 20 * 1000);
+    ASSERT_NEAR(policy.getHighBufferDuration(HIGH_US, MAX_US), HIGH_US, 50 * 1000);
+    ASSERT_EQ(policy.getMaxBufferDuration(MAX_US, HIGH_US), MAX_US);
+
+    // 1MB holds 8s of 1mbps
+    policy.setMemoryCap(1000 * 1000);
+    ASSERT_EQ(policy.getMaxBufferDuration(MAX_US, HIGH_US), 8 * 1000 * 1000);
+    policy.setMemoryCap(100 * 1000);
+    ASSERT_EQ(policy.getMaxBufferDuration(MAX_US, HIGH_US), HIGH_US);
+}
+
+TEST(bufferPolicy, slowLink)
+{
+    SMPBufferPolicy policy{};
+    policy.setBitrate(1000 * 1000);
+    readLink(policy, 0, {500}, 2);
+    ASSERT_NEAR(policy.getStartBufferDuration(START_US, HIGH_US), 2000 * 1000, 50 * 1000);
+    ASSERT_NEAR(policy.getHighBufferDuration(HIGH_US, MAX_US), 6000 * 1000, 200 * 1000);
+}
+
+TEST(bufferPolicy, unstableLink)
+{
+    SMPBufferPolicy policy{};
+    policy.setBitrate(1000 * 1000);
+    readLink(policy, 0, {4000, 250}, 4);
+    // faster than the media in average, but buffers as a slow one
+    ASSERT_GT(policy.getThroughput(), 1000 * 1000);
+    ASSERT_GT(policy.getStartBufferDuration(START_US, HIGH_US), START_US);
+    ASSERT_GT(policy.getHighBufferDuration(HIGH_US, MAX_US), HIGH_US * 3 / 2);
+    ASSERT_LE(policy.getHighBufferDuration(HIGH_US, 5000 * 1000), 5000 * 1000);
+}
+
+TEST(bufferPolicy, burstAfterBlock)
+{
+    SMPBufferPolicy policy{};
+    policy.setBitrate(1000 * 1000);
+    int64_t now = readLink(policy, 0, {1000}, 2);
+
+    // the buffer was full for a second, the data piled in the socket comes in at once
+    policy.onReadBlocked();
+    now += 1000 * 1000;
+
+    for (int i = 0; i < 5; i++) {
+        policy.onRead(100 * 1000, now);
+        now += 10 * 1000;
+    }
+
+    readLink(policy, now, {1000}, 1);
+    ASSERT_NEAR(policy.getThroughput(), 1000 * 1000, 100 * 1000);
+}
+
+TEST(pipelineReaper, releaseInPlaceWhenFull)
+{
+    SMPPipelineReaper &reaper = SMPPipelineReaper::getInstance();
+    int owner;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool released = false;
+
+    // the bound of the pipelines in releasing
+    for (int i = 0; i < 8; i++) {
+        reaper.post(&owner, [&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&released]() { return released; });
+        });
+    }
+
+    // not to wait for the stuck ones
+    std::thread::id releasedOn;
+    reaper.post(&owner, [&releasedOn]() { releasedOn = std::this_thread::get_id(); });
+    int pending = reaper.getPendingCount();
+
+    // the stuck ones refer to the locals, release them before any assertion returns
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+    }
+    condition.notify_all();
+    reaper.wait(&owner);
+
+    ASSERT_EQ(releasedOn, std::this_thread::get_id());
+    ASSERT_EQ(pending, 8);
+    ASSERT_EQ(reaper.getPendingCount(), 0);
+}
+
+enum notifierEventType { NOTIFIER_EVENT_PROGRESS, NOTIFIER_EVENT_POSITION, NOTIFIER_EVENT_VIDEO_RENDERED };
+
+typedef struct notifierContext {
+    std::mutex mutex;
+    std::condition_variable condition;
+    // the listener is held in Prepared until released, so the events are queued
+    bool blocked{false};
+    bool released{false};
+    std::vector<std::pair<int, int64_t>> events;
+} notifierContext;
+
+static void onNotifierPrepared(void *userData)
+{
+    auto *context = static_cast<notifierContext *>(userData);
+    std::unique_lock<std::mutex> lock(context->mutex);
+    context->blocked = true;
+    context->condition.notify_all();
+    context->condition.wait(lock, [context]() { return context->released; });
+}
+
+static void addNotifierEvent(void *userData, int type, int64_t value)
+{
+    auto *context = static_cast<notifierContext *>(userData);
+    std::lock_guard<std::mutex> lock(context->mutex);
+    context->events.emplace_back(type, value);
+    context->condition.notify_all();
+}
+
+static void onNotifierProgress(int64_t progress, void *userData)
+{
+    addNotifierEvent(userData, NOTIFIER_EVENT_PROGRESS, progress);
+}
+
+static void onNotifierPosition(int64_t position, void *userData)
+{
+    addNotifierEvent(userData, NOTIFIER_EVENT_POSITION, position);
+}
+
+static void onNotifierVideoRendered(int64_t timeMs, int64_t pts, void *userData)
+{
+    addNotifierEvent(userData, NOTIFIER_EVENT_VIDEO_RENDERED, pts);
+}
+
+static void setNotifierListener(PlayerNotifier &notifier, notifierContext &context)
+{
+    playerListener listener{nullptr};
+    listener.Prepared = onNotifierPrepared;
+    listener.LoadingProgress = onNotifierProgress;
+    listener.PositionUpdate = onNotifierPosition;
+    listener.VideoRendered = onNotifierVideoRendered;
+    listener.userData = &context;
+    notifier.setListener(listener);
+}
+
+static void blockNotifier(PlayerNotifier &notifier, notifierContext &context)
+{
+    notifier.NotifyPrepared();
+    std::unique_lock<std::mutex> lock(context.mutex);
+    context.condition.wait(lock, [&context]() { return context.blocked; });
+}
+
+static void releaseNotifier(notifierContext &context)
+{
+    std::lock_guard<std::mutex> lock(context.mutex);
+    context.released = true;
+    context.condition.notify_all();
+}
+
+static bool waitNotifierEvent(notifierContext &context, int type, int64_t value)
+{
+    std::unique_lock<std::mutex> lock(context.mutex);
+    return context.condition.wait_for(lock, std::chrono::seconds(5), [&context, type, value]() {
+        return !context.events.empty() && context.events.back() == std::make_pair(type, value);
+    });
+}
+
+static std::vector<int64_t> getNotifierValues(notifierContext &context, int type)
+{
+    std::lock_guard<std::mutex> lock(context.mutex);
+    std::vector<int64_t> values;
+
+    for (auto &event : context.events) {
+        if (event.first == type) {
+            values.push_back(event.second);
+        }
+    }
+
+    return values;
+}
+
+TEST(playerNotifier, ringOrder)
+{
+    const int producerCount = 4;
+    const int eventCount = 2000;
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+    std::vector<std::thread> producers;
+
+    for (int i = 0; i < producerCount; i++) {
+        producers.emplace_back([&notifier, i]() {
+            for (int j = 0; j < eventCount; j++) {
+                notifier.NotifyLoading(loading_event_progress, i * eventCount + j);
+            }
+        });
+    }
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(context.mutex);
+        ASSERT_TRUE(context.condition.wait_for(lock, std::chrono::seconds(5),
+                                               [&context]() { return context.events.size() >= producerCount * eventCount; }));
+    }
+
+    // in order of each producer, nothing lost nor duplicated
+    std::vector<int64_t> values = getNotifierValues(context, NOTIFIER_EVENT_PROGRESS);
+    ASSERT_EQ(values.size(), producerCount * eventCount);
+    std::vector<int64_t> next(producerCount);
+
+    for (int i = 0; i < producerCount; i++) {
+        next[i] = i * eventCount;
+    }
+
+    for (int64_t value : values) {
+        int producer = (int) (value / eventCount);
+        ASSERT_EQ(value, next[producer]);
+        next[producer]++;
+    }
+}
+
+TEST(playerNotifier, overflowOrder)
+{
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+    blockNotifier(notifier, context);
+
+    // much more than the ring, the rest are in the overflow list
+    for (int i = 0; i < 1000; i++) {
+        notifier.NotifyLoading(loading_event_progress, i);
+    }
+
+    releaseNotifier(context);
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_PROGRESS, 999));
+
+    // the ring is used again after the overflow is drained
+    for (int i = 1000; i < 1010; i++) {
+        notifier.NotifyLoading(loading_event_progress, i);
+    }
+
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_PROGRESS, 1009));
+    std::vector<int64_t> values = getNotifierValues(context, NOTIFIER_EVENT_PROGRESS);
+    ASSERT_EQ(values.size(), 1010);
+
+    for (int i = 0; i < values.size(); i++) {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST(playerNotifier, stateAfterOlderEvents)
+{
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+    blockNotifier(notifier, context);
+
+    notifier.NotifyPosition(1);
+    notifier.NotifyLoading(loading_event_progress, 2);
+    notifier.NotifyPosition(3);
+    releaseNotifier(context);
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_POSITION, 3));
+
+    // the newest position is set after the progress, it must not overtake it
+    std::lock_guard<std::mutex> lock(context.mutex);
+    ASSERT_EQ(context.events.size(), 2);
+    ASSERT_EQ(context.events[0], std::make_pair((int) NOTIFIER_EVENT_PROGRESS, (int64_t) 2));
+}
+
+TEST(playerNotifier, renderedEvents)
+{
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+
+    // every one is delivered by default
+    blockNotifier(notifier, context);
+
+    for (int i = 0; i < 100; i++) {
+        notifier.NotifyVideoRendered(i, i);
+    }
+
+    releaseNotifier(context);
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_VIDEO_RENDERED, 99));
+    std::vector<int64_t> values = getNotifierValues(context, NOTIFIER_EVENT_VIDEO_RENDERED);
+    ASSERT_EQ(values.size(), 100);
+
+    // only the newest one when coalesced
+    notifier.setCoalesceRenderedEvents(true);
+    {
+        std::lock_guard<std::mutex> lock(context.mutex);
+        context.events.clear();
+        context.blocked = false;
+        context.released = false;
+    }
+    blockNotifier(notifier, context);
+
+    for (int i = 100; i < 200; i++) {
+        notifier.NotifyVideoRendered(i, i);
+    }
+
+    releaseNotifier(context);
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_VIDEO_RENDERED, 199));
+    values = getNotifierValues(context, NOTIFIER_EVENT_VIDEO_RENDERED);
+    ASSERT_EQ(values.size(), 1);
+}
+
+TEST(playerNotifier, rateLimit)
+{
+    const int intervalMs = 100;
+    const int durationMs = 1000;
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+    notifier.setStateEventInterval(intervalMs);
+    int64_t start = af_getsteady_ms();
+    int64_t position = 0;
+
+    while (af_getsteady_ms() - start < durationMs) {
+        notifier.NotifyPosition(++position);
+        af_msleep(1);
+    }
+
+    // the newest one is delivered at last
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_POSITION, position));
+    std::vector<int64_t> values = getNotifierValues(context, NOTIFIER_EVENT_POSITION);
+    ASSERT_LE(values.size(), durationMs / intervalMs + 2);
+    ASSERT_GE(values.size(), durationMs / intervalMs / 2);
+}
+
+#ifndef WIN32
+static int64_t getCpuTimeUs()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+// the cpu of the notifier and the producer, at the event rate of a 60 fps playback
+TEST(playerNotifier, cpu)
+{
+    const int durationMs = 2000;
+    notifierContext context{};
+    PlayerNotifier notifier;
+    setNotifierListener(notifier, context);
+    int64_t cpuStart = getCpuTimeUs();
+    int64_t start = af_getsteady_ms();
+    int64_t frames = 0;
+
+    while (af_getsteady_ms() - start < durationMs) {
+        notifier.NotifyVideoRendered(af_getsteady_ms(), frames * 16667);
+        notifier.NotifyPosition(frames * 16);
+        frames++;
+        af_msleep(16);
+    }
+
+    int64_t wallUs = (af_getsteady_ms() - start) * 1000;
+    int64_t cpuUs = getCpuTimeUs() - cpuStart;
+    printf("{\"frames\":%lld,\"cpuUs\":%lld,\"wallUs\":%lld}\n", (long long) frames, (long long) cpuUs, (long long) wallUs);
+    ASSERT_TRUE(waitNotifierEvent(context, NOTIFIER_EVENT_POSITION, (frames - 1) * 16));
+    EXPECT_LT(cpuUs, wallUs / 20);
+}
+#endif
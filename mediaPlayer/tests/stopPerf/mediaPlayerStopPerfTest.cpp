@@ -0,0 +1,133 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+/*
+ * The latency of Stop while the link of the network emulator stalls, on the generated HLS clip from a loopback
+ * http server. The asynchronous Stop detaches the pipeline and leaves the blocked closing to the reaper, the rest
+ * of it is joining the player loop and flushing the decoders and the renders, a few ms at most. The synchronous
+ * one is reported for comparison.
+ */
+
+#include "gtest/gtest.h"
+#include "tests/localHttpServer.h"
+#include "tests/mediaFixture.h"
+#include <MediaPlayer.h>
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utils/AFUtils.h>
+#include <utils/frame_work_log.h>
+#include <utils/globalSettings.h>
+#include <utils/timer.h>
+#include <vector>
+
+// the link stalls after STALL_AFTER_MS in every STALL_INTERVAL_MS
+#define STALL_AFTER_MS 3000
+#define STALL_INTERVAL_MS (60 * 1000)
+#define ASYNC_STOP_RUNS 3
+// the median of the runs
+#define ASYNC_STOP_BUDGET_MS 10
+
+using namespace Cicada;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ignore_signal(SIGPIPE);
+    globalSettings::getSetting().setProperty("protected.render.headless", "ON");
+    return RUN_ALL_TESTS();
+}
+
+typedef struct stopContext {
+    mutex mMutex;
+    condition_variable mCond;
+    bool firstFrame{false};
+    bool error{false};
+} stopContext;
+
+static void onFirstFrameShow(void *userData)
+{
+    auto *context = static_cast<stopContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->firstFrame = true;
+    context->mCond.notify_all();
+}
+
+static void onError(int64_t errorCode, const void *errorMsg, void *userData)
+{
+    AF_LOGE("stop perf error %lld %s\n", errorCode, errorMsg ? (const char *) errorMsg : "");
+    auto *context = static_cast<stopContext *>(userData);
+    lock_guard<mutex> lock(context->mMutex);
+    context->error = true;
+    context->mCond.notify_all();
+}
+
+// stop while the link stalls, return the time Stop costs, or -1 if not started before the stall
+static int64_t stopStalled(const string &url, bool async)
+{
+    stopContext context{};
+    playerListener listener{nullptr};
+    listener.FirstFrameShow = onFirstFrameShow;
+    listener.ErrorCallback = onError;
+    listener.userData = &context;
+
+    // the time line of the emulated link starts from here
+    globalSettings::getSetting().setProperty(
+            "protected.network.emulator",
+            "{\"stallIntervalMs\":" + to_string(STALL_INTERVAL_MS) + ",\"stallMs\":" + to_string(STALL_INTERVAL_MS - STALL_AFTER_MS) + "}");
+    int64_t start = af_getsteady_ms();
+    unique_ptr<MediaPlayer> player = unique_ptr<MediaPlayer>(new MediaPlayer());
+    int view;
+    player->SetView(&view);
+    player->SetListener(listener);
+    player->SetOption("asyncStop", async ? "1" : "0");
+    player->SetDataSource(url.c_str());
+    player->SetAutoPlay(true);
+    player->Prepare();
+    bool started;
+    {
+        unique_lock<mutex> lock(context.mMutex);
+        context.mCond.wait_for(lock, chrono::milliseconds(STALL_AFTER_MS),
+                               [&context]() { return context.firstFrame || context.error; });
+        started = context.firstFrame;
+    }
+
+    // in the stall, the reading is blocked
+    af_msleep((int) std::max(STALL_AFTER_MS + 500 - (af_getsteady_ms() - start), (int64_t) 0));
+    int64_t stopStart = af_getsteady_ms();
+    player->Stop();
+    int64_t cost = af_getsteady_ms() - stopStart;
+    player = nullptr;
+    globalSettings::getSetting().setProperty("protected.network.emulator", "");
+    return started ? cost : -1;
+}
+
+TEST(stopPerf, stalledSource)
+{
+    string dir = mediaFixture::getDir();
+    mediaFixture::Config fixture{};
+    // longer than the link delivers before the stall
+    fixture.durationMs = 60 * 1000;
+    ASSERT_GE(mediaFixture::generate(dir, "stop", fixture), 0);
+    localHttpServer server(dir);
+    ASSERT_GT(server.start(), 0);
+    string url = server.getUrl("stop_hls/index.m3u8");
+
+    int64_t syncCost = stopStalled(url, false);
+    vector<int64_t> asyncCosts;
+
+    for (int i = 0; i < ASYNC_STOP_RUNS; i++) {
+        asyncCosts.push_back(stopStalled(url, true));
+    }
+
+    server.stop();
+    sort(asyncCosts.begin(), asyncCosts.end());
+    int64_t asyncCost = asyncCosts[ASYNC_STOP_RUNS / 2];
+    printf("{\"stop\":%lld,\"asyncStop\":%lld}\n", (long long) syncCost, (long long) asyncCost);
+    ASSERT_GE(syncCost, 0) << url << " not started before the stall";
+    ASSERT_GE(asyncCosts.front(), 0) << url << " not started before the stall";
+    EXPECT_LE(asyncCost, ASYNC_STOP_BUDGET_MS);
+}